@@ -252,6 +252,7 @@ static MQTTPubAckType_t getAckFromPacketType( uint8_t packetType );
  * @brief Receive bytes into the network buffer.
  *
  * @param[in] pContext Initialized MQTT Context.
+ * @param[in] offset Offset in the network buffer where the bytes are stored.
  * @param[in] bytesToRecv Number of bytes to receive.
  *
  * @note This operation calls the transport receive function
@@ -267,6 +268,7 @@ static MQTTPubAckType_t getAckFromPacketType( uint8_t packetType );
  * @return Number of bytes received, or negative number on network error.
  */
 static int32_t recvExact( const MQTTContext_t * pContext,
+                          size_t offset,
                           size_t bytesToRecv );
 
 /**
@@ -339,6 +341,24 @@ static MQTTStatus_t sendPublishAcks( MQTTContext_t * pContext,
  */
 static MQTTStatus_t handleKeepAlive( MQTTContext_t * pContext );
 
+/**
+ * @brief Update the state record of a received PUBLISH packet.
+ *
+ * @param[in] pContext MQTT Connection context.
+ * @param[in] packetIdentifier Packet ID of the PUBLISH.
+ * @param[in] pPublishInfo Deserialized PUBLISH.
+ * @param[out] pPublishRecordState State used to send the PUBACK or PUBREC.
+ * @param[out] pDuplicatePublish Set when the PUBLISH was received before and
+ * must not be passed to the application.
+ *
+ * @return MQTTSuccess, MQTTRecvFailed or a state update error.
+ */
+static MQTTStatus_t updateIncomingPublishState( MQTTContext_t * pContext,
+                                                uint16_t packetIdentifier,
+                                                const MQTTPublishInfo_t * pPublishInfo,
+                                                MQTTPublishState_t * pPublishRecordState,
+                                                bool * pDuplicatePublish );
+
 /**
  * @brief Handle received MQTT PUBLISH packet.
  *
@@ -350,6 +370,33 @@ static MQTTStatus_t handleKeepAlive( MQTTContext_t * pContext );
 static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
                                            MQTTPacketInfo_t * pIncomingPacket );
 
+#if ( MQTT_STREAM_LARGE_PUBLISH == 1 )
+
+/**
+ * @brief Handle a received PUBLISH packet larger than the network buffer by
+ * passing its payload to the application in fragments.
+ *
+ * The fixed header, topic name and packet ID stay at the start of the network
+ * buffer; each fragment of the payload is received into the rest of it.
+ *
+ * @param[in] pContext MQTT Connection context.
+ * @param[in] pIncomingPacket Incoming packet, partially in the network buffer.
+ *
+ * @note A deserialization or state update error is returned only after the
+ * rest of the packet has been drained from the transport, so the connection
+ * can go on. #MQTTRecvFailed means the packet could not be read to its end
+ * and the stream is out of sync: the connection must be closed.
+ *
+ * @return #MQTTNeedMoreBytes if the topic name has not been received yet;
+ * #MQTTNoDataAvailable once the packet is consumed (streamed, or discarded if
+ * its variable header does not fit in the buffer); #MQTTRecvFailed,
+ * #MQTTSendFailed or a deserialization or state update error otherwise.
+ */
+static MQTTStatus_t handleStreamedPublish( MQTTContext_t * pContext,
+                                           MQTTPacketInfo_t * pIncomingPacket );
+
+#endif /* if ( MQTT_STREAM_LARGE_PUBLISH == 1 ) */
+
 /**
  * @brief Handle received MQTT publish acks.
  *
@@ -478,6 +525,75 @@ static MQTTStatus_t validatePublishParams( const MQTTContext_t * pContext,
                                            const MQTTPublishInfo_t * pPublishInfo,
                                            uint16_t packetId );
 
+/**
+ * @brief Function to validate #MQTT_PublishBatch parameters.
+ *
+ * @brief param[in] pContext Initialized MQTT context.
+ * @brief param[in] pPublishInfo Array of MQTT PUBLISH packet parameters.
+ * @brief param[in] pPacketIds Packet Ids for the MQTT PUBLISH packets.
+ * @brief param[in] publishCount Number of publishes in the batch.
+ * @brief param[in] pHeaderBuffer Buffer for the serialized headers.
+ *
+ * @return #MQTTBadParameter if invalid parameters are passed;
+ * #MQTTSuccess otherwise.
+ */
+static MQTTStatus_t validatePublishBatchParams( const MQTTContext_t * pContext,
+                                                const MQTTPublishInfo_t * pPublishInfo,
+                                                const uint16_t * pPacketIds,
+                                                size_t publishCount,
+                                                const MQTTFixedBuffer_t * pHeaderBuffer );
+
+/**
+ * @brief Serialize everything but the payload of a batch of PUBLISH packets
+ * into a buffer, one packet after the other.
+ *
+ * @brief param[in] pPublishInfo Array of MQTT PUBLISH packet parameters.
+ * @brief param[in] pPacketIds Packet Ids for the MQTT PUBLISH packets.
+ * @brief param[in] publishCount Number of publishes in the batch.
+ * @brief param[in] pHeaderBuffer Buffer for the serialized headers.
+ *
+ * @return #MQTTNoMemory if the headers do not fit in @p pHeaderBuffer;
+ * #MQTTBadParameter if a packet cannot be serialized;
+ * #MQTTSuccess otherwise.
+ */
+static MQTTStatus_t serializePublishBatch( const MQTTPublishInfo_t * pPublishInfo,
+                                           const uint16_t * pPacketIds,
+                                           size_t publishCount,
+                                           const MQTTFixedBuffer_t * pHeaderBuffer );
+
+/**
+ * @brief Reserve the state records of the QoS 1 and QoS 2 publishes of a
+ * batch, releasing those already reserved if one fails.
+ *
+ * @brief param[in] pContext Initialized MQTT context.
+ * @brief param[in] pPublishInfo Array of MQTT PUBLISH packet parameters.
+ * @brief param[in] pPacketIds Packet Ids for the MQTT PUBLISH packets.
+ * @brief param[in] publishCount Number of publishes in the batch.
+ *
+ * @return #MQTTSuccess, or the status of the failed reservation.
+ */
+static MQTTStatus_t reservePublishBatch( const MQTTContext_t * pContext,
+                                         const MQTTPublishInfo_t * pPublishInfo,
+                                         const uint16_t * pPacketIds,
+                                         size_t publishCount );
+
+/**
+ * @brief Send a batch of PUBLISH packets serialized by #serializePublishBatch
+ * with as few transport calls as #MQTT_PUBLISH_BATCH_MAX_VECTORS allows.
+ *
+ * @brief param[in] pContext Initialized MQTT context.
+ * @brief param[in] pPublishInfo Array of MQTT PUBLISH packet parameters.
+ * @brief param[in] publishCount Number of publishes in the batch.
+ * @brief param[in] pHeaderBuffer Buffer with the serialized headers.
+ *
+ * @return #MQTTSendFailed if transport send failed;
+ * #MQTTSuccess otherwise.
+ */
+static MQTTStatus_t sendPublishBatch( MQTTContext_t * pContext,
+                                      const MQTTPublishInfo_t * pPublishInfo,
+                                      size_t publishCount,
+                                      const MQTTFixedBuffer_t * pHeaderBuffer );
+
 /**
  * @brief Performs matching for special cases when a topic filter ends
  * with a wildcard character.
@@ -963,6 +1079,7 @@ static MQTTPubAckType_t getAckFromPacketType( uint8_t packetType )
 /*-----------------------------------------------------------*/
 
 static int32_t recvExact( const MQTTContext_t * pContext,
+                          size_t offset,
                           size_t bytesToRecv )
 {
     uint8_t * pIndex = NULL;
@@ -974,12 +1091,13 @@ static int32_t recvExact( const MQTTContext_t * pContext,
     bool receiveError = false;
 
     assert( pContext != NULL );
-    assert( bytesToRecv <= pContext->networkBuffer.size );
+    assert( offset <= pContext->networkBuffer.size );
+    assert( bytesToRecv <= ( pContext->networkBuffer.size - offset ) );
     assert( pContext->getTime != NULL );
     assert( pContext->transportInterface.recv != NULL );
     assert( pContext->networkBuffer.pBuffer != NULL );
 
-    pIndex = pContext->networkBuffer.pBuffer;
+    pIndex = &( pContext->networkBuffer.pBuffer[ offset ] );
     recvFunc = pContext->transportInterface.recv;
     getTimeStampMs = pContext->getTime;
 
@@ -1067,7 +1185,7 @@ static MQTTStatus_t discardPacket( const MQTTContext_t * pContext,
             bytesToReceive = remainingLength - totalBytesReceived;
         }
 
-        bytesReceived = recvExact( pContext, bytesToReceive );
+        bytesReceived = recvExact( pContext, 0U, bytesToReceive );
 
         if( bytesReceived != ( int32_t ) bytesToReceive )
         {
@@ -1138,7 +1256,7 @@ static MQTTStatus_t discardStoredPacket( MQTTContext_t * pContext,
             bytesToReceive = remainingLength - totalBytesReceived;
         }
 
-        bytesReceived = recvExact( pContext, bytesToReceive );
+        bytesReceived = recvExact( pContext, 0U, bytesToReceive );
 
         if( bytesReceived != ( int32_t ) bytesToReceive )
         {
@@ -1200,7 +1318,7 @@ static MQTTStatus_t receivePacket( const MQTTContext_t * pContext,
     else
     {
         bytesToReceive = incomingPacket.remainingLength;
-        bytesReceived = recvExact( pContext, bytesToReceive );
+        bytesReceived = recvExact( pContext, 0U, bytesToReceive );
 
         if( bytesReceived == ( int32_t ) bytesToReceive )
         {
@@ -1392,27 +1510,21 @@ static MQTTStatus_t handleKeepAlive( MQTTContext_t * pContext )
 
 /*-----------------------------------------------------------*/
 
-static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
-                                           MQTTPacketInfo_t * pIncomingPacket )
+static MQTTStatus_t updateIncomingPublishState( MQTTContext_t * pContext,
+                                                uint16_t packetIdentifier,
+                                                const MQTTPublishInfo_t * pPublishInfo,
+                                                MQTTPublishState_t * pPublishRecordState,
+                                                bool * pDuplicatePublish )
 {
-    MQTTStatus_t status = MQTTBadParameter;
-    MQTTPublishState_t publishRecordState = MQTTStateNull;
-    uint16_t packetIdentifier = 0U;
-    MQTTPublishInfo_t publishInfo;
-    MQTTDeserializedInfo_t deserializedInfo;
-    bool duplicatePublish = false;
+    MQTTStatus_t status = MQTTSuccess;
 
     assert( pContext != NULL );
-    assert( pIncomingPacket != NULL );
-    assert( pContext->appCallback != NULL );
+    assert( pPublishInfo != NULL );
+    assert( pPublishRecordState != NULL );
+    assert( pDuplicatePublish != NULL );
 
-    status = MQTT_DeserializePublish( pIncomingPacket, &packetIdentifier, &publishInfo );
-    LogInfo( ( "De-serialized incoming PUBLISH packet: DeserializerResult=%s.",
-               MQTT_Status_strerror( status ) ) );
-
-    if( ( status == MQTTSuccess ) &&
-        ( pContext->incomingPublishRecords == NULL ) &&
-        ( publishInfo.qos > MQTTQoS0 ) )
+    if( ( pContext->incomingPublishRecords == NULL ) &&
+        ( pPublishInfo->qos > MQTTQoS0 ) )
     {
         LogError( ( "Incoming publish has QoS > MQTTQoS0 but incoming "
                     "publish records have not been initialized. Dropping the "
@@ -1428,15 +1540,15 @@ static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
         status = MQTT_UpdateStatePublish( pContext,
                                           packetIdentifier,
                                           MQTT_RECEIVE,
-                                          publishInfo.qos,
-                                          &publishRecordState );
+                                          pPublishInfo->qos,
+                                          pPublishRecordState );
 
         MQTT_POST_STATE_UPDATE_HOOK( pContext );
 
         if( status == MQTTSuccess )
         {
             LogInfo( ( "State record updated. New state=%s.",
-                       MQTT_State_strerror( publishRecordState ) ) );
+                       MQTT_State_strerror( *pPublishRecordState ) ) );
         }
 
         /* Different cases in which an incoming publish with duplicate flag is
@@ -1468,17 +1580,17 @@ static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
         else if( status == MQTTStateCollision )
         {
             status = MQTTSuccess;
-            duplicatePublish = true;
+            *pDuplicatePublish = true;
 
             /* Calculate the state for the ack packet that needs to be sent out
              * for the duplicate incoming publish. */
-            publishRecordState = MQTT_CalculateStatePublish( MQTT_RECEIVE,
-                                                             publishInfo.qos );
+            *pPublishRecordState = MQTT_CalculateStatePublish( MQTT_RECEIVE,
+                                                              pPublishInfo->qos );
 
             LogDebug( ( "Incoming publish packet with packet id %hu already exists.",
                         ( unsigned short ) packetIdentifier ) );
 
-            if( publishInfo.dup == false )
+            if( pPublishInfo->dup == false )
             {
                 LogError( ( "DUP flag is 0 for duplicate packet (MQTT-3.3.1.-1)." ) );
             }
@@ -1492,12 +1604,48 @@ static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
         }
     }
 
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
+                                           MQTTPacketInfo_t * pIncomingPacket )
+{
+    MQTTStatus_t status = MQTTBadParameter;
+    MQTTPublishState_t publishRecordState = MQTTStateNull;
+    uint16_t packetIdentifier = 0U;
+    MQTTPublishInfo_t publishInfo;
+    MQTTDeserializedInfo_t deserializedInfo;
+    bool duplicatePublish = false;
+
+    assert( pContext != NULL );
+    assert( pIncomingPacket != NULL );
+    assert( pContext->appCallback != NULL );
+
+    status = MQTT_DeserializePublish( pIncomingPacket, &packetIdentifier, &publishInfo );
+    LogInfo( ( "De-serialized incoming PUBLISH packet: DeserializerResult=%s.",
+               MQTT_Status_strerror( status ) ) );
+
+    if( status == MQTTSuccess )
+    {
+        status = updateIncomingPublishState( pContext,
+                                             packetIdentifier,
+                                             &publishInfo,
+                                             &publishRecordState,
+                                             &duplicatePublish );
+    }
+
     if( status == MQTTSuccess )
     {
         /* Set fields of deserialized struct. */
         deserializedInfo.packetIdentifier = packetIdentifier;
         deserializedInfo.pPublishInfo = &publishInfo;
         deserializedInfo.deserializationResult = status;
+        #if ( MQTT_STREAM_LARGE_PUBLISH == 1 )
+            deserializedInfo.payloadOffset = 0U;
+            deserializedInfo.payloadTotalLength = publishInfo.payloadLength;
+        #endif
 
         /* Invoke application callback to hand the buffer over to application
          * before sending acks.
@@ -1521,6 +1669,175 @@ static MQTTStatus_t handleIncomingPublish( MQTTContext_t * pContext,
 
 /*-----------------------------------------------------------*/
 
+#if ( MQTT_STREAM_LARGE_PUBLISH == 1 )
+
+static MQTTStatus_t handleStreamedPublish( MQTTContext_t * pContext,
+                                           MQTTPacketInfo_t * pIncomingPacket )
+{
+    MQTTStatus_t status = MQTTSuccess;
+    MQTTPublishState_t publishRecordState = MQTTStateNull;
+    uint16_t packetIdentifier = 0U;
+    MQTTPublishInfo_t publishInfo;
+    MQTTDeserializedInfo_t deserializedInfo;
+    bool duplicatePublish = false;
+    uint8_t * pBuffer;
+    size_t bufferSize, payloadStart, payloadLength = 0U;
+    size_t bytesDelivered = 0U, fragmentLength = 0U;
+    int32_t bytesReceived;
+
+    assert( pContext != NULL );
+    assert( pIncomingPacket != NULL );
+    assert( pContext->appCallback != NULL );
+
+    pBuffer = pContext->networkBuffer.pBuffer;
+    bufferSize = pContext->networkBuffer.size;
+
+    /* The variable header is the topic name, prefixed by its length, and the
+     * packet ID for QoS 1 and 2. */
+    payloadStart = pIncomingPacket->headerLength + sizeof( uint16_t );
+
+    if( pContext->index >= payloadStart )
+    {
+        payloadStart += ( ( size_t ) pBuffer[ pIncomingPacket->headerLength ] << 8U ) |
+                        ( size_t ) pBuffer[ pIncomingPacket->headerLength + 1U ];
+
+        if( ( pIncomingPacket->type & 0x06U ) != 0U )
+        {
+            payloadStart += sizeof( uint16_t );
+        }
+    }
+
+    if( payloadStart >= bufferSize )
+    {
+        /* No room for the variable header and a fragment of the payload. */
+        LogError( ( "Incoming PUBLISH will be dumped: Variable header does not "
+                    "fit in the network buffer. NetworkBufferSize=%lu.",
+                    ( unsigned long ) bufferSize ) );
+        status = discardStoredPacket( pContext, pIncomingPacket );
+    }
+    else if( pContext->index < payloadStart )
+    {
+        status = MQTTNeedMoreBytes;
+    }
+    else
+    {
+        pIncomingPacket->pRemainingData = &pBuffer[ pIncomingPacket->headerLength ];
+        status = MQTT_DeserializePublish( pIncomingPacket, &packetIdentifier, &publishInfo );
+        LogInfo( ( "De-serialized incoming streamed PUBLISH packet: DeserializerResult=%s.",
+                   MQTT_Status_strerror( status ) ) );
+
+        if( status == MQTTSuccess )
+        {
+            status = updateIncomingPublishState( pContext,
+                                                 packetIdentifier,
+                                                 &publishInfo,
+                                                 &publishRecordState,
+                                                 &duplicatePublish );
+        }
+
+        if( status == MQTTSuccess )
+        {
+            /* The packet is larger than the buffer, so every received byte
+             * belongs to it; those after the variable header are the first
+             * fragment of the payload. */
+            payloadLength = publishInfo.payloadLength;
+            fragmentLength = pContext->index - payloadStart;
+            publishInfo.pPayload = &pBuffer[ payloadStart ];
+
+            deserializedInfo.packetIdentifier = packetIdentifier;
+            deserializedInfo.pPublishInfo = &publishInfo;
+            deserializedInfo.deserializationResult = status;
+            deserializedInfo.payloadTotalLength = payloadLength;
+        }
+        else
+        {
+            /* The rest of the packet is still in the transport: drain it so
+             * that the next read starts at a fixed header. The error is
+             * reported either way; the stream stays in sync unless the drain
+             * itself fails. */
+            if( discardStoredPacket( pContext, pIncomingPacket ) != MQTTNoDataAvailable )
+            {
+                status = MQTTRecvFailed;
+            }
+        }
+
+        while( ( status == MQTTSuccess ) && ( bytesDelivered < payloadLength ) )
+        {
+            if( fragmentLength == 0U )
+            {
+                /* Receive the next fragment after the variable header, so the
+                 * topic name stays valid. */
+                fragmentLength = payloadLength - bytesDelivered;
+
+                if( fragmentLength > ( bufferSize - payloadStart ) )
+                {
+                    fragmentLength = bufferSize - payloadStart;
+                }
+
+                bytesReceived = recvExact( pContext, payloadStart, fragmentLength );
+
+                if( bytesReceived != ( int32_t ) fragmentLength )
+                {
+                    LogError( ( "Streamed PUBLISH reception failed. ReceivedBytes=%ld, "
+                                "ExpectedBytes=%lu.",
+                                ( long int ) bytesReceived,
+                                ( unsigned long ) fragmentLength ) );
+                    status = MQTTRecvFailed;
+
+                    /* The application never sees the last fragment: forget
+                     * the publish so that a copy resent by the broker is
+                     * delivered again. */
+                    if( ( publishInfo.qos > MQTTQoS0 ) && ( duplicatePublish == false ) )
+                    {
+                        ( void ) MQTT_RemoveIncomingStateRecord( pContext, packetIdentifier );
+                    }
+                }
+            }
+
+            if( status == MQTTSuccess )
+            {
+                /* Duplicates are drained without reaching the application. */
+                if( duplicatePublish == false )
+                {
+                    publishInfo.payloadLength = fragmentLength;
+                    deserializedInfo.payloadOffset = bytesDelivered;
+                    pContext->appCallback( pContext,
+                                           pIncomingPacket,
+                                           &deserializedInfo );
+                }
+
+                bytesDelivered += fragmentLength;
+                fragmentLength = 0U;
+            }
+        }
+
+        /* Whatever happened, the buffer holds nothing worth keeping. */
+        pContext->index = 0U;
+
+        if( status == MQTTSuccess )
+        {
+            pContext->lastPacketRxTime = pContext->getTime();
+
+            /* Send PUBACK or PUBREC if necessary. */
+            status = sendPublishAcks( pContext,
+                                      packetIdentifier,
+                                      publishRecordState );
+
+            if( status == MQTTSuccess )
+            {
+                /* The packet is consumed; nothing is left in the buffer. */
+                status = MQTTNoDataAvailable;
+            }
+        }
+    }
+
+    return status;
+}
+
+#endif /* if ( MQTT_STREAM_LARGE_PUBLISH == 1 ) */
+
+/*-----------------------------------------------------------*/
+
 static MQTTStatus_t handlePublishAcks( MQTTContext_t * pContext,
                                        MQTTPacketInfo_t * pIncomingPacket )
 {
@@ -1750,10 +2067,20 @@ static MQTTStatus_t receiveSingleIteration( MQTTContext_t * pContext,
     /* If the MQTT Packet size is bigger than the buffer itself. */
     else if( totalMQTTPacketLength > pContext->networkBuffer.size )
     {
-        /* Discard the packet from the receive buffer and drain the pending
-         * data from the socket buffer. */
-        status = discardStoredPacket( pContext,
-                                      &incomingPacket );
+        #if ( MQTT_STREAM_LARGE_PUBLISH == 1 )
+            if( ( incomingPacket.type & 0xF0U ) == MQTT_PACKET_TYPE_PUBLISH )
+            {
+                /* Pass the payload to the application in fragments. */
+                status = handleStreamedPublish( pContext, &incomingPacket );
+            }
+            else
+        #endif
+        {
+            /* Discard the packet from the receive buffer and drain the pending
+             * data from the socket buffer. */
+            status = discardStoredPacket( pContext,
+                                          &incomingPacket );
+        }
     }
     /* If the total packet is of more length than the bytes we have available. */
     else if( totalMQTTPacketLength > pContext->index )
@@ -2477,6 +2804,11 @@ static MQTTStatus_t handleSessionResumption( MQTTContext_t * pContext,
                              0x00,
                              pContext->incomingPublishRecordMaxCount * sizeof( *pContext->incomingPublishRecords ) );
         }
+
+        #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+            ( void ) memset( &pContext->outgoingPublishIndex, 0x00, sizeof( pContext->outgoingPublishIndex ) );
+            ( void ) memset( &pContext->incomingPublishIndex, 0x00, sizeof( pContext->incomingPublishIndex ) );
+        #endif
     }
 
     return status;
@@ -2528,6 +2860,254 @@ static MQTTStatus_t validatePublishParams( const MQTTContext_t * pContext,
 
 /*-----------------------------------------------------------*/
 
+static MQTTStatus_t validatePublishBatchParams( const MQTTContext_t * pContext,
+                                                const MQTTPublishInfo_t * pPublishInfo,
+                                                const uint16_t * pPacketIds,
+                                                size_t publishCount,
+                                                const MQTTFixedBuffer_t * pHeaderBuffer )
+{
+    MQTTStatus_t status = MQTTSuccess;
+    size_t i;
+
+    if( ( pContext == NULL ) || ( pPublishInfo == NULL ) || ( pHeaderBuffer == NULL ) )
+    {
+        LogError( ( "Argument cannot be NULL: pContext=%p, "
+                    "pPublishInfo=%p, pHeaderBuffer=%p.",
+                    ( void * ) pContext,
+                    ( void * ) pPublishInfo,
+                    ( void * ) pHeaderBuffer ) );
+        status = MQTTBadParameter;
+    }
+    else if( pHeaderBuffer->pBuffer == NULL )
+    {
+        LogError( ( "pHeaderBuffer->pBuffer cannot be NULL." ) );
+        status = MQTTBadParameter;
+    }
+    else if( publishCount == 0U )
+    {
+        LogError( ( "A batch needs at least one publish." ) );
+        status = MQTTBadParameter;
+    }
+    else
+    {
+        /* A NULL packet ID array is only valid if all publishes are QoS 0. */
+        for( i = 0U; ( i < publishCount ) && ( status == MQTTSuccess ); i++ )
+        {
+            status = validatePublishParams( pContext,
+                                            &pPublishInfo[ i ],
+                                            ( pPacketIds != NULL ) ? pPacketIds[ i ] : 0U );
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t serializePublishBatch( const MQTTPublishInfo_t * pPublishInfo,
+                                           const uint16_t * pPacketIds,
+                                           size_t publishCount,
+                                           const MQTTFixedBuffer_t * pHeaderBuffer )
+{
+    MQTTStatus_t status = MQTTSuccess;
+    size_t remainingLength = 0U;
+    size_t packetSize = 0U;
+    size_t headerSize = 0U;
+    size_t chunkSize = 0U;
+    size_t offset = 0U;
+    size_t i;
+    uint8_t * pIndex;
+
+    /* Maximum number of bytes of the PUBLISH header before the topic name,
+     * as in #MQTT_Publish. */
+    uint8_t mqttHeader[ 7U ];
+
+    for( i = 0U; ( i < publishCount ) && ( status == MQTTSuccess ); i++ )
+    {
+        status = MQTT_GetPublishPacketSize( &pPublishInfo[ i ],
+                                            &remainingLength,
+                                            &packetSize );
+
+        if( status == MQTTSuccess )
+        {
+            status = MQTT_SerializePublishHeaderWithoutTopic( &pPublishInfo[ i ],
+                                                              remainingLength,
+                                                              mqttHeader,
+                                                              &headerSize );
+        }
+
+        if( status == MQTTSuccess )
+        {
+            /* The header, topic name and packet ID go to the buffer; the
+             * payload is sent from where the caller keeps it. */
+            chunkSize = packetSize - pPublishInfo[ i ].payloadLength;
+            assert( chunkSize == ( headerSize + pPublishInfo[ i ].topicNameLength +
+                                   ( ( pPublishInfo[ i ].qos > MQTTQoS0 ) ? 2U : 0U ) ) );
+
+            if( chunkSize > ( pHeaderBuffer->size - offset ) )
+            {
+                LogError( ( "Header buffer is too small for publish %lu of the batch: "
+                            "Needed=%lu, Available=%lu.",
+                            ( unsigned long ) i,
+                            ( unsigned long ) ( offset + chunkSize ),
+                            ( unsigned long ) pHeaderBuffer->size ) );
+                status = MQTTNoMemory;
+            }
+        }
+
+        if( status == MQTTSuccess )
+        {
+            pIndex = &pHeaderBuffer->pBuffer[ offset ];
+            ( void ) memcpy( pIndex, mqttHeader, headerSize );
+            pIndex = &pIndex[ headerSize ];
+            ( void ) memcpy( pIndex, pPublishInfo[ i ].pTopicName, pPublishInfo[ i ].topicNameLength );
+            pIndex = &pIndex[ pPublishInfo[ i ].topicNameLength ];
+
+            if( pPublishInfo[ i ].qos > MQTTQoS0 )
+            {
+                pIndex[ 0 ] = ( ( uint8_t ) ( ( pPacketIds[ i ] ) >> 8 ) );
+                pIndex[ 1 ] = ( ( uint8_t ) ( ( pPacketIds[ i ] ) & 0x00ffU ) );
+            }
+
+            offset += chunkSize;
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t reservePublishBatch( const MQTTContext_t * pContext,
+                                         const MQTTPublishInfo_t * pPublishInfo,
+                                         const uint16_t * pPacketIds,
+                                         size_t publishCount )
+{
+    MQTTStatus_t status = MQTTSuccess;
+    size_t reservedCount = 0U;
+    size_t i;
+
+    while( ( status == MQTTSuccess ) && ( reservedCount < publishCount ) )
+    {
+        if( pPublishInfo[ reservedCount ].qos > MQTTQoS0 )
+        {
+            status = MQTT_ReserveState( pContext,
+                                        pPacketIds[ reservedCount ],
+                                        pPublishInfo[ reservedCount ].qos );
+
+            /* State already exists for a duplicate packet, as in
+             * #MQTT_Publish. */
+            if( ( status == MQTTStateCollision ) && ( pPublishInfo[ reservedCount ].dup == true ) )
+            {
+                status = MQTTSuccess;
+            }
+        }
+
+        if( status == MQTTSuccess )
+        {
+            reservedCount++;
+        }
+    }
+
+    if( status != MQTTSuccess )
+    {
+        LogError( ( "Reserving state for publish %lu of the batch failed: PacketID=%u.",
+                    ( unsigned long ) reservedCount,
+                    ( unsigned int ) pPacketIds[ reservedCount ] ) );
+
+        /* Nothing of the batch is sent, so release the new records of the
+         * earlier publishes. Duplicates keep theirs, as a failed
+         * #MQTT_Publish would: they are resends of publishes that may
+         * already have been in the records. */
+        for( i = 0U; i < reservedCount; i++ )
+        {
+            if( ( pPublishInfo[ i ].qos > MQTTQoS0 ) && ( pPublishInfo[ i ].dup == false ) )
+            {
+                ( void ) MQTT_RemoveStateRecord( pContext, pPacketIds[ i ] );
+            }
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t sendPublishBatch( MQTTContext_t * pContext,
+                                      const MQTTPublishInfo_t * pPublishInfo,
+                                      size_t publishCount,
+                                      const MQTTFixedBuffer_t * pHeaderBuffer )
+{
+    MQTTStatus_t status = MQTTSuccess;
+    TransportOutVector_t pIoVector[ MQTT_PUBLISH_BATCH_MAX_VECTORS ];
+    TransportOutVector_t * pLastVector;
+    size_t ioVectorLength = 0U;
+    size_t totalMessageLength = 0U;
+    size_t remainingLength = 0U;
+    size_t packetSize = 0U;
+    size_t chunkSize = 0U;
+    size_t offset = 0U;
+    size_t publishesSent = 0U;
+    const uint8_t * pChunk;
+
+    /* A publish needs up to two vectors: the serialized header, topic name and
+     * packet ID, then the payload. */
+    assert( MQTT_PUBLISH_BATCH_MAX_VECTORS >= 2U );
+
+    while( ( status == MQTTSuccess ) && ( publishesSent < publishCount ) )
+    {
+        ioVectorLength = 0U;
+        totalMessageLength = 0U;
+
+        while( ( ioVectorLength <= ( MQTT_PUBLISH_BATCH_MAX_VECTORS - 2U ) ) &&
+               ( publishesSent < publishCount ) )
+        {
+            /* Sizes were validated when the batch was serialized. */
+            ( void ) MQTT_GetPublishPacketSize( &pPublishInfo[ publishesSent ],
+                                                &remainingLength,
+                                                &packetSize );
+            chunkSize = packetSize - pPublishInfo[ publishesSent ].payloadLength;
+            pChunk = &pHeaderBuffer->pBuffer[ offset ];
+            pLastVector = ( ioVectorLength > 0U ) ? &pIoVector[ ioVectorLength - 1U ] : NULL;
+
+            /* The headers of publishes without payload follow each other in
+             * the buffer and share a vector. */
+            if( ( pLastVector != NULL ) &&
+                ( &( ( const uint8_t * ) pLastVector->iov_base )[ pLastVector->iov_len ] == pChunk ) )
+            {
+                pLastVector->iov_len += chunkSize;
+            }
+            else
+            {
+                pIoVector[ ioVectorLength ].iov_base = pChunk;
+                pIoVector[ ioVectorLength ].iov_len = chunkSize;
+                ioVectorLength++;
+            }
+
+            /* Publish packets are allowed to contain no payload. */
+            if( pPublishInfo[ publishesSent ].payloadLength > 0U )
+            {
+                pIoVector[ ioVectorLength ].iov_base = pPublishInfo[ publishesSent ].pPayload;
+                pIoVector[ ioVectorLength ].iov_len = pPublishInfo[ publishesSent ].payloadLength;
+                ioVectorLength++;
+            }
+
+            totalMessageLength += packetSize;
+            offset += chunkSize;
+            publishesSent++;
+        }
+
+        if( sendMessageVector( pContext, pIoVector, ioVectorLength ) != ( int32_t ) totalMessageLength )
+        {
+            status = MQTTSendFailed;
+        }
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 MQTTStatus_t MQTT_Init( MQTTContext_t * pContext,
                         const TransportInterface_t * pTransportInterface,
                         MQTTGetCurrentTimeFunc_t getTimeFunction,
@@ -2631,12 +3211,31 @@ MQTTStatus_t MQTT_InitStatefulQoS( MQTTContext_t * pContext,
                     " been called successfully.\n" ) );
         status = MQTTBadParameter;
     }
+
+    #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+        /* Record links are 16-bit indices. */
+        else if( ( outgoingPublishCount > UINT16_MAX ) ||
+                 ( incomingPublishCount > UINT16_MAX ) )
+        {
+            LogError( ( "Record counts are limited to %u with hashed state records: "
+                        "outgoingPublishCount=%lu, incomingPublishCount=%lu",
+                        ( unsigned int ) UINT16_MAX,
+                        ( unsigned long ) outgoingPublishCount,
+                        ( unsigned long ) incomingPublishCount ) );
+            status = MQTTBadParameter;
+        }
+    #endif
     else
     {
         pContext->incomingPublishRecordMaxCount = incomingPublishCount;
         pContext->incomingPublishRecords = pIncomingPublishRecords;
         pContext->outgoingPublishRecordMaxCount = outgoingPublishCount;
         pContext->outgoingPublishRecords = pOutgoingPublishRecords;
+
+        #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+            ( void ) memset( &pContext->outgoingPublishIndex, 0x00, sizeof( pContext->outgoingPublishIndex ) );
+            ( void ) memset( &pContext->incomingPublishIndex, 0x00, sizeof( pContext->incomingPublishIndex ) );
+        #endif
     }
 
     return status;
@@ -2919,6 +3518,118 @@ MQTTStatus_t MQTT_Publish( MQTTContext_t * pContext,
 
 /*-----------------------------------------------------------*/
 
+MQTTStatus_t MQTT_PublishBatch( MQTTContext_t * pContext,
+                                const MQTTPublishInfo_t * pPublishInfo,
+                                const uint16_t * pPacketIds,
+                                size_t publishCount,
+                                const MQTTFixedBuffer_t * pHeaderBuffer )
+{
+    MQTTPublishState_t publishStatus = MQTTStateNull;
+    MQTTStatus_t updateStatus = MQTTSuccess;
+    bool hasStatefulPublish = false;
+    bool stateUpdateHookExecuted = false;
+    size_t i;
+
+    /* Validate arguments. */
+    MQTTStatus_t status = validatePublishBatchParams( pContext,
+                                                      pPublishInfo,
+                                                      pPacketIds,
+                                                      publishCount,
+                                                      pHeaderBuffer );
+
+    if( status == MQTTSuccess )
+    {
+        status = serializePublishBatch( pPublishInfo,
+                                        pPacketIds,
+                                        publishCount,
+                                        pHeaderBuffer );
+    }
+
+    if( status == MQTTSuccess )
+    {
+        for( i = 0U; i < publishCount; i++ )
+        {
+            if( pPublishInfo[ i ].qos > MQTTQoS0 )
+            {
+                hasStatefulPublish = true;
+            }
+        }
+    }
+
+    if( ( status == MQTTSuccess ) && ( hasStatefulPublish == true ) )
+    {
+        MQTT_PRE_STATE_UPDATE_HOOK( pContext );
+
+        /* Set the flag so that the corresponding hook can be called later. */
+        stateUpdateHookExecuted = true;
+
+        status = reservePublishBatch( pContext,
+                                      pPublishInfo,
+                                      pPacketIds,
+                                      publishCount );
+    }
+
+    if( status == MQTTSuccess )
+    {
+        /* Take the mutex as multiple send calls may be required for sending
+         * the batch. */
+        MQTT_PRE_SEND_HOOK( pContext );
+
+        status = sendPublishBatch( pContext,
+                                   pPublishInfo,
+                                   publishCount,
+                                   pHeaderBuffer );
+
+        /* Give the mutex away for the next taker. */
+        MQTT_POST_SEND_HOOK( pContext );
+    }
+
+    if( ( status == MQTTSuccess ) && ( hasStatefulPublish == true ) )
+    {
+        /* Update state machine after the PUBLISH packets are sent.
+         * Only to be done for QoS1 or QoS2. */
+        for( i = 0U; i < publishCount; i++ )
+        {
+            if( pPublishInfo[ i ].qos > MQTTQoS0 )
+            {
+                updateStatus = MQTT_UpdateStatePublish( pContext,
+                                                        pPacketIds[ i ],
+                                                        MQTT_SEND,
+                                                        pPublishInfo[ i ].qos,
+                                                        &publishStatus );
+
+                if( updateStatus != MQTTSuccess )
+                {
+                    LogError( ( "Update state for publish failed with status %s."
+                                " However PUBLISH packet was sent to the broker."
+                                " Any further handling of ACKs for the packet Id"
+                                " %u will fail.",
+                                MQTT_Status_strerror( updateStatus ),
+                                ( unsigned int ) pPacketIds[ i ] ) );
+                    status = updateStatus;
+                }
+            }
+        }
+    }
+
+    if( stateUpdateHookExecuted == true )
+    {
+        /* Regardless of the status, if the mutex was taken due to a
+         * packet being of QoS > QoS0, then it should be relinquished. */
+        MQTT_POST_STATE_UPDATE_HOOK( pContext );
+    }
+
+    if( status != MQTTSuccess )
+    {
+        LogError( ( "MQTT PUBLISH batch failed with status %s.",
+                    MQTT_Status_strerror( status ) ) );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 MQTTStatus_t MQTT_Ping( MQTTContext_t * pContext )
 {
     int32_t sendResult = 0;
@@ -69,6 +69,26 @@ static const size_t ZERO_SIZE_T = 0U;
  */
 #define UINT16_CHECK_BIT( x, position )         ( ( ( x ) & ( UINT16_BITMAP_BIT_SET_AT( position ) ) ) == ( UINT16_BITMAP_BIT_SET_AT( position ) ) )
 
+#if ( MQTT_STATE_HASHED_RECORDS == 1 )
+
+/**
+ * @brief Value of a record link (index + 1) that points to no record.
+ */
+    #define RECORD_LINK_NONE    ( ( uint16_t ) 0U )
+#endif
+
+/**
+ * @brief A state record array of the MQTT context.
+ */
+typedef struct StateRecords
+{
+    MQTTPubAckInfo_t * records;    /**< @brief The record array. */
+    size_t recordCount;            /**< @brief Length of the record array. */
+    #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+        MQTTStateIndex_t * pIndex; /**< @brief Index of the record array. */
+    #endif
+} StateRecords_t;
+
 /*-----------------------------------------------------------*/
 
 /**
@@ -113,23 +133,47 @@ static bool validateTransitionAck( MQTTPublishState_t currentState,
 static bool isPublishOutgoing( MQTTPubAckType_t packetType,
                                MQTTStateOperation_t opType );
 
+/**
+ * @brief Get the outgoing or incoming state record array of a context.
+ *
+ * @param[in] pMqttContext Initialized MQTT context.
+ * @param[in] isOutgoing Whether to get the outgoing publish records.
+ * @param[out] pRecords The record array.
+ */
+static void getRecords( const MQTTContext_t * pMqttContext,
+                        bool isOutgoing,
+                        StateRecords_t * pRecords );
+
 /**
  * @brief Find a packet ID in the state record.
  *
- * @param[in] records State record array.
- * @param[in] recordCount Length of record array.
+ * @param[in] pRecords State record array.
  * @param[in] packetId packet ID to search for.
  * @param[out] pQos QoS retrieved from record.
  * @param[out] pCurrentState state retrieved from record.
  *
- * @return index of the packet id in the record if it exists, else the record length.
+ * @return index of the packet id in the record if it exists, else #MQTT_INVALID_STATE_COUNT.
  */
-static size_t findInRecord( const MQTTPubAckInfo_t * records,
-                            size_t recordCount,
+static size_t findInRecord( const StateRecords_t * pRecords,
                             uint16_t packetId,
                             MQTTQoS_t * pQos,
                             MQTTPublishState_t * pCurrentState );
 
+/**
+ * @brief Remove the record of a QoS 1 or 2 publish.
+ *
+ * @param[in] pMqttContext Initialized MQTT context.
+ * @param[in] isOutgoing Whether the publish is outgoing or incoming.
+ * @param[in] packetId ID of the PUBLISH packet.
+ *
+ * @return #MQTTBadParameter or #MQTTSuccess.
+ */
+static MQTTStatus_t removeStateRecord( const MQTTContext_t * pMqttContext,
+                                      bool isOutgoing,
+                                      uint16_t packetId );
+
+#if ( MQTT_STATE_HASHED_RECORDS == 0 )
+
 /**
  * @brief Compact records.
  *
@@ -142,20 +186,63 @@ static size_t findInRecord( const MQTTPubAckInfo_t * records,
  */
 static void compactRecords( MQTTPubAckInfo_t * records,
                             size_t recordCount );
+#else
+
+/**
+ * @brief Get the bucket of a packet ID.
+ *
+ * @param[in] pRecords State record array.
+ * @param[in] packetId Packet ID of the record.
+ *
+ * @return Index of the record that holds the head of the bucket.
+ */
+static size_t bucketOf( const StateRecords_t * pRecords,
+                        uint16_t packetId );
+
+/**
+ * @brief Append a record to the end of the publish order.
+ *
+ * @param[in] pRecords State record array.
+ * @param[in] recordIndex Index of the record.
+ */
+static void linkRecord( const StateRecords_t * pRecords,
+                        size_t recordIndex );
+
+/**
+ * @brief Remove a record from the publish order.
+ *
+ * The links of the removed record are kept, so a cursor of
+ * #MQTT_PublishToResend or #MQTT_PubrelToResend that points to it still
+ * continues with the records that followed it.
+ *
+ * @param[in] pRecords State record array.
+ * @param[in] recordIndex Index of the record.
+ */
+static void unlinkRecord( const StateRecords_t * pRecords,
+                          size_t recordIndex );
+
+/**
+ * @brief Remove a record from its bucket and the publish order, and put it
+ * on the free list.
+ *
+ * @param[in] pRecords State record array.
+ * @param[in] recordIndex Index of the record.
+ */
+static void freeRecord( const StateRecords_t * pRecords,
+                        size_t recordIndex );
+#endif /* if ( MQTT_STATE_HASHED_RECORDS == 0 ) */
 
 /**
  * @brief Store a new entry in the state record.
  *
- * @param[in] records State record array.
- * @param[in] recordCount Length of record array.
+ * @param[in] pRecords State record array.
  * @param[in] packetId Packet ID of new entry.
  * @param[in] qos QoS of new entry.
  * @param[in] publishState State of new entry.
  *
  * @return #MQTTSuccess, #MQTTNoMemory, or #MQTTStateCollision.
  */
-static MQTTStatus_t addRecord( MQTTPubAckInfo_t * records,
-                               size_t recordCount,
+static MQTTStatus_t addRecord( const StateRecords_t * pRecords,
                                uint16_t packetId,
                                MQTTQoS_t qos,
                                MQTTPublishState_t publishState );
@@ -163,12 +250,12 @@ static MQTTStatus_t addRecord( MQTTPubAckInfo_t * records,
 /**
  * @brief Update and possibly delete an entry in the state record.
  *
- * @param[in] records State record array.
+ * @param[in] pRecords State record array.
  * @param[in] recordIndex index of record to update.
  * @param[in] newState New state to update.
  * @param[in] shouldDelete Whether an existing entry should be deleted.
  */
-static void updateRecord( MQTTPubAckInfo_t * records,
+static void updateRecord( const StateRecords_t * pRecords,
                           size_t recordIndex,
                           MQTTPublishState_t newState,
                           bool shouldDelete );
@@ -191,8 +278,7 @@ static uint16_t stateSelect( const MQTTContext_t * pMqttContext,
  * @brief Update the state records for an ACK after state transition
  * validations.
  *
- * @param[in] records State records pointer.
- * @param[in] maxRecordCount The maximum number of records.
+ * @param[in] pRecords State record array.
  * @param[in] recordIndex Index at which the record is stored.
  * @param[in] packetId Packet id of the packet.
  * @param[in] currentState Current state of the publish record.
@@ -200,8 +286,7 @@ static uint16_t stateSelect( const MQTTContext_t * pMqttContext,
  *
  * @return #MQTTIllegalState, or #MQTTSuccess.
  */
-static MQTTStatus_t updateStateAck( MQTTPubAckInfo_t * records,
-                                    size_t maxRecordCount,
+static MQTTStatus_t updateStateAck( const StateRecords_t * pRecords,
                                     size_t recordIndex,
                                     uint16_t packetId,
                                     MQTTPublishState_t currentState,
@@ -443,12 +528,46 @@ static bool isPublishOutgoing( MQTTPubAckType_t packetType,
 
 /*-----------------------------------------------------------*/
 
-static size_t findInRecord( const MQTTPubAckInfo_t * records,
-                            size_t recordCount,
+static void getRecords( const MQTTContext_t * pMqttContext,
+                        bool isOutgoing,
+                        StateRecords_t * pRecords )
+{
+    assert( pMqttContext != NULL );
+    assert( pRecords != NULL );
+
+    /* The state functions take a const context and write only through its
+     * record pointers. The index of the hashed store is the exception: it is
+     * kept in the context so that a new clean session clears it together with
+     * the records. */
+    if( isOutgoing == true )
+    {
+        pRecords->records = pMqttContext->outgoingPublishRecords;
+        pRecords->recordCount = pMqttContext->outgoingPublishRecordMaxCount;
+        #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+            pRecords->pIndex = ( MQTTStateIndex_t * ) &pMqttContext->outgoingPublishIndex;
+        #endif
+    }
+    else
+    {
+        pRecords->records = pMqttContext->incomingPublishRecords;
+        pRecords->recordCount = pMqttContext->incomingPublishRecordMaxCount;
+        #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+            pRecords->pIndex = ( MQTTStateIndex_t * ) &pMqttContext->incomingPublishIndex;
+        #endif
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+#if ( MQTT_STATE_HASHED_RECORDS == 0 )
+
+static size_t findInRecord( const StateRecords_t * pRecords,
                             uint16_t packetId,
                             MQTTQoS_t * pQos,
                             MQTTPublishState_t * pCurrentState )
 {
+    const MQTTPubAckInfo_t * records = pRecords->records;
+    size_t recordCount = pRecords->recordCount;
     size_t index = 0;
 
     assert( packetId != MQTT_PACKET_ID_INVALID );
@@ -517,12 +636,13 @@ static void compactRecords( MQTTPubAckInfo_t * records,
 
 /*-----------------------------------------------------------*/
 
-static MQTTStatus_t addRecord( MQTTPubAckInfo_t * records,
-                               size_t recordCount,
+static MQTTStatus_t addRecord( const StateRecords_t * pRecords,
                                uint16_t packetId,
                                MQTTQoS_t qos,
                                MQTTPublishState_t publishState )
 {
+    MQTTPubAckInfo_t * records = pRecords->records;
+    size_t recordCount = pRecords->recordCount;
     MQTTStatus_t status = MQTTNoMemory;
     int32_t index = 0;
     size_t availableIndex = recordCount;
@@ -582,21 +702,219 @@ static MQTTStatus_t addRecord( MQTTPubAckInfo_t * records,
     return status;
 }
 
+#else /* if ( MQTT_STATE_HASHED_RECORDS == 0 ) */
+
+static size_t bucketOf( const StateRecords_t * pRecords,
+                        uint16_t packetId )
+{
+    assert( pRecords->recordCount > 0U );
+
+    /* Consecutive packet IDs, as handed out by MQTT_GetPacketId, fall in
+     * different buckets, so with up to recordCount publishes in flight a
+     * bucket seldom holds more than one record. */
+    return ( size_t ) packetId % pRecords->recordCount;
+}
+
+/*-----------------------------------------------------------*/
+
+static void linkRecord( const StateRecords_t * pRecords,
+                        size_t recordIndex )
+{
+    MQTTPubAckInfo_t * records = pRecords->records;
+    MQTTStateIndex_t * pIndex = pRecords->pIndex;
+    uint16_t link = ( uint16_t ) ( recordIndex + 1U );
+
+    records[ recordIndex ].prevRecord = pIndex->tail;
+    records[ recordIndex ].nextRecord = RECORD_LINK_NONE;
+
+    if( pIndex->tail == RECORD_LINK_NONE )
+    {
+        pIndex->head = link;
+    }
+    else
+    {
+        records[ pIndex->tail - 1U ].nextRecord = link;
+    }
+
+    pIndex->tail = link;
+}
+
+/*-----------------------------------------------------------*/
+
+static void unlinkRecord( const StateRecords_t * pRecords,
+                          size_t recordIndex )
+{
+    MQTTPubAckInfo_t * records = pRecords->records;
+    MQTTStateIndex_t * pIndex = pRecords->pIndex;
+    uint16_t prev = records[ recordIndex ].prevRecord;
+    uint16_t next = records[ recordIndex ].nextRecord;
+
+    if( prev == RECORD_LINK_NONE )
+    {
+        pIndex->head = next;
+    }
+    else
+    {
+        records[ prev - 1U ].nextRecord = next;
+    }
+
+    if( next == RECORD_LINK_NONE )
+    {
+        pIndex->tail = prev;
+    }
+    else
+    {
+        records[ next - 1U ].prevRecord = prev;
+    }
+}
+
+/*-----------------------------------------------------------*/
+
+static void freeRecord( const StateRecords_t * pRecords,
+                        size_t recordIndex )
+{
+    MQTTPubAckInfo_t * records = pRecords->records;
+    MQTTStateIndex_t * pIndex = pRecords->pIndex;
+    uint16_t link = ( uint16_t ) ( recordIndex + 1U );
+    uint16_t * pLink = &records[ bucketOf( pRecords, records[ recordIndex ].packetId ) ].bucketHead;
+
+    /* Find the link to the record in its bucket. */
+    while( *pLink != link )
+    {
+        assert( *pLink != RECORD_LINK_NONE );
+        pLink = &records[ *pLink - 1U ].bucketNext;
+    }
+
+    *pLink = records[ recordIndex ].bucketNext;
+    unlinkRecord( pRecords, recordIndex );
+
+    /* Mark the record as invalid. */
+    records[ recordIndex ].packetId = MQTT_PACKET_ID_INVALID;
+    records[ recordIndex ].qos = MQTTQoS0;
+    records[ recordIndex ].publishState = MQTTStateNull;
+
+    records[ recordIndex ].bucketNext = pIndex->freeList;
+    pIndex->freeList = link;
+}
+
+/*-----------------------------------------------------------*/
+
+static size_t findInRecord( const StateRecords_t * pRecords,
+                            uint16_t packetId,
+                            MQTTQoS_t * pQos,
+                            MQTTPublishState_t * pCurrentState )
+{
+    const MQTTPubAckInfo_t * records = pRecords->records;
+    size_t index = MQTT_INVALID_STATE_COUNT;
+    uint16_t link = RECORD_LINK_NONE;
+
+    assert( packetId != MQTT_PACKET_ID_INVALID );
+
+    *pCurrentState = MQTTStateNull;
+
+    if( pRecords->recordCount > 0U )
+    {
+        link = records[ bucketOf( pRecords, packetId ) ].bucketHead;
+    }
+
+    while( link != RECORD_LINK_NONE )
+    {
+        if( records[ link - 1U ].packetId == packetId )
+        {
+            *pQos = records[ link - 1U ].qos;
+            *pCurrentState = records[ link - 1U ].publishState;
+            index = ( size_t ) link - 1U;
+            break;
+        }
+
+        link = records[ link - 1U ].bucketNext;
+    }
+
+    return index;
+}
+
+/*-----------------------------------------------------------*/
+
+static MQTTStatus_t addRecord( const StateRecords_t * pRecords,
+                               uint16_t packetId,
+                               MQTTQoS_t qos,
+                               MQTTPublishState_t publishState )
+{
+    MQTTPubAckInfo_t * records = pRecords->records;
+    MQTTStateIndex_t * pIndex = pRecords->pIndex;
+    MQTTStatus_t status = MQTTSuccess;
+    size_t recordIndex = MQTT_INVALID_STATE_COUNT;
+    size_t bucket = 0U;
+    MQTTQoS_t foundQos = MQTTQoS0;
+    MQTTPublishState_t foundState = MQTTStateNull;
+
+    assert( packetId != MQTT_PACKET_ID_INVALID );
+    assert( qos != MQTTQoS0 );
+
+    recordIndex = findInRecord( pRecords, packetId, &foundQos, &foundState );
+
+    if( recordIndex != MQTT_INVALID_STATE_COUNT )
+    {
+        /* Collision. */
+        LogError( ( "Collision when adding PacketID=%u at index=%u.",
+                    ( unsigned int ) packetId,
+                    ( unsigned int ) recordIndex ) );
+
+        status = MQTTStateCollision;
+    }
+    else if( pIndex->freeList != RECORD_LINK_NONE )
+    {
+        recordIndex = ( size_t ) pIndex->freeList - 1U;
+        pIndex->freeList = records[ recordIndex ].bucketNext;
+    }
+    else if( pIndex->used < pRecords->recordCount )
+    {
+        /* Records past the used count are still zeroed and on no list. */
+        recordIndex = pIndex->used;
+        pIndex->used++;
+    }
+    else
+    {
+        status = MQTTNoMemory;
+    }
+
+    if( status == MQTTSuccess )
+    {
+        bucket = bucketOf( pRecords, packetId );
+
+        records[ recordIndex ].packetId = packetId;
+        records[ recordIndex ].qos = qos;
+        records[ recordIndex ].publishState = publishState;
+        records[ recordIndex ].bucketNext = records[ bucket ].bucketHead;
+        records[ bucket ].bucketHead = ( uint16_t ) ( recordIndex + 1U );
+        linkRecord( pRecords, recordIndex );
+    }
+
+    return status;
+}
+#endif /* if ( MQTT_STATE_HASHED_RECORDS == 0 ) */
+
 /*-----------------------------------------------------------*/
 
-static void updateRecord( MQTTPubAckInfo_t * records,
+static void updateRecord( const StateRecords_t * pRecords,
                           size_t recordIndex,
                           MQTTPublishState_t newState,
                           bool shouldDelete )
 {
+    MQTTPubAckInfo_t * records = pRecords->records;
+
     assert( records != NULL );
 
     if( shouldDelete == true )
     {
-        /* Mark the record as invalid. */
-        records[ recordIndex ].packetId = MQTT_PACKET_ID_INVALID;
-        records[ recordIndex ].qos = MQTTQoS0;
-        records[ recordIndex ].publishState = MQTTStateNull;
+        #if ( MQTT_STATE_HASHED_RECORDS == 0 )
+            /* Mark the record as invalid. */
+            records[ recordIndex ].packetId = MQTT_PACKET_ID_INVALID;
+            records[ recordIndex ].qos = MQTTQoS0;
+            records[ recordIndex ].publishState = MQTTStateNull;
+        #else
+            freeRecord( pRecords, recordIndex );
+        #endif
     }
     else
     {
@@ -634,20 +952,59 @@ static uint16_t stateSelect( const MQTTContext_t * pMqttContext,
     records = pMqttContext->outgoingPublishRecords;
     maxCount = pMqttContext->outgoingPublishRecordMaxCount;
 
-    while( *pCursor < maxCount )
+    #if ( MQTT_STATE_HASHED_RECORDS == 0 )
+        while( *pCursor < maxCount )
+        {
+            /* Check if any of the search states are present. */
+            stateCheck = UINT16_CHECK_BIT( searchStates, records[ *pCursor ].publishState );
+
+            if( stateCheck == true )
+            {
+                packetId = records[ *pCursor ].packetId;
+                ( *pCursor )++;
+                break;
+            }
+
+            ( *pCursor )++;
+        }
+    #else /* if ( MQTT_STATE_HASHED_RECORDS == 0 ) */
     {
-        /* Check if any of the search states are present. */
-        stateCheck = UINT16_CHECK_BIT( searchStates, records[ *pCursor ].publishState );
+        /* The cursor holds the link of the next record in publish order, or
+         * MQTT_INVALID_STATE_COUNT after the last one. */
+        uint16_t link = RECORD_LINK_NONE;
 
-        if( stateCheck == true )
+        if( *pCursor == MQTT_STATE_CURSOR_INITIALIZER )
         {
-            packetId = records[ *pCursor ].packetId;
-            ( *pCursor )++;
-            break;
+            link = pMqttContext->outgoingPublishIndex.head;
         }
+        else if( *pCursor <= maxCount )
+        {
+            link = ( uint16_t ) *pCursor;
+        }
+        else
+        {
+            /* Past the last record. */
+        }
+
+        while( link != RECORD_LINK_NONE )
+        {
+            const MQTTPubAckInfo_t * pRecord = &records[ link - 1U ];
 
-        ( *pCursor )++;
+            link = pRecord->nextRecord;
+
+            /* Check if any of the search states are present. */
+            stateCheck = UINT16_CHECK_BIT( searchStates, pRecord->publishState );
+
+            if( stateCheck == true )
+            {
+                packetId = pRecord->packetId;
+                break;
+            }
+        }
+
+        *pCursor = ( link == RECORD_LINK_NONE ) ? MQTT_INVALID_STATE_COUNT : ( size_t ) link;
     }
+    #endif /* if ( MQTT_STATE_HASHED_RECORDS == 0 ) */
 
     return packetId;
 }
@@ -703,8 +1060,7 @@ MQTTPublishState_t MQTT_CalculateStateAck( MQTTPubAckType_t packetType,
 
 /*-----------------------------------------------------------*/
 
-static MQTTStatus_t updateStateAck( MQTTPubAckInfo_t * records,
-                                    size_t maxRecordCount,
+static MQTTStatus_t updateStateAck( const StateRecords_t * pRecords,
                                     size_t recordIndex,
                                     uint16_t packetId,
                                     MQTTPublishState_t currentState,
@@ -714,7 +1070,7 @@ static MQTTStatus_t updateStateAck( MQTTPubAckInfo_t * records,
     bool shouldDeleteRecord = false;
     bool isTransitionValid = false;
 
-    assert( records != NULL );
+    assert( pRecords->records != NULL );
 
     /* Record to be deleted if the state transition is completed or if a PUBREC
      * is received for an outgoing QoS2 publish. When a PUBREC is received,
@@ -732,7 +1088,7 @@ static MQTTStatus_t updateStateAck( MQTTPubAckInfo_t * records,
          * current state can be the same. No update of record required in that case. */
         if( currentState != newState )
         {
-            updateRecord( records,
+            updateRecord( pRecords,
                           recordIndex,
                           newState,
                           shouldDeleteRecord );
@@ -743,8 +1099,7 @@ static MQTTStatus_t updateStateAck( MQTTPubAckInfo_t * records,
              * a PUBREL needs to be resent in case of a session reestablishment. */
             if( newState == MQTTPubRelSend )
             {
-                status = addRecord( records,
-                                    maxRecordCount,
+                status = addRecord( pRecords,
                                     packetId,
                                     MQTTQoS2,
                                     MQTTPubRelSend );
@@ -774,6 +1129,7 @@ static MQTTStatus_t updateStatePublish( const MQTTContext_t * pMqttContext,
 {
     MQTTStatus_t status = MQTTSuccess;
     bool isTransitionValid = false;
+    StateRecords_t records;
 
     assert( pMqttContext != NULL );
     assert( packetId != MQTT_PACKET_ID_INVALID );
@@ -789,8 +1145,8 @@ static MQTTStatus_t updateStatePublish( const MQTTContext_t * pMqttContext,
         /* addRecord will check for collisions. */
         if( opType == MQTT_RECEIVE )
         {
-            status = addRecord( pMqttContext->incomingPublishRecords,
-                                pMqttContext->incomingPublishRecordMaxCount,
+            getRecords( pMqttContext, false, &records );
+            status = addRecord( &records,
                                 packetId,
                                 qos,
                                 newState );
@@ -802,7 +1158,8 @@ static MQTTStatus_t updateStatePublish( const MQTTContext_t * pMqttContext,
              * update is required. */
             if( currentState != newState )
             {
-                updateRecord( pMqttContext->outgoingPublishRecords,
+                getRecords( pMqttContext, true, &records );
+                updateRecord( &records,
                               recordIndex,
                               newState,
                               false );
@@ -827,6 +1184,7 @@ MQTTStatus_t MQTT_ReserveState( const MQTTContext_t * pMqttContext,
                                 MQTTQoS_t qos )
 {
     MQTTStatus_t status = MQTTSuccess;
+    StateRecords_t records;
 
     if( qos == MQTTQoS0 )
     {
@@ -839,8 +1197,8 @@ MQTTStatus_t MQTT_ReserveState( const MQTTContext_t * pMqttContext,
     else
     {
         /* Collisions are detected when adding the record. */
-        status = addRecord( pMqttContext->outgoingPublishRecords,
-                            pMqttContext->outgoingPublishRecordMaxCount,
+        getRecords( pMqttContext, true, &records );
+        status = addRecord( &records,
                             packetId,
                             qos,
                             MQTTPublishSend );
@@ -891,6 +1249,7 @@ MQTTStatus_t MQTT_UpdateStatePublish( const MQTTContext_t * pMqttContext,
     MQTTStatus_t mqttStatus = MQTTSuccess;
     size_t recordIndex = MQTT_INVALID_STATE_COUNT;
     MQTTQoS_t foundQoS = MQTTQoS0;
+    StateRecords_t records;
 
     if( ( pMqttContext == NULL ) || ( pNewState == NULL ) )
     {
@@ -913,8 +1272,8 @@ MQTTStatus_t MQTT_UpdateStatePublish( const MQTTContext_t * pMqttContext,
     else if( opType == MQTT_SEND )
     {
         /* Search record for entry so we can check QoS. */
-        recordIndex = findInRecord( pMqttContext->outgoingPublishRecords,
-                                    pMqttContext->outgoingPublishRecordMaxCount,
+        getRecords( pMqttContext, true, &records );
+        recordIndex = findInRecord( &records,
                                     packetId,
                                     &foundQoS,
                                     &currentState );
@@ -954,27 +1313,28 @@ MQTTStatus_t MQTT_UpdateStatePublish( const MQTTContext_t * pMqttContext,
 
 /*-----------------------------------------------------------*/
 
-MQTTStatus_t MQTT_RemoveStateRecord( const MQTTContext_t * pMqttContext,
-                                     uint16_t packetId )
+static MQTTStatus_t removeStateRecord( const MQTTContext_t * pMqttContext,
+                                      bool isOutgoing,
+                                      uint16_t packetId )
 {
     MQTTStatus_t status = MQTTSuccess;
-    MQTTPubAckInfo_t * records;
+    StateRecords_t records;
     size_t recordIndex;
     /* Current state is updated by the findInRecord function. */
     MQTTPublishState_t currentState;
     MQTTQoS_t qos = MQTTQoS0;
 
+    assert( pMqttContext != NULL );
+
+    getRecords( pMqttContext, isOutgoing, &records );
 
-    if( ( pMqttContext == NULL ) || ( ( pMqttContext->outgoingPublishRecords == NULL ) ) )
+    if( records.records == NULL )
     {
         status = MQTTBadParameter;
     }
     else
     {
-        records = pMqttContext->outgoingPublishRecords;
-
-        recordIndex = findInRecord( records,
-                                    pMqttContext->outgoingPublishRecordMaxCount,
+        recordIndex = findInRecord( &records,
                                     packetId,
                                     &qos,
                                     &currentState );
@@ -990,7 +1350,7 @@ MQTTStatus_t MQTT_RemoveStateRecord( const MQTTContext_t * pMqttContext,
         else
         {
             /* Delete the record. */
-            updateRecord( records,
+            updateRecord( &records,
                           recordIndex,
                           MQTTStateNull,
                           true );
@@ -1002,6 +1362,36 @@ MQTTStatus_t MQTT_RemoveStateRecord( const MQTTContext_t * pMqttContext,
 
 /*-----------------------------------------------------------*/
 
+MQTTStatus_t MQTT_RemoveStateRecord( const MQTTContext_t * pMqttContext,
+                                     uint16_t packetId )
+{
+    MQTTStatus_t status = MQTTBadParameter;
+
+    if( pMqttContext != NULL )
+    {
+        status = removeStateRecord( pMqttContext, true, packetId );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
+MQTTStatus_t MQTT_RemoveIncomingStateRecord( const MQTTContext_t * pMqttContext,
+                                             uint16_t packetId )
+{
+    MQTTStatus_t status = MQTTBadParameter;
+
+    if( pMqttContext != NULL )
+    {
+        status = removeStateRecord( pMqttContext, false, packetId );
+    }
+
+    return status;
+}
+
+/*-----------------------------------------------------------*/
+
 MQTTStatus_t MQTT_UpdateStateAck( const MQTTContext_t * pMqttContext,
                                   uint16_t packetId,
                                   MQTTPubAckType_t packetType,
@@ -1012,10 +1402,9 @@ MQTTStatus_t MQTT_UpdateStateAck( const MQTTContext_t * pMqttContext,
     MQTTPublishState_t currentState = MQTTStateNull;
     bool isOutgoingPublish = isPublishOutgoing( packetType, opType );
     MQTTQoS_t qos = MQTTQoS0;
-    size_t maxRecordCount = MQTT_INVALID_STATE_COUNT;
     size_t recordIndex = MQTT_INVALID_STATE_COUNT;
 
-    MQTTPubAckInfo_t * records = NULL;
+    StateRecords_t records;
     MQTTStatus_t status = MQTTBadResponse;
 
     if( ( pMqttContext == NULL ) || ( pNewState == NULL ) )
@@ -1037,19 +1426,9 @@ MQTTStatus_t MQTT_UpdateStateAck( const MQTTContext_t * pMqttContext,
     }
     else
     {
-        if( isOutgoingPublish == true )
-        {
-            records = pMqttContext->outgoingPublishRecords;
-            maxRecordCount = pMqttContext->outgoingPublishRecordMaxCount;
-        }
-        else
-        {
-            records = pMqttContext->incomingPublishRecords;
-            maxRecordCount = pMqttContext->incomingPublishRecordMaxCount;
-        }
+        getRecords( pMqttContext, isOutgoingPublish, &records );
 
-        recordIndex = findInRecord( records,
-                                    maxRecordCount,
+        recordIndex = findInRecord( &records,
                                     packetId,
                                     &qos,
                                     &currentState );
@@ -1060,8 +1439,7 @@ MQTTStatus_t MQTT_UpdateStateAck( const MQTTContext_t * pMqttContext,
         newState = MQTT_CalculateStateAck( packetType, opType, qos );
 
         /* Validate state transition and update state record. */
-        status = updateStateAck( records,
-                                 maxRecordCount,
+        status = updateStateAck( &records,
                                  recordIndex,
                                  packetId,
                                  currentState,
@@ -38,6 +38,9 @@
 /* Include MQTT serializer library. */
 #include "core_mqtt_serializer.h"
 
+/* The layout of the state records depends on MQTT_STATE_HASHED_RECORDS. */
+#include "core_mqtt_config_defaults.h"
+
 /* Include transport interface. */
 #include "transport_interface.h"
 
@@ -93,6 +96,12 @@ typedef uint32_t (* MQTTGetCurrentTimeFunc_t )( void );
  * result of #MQTTSuccess or #MQTTServerRefused. The latter can be obtained
  * when deserializing a SUBACK, indicating a broker's rejection of a subscribe.
  *
+ * @note With #MQTT_STREAM_LARGE_PUBLISH, a PUBLISH larger than the network
+ * buffer is passed in several calls, one per payload fragment. The publish info
+ * then describes the fragment: its payload points into the network buffer and
+ * is only valid during the call, while the topic name and packet ID are the
+ * same in every call.
+ *
  * @param[in] pContext Initialized MQTT context.
  * @param[in] pPacketInfo Information on the type of incoming MQTT packet.
  * @param[in] pDeserializedInfo Deserialized information from incoming packet.
@@ -163,8 +172,32 @@ typedef struct MQTTPubAckInfo
     uint16_t packetId;               /**< @brief The packet ID of the original PUBLISH. */
     MQTTQoS_t qos;                   /**< @brief The QoS of the original PUBLISH. */
     MQTTPublishState_t publishState; /**< @brief The current state of the publish process. */
+    #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+        uint16_t bucketHead;         /**< @brief First record of the bucket with this index, as index + 1 (0 for none). */
+        uint16_t bucketNext;         /**< @brief Next record in the same bucket or in the free list, as index + 1 (0 for none). */
+        uint16_t prevRecord;         /**< @brief Previous record in publish order, as index + 1 (0 for none). */
+        uint16_t nextRecord;         /**< @brief Next record in publish order, as index + 1 (0 for none). */
+    #endif
 } MQTTPubAckInfo_t;
 
+#if ( MQTT_STATE_HASHED_RECORDS == 1 )
+
+/**
+ * @ingroup mqtt_struct_types
+ * @brief Lookup and ordering data of a state record array, used when
+ * #MQTT_STATE_HASHED_RECORDS is enabled.
+ *
+ * All zero is an empty index, matching a zeroed record array.
+ */
+    typedef struct MQTTStateIndex
+    {
+        uint16_t head;     /**< @brief Oldest record in publish order, as index + 1 (0 when empty). */
+        uint16_t tail;     /**< @brief Newest record in publish order, as index + 1 (0 when empty). */
+        uint16_t freeList; /**< @brief Last removed record, as index + 1 (0 when none). */
+        uint16_t used;     /**< @brief Number of records taken from the array since it was cleared. */
+    } MQTTStateIndex_t;
+#endif
+
 /**
  * @ingroup mqtt_struct_types
  * @brief A struct representing an MQTT connection.
@@ -191,6 +224,19 @@ typedef struct MQTTContext
      */
     size_t incomingPublishRecordMaxCount;
 
+    #if ( MQTT_STATE_HASHED_RECORDS == 1 )
+
+        /**
+         * @brief Index of the outgoing publish records.
+         */
+        MQTTStateIndex_t outgoingPublishIndex;
+
+        /**
+         * @brief Index of the incoming publish records.
+         */
+        MQTTStateIndex_t incomingPublishIndex;
+    #endif
+
     /**
      * @brief The transport interface used by the MQTT connection.
      */
@@ -258,6 +304,10 @@ typedef struct MQTTDeserializedInfo
     uint16_t packetIdentifier;          /**< @brief Packet ID of deserialized packet. */
     MQTTPublishInfo_t * pPublishInfo;   /**< @brief Pointer to deserialized publish info. */
     MQTTStatus_t deserializationResult; /**< @brief Return code of deserialization. */
+    #if ( MQTT_STREAM_LARGE_PUBLISH == 1 )
+        size_t payloadOffset;           /**< @brief Offset of the PUBLISH fragment in pPublishInfo within the whole payload. */
+        size_t payloadTotalLength;      /**< @brief Length of the whole PUBLISH payload. */
+    #endif
 } MQTTDeserializedInfo_t;
 
 /**
@@ -356,6 +406,8 @@ MQTTStatus_t MQTT_Init( MQTTContext_t * pContext,
  * @param[in] incomingPublishCount Maximum number of records which can be kept in the memory
  * pointed to by @p pIncomingPublishRecords.
  *
+ * @note With #MQTT_STATE_HASHED_RECORDS enabled, each record count is limited to 65535.
+ *
  * @return #MQTTBadParameter if invalid parameters are passed;
  * #MQTTSuccess otherwise.
  *
@@ -629,6 +681,85 @@ MQTTStatus_t MQTT_Publish( MQTTContext_t * pContext,
                            uint16_t packetId );
 /* @[declare_mqtt_publish] */
 
+/**
+ * @brief Publishes several messages with as few transport calls as possible.
+ *
+ * The fixed header, topic name and packet ID of every PUBLISH are serialized
+ * one after the other into @p pHeaderBuffer. The batch then goes to the
+ * transport as a single #TransportWritev_t call that points to these headers
+ * and to the payloads where the caller keeps them, so a series of small
+ * publishes fills one TCP segment or TLS record instead of one each. A batch
+ * needing more than #MQTT_PUBLISH_BATCH_MAX_VECTORS vectors (two per publish
+ * with a payload) is split into as many calls as needed. Without a writev
+ * function each vector takes a #TransportSend_t call.
+ *
+ * The QoS 1 and QoS 2 publishes get their state records as with
+ * #MQTT_Publish, all before anything is sent. If one cannot be reserved, the
+ * records already reserved for the batch are released (except for duplicates)
+ * and nothing is sent. If the transport fails mid-batch, the records stay
+ * reserved and #MQTT_PublishToResend returns them, as for #MQTT_Publish.
+ *
+ * @param[in] pContext Initialized MQTT context.
+ * @param[in] pPublishInfo Array of MQTT PUBLISH packet parameters.
+ * @param[in] pPacketIds Packet IDs generated by #MQTT_GetPacketId, one per
+ * entry of @p pPublishInfo. Entries of QoS 0 publishes are ignored, and the
+ * array may be NULL if all publishes are QoS 0.
+ * @param[in] publishCount Number of publishes in the batch.
+ * @param[in] pHeaderBuffer Buffer for the serialized headers, at least 9 bytes
+ * plus the topic name length per publish. It must stay untouched until the
+ * function returns. The context's network buffer may be used only if no
+ * #MQTT_ProcessLoop or #MQTT_ReceiveLoop can run meanwhile, and not from the
+ * event callback.
+ *
+ * @return #MQTTNoMemory if @p pHeaderBuffer is too small for the headers or
+ * no state record is left;
+ * #MQTTBadParameter if invalid parameters are passed;
+ * #MQTTStateCollision if a packet ID is already in use;
+ * #MQTTSendFailed if transport write failed;
+ * #MQTTSuccess otherwise.
+ *
+ * <b>Example</b>
+ * @code{c}
+ *
+ * // Variables used in this example.
+ * MQTTStatus_t status;
+ * MQTTPublishInfo_t publishInfo[ 2 ] = { 0 };
+ * uint16_t packetIds[ 2 ];
+ * uint8_t headerBuffer[ 64 ];
+ * MQTTFixedBuffer_t headers = { headerBuffer, sizeof( headerBuffer ) };
+ * // This context is assumed to be initialized and connected.
+ * MQTTContext_t * pContext;
+ *
+ * publishInfo[ 0 ].qos = MQTTQoS1;
+ * publishInfo[ 0 ].pTopicName = "/some/topic/name";
+ * publishInfo[ 0 ].topicNameLength = strlen( publishInfo[ 0 ].pTopicName );
+ * publishInfo[ 0 ].pPayload = "Hello";
+ * publishInfo[ 0 ].payloadLength = strlen( "Hello" );
+ * packetIds[ 0 ] = MQTT_GetPacketId( pContext );
+ *
+ * publishInfo[ 1 ] = publishInfo[ 0 ];
+ * publishInfo[ 1 ].pPayload = "World!";
+ * publishInfo[ 1 ].payloadLength = strlen( "World!" );
+ * packetIds[ 1 ] = MQTT_GetPacketId( pContext );
+ *
+ * status = MQTT_PublishBatch( pContext, publishInfo, packetIds, 2, &headers );
+ *
+ * if( status == MQTTSuccess )
+ * {
+ *      // Both publishes went out in one transport call. Since the QoS
+ *      // is > 0, call MQTT_ReceiveLoop() or MQTT_ProcessLoop() to process
+ *      // the publish acknowledgments.
+ * }
+ * @endcode
+ */
+/* @[declare_mqtt_publishbatch] */
+MQTTStatus_t MQTT_PublishBatch( MQTTContext_t * pContext,
+                                const MQTTPublishInfo_t * pPublishInfo,
+                                const uint16_t * pPacketIds,
+                                size_t publishCount,
+                                const MQTTFixedBuffer_t * pHeaderBuffer );
+/* @[declare_mqtt_publishbatch] */
+
 /**
  * @brief Cancels an outgoing publish callback (only for QoS > QoS0) by
  * removing it from the pending ACK list.
@@ -76,6 +76,18 @@
     #define MQTT_SUB_UNSUB_MAX_VECTORS    ( 4U )
 #endif
 
+/**
+ * @ingroup mqtt_constants
+ * @brief Maximum number of vectors in one transport call of
+ * #MQTT_PublishBatch.
+ *
+ * A publish takes two vectors, one if it has no payload. The vectors live on
+ * the stack of the caller of #MQTT_PublishBatch.
+ */
+#ifndef MQTT_PUBLISH_BATCH_MAX_VECTORS
+    #define MQTT_PUBLISH_BATCH_MAX_VECTORS    ( 16U )
+#endif
+
 /**
  * @brief The number of retries for receiving CONNACK.
  *
@@ -195,6 +207,63 @@
     #error MQTT_SEND_RETRY_TIMEOUT_MS is deprecated. Instead use MQTT_SEND_TIMEOUT_MS.
 #endif
 
+/**
+ * @brief Store the QoS 1 and QoS 2 state records in a hash table keyed by
+ * packet ID instead of a compacted array.
+ *
+ * With the default array store, every lookup scans the records and adding a
+ * record may shift all of them, so acknowledging a publish costs time linear
+ * in the number of publishes in flight. With this option the record array
+ * doubles as a chained hash table: the record at index `packetId % recordCount`
+ * holds the head of the bucket of that packet ID, records are never moved, and
+ * removed records are reused through a free list. Lookups, additions and
+ * removals take constant time; consecutive packet IDs, as handed out by
+ * #MQTT_GetPacketId, never share a bucket. Publish order, needed by
+ * #MQTT_PublishToResend and #MQTT_PubrelToResend, is kept in a list linked
+ * through the records.
+ *
+ * The option adds four 16-bit links to #MQTTPubAckInfo_t and a small index
+ * per record array to #MQTTContext_t, and limits each record array to 65535
+ * entries. Record arrays must still be zero-initialized before
+ * #MQTT_InitStatefulQoS. The records are only worth the extra RAM when many
+ * publishes are in flight; for a handful the array scan is as fast.
+ *
+ * <b>Possible values:</b> `0` (array store) or `1` (hashed store). <br>
+ * <b>Default value:</b> `0`
+ */
+#ifndef MQTT_STATE_HASHED_RECORDS
+    #define MQTT_STATE_HASHED_RECORDS    ( 0 )
+#endif
+
+/**
+ * @brief Deliver incoming PUBLISH packets that do not fit in the network
+ * buffer to the event callback in fragments instead of discarding them.
+ *
+ * By default an incoming packet must fit whole in the #MQTTFixedBuffer_t given
+ * to #MQTT_Init, so the buffer has to be as large as the largest message the
+ * application may receive. With this option a PUBLISH only needs its fixed
+ * header, topic name and packet identifier to fit. Once those are in the
+ * buffer, the state record is updated and the payload is read into the rest of
+ * the buffer, one fragment at a time; the event callback is invoked for each
+ * fragment with the topic name still valid. The fields
+ * MQTTDeserializedInfo_t.payloadOffset and
+ * MQTTDeserializedInfo_t.payloadTotalLength place the fragment in the whole
+ * payload. The PUBACK or PUBREC is sent after the last fragment.
+ *
+ * Packets that fit in the buffer are delivered whole, as one fragment at
+ * offset 0. If the connection fails in the middle of a payload, the callback
+ * does not see the last fragment and the application must drop what it has
+ * received; the state record of a QoS 1 or 2 publish is removed so that a
+ * resent copy is delivered again.
+ *
+ * <b>Possible values:</b> `0` (discard packets larger than the buffer) or `1`
+ * (stream their payload). <br>
+ * <b>Default value:</b> `0`
+ */
+#ifndef MQTT_STREAM_LARGE_PUBLISH
+    #define MQTT_STREAM_LARGE_PUBLISH    ( 0 )
+#endif
+
 /**
  * @brief Macro that is called in the MQTT library for logging "Error" level
  * messages.
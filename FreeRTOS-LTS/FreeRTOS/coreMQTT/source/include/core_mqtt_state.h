@@ -144,6 +144,27 @@ MQTTStatus_t MQTT_RemoveStateRecord( const MQTTContext_t * pMqttContext,
                                      uint16_t packetId );
 /** @endcond */
 
+/**
+ * @fn MQTTStatus_t MQTT_RemoveIncomingStateRecord( const MQTTContext_t * pMqttContext, uint16_t packetId );
+ * @brief Remove the state record for an incoming PUBLISH packet.
+ *
+ * Used when a streamed PUBLISH (#MQTT_STREAM_LARGE_PUBLISH) is cut off before
+ * its last fragment, so that a copy resent by the broker is delivered again.
+ *
+ * @param[in] pMqttContext Initialized MQTT context.
+ * @param[in] packetId ID of the PUBLISH packet.
+ *
+ * @return #MQTTBadParameter or #MQTTSuccess.
+ */
+
+/**
+ * @cond DOXYGEN_IGNORE
+ * Doxygen should ignore this definition, this function is private.
+ */
+MQTTStatus_t MQTT_RemoveIncomingStateRecord( const MQTTContext_t * pMqttContext,
+                                             uint16_t packetId );
+/** @endcond */
+
 /**
  * @fn MQTTPublishState_t MQTT_CalculateStateAck( MQTTPubAckType_t packetType, MQTTStateOperation_t opType, MQTTQoS_t qos );
  * @brief Calculate the state from a PUBACK, PUBREC, PUBREL, or PUBCOMP.
@@ -43,7 +43,7 @@
 /* Scheduler Related */
 #define configUSE_PREEMPTION 1
 #define configUSE_TICKLESS_IDLE 0
-#define configUSE_IDLE_HOOK 0
+#define configUSE_IDLE_HOOK 1          // WFI no baixo consumo (inc/power_save.c)
 #define configUSE_TICK_HOOK 0
 #define configTICK_RATE_HZ ((TickType_t)1000)
 #define configMAX_PRIORITIES 32
@@ -66,6 +66,8 @@
 #define configUSE_NEWLIB_REENTRANT 0
 #define configENABLE_BACKWARD_COMPATIBILITY 0
 #define configNUM_THREAD_LOCAL_STORAGE_POINTERS 5
+// Índice 1 reservado para a conclusão das transações do gerenciador I2C (inc/i2c_bus.c)
+#define configTASK_NOTIFICATION_ARRAY_ENTRIES 2
 
 /* System */
 #define configSTACK_DEPTH_TYPE uint32_t
@@ -78,12 +80,21 @@
 #define configAPPLICATION_ALLOCATED_HEAP 0
 
 /* Hook function related definitions. */
-#define configCHECK_FOR_STACK_OVERFLOW 0
+// Método 2 (marca no fim da pilha) na troca de contexto; vApplicationStackOverflowHook em blink.c
+#define configCHECK_FOR_STACK_OVERFLOW 2
 #define configUSE_MALLOC_FAILED_HOOK 0
 #define configUSE_DAEMON_TASK_STARTUP_HOOK 0
 
 /* Run time and task stats gathering related definitions. */
-#define configGENERATE_RUN_TIME_STATS 0
+// Tempo de execução por tarefa: diagnóstico publicado em MQTT (inc/diag.c) e perfil de
+// carga por núcleo (inc/core_load.c, -DCORE_LOAD_PROFILE=ON na configuração do CMake)
+#define configGENERATE_RUN_TIME_STATS 1
+#ifndef __ASSEMBLER__
+#include "hardware/structs/timer.h"
+// Timer de 1 MHz do RP2040, já rodando: só a metade baixa (as diferenças toleram o estouro a cada ~71 min)
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE() (timer_hw->timerawl)
+#endif
 #define configUSE_TRACE_FACILITY 1
 #define configUSE_STATS_FORMATTING_FUNCTIONS 0
 
@@ -105,10 +116,13 @@
 */
 
 /* SMP port only */
-#define configNUM_CORES 2
+// O kernel V11 lê configNUMBER_OF_CORES (configNUM_CORES é o nome antigo e era ignorado)
+#define configNUMBER_OF_CORES 2
 #define configTICK_CORE 0
 #define configRUN_MULTIPLE_PRIORITIES 1
-#define configUSE_CORE_AFFINITY 0
+// Rede no núcleo 0 e aquisição no núcleo 1 (inc/task_cores.h)
+#define configUSE_CORE_AFFINITY 1
+#define configUSE_PASSIVE_IDLE_HOOK 1
 
 /* RP2040 specific */
 #define configSUPPORT_PICO_SYNC_INTEROP 1
@@ -6,15 +6,34 @@
 #include "FreeRTOS.h"
 #include "task.h"
 #include "semphr.h"
-#include "queue.h"
 #include "hardware/i2c.h"
 #include "hardware/adc.h"
 #include "hardware/pwm.h"
 #include "inc/bmp280.h"
 #include "inc/ssd1306.h"
-#include "inc/vl53l1x.h"
-#include "inc/vl53l0x.h"
+#include "inc/sensor_hal.h"
+#include "inc/i2c_bus.h"
+#include "inc/telemetry.h"
+#include "inc/journal.h"
+#include "inc/sample_ring.h"
+#include "inc/task_cores.h"
+#include "inc/core_load.h"
+#include "inc/diag.h"
+#include "inc/sensor_timing.h"
+#include "inc/log_async.h"
+#include "inc/rbe.h"
+#include "inc/dev_config.h"
+#include "inc/net_conn.h"
+#include "inc/topic_trie.h"
+#include "inc/power_save.h"
+#if MQTT_TLS
+#include "inc/mqtt_tls.h"
+#include "mqtt_ca_cert.h"
+#endif
+#include "pico/async_context_freertos.h"
+#include "hardware/flash.h"
 #include <stdint.h>
+#include <stdatomic.h>
 
 // Compatibilidade com arrays gerados para Arduino
 #ifndef PROGMEM
@@ -35,6 +54,17 @@
 #define MAX_SDA_PIN 2
 #define MAX_SCL_PIN 3
 
+// GPIO1 (data-ready) do VL53L1X e período entre medições
+#ifndef TOF_INT_PIN
+#define TOF_INT_PIN 4
+#endif
+#define TOF_PERIOD_MS 50
+
+// INT (A_FULL) do MAX30101, que divide GP2/GP3 com o ToF (endereço 0x57)
+#ifndef PPG_INT_PIN
+#define PPG_INT_PIN 8
+#endif
+
 // Pinos vindos do seu main.h para facilitar a leitura
 #ifndef BUTTON5_PIN
 #define BUTTON5_PIN 5
@@ -44,69 +74,102 @@
 #define LED_PIN_B 12
 #endif
 
+// Período do laço de aquisição, em prazos absolutos (a simulação no host usa um valor menor).
+// Com o relato por exceção é o período mais longo, com os valores parados.
+#ifndef SENSOR_PERIOD_MS
+#define SENSOR_PERIOD_MS 10000
+#endif
+
+// Relato por exceção (inc/rbe.c): só publica o que mudou além da zona morta,
+// com batimento, e amostra mais rápido (até SENSOR_PERIOD_FAST_MS) quando os
+// valores andam. Com 0, toda amostra é publicada a cada SENSOR_PERIOD_MS.
+#ifndef REPORT_BY_EXCEPTION
+#define REPORT_BY_EXCEPTION 1
+#endif
+
+#ifndef SENSOR_PERIOD_FAST_MS
+#define SENSOR_PERIOD_FAST_MS (SENSOR_PERIOD_MS / 5)
+#endif
+
+// Baixo consumo (inc/power_save.h): junta UPLINK_BATCH amostras e publica em
+// rajada, com o rádio em economia de energia entre as rajadas
+#ifndef LOW_POWER
+#define LOW_POWER 0
+#endif
+
+#ifndef UPLINK_BATCH
+#define UPLINK_BATCH 6
+#endif
+
+_Static_assert(DEV_CONFIG_BATCH_MAX <= SAMPLE_RING_SIZE / 2, "a rajada não pode encher o anel de amostras");
+
+// Intervalo mínimo entre atualizações do display e do LED, independente da taxa
+// de amostragem; a atualização sai no primeiro ciclo depois do prazo
+#ifndef DISPLAY_PERIOD_MS
+#define DISPLAY_PERIOD_MS SENSOR_PERIOD_MS
+#endif
+
+// Diário de telemetria (inc/journal.c) nos últimos setores da flash: guarda as
+// amostras enquanto o broker está fora. 128 KiB = 32 setores x 127 amostras (~11 h a 10 s)
+#ifndef JOURNAL_FLASH_SIZE
+#define JOURNAL_FLASH_SIZE (128 * 1024)
+#endif
+
+// Reenvio do diário após a reconexão: um lote a cada intervalo, para não
+// disputar o enlace com as amostras ao vivo nem encher os buffers do lwIP
+#ifndef JOURNAL_REPLAY_INTERVAL_MS
+#define JOURNAL_REPLAY_INTERVAL_MS 250
+#endif
+
 // --- Variáveis Globais (Definição Real) ---
 bool alarme = false;
 bool posicao_js = false;
 bool ledverdestatus = false;
-MQTT_CLIENT_T *mqtt_state;
-QueueHandle_t filaMQTT;
+// Amostras do sensor para tarefaMQTT, preenchidas e consumidas no próprio slot (inc/sample_ring.c)
+sample_ring_t anelAmostras;
 TaskHandle_t hTarefaSensor = NULL;
 TaskHandle_t hTarefaMQTT = NULL;
 bool tarefas_pausadas = false;
-
-// Estrutura para a Fila de Dados do Sensor
-typedef struct
+journal_t diario;
+static bool diario_ok;
+static flash_dev_t flashDiario;
+// Configuração em campo (inc/dev_config.c), nos setores logo antes do diário
+static flash_dev_t flashConfig;
+// Comando de configuração recebido pelo callback do lwIP, tratado em tarefaMQTT
+static char comandoConfig[DEV_CONFIG_CMD_MAX];
+static size_t comandoLen;
+static atomic_bool comandoPronto;
+// Conjuntos de pinos atendidos pelo gerenciador de barramento (inc/i2c_bus.c).
+// O I2C1 alterna entre display (GP14/15) e ToF (GP2/3); quem troca os pinos é a tarefa dona do controlador.
+static i2c_bus_id_t busBMP280;
+static i2c_bus_id_t busDisplay;
+static i2c_bus_id_t busToF;
+
+// BMP280 com calibração já resolvida; a conversão forçada é disparada junto com a
+// leitura do ciclo anterior e recolhida no ciclo seguinte, sobrepondo o tempo de
+// conversão à espera do período
+static bmp280_handle_t bmp;
+static volatile uint64_t bmp_disparo_us;   // 0 = sem disparo válido (na fila do I2C0 ou falhou)
+
+// Filtro de relato por exceção: escrito só por tarefaSensorBMP280 (a simulação lê as estatísticas)
+rbe_t filtroRelato;
+
+// Estrutura para a Fila de Dados do Sensor (campos em inc/telemetry.h: inteiros, com instante da amostra)
+typedef telemetry_sample_t DadosSensor;
+
+static uint32_t agora_ms(void)
 {
-    float temperatura;
-    uint32_t pressao;
-    uint16_t distancia_mm;
-} DadosSensor;
-
-// --- FUNÇÕES DE SUPORTE (Vindas do embarca.c e mqtt_utils.c) ---
-static inline void i2c1_use_display_pins(void)
-{
-    // Ativa pinos do display (GP14/GP15)
-    gpio_set_function(DISP_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(DISP_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(DISP_SDA_PIN);
-    gpio_pull_up(DISP_SCL_PIN);
-    // Velocidade maior para o display
-    i2c_set_baudrate(i2c1, 400000);
-    sleep_ms(2);
-
-    // Desativa pinos do sensor (GP2/GP3) para evitar conflito no barramento
-    gpio_set_function(MAX_SDA_PIN, GPIO_FUNC_NULL);
-    gpio_set_function(MAX_SCL_PIN, GPIO_FUNC_NULL);
-    gpio_disable_pulls(MAX_SDA_PIN);
-    gpio_disable_pulls(MAX_SCL_PIN);
-}
-
-static inline void i2c1_use_sensor_pins(void)
-{
-    // Ativa pinos do sensor (GP2/GP3)
-    gpio_set_function(MAX_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(MAX_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(MAX_SDA_PIN);
-    gpio_pull_up(MAX_SCL_PIN);
-    // Reduz velocidade para dar margem caso pull-ups sejam fracos
-    i2c_set_baudrate(i2c1, 100000);
-    sleep_ms(2);
-
-    // Desativa pinos do display (GP14/GP15)
-    gpio_set_function(DISP_SDA_PIN, GPIO_FUNC_NULL);
-    gpio_set_function(DISP_SCL_PIN, GPIO_FUNC_NULL);
-    gpio_disable_pulls(DISP_SDA_PIN);
-    gpio_disable_pulls(DISP_SCL_PIN);
+    return (uint32_t)(time_us_64() / 1000);
 }
 
-static void i2c_scan_bus(i2c_inst_t *i2c, const char *label)
+// --- FUNÇÕES DE SUPORTE (Vindas do embarca.c e mqtt_utils.c) ---
+static void i2c_scan_bus(i2c_bus_id_t bus, const char *label, sensor_scan_t *scan)
 {
+    sensor_hal_scan(bus, scan);
     printf("[I2C] Scan %s:", label);
     for (int addr = 0x03; addr <= 0x77; addr++)
     {
-        uint8_t dummy;
-        int ret = i2c_read_timeout_us(i2c, addr, &dummy, 1, false, 2000);
-        if (ret == 1)
+        if (sensor_scan_has(scan, addr))
         {
             printf(" 0x%02X", addr);
         }
@@ -114,15 +177,96 @@ static void i2c_scan_bus(i2c_inst_t *i2c, const char *label)
     printf("\n");
 }
 
-// Tentativa de detecção rápida para TCS34725 (endereço 0x29)
-static bool tcs34725_read_id(i2c_inst_t *i2c, uint8_t addr, uint8_t *out_id)
+// Rotinas dos drivers executadas pela tarefa dona do controlador
+static bool job_ssd1306_init(i2c_inst_t *i2c, void *ctx)
+{
+    (void)ctx;
+    return ssd1306_init(i2c, 0x3C);
+}
+
+// Envia as janelas já preparadas pela tarefa do sensor (postado sem espera)
+static bool job_ssd1306_flush(i2c_inst_t *i2c, void *ctx)
 {
-    // Bit de comando 0x80 precisa ser somado ao registrador para leitura
-    uint8_t reg = 0x80 | 0x12; // ID register
-    int wr = i2c_write_blocking(i2c, addr, &reg, 1, true);
-    if (wr != 1) return false;
-    int rd = i2c_read_blocking(i2c, addr, out_id, 1, false);
-    return rd == 1;
+    (void)i2c;
+    (void)ctx;
+    return ssd1306_flush_send();
+}
+
+static bool job_bmp280_init(i2c_inst_t *i2c, void *ctx)
+{
+    (void)i2c;
+    (void)ctx;
+    bmp280_init();
+    return bmp280_handle_init(&bmp, I2C_ADDR) == BMP280_TRUE;
+}
+
+static bool job_bmp280_trigger(i2c_inst_t *i2c, void *ctx)
+{
+    (void)i2c;
+    (void)ctx;
+    bool ok = bmp280_trigger_forced(&bmp) == BMP280_TRUE;
+    bmp_disparo_us = ok ? time_us_64() : 0;
+    return ok;
+}
+
+typedef struct
+{
+    DadosSensor *dados;
+    collect_status_t status;
+} ColetaBMP280;
+
+// Só inteiros até a amostra: °C x100 direto e pressão Q24.8 arredondada para Pa
+static bool job_bmp280_collect(i2c_inst_t *i2c, void *ctx)
+{
+    (void)i2c;
+    ColetaBMP280 *c = ctx;
+    sensors_fixed_t f;
+    c->status = bmp280_collect_fixed(&bmp, &f);
+    if (c->status == COLLECT_OK)
+    {
+        c->dados->temp_c100 = (int16_t)f.temperature;
+        c->dados->pres_pa = (f.pressure + 128) >> 8;
+    }
+    return c->status != COLLECT_ERROR;
+}
+
+// Recolhe a conversão disparada no ciclo anterior e posta o disparo do próximo
+// antes da leitura: os dois saem na mesma rodada do I2C0 (a leitura primeiro) e
+// a conversão corre durante a espera do período. Sem disparo recente (primeiro
+// ciclo, retomada após pausa, disparo que falhou ou não achou vaga) dispara
+// agora e espera só o tempo de conversão.
+static bool bmp280_recolher(DadosSensor *dados, uint32_t validade_ms)
+{
+    uint64_t disparo = bmp_disparo_us;
+    if (!disparo || time_us_64() - disparo > (uint64_t)validade_ms * 1000u)
+    {
+        if (!i2c_bus_run(busBMP280, job_bmp280_trigger, NULL))
+            return false;
+        disparo = bmp_disparo_us;
+    }
+    uint64_t pronto = disparo + bmp280_measurement_time_us(&bmp);
+    uint64_t agora = time_us_64();
+    if (agora < pronto)
+        vTaskDelay(pdMS_TO_TICKS((uint32_t)(pronto - agora) / 1000) + 1);
+
+    ColetaBMP280 c = {.dados = dados, .status = COLLECT_BUSY};
+    bmp_disparo_us = 0;
+    i2c_bus_post(busBMP280, job_bmp280_trigger, NULL);
+    if (!i2c_bus_run(busBMP280, job_bmp280_collect, &c))
+        return false;
+    if (c.status == COLLECT_BUSY)
+    {
+        // Ainda medindo: o disparo postado já reiniciou a conversão. Espera por
+        // ela e deixa o próximo ciclo disparar de novo
+        for (int tentativa = 0; tentativa < 2 && c.status == COLLECT_BUSY; ++tentativa)
+        {
+            vTaskDelay(pdMS_TO_TICKS(bmp280_measurement_time_us(&bmp) / 1000) + 1);
+            if (!i2c_bus_run(busBMP280, job_bmp280_collect, &c))
+                return false;
+        }
+        bmp_disparo_us = 0;
+    }
+    return c.status == COLLECT_OK;
 }
 
 void pinos_start()
@@ -155,49 +299,64 @@ void pwm_led(uint gpio_pin, uint brilho)
     pwm_set_gpio_level(gpio_pin, brilho);
 }
 
-// Callback do DNS
-static void dns_found(const char *name, const ip_addr_t *ipaddr, void *callback_arg)
-{
-    MQTT_CLIENT_T *state = (MQTT_CLIENT_T *)callback_arg;
-    if (ipaddr)
-    {
-        state->remote_addr = *ipaddr;
-        printf("[DNS] Resolvido: %s\n", ip4addr_ntoa(ipaddr));
-    }
-}
+// --- CALLBACKS MQTT ---
 
-void run_dns_lookup(MQTT_CLIENT_T *state)
+// Assinaturas (o índice volta da árvore de despacho, inc/topic_trie.h) e o
+// destino da mensagem que está chegando (net_conn entrega o tópico antes dos dados)
+enum { ASSINATURA_LED, ASSINATURA_CONFIG, ASSINATURAS };
+static const net_conn_sub_t assinaturas[ASSINATURAS] = {
+    [ASSINATURA_LED] = {"pico_w/recv", 0},
+    [ASSINATURA_CONFIG] = {DEV_CONFIG_TOPIC_SET, 1},
+};
+static topic_trie_t despacho;
+static enum { ENTRADA_LED, ENTRADA_CONFIG, ENTRADA_DESCARTE } entrada;
+
+static void mqtt_pub_start_cb(void *arg, const char *topic, u32_t tot_len)
 {
-    printf("[DNS] Resolvendo %s...\n", MQTT_SERVER_HOST);
-    cyw43_arch_lwip_begin();
-    dns_gethostbyname(MQTT_SERVER_HOST, &(state->remote_addr), dns_found, state);
-    cyw43_arch_lwip_end();
-
-    // Aguarda resolução básica (em um sistema real, use semáforo)
-    while (state->remote_addr.addr == 0)
+    (void)arg;
+    uint16_t ids[ASSINATURAS];
+    size_t n = topic_trie_match(&despacho, topic, strlen(topic), ids, ASSINATURAS);
+    bool led = false, config = false;
+    for (size_t i = 0; i < n && i < ASSINATURAS; i++)
     {
-        vTaskDelay(pdMS_TO_TICKS(100));
+        led |= ids[i] == ASSINATURA_LED;
+        config |= ids[i] == ASSINATURA_CONFIG;
     }
-}
-
-// --- CALLBACKS MQTT ---
-
-static void mqtt_connection_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status)
-{
-    if (status == MQTT_CONNECT_ACCEPTED)
+    if (!config)
+        entrada = led ? ENTRADA_LED : ENTRADA_DESCARTE;
+    // Um comando por vez: o anterior ainda não foi tratado por tarefaMQTT
+    else if (tot_len > DEV_CONFIG_CMD_MAX || atomic_load_explicit(&comandoPronto, memory_order_acquire))
     {
-        printf("[MQTT] Conectado ao Broker!\n");
-        // Subscreve ao tópico de comando
-        mqtt_sub_unsub(client, "pico_w/recv", 0, NULL, NULL, 1);
+        entrada = ENTRADA_DESCARTE;
+        LOG_W("[Config] Comando descartado (%lu bytes)\n", (unsigned long)tot_len);
     }
     else
     {
-        printf("[MQTT] Erro na conexão: %d\n", status);
+        entrada = ENTRADA_CONFIG;
+        comandoLen = 0;
     }
 }
 
 static void mqtt_pub_data_cb(void *arg, const u8_t *data, u16_t len, u8_t flags)
 {
+    if (entrada == ENTRADA_CONFIG)
+    {
+        // O comando pode chegar em pedaços; só vai para tarefaMQTT inteiro
+        if (comandoLen + len <= sizeof comandoConfig)
+        {
+            memcpy(&comandoConfig[comandoLen], data, len);
+            comandoLen += len;
+        }
+        if (flags & NET_CONN_DATA_LAST)
+        {
+            atomic_store_explicit(&comandoPronto, true, memory_order_release);
+            sample_ring_wake(&anelAmostras);
+        }
+        return;
+    }
+    if (entrada != ENTRADA_LED)
+        return;
+
     char buffer[BUFFER_SIZE];
     if (len < BUFFER_SIZE)
     {
@@ -257,49 +416,82 @@ void tarefaLeituraBotao(void *pvParameters)
 }
 
 
-void tarefaSensorBMP280(void *pvParameters)
+// Palavra QUENTE/FRIO em escala máxima e LED correspondente
+static void atualizar_display(int32_t temp_c100, int32_t limiar_c100)
 {
-    // Inicializa I2C0 com os pinos definidos acima
-    i2c_init(i2c0, 100 * 1000);
-    gpio_set_function(I2C_SDA_PIN, GPIO_FUNC_I2C);
-    gpio_set_function(I2C_SCL_PIN, GPIO_FUNC_I2C);
-    gpio_pull_up(I2C_SDA_PIN);
-    gpio_pull_up(I2C_SCL_PIN);
-
-    // Inicializa I2C1 para o display
-    i2c1_use_display_pins();
-    ssd1306_init(i2c1, 0x3C);
-    i2c_scan_bus(i2c1, "I2C1 GP14/GP15 (display)");
-
-    // Inicializa sensor ToF (tenta VL53L0X primeiro; se falhar, usa VL53L1X)
-    i2c1_use_sensor_pins();
-    i2c_scan_bus(i2c1, "I2C1 GP2/GP3 (sensor)");
-    bool use_l0x = false;
-    bool tof_ok = false;
-    if (vl53l0x_init(i2c1)) {
-        use_l0x = true;
-        tof_ok = true;
-        printf("[VL53L0X] Sensor detectado e pronto.\n");
+    ssd1306_clear();
+
+    bool quente = temp_c100 >= limiar_c100;
+    const char *word = quente ? "QUENTE" : "FRIO";
+    int len = (int)strlen(word);
+    // Calcula escala máxima que cabe na largura e altura
+    int max_scale_w = 128 / (len * 6);
+    int max_scale_h = 64 / 7;
+    int scale = max_scale_w;
+    if (scale > max_scale_h) scale = max_scale_h;
+    if (scale < 1) scale = 1;
+    int text_w = len * 6 * scale;
+    int text_h = 7 * scale;
+    int x0 = (128 - text_w) / 2;
+    int y0 = (64 - text_h) / 2;
+
+    ssd1306_draw_text_scaled(x0, y0, word, scale, true);
+
+    // LED cores: quente=vermelho, frio=azul
+    if (quente) {
+        pwm_led(LED_PIN_R, 3000);
+        pwm_led(LED_PIN_G, 0);
+        pwm_led(LED_PIN_B, 0);
     } else {
-        // Tenta VL53L1X como fallback
-        tof_ok = vl53l1x_init(i2c1, VL53L1X_I2C_ADDR) &&
-                 vl53l1x_start_continuous(i2c1, VL53L1X_I2C_ADDR, 50);
-        if (tof_ok) {
-            bool ready = false;
-            for (int tries = 0; tries < 20 && !ready; ++tries) {
-                sleep_ms(20);
-                ready = vl53l1x_data_ready(i2c1, VL53L1X_I2C_ADDR);
-            }
-            printf("[VL53L1X] Inicializado e medindo continuamente. Pronto=%s\n", ready ? "sim" : "não");
-        } else {
-            printf("[ToF] Falha ao inicializar (confira fiação/pulls em GP2/GP3).\n");
-        }
+        pwm_led(LED_PIN_R, 0);
+        pwm_led(LED_PIN_G, 0);
+        pwm_led(LED_PIN_B, 3000);
     }
-    // Volta p/ pinos do display por padrão
-    i2c1_use_display_pins();
 
-    bmp280_init();
-    DadosSensor dados;
+    // Só as regiões alteradas; a transmissão segue na tarefa do I2C1 enquanto o laço continua.
+    // Se o envio anterior ainda estiver pendente, as alterações ficam para a próxima atualização.
+    if (ssd1306_flush_prepare())
+        i2c_bus_post(busDisplay, job_ssd1306_flush, NULL);
+}
+
+// Limiares e faixa de período do relato por exceção a partir da configuração viva;
+// desligado, o período fica fixo no mais longo e toda amostra é publicada
+static void configurar_relato(const dev_config_t *c, bool inicio)
+{
+    rbe_config_t relato;
+    rbe_default_config(&relato, c->temp_threshold_c100, c->dist_threshold_mm,
+                       c->report_by_exception ? c->sensor_period_fast_ms : c->sensor_period_ms, c->sensor_period_ms);
+    if (inicio)
+        rbe_init(&filtroRelato, &relato);
+    else
+        rbe_set_config(&filtroRelato, &relato);
+}
+
+void tarefaSensorBMP280(void *pvParameters)
+{
+    // Anel de log próprio: as linhas do laço saem sem trava e sem esperar o USB
+    log_async_register();
+
+    // Inicializa I2C1 para o display
+    i2c_bus_run(busDisplay, job_ssd1306_init, NULL);
+    sensor_scan_t scan;
+    i2c_scan_bus(busDisplay, "I2C1 GP14/GP15 (display)", &scan);
+
+    // Sensores de GP2/GP3 (ToF, oxímetro) descobertos a partir da varredura:
+    // VL53L0X é medido sob demanda, VL53L1X em ranging contínuo dirigido pela
+    // interrupção de GPIO1 e o MAX30101 esvaziado em lotes pela tarefa PPG
+    i2c_scan_bus(busToF, "I2C1 GP2/GP3 (sensor)", &scan);
+    static const sensor_wiring_t fiacao[SENSOR_KIND_COUNT] = {
+        [SENSOR_DISTANCE] = {TOF_INT_PIN, TOF_PERIOD_MS},
+        [SENSOR_PPG] = {PPG_INT_PIN, 0},
+        [SENSOR_COLOR] = {-1, 0},
+    };
+    sensor_hal_discover(busToF, &scan, fiacao);
+    if (!sensor_hal_get(SENSOR_DISTANCE))
+        printf("[ToF] Nenhum sensor inicializado (confira fiação/pulls em GP2/GP3).\n");
+
+    if (!i2c_bus_run(busBMP280, job_bmp280_init, NULL))
+        printf("[BMP280] Falha ao inicializar (confira fiação em GP0/GP1).\n");
 
     static const uint8_t epd_bitmap_fogo[] = {0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
 	0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 
@@ -562,127 +754,463 @@ void tarefaSensorBMP280(void *pvParameters)
 
         0xff, 0xff, 0xff, 0xfc};
 
+    // Prazos absolutos: o período não soma o tempo de I2C, printf e display.
+    // Um ciclo que passa do prazo seguinte não desloca os próximos.
+    TickType_t prazo = xTaskGetTickCount();
+    uint32_t proximo_display = agora_ms();
+    // Cópia da configuração viva, relida quando um comando muda a versão
+    static dev_config_t cfg;
+    uint32_t versao = dev_config_version();
+    dev_config_get(&cfg);
+    configurar_relato(&cfg, true);
+    uint32_t periodo = rbe_period_ms(&filtroRelato);
+    sensor_timing_start(periodo);
+    uint16_t dist_mm = 0;
+
     while (1)
     {
-        // Lê distância do sensor ToF (VL53L0X ou VL53L1X) nos pinos GP2/GP3
-        uint16_t dist_mm = 0;
-        uint8_t range_status = 0, stream_count = 0;
-        i2c1_use_sensor_pins();
-        if (tof_ok) {
-            if (use_l0x) {
-                if (vl53l0x_read_distance_mm(i2c1, &dist_mm)) {
-                    printf("[VL53L0X] Distância: %u mm\n", (unsigned)dist_mm);
-                }
-            } else {
-                if (vl53l1x_read_range_block(i2c1, VL53L1X_I2C_ADDR, &dist_mm, &range_status, &stream_count)) {
-                    printf("[VL53L1X] Distância: %u mm | status=0x%02X | stream=%u\n", (unsigned)dist_mm, range_status, stream_count);
-                }
-            }
+        if (dev_config_version() != versao)
+        {
+            versao = dev_config_version();
+            dev_config_get(&cfg);
+            configurar_relato(&cfg, false);
+            LOG_I("[Sensor] Configuração v%lu aplicada\n", (unsigned long)versao);
         }
-        // Retorna para os pinos do display
-        i2c1_use_display_pins();
-
-        sensors_t s = bmp280_get_all(I2C_ADDR);
-        dados.temperatura = s.temperature;
-        dados.pressao = s.pressure;
-        dados.distancia_mm = dist_mm;
-
-        printf("[Sensor] T: %.2f C | P: %lu Pa\n", dados.temperatura, dados.pressao);
-
-        ssd1306_clear();
-
-        const char *word = (dados.temperatura >= (float)TEMP_THRESHOLD_C) ? "QUENTE" : "FRIO";
-        int len = (int)strlen(word);
-        // Calcula escala máxima que cabe na largura e altura
-        int max_scale_w = 128 / (len * 6);
-        int max_scale_h = 64 / 7;
-        int scale = max_scale_w;
-        if (scale > max_scale_h) scale = max_scale_h;
-        if (scale < 1) scale = 1;
-        int text_w = len * 6 * scale;
-        int text_h = 7 * scale;
-        int x0 = (128 - text_w) / 2;
-        int y0 = (64 - text_h) / 2;
-
-        ssd1306_draw_text_scaled(x0, y0, word, scale, true);
-
-        // LED cores: quente=vermelho, frio=azul
-        if (dados.temperatura >= (float)TEMP_THRESHOLD_C) {
-            pwm_led(LED_PIN_R, 3000);
-            pwm_led(LED_PIN_G, 0);
-            pwm_led(LED_PIN_B, 0);
-        } else {
-            pwm_led(LED_PIN_R, 0);
-            pwm_led(LED_PIN_G, 0);
-            pwm_led(LED_PIN_B, 3000);
+
+        // Distância do sensor ToF: a leitura mais nova do lote; sem leitura nova fica a anterior
+        sensor_reading_t lote[4];
+        size_t n = sensor_hal_read(SENSOR_DISTANCE, lote, 4);
+        if (n > 0) {
+            const sensor_reading_t *r = &lote[n - 1];
+            dist_mm = r->distance.mm;
+            LOG_I("[ToF] Distância: %u mm | status=0x%02X | stream=%u | idade=%lu ms\n", (unsigned)dist_mm,
+                  r->distance.status, r->distance.stream, (unsigned long)((time_us_64() - r->t_us) / 1000));
+        }
+
+        // A amostra é montada direto no slot do anel; com o anel cheio só é exibida
+        DadosSensor descarte;
+        DadosSensor *dados = sample_ring_claim(&anelAmostras);
+        if (!dados)
+            dados = &descarte;
+        dados->temp_c100 = 0;
+        dados->pres_pa = 0;
+        // Conversão mais velha que dois períodos (pausa, atraso) é descartada
+        if (!bmp280_recolher(dados, 2 * periodo))
+            LOG_W("[BMP280] Leitura falhou.\n");
+        // Um só instante: t_ms vai na telemetria, t_us mede a latência até a publicação
+        uint64_t instante_us = time_us_64();
+        dados->t_ms = (uint32_t)(instante_us / 1000);
+        dados->t_us = (uint32_t)instante_us;
+        dados->dist_mm = dist_mm;
+
+        // Temperatura já em inteiro (°C x 100): sinal, parte inteira e centésimos
+        uint16_t t_abs = (uint16_t)(dados->temp_c100 < 0 ? -dados->temp_c100 : dados->temp_c100);
+        LOG_I("[Sensor] T: %c%u.%02u C | P: %lu Pa\n", dados->temp_c100 < 0 ? '-' : '+', t_abs / 100, t_abs % 100,
+              (unsigned long)dados->pres_pa);
+
+        dados->bpm_x10 = dados->spo2_x10 = 0;
+        if (sensor_hal_read(SENSOR_PPG, lote, 1)) {
+            const ppg_result_t *ppg = &lote[0].ppg;
+            dados->bpm_x10 = ppg->bpm_x10;
+            dados->spo2_x10 = ppg->spo2_x10;
+            LOG_I("[MAX30101] %u.%u bpm | SpO2 %u.%u%% | %lu batimentos\n", ppg->bpm_x10 / 10, ppg->bpm_x10 % 10,
+                  ppg->spo2_x10 / 10, ppg->spo2_x10 % 10, (unsigned long)ppg->beats);
+        }
+
+        // Amostra sem mudança fica no slot sem ser publicada: o próximo ciclo a sobrescreve.
+        // Com o anel cheio ela nem passa pelo filtro, que marcaria como publicado
+        // um valor que se perdeu: a mudança sai quando houver slot
+        if (dados != &descarte && (!cfg.report_by_exception || rbe_update(&filtroRelato, dados)))
+            sample_ring_commit(&anelAmostras);
+
+        if ((int32_t)(agora_ms() - proximo_display) >= 0)
+        {
+            proximo_display += cfg.display_period_ms;
+            if ((int32_t)(agora_ms() - proximo_display) >= 0)
+                proximo_display = agora_ms() + cfg.display_period_ms;
+            atualizar_display(dados->temp_c100, cfg.temp_threshold_c100);
         }
 
-        ssd1306_update();
+        if (rbe_period_ms(&filtroRelato) != periodo) {
+            periodo = rbe_period_ms(&filtroRelato);
+            sensor_timing_set_period(periodo);
+            LOG_D("[Sensor] Período de amostragem: %lu ms\n", (unsigned long)periodo);
+        }
+        sensor_timing_cycle_end();
+        sensor_timing_wake(xTaskDelayUntil(&prazo, pdMS_TO_TICKS(periodo)) == pdFALSE);
+    }
+}
+
+static bool publicar(const char *topico, const void *payload, size_t len)
+{
+    if (!net_conn_online())
+        return false;
+    power_save_wake();
+    if (!net_conn_publish(topico, payload, len, 0))
+        return false;
+    power_save_sent(strlen(topico) + len);
+    return true;
+}
+
+// Amostras por publicação: um lote CBOR ou um objeto JSON
+#if TELEMETRY_FORMAT == TELEMETRY_CBOR
+#define LOTE_MAX TELEMETRY_BATCH_MAX
+#else
+#define LOTE_MAX 1
+#endif
+
+// Limiares enviados com a telemetria; seguem a configuração viva (tarefaMQTT)
+static telemetry_meta_t meta;
+
+// Publica até LOTE_MAX amostras com números de sequência consecutivos, codificadas
+// direto de onde estão (slots do anel ou leitura do diário)
+static bool publicar_amostras(const DadosSensor *const *a, size_t n, bool reenvio)
+{
+#if TELEMETRY_FORMAT == TELEMETRY_CBOR
+    static uint8_t payload[TELEMETRY_CBOR_BATCH_MAX_BYTES];
+    telemetry_batch_t lote;
+    telemetry_batch_begin(&lote, payload, sizeof payload, &meta);
+    for (size_t i = 0; i < n; ++i)
+        if (!telemetry_batch_add(&lote, a[i]))
+            return false;
+    size_t len = telemetry_batch_finish(&lote);
+    if (!publicar(TELEMETRY_TOPIC_CBOR, payload, len))
+        return false;
+    if (reenvio)
+        LOG_I("[MQTT] Reenviado lote CBOR: %u amostras (seq %lu), %u bytes\n", lote.count, (unsigned long)a[0]->seq,
+              (unsigned)len);
+    else
+        LOG_I("[MQTT] Enviado lote CBOR: %u amostras (seq %lu), %u bytes\n", lote.count, (unsigned long)a[0]->seq,
+              (unsigned)len);
+#else
+    char payload[BUFFER_SIZE];
+    size_t len = telemetry_encode_json(a[0], &meta, payload, sizeof payload);
+    if (n != 1 || !len || !publicar(TELEMETRY_TOPIC_JSON, payload, len))
+        return false;
+    if (reenvio)
+        LOG_I("[MQTT] Reenviado JSON: seq %lu, %u bytes\n", (unsigned long)a[0]->seq, (unsigned)len);
+    else
+        LOG_I("[MQTT] Enviado JSON: seq %lu, %u bytes\n", (unsigned long)a[0]->seq, (unsigned)len);
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+    // O payload é texto: sai síncrono, só no nível de depuração
+    printf("[MQTT] %s\n", payload);
+#endif
+#endif
+    return true;
+}
+
+// Registro de diagnóstico (tarefas, pilhas, heap, memória do lwIP) em DIAG_TOPIC
+static void publicar_diagnostico(void)
+{
+    static uint8_t payload[DIAG_CBOR_MAX_BYTES];
+    size_t len = diag_encode(payload, sizeof payload);
+    if (len && publicar(DIAG_TOPIC, payload, len))
+        LOG_I("[Diag] Enviado: %u bytes, heap livre %u (mín %u)\n", (unsigned)len, (unsigned)xPortGetFreeHeapSize(),
+              (unsigned)xPortGetMinimumEverFreeHeapSize());
+}
+
+// Comando guardado pelo callback: aplica (e grava em flash) aqui, fora do contexto
+// do lwIP, e responde com a configuração resultante ou o erro
+static void tratar_comando(void)
+{
+    static char resposta[DEV_CONFIG_RESP_MAX];
+    size_t len = dev_config_command(comandoConfig, comandoLen, resposta, sizeof resposta);
+    atomic_store_explicit(&comandoPronto, false, memory_order_release);
+    if (len && publicar(DEV_CONFIG_TOPIC_RESP, resposta, len))
+        LOG_I("[Config] Resposta enviada: %u bytes, versão %lu\n", (unsigned)len, (unsigned long)dev_config_version());
+}
 
-        xQueueSend(filaMQTT, &dados, 0);
-        vTaskDelay(pdMS_TO_TICKS(10000));
+// Numeração única por dispositivo; sem diário, só dentro desta execução
+static uint32_t proximo_seq(void)
+{
+    static uint32_t seq;
+    return diario_ok ? journal_next_seq(&diario) : seq++;
+}
+
+// As n amostras mais antigas do anel que não saíram ao vivo vão para o diário
+// (sem diário, se perdem) e os slots voltam ao produtor
+static void guardar(size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const DadosSensor *a = sample_ring_at(&anelAmostras, i);
+        if (!diario_ok || !journal_append(&diario, a))
+            LOG_W("[Diário] Amostra seq %lu descartada\n", (unsigned long)a->seq);
     }
+    sample_ring_release(&anelAmostras, n);
+}
+
+static uint32_t diario_pendentes(void)
+{
+    return diario_ok ? journal_pending(&diario) : 0;
+}
+
+// Driver do CYW43 num async_context próprio, preso ao núcleo de rede (o contexto
+// padrão do SDK cria a tarefa sem afinidade). A interrupção do rádio é instalada
+// no núcleo de quem chama cyw43_arch_init(): tarefaMQTT, também no núcleo de rede.
+static int wifi_init(void)
+{
+    static async_context_freertos_t contexto;
+    async_context_freertos_config_t cfg = async_context_freertos_default_config();
+    cfg.task_priority = CYW43_TASK_PRIO;
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    cfg.task_core_id = CORE_REDE;
+#endif
+    if (!async_context_freertos_init(&contexto, &cfg))
+        return -1;
+    cyw43_arch_set_async_context(&contexto.core);
+    int r = cyw43_arch_init();
+    // A tcpip_thread do lwIP nasce dentro de cyw43_arch_init(), sem afinidade
+    task_pin(xTaskGetHandle(TCPIP_THREAD_NAME), CORE_REDE);
+    return r;
+}
+
+// Sessão completa ou perdida (tarefa de conexão): tarefaMQTT acorda para reenviar
+// o diário ou desviar as amostras para ele sem esperar a próxima amostra
+static void conexao_mudou(bool online)
+{
+    (void)online;
+    sample_ring_wake(&anelAmostras);
+}
+
+static TickType_t ate(uint32_t instante_ms)
+{
+    int32_t falta = (int32_t)(instante_ms - agora_ms());
+    return falta > 0 ? pdMS_TO_TICKS(falta) : 0;
 }
 
 void tarefaMQTT(void *pvParameters)
 {
+    // Primeira tarefa a rodar (núcleo de rede, antes da tarefa de carga): a carga
+    // por núcleo só vale com cada tarefa ociosa presa ao seu núcleo
+    task_pin_idle();
+    log_async_register();
+
+    // 0. Diário em flash antes da rede: o que ficou pendente da última execução sai na conexão
+    diario_ok = flash_dev_pico(&flashDiario, PICO_FLASH_SIZE_BYTES - JOURNAL_FLASH_SIZE, JOURNAL_FLASH_SIZE) &&
+                journal_open(&diario, &flashDiario);
+    if (diario_ok)
+        printf("[Diário] %lu amostras pendentes, próximo seq %lu\n", (unsigned long)journal_pending(&diario),
+               (unsigned long)diario.next_seq);
+    else
+        printf("[Diário] Região de flash indisponível: amostras sem conexão serão descartadas\n");
+
     // 1. Inicializa o Wi-Fi SOMENTE AQUI dentro do RTOS
-    if (cyw43_arch_init())
+    if (wifi_init())
     {
         printf("[Erro] Falha no hardware Wi-Fi\n");
         vTaskDelete(NULL);
     }
     cyw43_arch_enable_sta_mode();
 
-    printf("[Wi-Fi] Conectando a %s...\n", WIFI_SSID);
-    while (cyw43_arch_wifi_connect_timeout_ms(WIFI_SSID, WIFI_PASSWORD, CYW43_AUTH_WPA2_AES_PSK, 15000))
+    static dev_config_t cfg;
+    uint32_t versao_cfg = dev_config_version();
+    dev_config_get(&cfg);
+    meta.dist_threshold_mm = (uint16_t)cfg.dist_threshold_mm;
+    meta.temp_threshold_c100 = (int16_t)cfg.temp_threshold_c100;
+    power_save_init(cfg.low_power);
+
+    // 2. Wi-Fi, DNS, broker e assinaturas ficam com o gerenciador da conexão
+    // (inc/net_conn.c); aqui só se pergunta se a sessão está completa
+#if MQTT_TLS
+    // TLS com SNI e retomada de sessão nas reconexões (inc/mqtt_tls.c); a CA vem
+    // de MQTT_CA_CERT no .env, e sem ela só com MQTT_TLS_INSECURE=1
+#ifdef MQTT_TLS_CA_PEM
+    if (!mqtt_tls_init(MQTT_TLS_CA_PEM))
+#elif MQTT_TLS_INSECURE
+    if (!mqtt_tls_init(NULL))
+#else
+#error "MQTT_TLS=1 exige MQTT_CA_CERT (ou MQTT_TLS_INSECURE=1)"
+#endif
     {
-        printf("[Wi-Fi] Tentando reconectar...\n");
-        vTaskDelay(pdMS_TO_TICKS(3000));
+        printf("[Erro] Falha na configuração do TLS\n");
+        vTaskDelete(NULL);
+    }
+#endif
+    // Árvore de despacho montada antes da conexão; depois só é lida
+    topic_trie_init(&despacho);
+    for (uint16_t i = 0; i < ASSINATURAS; i++)
+        if (!topic_trie_add(&despacho, assinaturas[i].topic, strlen(assinaturas[i].topic), i))
+            printf("[Erro] Assinatura %s fora da árvore de despacho\n", assinaturas[i].topic);
+    static const net_conn_config_t conexao = {
+        .ssid = WIFI_SSID,
+        .password = WIFI_PASSWORD,
+        .auth = CYW43_AUTH_WPA2_AES_PSK,
+        .fallback_host = MQTT_SERVER_HOST,
+        .fallback_port = MQTT_SERVER_PORT,
+        .client_id = "PicoW_Pablo_ADS",
+        .keep_alive_s = 60,
+        .subs = assinaturas,
+        .sub_count = ASSINATURAS,
+        .pub_cb = mqtt_pub_start_cb,
+        .data_cb = mqtt_pub_data_cb,
+        .on_change = conexao_mudou,
+    };
+    if (!net_conn_start(&conexao, cfg.broker_host, cfg.broker_port))
+    {
+        printf("[Erro] Falha ao iniciar o gerenciador da conexão\n");
+        vTaskDelete(NULL);
     }
-    printf("[Wi-Fi] Online!\n");
 
-    // 2. Evite calloc: Use uma variável estática para o estado
-    static MQTT_CLIENT_T local_state;
-    mqtt_state = &local_state;
+    // Lote ao vivo: as amostras ficam nos slots do anel até sair o lote (LOTE_MAX
+    // amostras, ou a mais antiga com TELEMETRY_BATCH_AGE_MS). Em baixo consumo, até
+    // a rajada: uplink_batch amostras, ou a mais antiga com uplink_batch períodos;
+    // com o rádio acordado, tudo o que houver no anel sai junto. Sem conexão, ou
+    // com diário por reenviar, vão para o diário para manter a ordem de sequência.
+    size_t numeradas = 0;
+    uint32_t proximo_reenvio = agora_ms();
+    uint32_t proximo_diag = agora_ms() + cfg.diag_interval_ms;
+    bool estava_online = false;
 
-    run_dns_lookup(mqtt_state);
+    while (1)
+    {
+        if (atomic_load_explicit(&comandoPronto, memory_order_acquire))
+            tratar_comando();
 
-    struct mqtt_connect_client_info_t ci = {0};
-    ci.client_id = "PicoW_Pablo_ADS"; //
-    ci.keep_alive = 60;
+        if (dev_config_version() != versao_cfg)
+        {
+            static dev_config_t novo;
+            versao_cfg = dev_config_version();
+            dev_config_get(&novo);
+            bool troca_broker = strcmp(novo.broker_host, cfg.broker_host) != 0 || novo.broker_port != cfg.broker_port;
+            cfg = novo;
+            meta.dist_threshold_mm = (uint16_t)cfg.dist_threshold_mm;
+            meta.temp_threshold_c100 = (int16_t)cfg.temp_threshold_c100;
+            proximo_diag = agora_ms() + cfg.diag_interval_ms;
+            power_save_set_mode(cfg.low_power);
+            if (troca_broker)
+            {
+                // A resposta ao comando já saiu pela sessão antiga
+                printf("[MQTT] Broker alterado para %s:%u\n", cfg.broker_host, (unsigned)cfg.broker_port);
+                net_conn_set_broker(cfg.broker_host, cfg.broker_port);
+            }
+        }
+
+        bool online = net_conn_online();
+        if (online != estava_online)
+        {
+            if (online)
+            {
+                LOG_I("[MQTT] Sessão ativa: %lu amostras no diário\n", (unsigned long)diario_pendentes());
+                power_save_link_up();
+            }
+            else
+                LOG_W("[MQTT] Sem conexão: amostras vão para o diário em flash\n");
+            estava_online = online;
+        }
 
-    cyw43_arch_lwip_begin();
-    mqtt_state->mqtt_client = mqtt_client_new();
-    mqtt_client_connect(mqtt_state->mqtt_client, &(mqtt_state->remote_addr), MQTT_SERVER_PORT, mqtt_connection_cb, mqtt_state, &ci);
-    mqtt_set_inpub_callback(mqtt_state->mqtt_client, NULL, mqtt_pub_data_cb, NULL);
-    cyw43_arch_lwip_end();
+        // Número de sequência na ordem de chegada, gravado no próprio slot
+        size_t n = sample_ring_count(&anelAmostras);
+        for (; numeradas < n; ++numeradas)
+            sample_ring_at(&anelAmostras, numeradas)->seq = proximo_seq();
 
-    DadosSensor dados;
-    char payload[BUFFER_SIZE];
+        if (n && (!online || diario_pendentes()))
+        {
+            guardar(n);
+            numeradas = n = 0;
+        }
 
-    while (1)
-    {
-        if (xQueueReceive(filaMQTT, &dados, portMAX_DELAY))
+        uint32_t fim_rajada;
+        bool rajada = power_save_poll(&fim_rajada);
+        uint32_t idade_max = cfg.low_power ? cfg.uplink_batch * cfg.sensor_period_ms : TELEMETRY_BATCH_AGE_MS;
+        bool sai = n && agora_ms() - sample_ring_at(&anelAmostras, 0)->t_ms >= idade_max;
+        if (cfg.low_power)
+            sai = sai || (n && (n >= cfg.uplink_batch || power_save_awake()));
+        else
+            sai = sai || n >= LOTE_MAX;
+        if (sai)
         {
-            if (mqtt_client_is_connected(mqtt_state->mqtt_client))
+            size_t k = n < LOTE_MAX ? n : LOTE_MAX;
+            const DadosSensor *lote[LOTE_MAX];
+            for (size_t i = 0; i < k; ++i)
+                lote[i] = sample_ring_at(&anelAmostras, i);
+            if (publicar_amostras(lote, k, false))
             {
-                snprintf(payload, BUFFER_SIZE,
-                         "{\"temp\": %.2f, \"pres\": %lu, \"dist\": %u, \"threshold_mm\": %u, \"temp_threshold_c\": %.2f}",
-                         dados.temperatura,
-                         dados.pressao,
-                         dados.distancia_mm,
-                         (unsigned)DIST_THRESHOLD_MM,
-                         (double)TEMP_THRESHOLD_C);
-                cyw43_arch_lwip_begin();
-                mqtt_publish(mqtt_state->mqtt_client, "pico_w/sensor", payload, strlen(payload), 0, 0, NULL, NULL);
-                cyw43_arch_lwip_end();
-                printf("[MQTT] Enviado: %s\n", payload);
+                for (size_t i = 0; i < k; ++i)
+                    sensor_timing_published(lote[i]->t_us);
+                sample_ring_release(&anelAmostras, k);
             }
+            else
+                guardar(k);
+            numeradas -= k;
+            continue;
+        }
+
+        // Reenvio em ordem, um lote por intervalo; só é confirmado no diário se a publicação foi aceita
+        if (online && diario_pendentes() && (int32_t)(agora_ms() - proximo_reenvio) >= 0)
+        {
+            DadosSensor antigas[LOTE_MAX];
+            const DadosSensor *lote[LOTE_MAX];
+            size_t k = journal_peek(&diario, antigas, LOTE_MAX);
+            for (size_t i = 0; i < k; ++i)
+                lote[i] = &antigas[i];
+            if (k && publicar_amostras(lote, k, true))
+                journal_ack(&diario);
+            proximo_reenvio = agora_ms() + JOURNAL_REPLAY_INTERVAL_MS;
         }
+
+        // Em baixo consumo o diagnóstico pega carona na rajada, com no máximo um intervalo de atraso
+        int32_t atraso_diag = (int32_t)(agora_ms() - proximo_diag);
+        if (online && atraso_diag >= 0 &&
+            (!cfg.low_power || power_save_awake() || atraso_diag >= (int32_t)cfg.diag_interval_ms))
+        {
+            publicar_diagnostico();
+            proximo_diag = agora_ms() + cfg.diag_interval_ms;
+        }
+
+        // Dorme até a próxima amostra ou o primeiro prazo pendente
+        TickType_t espera = portMAX_DELAY;
+        if (n)
+            espera = ate(sample_ring_at(&anelAmostras, 0)->t_ms + idade_max);
+        if (online && diario_pendentes() && ate(proximo_reenvio) < espera)
+            espera = ate(proximo_reenvio);
+        uint32_t prazo_diag = proximo_diag + (cfg.low_power ? cfg.diag_interval_ms : 0);
+        if (online && ate(prazo_diag) < espera)
+            espera = ate(prazo_diag);
+        if (rajada && ate(fim_rajada) < espera)
+            espera = ate(fim_rajada);
+        sample_ring_wait(&anelAmostras, espera);
     }
 }
 
+// Padrão de fábrica vindo do .env (macros do CMake); uma configuração gravada em
+// flash por comando MQTT prevalece. Antes das tarefas: todas leem o bloco vivo.
+static void config_init(void)
+{
+    dev_config_t padrao = {
+        .temp_threshold_c100 = (int32_t)(TEMP_THRESHOLD_C * 100),
+        .dist_threshold_mm = DIST_THRESHOLD_MM,
+        .sensor_period_ms = SENSOR_PERIOD_MS,
+        .sensor_period_fast_ms = SENSOR_PERIOD_FAST_MS,
+        .display_period_ms = DISPLAY_PERIOD_MS,
+        .diag_interval_ms = DIAG_INTERVAL_MS,
+        .report_by_exception = REPORT_BY_EXCEPTION,
+        .low_power = LOW_POWER,
+        .uplink_batch = UPLINK_BATCH,
+        .broker_port = MQTT_SERVER_PORT,
+    };
+    strncpy(padrao.broker_host, MQTT_SERVER_HOST, DEV_CONFIG_HOST_MAX);
+    bool ok = flash_dev_pico(&flashConfig, PICO_FLASH_SIZE_BYTES - JOURNAL_FLASH_SIZE - DEV_CONFIG_FLASH_SIZE,
+                             DEV_CONFIG_FLASH_SIZE);
+    dev_config_init(&padrao, ok ? &flashConfig : NULL);
+
+    dev_config_stats_t st;
+    dev_config_get_stats(&st);
+    if (!ok)
+        printf("[Config] Região de flash indisponível: comandos valem só até o próximo boot\n");
+    else if (st.loaded_counter)
+        printf("[Config] Configuração gravada #%lu carregada\n", (unsigned long)st.loaded_counter);
+    else
+        printf("[Config] Padrão de fábrica (.env)\n");
+}
+
+// configCHECK_FOR_STACK_OVERFLOW: a pilha já foi corrompida, não há como seguir
+void vApplicationStackOverflowHook(TaskHandle_t tarefa, char *nome)
+{
+    (void)tarefa;
+    panic("Estouro de pilha na tarefa %s", nome);
+}
+
 int main()
 {
     stdio_init_all();
@@ -700,13 +1228,21 @@ int main()
     printf("==================================\n");
 
     pinos_start();
+    config_init();
+
 
-    filaMQTT = xQueueCreate(5, sizeof(DadosSensor));
+    // BMP280 sozinho no I2C0; no I2C1 o display roda a 400 kHz e o ToF a 100 kHz (margem para pull-ups fracos)
+    busBMP280 = i2c_bus_register(&(i2c_bus_pins_t){i2c0, I2C_SDA_PIN, I2C_SCL_PIN, 100 * 1000});
+    busDisplay = i2c_bus_register(&(i2c_bus_pins_t){i2c1, DISP_SDA_PIN, DISP_SCL_PIN, 400 * 1000});
+    busToF = i2c_bus_register(&(i2c_bus_pins_t){i2c1, MAX_SDA_PIN, MAX_SCL_PIN, 100 * 1000});
 
-    // Valores otimizados para evitar estouro de memória
-    xTaskCreate(tarefaLeituraBotao, "Botao", 128, NULL, 1, NULL);
-    xTaskCreate(tarefaSensorBMP280, "Sensor", 256, NULL, 1, &hTarefaSensor);
-    xTaskCreate(tarefaMQTT, "MQTT", 896, NULL, 1, &hTarefaMQTT); // Reduzido para 896
+    // Valores otimizados para evitar estouro de memória; núcleos e prioridades em inc/task_cores.h
+    task_create_on(tarefaLeituraBotao, "Botao", 128, NULL, BOTAO_TASK_PRIO, CORE_AQUISICAO, NULL);
+    task_create_on(tarefaSensorBMP280, "Sensor", 256, NULL, SENSOR_TASK_PRIO, CORE_AQUISICAO, &hTarefaSensor);
+    task_create_on(tarefaMQTT, "MQTT", 896, NULL, MQTT_TASK_PRIO, CORE_REDE, &hTarefaMQTT); // Reduzido para 896
+    sample_ring_init(&anelAmostras, hTarefaMQTT);
+    core_load_start();
+    log_async_start();
 
     vTaskStartScheduler();
     while (1)
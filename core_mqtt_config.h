@@ -0,0 +1,25 @@
+#ifndef CORE_MQTT_CONFIG_H
+#define CORE_MQTT_CONFIG_H
+
+// Configuração do coreMQTT (MQTT_STACK=coremqtt no .env; inc/net_conn.c e
+// inc/mqtt_transport.c). Sem log próprio: as falhas que importam saem pelo log
+// diferido do gerenciador da conexão.
+
+// Espera por byte dentro de um pacote já começado; o transporte espera no
+// select() (MQTT_TRANSPORT_RECV_WAIT_MS), então a biblioteca quase não gira à toa
+#define MQTT_RECV_POLLING_TIMEOUT_MS 100U
+
+// Envio travado além deste prazo derruba a sessão (o socket já tem SO_SNDTIMEO)
+#define MQTT_SEND_TIMEOUT_MS 10000U
+
+#define MQTT_PINGRESP_TIMEOUT_MS 5000U
+
+// Registros de QoS no vetor compactado do coreMQTT (MQTT_STATE_HASHED_RECORDS
+// fica 0): com NET_CONN_QOS_RECORDS=4 a busca linear custa o mesmo que a tabela
+// por packet ID e cada registro é 8 B menor (sim/bench_mqtt_state.c)
+
+// PUBLISH maior que o buffer de recepção (NET_CONN_MQTT_BUFFER) chega à
+// aplicação em pedaços em vez de ser descartado (sim/check_mqtt_stream.c)
+#define MQTT_STREAM_LARGE_PUBLISH 1
+
+#endif
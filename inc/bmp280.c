@@ -18,6 +18,24 @@ static int32_t bmp280_raw_pressure_data(uint8_t deviceAddress);
 static uint16_t bmp280_read_calibration_word_unsigned(uint8_t deviceAddress, uint8_t startRegisterAddress);
 static int16_t bmp280_read_calibration_word_signed(uint8_t deviceAddress, uint8_t startRegisterAddress);
 static void bmp280_get_bits_in_register(uint8_t deviceAddress, uint8_t registerAddress, uint8_t *fieldData, uint8_t fieldStartBitAddress, uint8_t fieldLength);
+static int32_t bmp280_raw_20bit(const uint8_t *data);
+static collect_status_t bmp280_collect_raw(bmp280_handle_t *handle, int32_t *adc_T, int32_t *adc_P);
+
+/*altitude in centimeters (44330 * (1 - (p / 101325) ^ 0.190284)) every ALTITUDE_TABLE_STEP_PA from ALTITUDE_TABLE_MIN_PA*/
+static const int32_t altitude_table_cm[] = {
+  916469, 894459, 873017, 852111, 831712, 811793, 792329, 773299,
+  754680, 736454, 718603, 701109, 683958, 667134, 650624, 634415,
+  618495, 602853, 587478, 572361, 557491, 542860, 528460, 514282,
+  500319, 486563, 473009, 459650, 446479, 433490, 420679, 408039,
+  395566, 383255, 371101, 359100, 347248, 335540, 323972, 312542,
+  301245, 290078, 279037, 268120, 257324, 246644, 236080, 225628,
+  215285, 205048, 194916, 184886, 174956, 165124, 155387, 145743,
+  136191, 126728, 117353, 108064, 98859, 89736, 80695, 71732,
+  62847, 54039, 45305, 36644, 28056, 19538, 11089, 2709,
+  -5604, -13852, -22035, -30155, -38212, -46208, -54143, -62020,
+  -69838, -77599,
+};
+#define ALTITUDE_TABLE_LENGTH (sizeof(altitude_table_cm) / sizeof(altitude_table_cm[0]))
 
 /*initializer, detects the connected chips automatically and resets all of them. returns the detected addresses (if any), 
  * and automatically gets the calibration data for further calculations. also sets the default values.
@@ -180,13 +198,19 @@ int32_t bmp280_get_temperature(uint8_t deviceAddress)
   calibration_param_t *dig = bmp280_which_dig(deviceAddress);       /*automatically relating device address and calibration data*/
 
   int32_t adc_T = bmp280_raw_temperature_data(deviceAddress);      /*per Bosch guideline*/
+  return bmp280_compensate_temperature(dig, adc_T, &t_fine);
+}
+
+/*Bosch integer compensation; returns centigrade x100 and updates tFine for the pressure compensation*/
+int32_t bmp280_compensate_temperature(const calibration_param_t *dig, int32_t adc_T, int32_t *tFine)
+{
   int32_t var1, var2, T;
 
   var1 = ((((adc_T >> 3) - ((int32_t)dig->T1 << 1))) * ((int32_t)dig->T2)) >> 11;
   var2 = (((((adc_T >> 4) - ((int32_t)dig->T1)) * ((adc_T >> 4) - ((int32_t)dig->T1))) >> 12) * ((int32_t)dig->T3)) >> 14;
 
-  t_fine = var1 + var2;
-  T = (t_fine * 5 + 128) >> 8;
+  *tFine = var1 + var2;
+  T = (*tFine * 5 + 128) >> 8;
   return T;
 }
 
@@ -196,10 +220,16 @@ uint32_t bmp280_get_pressure(uint8_t deviceAddress)
   calibration_param_t *dig = bmp280_which_dig(deviceAddress);
 
   int32_t adc_P = bmp280_raw_pressure_data(deviceAddress);
+  return bmp280_compensate_pressure(dig, adc_P, t_fine);
+}
+
+/*Bosch 32 bit integer compensation; returns pascal*/
+uint32_t bmp280_compensate_pressure(const calibration_param_t *dig, int32_t adc_P, int32_t tFine)
+{
   int32_t var1, var2;
   uint32_t p;
 
-  var1 = (((int32_t) t_fine) / 2) - (int32_t) 64000;
+  var1 = (((int32_t) tFine) / 2) - (int32_t) 64000;
   var2 = (((var1 / 4) * (var1 / 4)) / 2048) * ((int32_t) dig->P6);
   var2 = var2 + ((var1 * ((int32_t) dig->P5)) * 2);
   var2 = (var2 / 4) + (((int32_t) dig->P4) * 65536);
@@ -230,6 +260,59 @@ uint32_t bmp280_get_pressure(uint8_t deviceAddress)
   return p;
 }
 
+/*Bosch 64 bit integer compensation; returns pascal in Q24.8 (value / 256 = Pa), resolution ~0.004 Pa*/
+uint32_t bmp280_compensate_pressure_q24_8(const calibration_param_t *dig, int32_t adc_P, int32_t tFine)
+{
+  int64_t var1, var2, p;
+
+  var1 = ((int64_t)tFine) - 128000;
+  var2 = var1 * var1 * (int64_t)dig->P6;
+  var2 = var2 + ((var1 * (int64_t)dig->P5) << 17);
+  var2 = var2 + (((int64_t)dig->P4) << 35);
+  var1 = ((var1 * var1 * (int64_t)dig->P3) >> 8) + ((var1 * (int64_t)dig->P2) << 12);
+  var1 = (((((int64_t)1) << 47) + var1)) * ((int64_t)dig->P1) >> 33;
+
+  if (var1 == 0)
+  {
+    return 0;       /*avoid exception caused by division by zero*/
+  }
+  p = 1048576 - adc_P;
+  p = (((p << 31) - var2) * 3125) / var1;
+  var1 = (((int64_t)dig->P9) * (p >> 13) * (p >> 13)) >> 25;
+  var2 = (((int64_t)dig->P8) * p) >> 19;
+  p = ((p + var1 + var2) >> 8) + (((int64_t)dig->P7) << 4);
+  return (uint32_t)p;
+}
+
+/*altitude from the table with quadratic (Newton forward) interpolation; error < 3 cm over 300..1100 hPa.
+ * clamps outside the table range
+ */
+int32_t bmp280_altitude_cm(uint32_t pressureQ24_8)
+{
+  const int64_t step = (int64_t)ALTITUDE_TABLE_STEP_PA << 8;
+  int64_t x = (int64_t)pressureQ24_8 - ((int64_t)ALTITUDE_TABLE_MIN_PA << 8);
+
+  if (x <= 0)
+  {
+    return altitude_table_cm[0];
+  }
+  size_t i = (size_t)(x / step);
+  if (i > ALTITUDE_TABLE_LENGTH - 3)
+  {
+    i = ALTITUDE_TABLE_LENGTH - 3;
+    if (x > (int64_t)(ALTITUDE_TABLE_LENGTH - 1) * step)
+    {
+      return altitude_table_cm[ALTITUDE_TABLE_LENGTH - 1];
+    }
+  }
+  x -= (int64_t)i * step;
+
+  int64_t y0 = altitude_table_cm[i], y1 = altitude_table_cm[i + 1], y2 = altitude_table_cm[i + 2];
+  int64_t d1 = y1 - y0;
+  int64_t d2 = y2 - 2 * y1 + y0;
+  return (int32_t)(y0 + (d1 * x) / step + (d2 * x * (x - step)) / (2 * step * step));
+}
+
 /*calculates altitude from barometric pressure without temperature as an argument*/
 float bmp280_calculate_altitude_quick(uint8_t deviceAddress, uint32_t barometricPressure)
 {
@@ -275,6 +358,122 @@ sensors_t bmp280_get_all(uint8_t deviceAddress)
   return sensors_value;
 }
 
+/*resolves the calibration of one chip into a handle with a single burst read (0X88..0X9F) and caches its
+ * oversampling settings. call after bmp280_init (or bmp280_set), since the cached ctrl_meas is reused on every trigger
+ */
+output_status_t bmp280_handle_init(bmp280_handle_t *handle, uint8_t deviceAddress)
+{
+  uint8_t cal[CALIBRATION_LENGTH];
+  uint8_t ctrl;
+
+  if (bmp280_check_id(deviceAddress) != BMP280_TRUE)
+  {
+    return BMP280_FALSE;
+  }
+  if (bmp280_read_burst(deviceAddress, T1_ADDRESS, cal, CALIBRATION_LENGTH) != BMP280_TRUE ||
+      bmp280_read_burst(deviceAddress, CTRL_MEAS_ADDRESS, &ctrl, 1) != BMP280_TRUE)
+  {
+    return BMP280_FALSE;
+  }
+
+  handle->address = deviceAddress;
+  handle->dig.T1 = (uint16_t)(cal[0] | (cal[1] << 8));
+  handle->dig.T2 = (int16_t)(cal[2] | (cal[3] << 8));
+  handle->dig.T3 = (int16_t)(cal[4] | (cal[5] << 8));
+  handle->dig.P1 = (uint16_t)(cal[6] | (cal[7] << 8));
+  handle->dig.P2 = (int16_t)(cal[8] | (cal[9] << 8));
+  handle->dig.P3 = (int16_t)(cal[10] | (cal[11] << 8));
+  handle->dig.P4 = (int16_t)(cal[12] | (cal[13] << 8));
+  handle->dig.P5 = (int16_t)(cal[14] | (cal[15] << 8));
+  handle->dig.P6 = (int16_t)(cal[16] | (cal[17] << 8));
+  handle->dig.P7 = (int16_t)(cal[18] | (cal[19] << 8));
+  handle->dig.P8 = (int16_t)(cal[20] | (cal[21] << 8));
+  handle->dig.P9 = (int16_t)(cal[22] | (cal[23] << 8));
+  handle->t_fine = 0;
+  handle->ctrl_meas = ctrl & (uint8_t)~(((1 << MODE_LENGTH) - 1) << MODE_BIT);
+  return BMP280_TRUE;
+}
+
+/*starts one forced conversion with a single ctrl_meas write and returns at once; the chip goes back to sleep by itself*/
+output_status_t bmp280_trigger_forced(bmp280_handle_t *handle)
+{
+  return bmp280_write_register(handle->address, CTRL_MEAS_ADDRESS, handle->ctrl_meas | (MODE_FORCED << MODE_BIT));
+}
+
+/*maximum conversion time for the cached oversampling (datasheet 3.8.1): 1.25 + 2.3 * T_os + (2.3 * P_os + 0.575) ms*/
+uint32_t bmp280_measurement_time_us(const bmp280_handle_t *handle)
+{
+  uint8_t osT = (handle->ctrl_meas >> OSRS_T_BIT) & ((1 << OSRS_T_LENGTH) - 1);
+  uint8_t osP = (handle->ctrl_meas >> OSRS_P_BIT) & ((1 << OSRS_P_LENGTH) - 1);
+  uint32_t nT = osT ? (1u << ((osT > OVERSAMPLING_16X ? OVERSAMPLING_16X : osT) - 1)) : 0;
+  uint32_t nP = osP ? (1u << ((osP > OVERSAMPLING_16X ? OVERSAMPLING_16X : osP) - 1)) : 0;
+  return 1250u + 2300u * nT + (nP ? 2300u * nP + 575u : 0u);
+}
+
+/*collects the result of the last trigger. COLLECT_BUSY while the chip is still measuring*/
+collect_status_t bmp280_collect(bmp280_handle_t *handle, sensors_t *sensors)
+{
+#if BMP280_FIXED_POINT
+  sensors_fixed_t fixed;
+  collect_status_t status = bmp280_collect_fixed(handle, &fixed);
+
+  if (status == COLLECT_OK)       /*float only at the interface*/
+  {
+    sensors->temperature = (float)fixed.temperature / 100;
+    sensors->pressure = (fixed.pressure + 128) >> 8;
+    sensors->altitude = (float)fixed.altitude / 100;
+  }
+  return status;
+#else
+  int32_t adc_T, adc_P;
+  collect_status_t status = bmp280_collect_raw(handle, &adc_T, &adc_P);
+
+  if (status == COLLECT_OK)
+  {
+    sensors->temperature = (float)bmp280_compensate_temperature(&handle->dig, adc_T, &handle->t_fine) / 100;
+    sensors->pressure = bmp280_compensate_pressure(&handle->dig, adc_P, handle->t_fine);
+    sensors->altitude = bmp280_calculate_altitude_quick(handle->address, sensors->pressure);
+  }
+  return status;
+#endif
+}
+
+/*integer-only collection: temperature x100, 64 bit pressure compensation and table altitude*/
+collect_status_t bmp280_collect_fixed(bmp280_handle_t *handle, sensors_fixed_t *sensors)
+{
+  int32_t adc_T, adc_P;
+  collect_status_t status = bmp280_collect_raw(handle, &adc_T, &adc_P);
+
+  if (status == COLLECT_OK)
+  {
+    sensors->temperature = bmp280_compensate_temperature(&handle->dig, adc_T, &handle->t_fine);
+    sensors->pressure = bmp280_compensate_pressure_q24_8(&handle->dig, adc_P, handle->t_fine);
+    sensors->altitude = bmp280_altitude_cm(sensors->pressure);
+  }
+  return status;
+}
+
+/*one burst read of 0XF3..0XFC (status + both raw values in the same transaction, so they belong to the same
+ * conversion)
+ */
+static collect_status_t bmp280_collect_raw(bmp280_handle_t *handle, int32_t *adc_T, int32_t *adc_P)
+{
+  uint8_t data[BURST_LENGTH];
+
+  if (bmp280_read_burst(handle->address, BURST_START_ADDRESS, data, BURST_LENGTH) != BMP280_TRUE)
+  {
+    return COLLECT_ERROR;
+  }
+  if ((data[0] & MEASURING_MASK) || (data[CTRL_MEAS_ADDRESS - BURST_START_ADDRESS] & (((1 << MODE_LENGTH) - 1) << MODE_BIT)) == (MODE_FORCED << MODE_BIT))
+  {
+    return COLLECT_BUSY;
+  }
+
+  *adc_P = bmp280_raw_20bit(&data[PRESSURE_MSB - BURST_START_ADDRESS]);
+  *adc_T = bmp280_raw_20bit(&data[TEMP_MSB - BURST_START_ADDRESS]);
+  return COLLECT_OK;
+}
+
 /*returns bmp280 mode of operation: sleep, normal or forced*/
 operation_mode_t bmp280_get_mode(uint8_t deviceAddress)
 {
@@ -382,6 +581,12 @@ iir_filter_t bmp280_get_filter_coefficient(uint8_t deviceAddress)
   return filterCoefficient;
 }
 
+/*msb, lsb, xlsb[7:4] -> 20 bit raw value*/
+static int32_t bmp280_raw_20bit(const uint8_t *data)
+{
+  return (int32_t)((((uint32_t)data[0]) << 12) + (((uint32_t)data[1]) << 4) + (((uint32_t)data[2]) >> 4));
+}
+
 /*raw reading of temperature registers, uncompensated*/
 static int32_t bmp280_raw_temperature_data(uint8_t deviceAddress)
 {
@@ -43,6 +43,26 @@ typedef struct
   float altitude;
 } sensors_t;
 
+/*pre-resolved device handle: calibration, t_fine and ctrl_meas oversampling bits are cached, so a forced
+ * conversion costs one register write to start and one burst read to collect*/
+typedef struct
+{
+  uint8_t address;
+  calibration_param_t dig;
+  int32_t t_fine;
+  uint8_t ctrl_meas;        /*oversampling bits, mode field cleared*/
+} bmp280_handle_t;
+
+typedef enum {COLLECT_OK, COLLECT_BUSY, COLLECT_ERROR} collect_status_t;
+
+/*integer-only readings*/
+typedef struct
+{
+  int32_t temperature;      /*centigrade x100*/
+  uint32_t pressure;        /*pascal, Q24.8*/
+  int32_t altitude;         /*centimeters*/
+} sensors_fixed_t;
+
 i2c_address_t bmp280_init();
 output_status_t bmp280_check_id(uint8_t deviceAddress);
 i2c_address_t bmp280_check_connected_address();
@@ -65,9 +85,23 @@ over_sampling_t bmp280_get_pressure_oversampling(uint8_t deviceAddress);
 standby_time_t bmp280_get_standby_time(uint8_t deviceAddress);
 iir_filter_t bmp280_get_filter_coefficient(uint8_t deviceAddress);
 
+output_status_t bmp280_handle_init(bmp280_handle_t *handle, uint8_t deviceAddress);
+output_status_t bmp280_trigger_forced(bmp280_handle_t *handle);
+uint32_t bmp280_measurement_time_us(const bmp280_handle_t *handle);
+collect_status_t bmp280_collect(bmp280_handle_t *handle, sensors_t *sensors);
+collect_status_t bmp280_collect_fixed(bmp280_handle_t *handle, sensors_fixed_t *sensors);
+
+/*compensation primitives (datasheet 8.2 integer formulas), also used by the host benchmark*/
+int32_t bmp280_compensate_temperature(const calibration_param_t *dig, int32_t adc_T, int32_t *tFine);
+uint32_t bmp280_compensate_pressure(const calibration_param_t *dig, int32_t adc_P, int32_t tFine);
+uint32_t bmp280_compensate_pressure_q24_8(const calibration_param_t *dig, int32_t adc_P, int32_t tFine);
+int32_t bmp280_altitude_cm(uint32_t pressureQ24_8);
+
 void bmp280_i2c_init();
 void bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
 void bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+output_status_t bmp280_read_burst(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength);
+output_status_t bmp280_write_register(uint8_t deviceAddress, uint8_t registerAddress, uint8_t value);
 void delay_function(uint32_t delayMS);
 float power_function (float x, float y);
 
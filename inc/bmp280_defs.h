@@ -7,6 +7,12 @@
 
 /*configurable definitions*/
 #define STARTUP_DELAY_IN_MS       1000
+
+/*1: bmp280_collect uses the integer-only path (64 bit pressure compensation, table altitude), no powf.
+ * 0: 32 bit pressure compensation and float altitude through power_function*/
+#ifndef BMP280_FIXED_POINT
+#define BMP280_FIXED_POINT        1
+#endif
 /*end of configurable definitions*/
 
 /*constant definitions*/
@@ -27,6 +33,13 @@
 #define TEMP_LSB                  0xFB
 #define TEMP_XLSB                 0xFC
 
+#define BURST_START_ADDRESS       STATUS_ADDRESS        /*0XF3..0XFC: status, ctrl_meas, config, reserved, press[3], temp[3]*/
+#define BURST_LENGTH              10
+#define CALIBRATION_LENGTH        24                    /*0X88..0X9F*/
+
+#define ALTITUDE_TABLE_MIN_PA     30000                 /*sensor range 300..1100 hPa*/
+#define ALTITUDE_TABLE_STEP_PA    1000
+
 #define IM_UPDATE_BIT             0X00
 #define MEASURING_BIT             0X01
 #define MODE_BIT                  0X00
@@ -38,6 +51,7 @@
 
 #define IM_UPDATE_LENGTH          0X01
 #define MEASURING_LENGTH          0X03
+#define MEASURING_MASK            0X08
 #define MODE_LENGTH               0X02
 #define OSRS_P_LENGTH             0X03
 #define OSRS_T_LENGTH             0X03
@@ -1,5 +1,6 @@
 #include "bmp280.h"
 #include "hardware/i2c.h"
+#include "inc/sensor_reg.h"
 #include "pico/stdlib.h"
 #include "math.h"
 
@@ -9,21 +10,23 @@
 
 void bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
 {
-    uint8_t buffer[dataLength + 1];
-    buffer[0] = startRegisterAddress;
-    for (uint8_t i = 0; i < dataLength; i++) {
-        buffer[i + 1] = data[i];
-    }
-
-    i2c_write_blocking(I2C_PORT, deviceAddress, buffer, dataLength + 1, false);
+    sensor_reg_write(I2C_PORT, deviceAddress, startRegisterAddress, data, dataLength);
 }
 
 void bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
 {
-    // Escreve o endereço do registrador a ser lido
-    i2c_write_blocking(I2C_PORT, deviceAddress, &startRegisterAddress, 1, true);
-    // Lê os dados a partir dele
-    i2c_read_blocking(I2C_PORT, deviceAddress, data, dataLength, false);
+    sensor_reg_read(I2C_PORT, deviceAddress, startRegisterAddress, data, dataLength);
+}
+
+/*register pointer write and data read in one transaction (repeated start); fails on NACK*/
+output_status_t bmp280_read_burst(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    return sensor_reg_read(I2C_PORT, deviceAddress, startRegisterAddress, data, dataLength) ? BMP280_TRUE : BMP280_FALSE;
+}
+
+output_status_t bmp280_write_register(uint8_t deviceAddress, uint8_t registerAddress, uint8_t value)
+{
+    return sensor_reg_write8(I2C_PORT, deviceAddress, registerAddress, value) ? BMP280_TRUE : BMP280_FALSE;
 }
 
 void bmp280_i2c_init()
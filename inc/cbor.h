@@ -0,0 +1,64 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Escrita CBOR (RFC 8949) mínima, só o que a telemetria e o diagnóstico usam:
+// inteiros de até 32 bits, arrays de tamanho definido e texto. O chamador
+// garante espaço (cada cabeçalho ocupa no máximo 5 bytes).
+
+#define CBOR_UINT 0
+#define CBOR_NEGINT 1
+#define CBOR_TEXT 3
+#define CBOR_ARRAY 4
+#define CBOR_HEAD_MAX 5
+
+// Cabeçalho CBOR: tipo maior nos 3 bits altos, argumento no menor número de bytes
+static inline size_t cbor_head(uint8_t *p, uint8_t major, uint32_t v)
+{
+    major <<= 5;
+    if (v < 24) {
+        p[0] = major | (uint8_t)v;
+        return 1;
+    }
+    if (v <= 0xFF) {
+        p[0] = major | 24;
+        p[1] = (uint8_t)v;
+        return 2;
+    }
+    if (v <= 0xFFFF) {
+        p[0] = major | 25;
+        p[1] = (uint8_t)(v >> 8);
+        p[2] = (uint8_t)v;
+        return 3;
+    }
+    p[0] = major | 26;
+    p[1] = (uint8_t)(v >> 24);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 8);
+    p[4] = (uint8_t)v;
+    return 5;
+}
+
+static inline size_t cbor_uint(uint8_t *p, uint32_t v)
+{
+    return cbor_head(p, CBOR_UINT, v);
+}
+
+static inline size_t cbor_int(uint8_t *p, int32_t v)
+{
+    return v < 0 ? cbor_head(p, CBOR_NEGINT, (uint32_t)(-1 - v)) : cbor_head(p, CBOR_UINT, (uint32_t)v);
+}
+
+static inline size_t cbor_array(uint8_t *p, uint32_t n)
+{
+    return cbor_head(p, CBOR_ARRAY, n);
+}
+
+// Texto UTF-8 de n bytes (n < 24 ocupa 1 byte de cabeçalho)
+static inline size_t cbor_text(uint8_t *p, const char *s, size_t n)
+{
+    size_t h = cbor_head(p, CBOR_TEXT, (uint32_t)n);
+    memcpy(p + h, s, n);
+    return h + n;
+}
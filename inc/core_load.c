@@ -0,0 +1,144 @@
+#include "inc/core_load.h"
+#include <stdio.h>
+#include <string.h>
+#include "inc/task_cores.h"
+
+#if CORE_LOAD_PROFILE
+
+static configRUN_TIME_COUNTER_TYPE s_t_ant;
+static configRUN_TIME_COUNTER_TYPE s_ocioso_ant[configNUMBER_OF_CORES];
+static uint64_t s_soma[configNUMBER_OF_CORES];
+static core_load_stats_t s_stats;
+
+// Tempo de execução de cada tarefa na leitura anterior, pelo número da tarefa
+static struct {
+    UBaseType_t numero;
+    configRUN_TIME_COUNTER_TYPE tempo;
+} s_tarefas_ant[CORE_LOAD_MAX_TASKS];
+static size_t s_num_tarefas_ant;
+static TaskStatus_t s_estado[CORE_LOAD_MAX_TASKS];
+
+// Mesma base de tempo que o kernel usa para contar a execução das tarefas
+static configRUN_TIME_COUNTER_TYPE contador(void)
+{
+#ifdef portALT_GET_RUN_TIME_COUNTER_VALUE
+    configRUN_TIME_COUNTER_TYPE t;
+    portALT_GET_RUN_TIME_COUNTER_VALUE(t);
+    return t;
+#else
+    return (configRUN_TIME_COUNTER_TYPE)portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+}
+
+bool core_load_sample(core_load_t *out)
+{
+    configRUN_TIME_COUNTER_TYPE t = contador();
+    uint32_t dt = (uint32_t)(t - s_t_ant);
+    if (dt == 0) return false;
+    out->elapsed_us = dt;
+    for (BaseType_t c = 0; c < configNUMBER_OF_CORES; ++c) {
+        configRUN_TIME_COUNTER_TYPE ocioso = task_idle_run_time(c);
+        uint32_t d = (uint32_t)(ocioso - s_ocioso_ant[c]);
+        s_ocioso_ant[c] = ocioso;
+        // A contagem da tarefa ociosa só avança na troca de contexto: pode passar de dt
+        out->load_permille[c] = d >= dt ? 0 : (uint16_t)(1000u - (uint32_t)((uint64_t)d * 1000u / dt));
+    }
+    s_t_ant = t;
+
+    s_stats.intervals++;
+    for (int c = 0; c < configNUMBER_OF_CORES; ++c) {
+        s_soma[c] += out->load_permille[c];
+        s_stats.avg_permille[c] = (uint16_t)(s_soma[c] / s_stats.intervals);
+        if (out->load_permille[c] > s_stats.max_permille[c])
+            s_stats.max_permille[c] = out->load_permille[c];
+    }
+    return true;
+}
+
+void core_load_get_stats(core_load_stats_t *out)
+{
+    *out = s_stats;
+}
+
+static configRUN_TIME_COUNTER_TYPE tempo_anterior(UBaseType_t numero)
+{
+    for (size_t i = 0; i < s_num_tarefas_ant; ++i)
+        if (s_tarefas_ant[i].numero == numero) return s_tarefas_ant[i].tempo;
+    return 0;
+}
+
+static const char *nucleo(const TaskStatus_t *s)
+{
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    if (s->uxCoreAffinityMask == (1u << 0)) return "n0";
+    if (s->uxCoreAffinityMask == (1u << 1)) return "n1";
+#else
+    (void)s;
+#endif
+    return "*";
+}
+
+// Fatia de cada tarefa no intervalo, em décimos de porcento do tempo de um núcleo
+static void imprime_tarefas(uint32_t dt)
+{
+    UBaseType_t n = uxTaskGetSystemState(s_estado, CORE_LOAD_MAX_TASKS, NULL);
+    if (n == 0) {
+        printf("[Carga]   mais de %d tarefas: aumente CORE_LOAD_MAX_TASKS\n", CORE_LOAD_MAX_TASKS);
+        return;
+    }
+    printf("[Carga]  ");
+    for (UBaseType_t i = 0; i < n; ++i) {
+        uint32_t d = (uint32_t)(s_estado[i].ulRunTimeCounter - tempo_anterior(s_estado[i].xTaskNumber));
+        uint32_t pm = (uint32_t)((uint64_t)d * 1000u / dt);
+        if (pm)
+            printf(" %s/%s %lu.%lu%%", s_estado[i].pcTaskName, nucleo(&s_estado[i]), (unsigned long)(pm / 10),
+                   (unsigned long)(pm % 10));
+    }
+    printf("\n");
+    for (UBaseType_t i = 0; i < n; ++i) {
+        s_tarefas_ant[i].numero = s_estado[i].xTaskNumber;
+        s_tarefas_ant[i].tempo = s_estado[i].ulRunTimeCounter;
+    }
+    s_num_tarefas_ant = n;
+}
+
+static void tarefaCarga(void *arg)
+{
+    (void)arg;
+    TickType_t ultimo = xTaskGetTickCount();
+    for (;;) {
+        vTaskDelayUntil(&ultimo, pdMS_TO_TICKS(CORE_LOAD_PERIOD_MS));
+        core_load_t c;
+        if (!core_load_sample(&c)) continue;
+        printf("[Carga] %lu ms:", (unsigned long)(c.elapsed_us / 1000));
+        for (int i = 0; i < configNUMBER_OF_CORES; ++i)
+            printf(" núcleo %d %u.%u%%", i, c.load_permille[i] / 10, c.load_permille[i] % 10);
+        printf("\n");
+        imprime_tarefas(c.elapsed_us);
+    }
+}
+
+bool core_load_start(void)
+{
+    return task_create_on(tarefaCarga, "Carga", 384, NULL, CORE_LOAD_TASK_PRIO, CORE_REDE, NULL) == pdPASS;
+}
+
+#else
+
+bool core_load_start(void)
+{
+    return true;
+}
+
+bool core_load_sample(core_load_t *out)
+{
+    (void)out;
+    return false;
+}
+
+void core_load_get_stats(core_load_stats_t *out)
+{
+    memset(out, 0, sizeof *out);
+}
+
+#endif
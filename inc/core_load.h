@@ -0,0 +1,53 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Perfil de carga por núcleo, ligado na compilação (CORE_LOAD_PROFILE=1), a partir
+// dos contadores de tempo de execução do kernel (timer de 1 MHz do RP2040).
+//
+// A carga de um núcleo no intervalo é o tempo decorrido menos o tempo de
+// execução da sua tarefa ociosa. Uma tarefa de baixa prioridade no núcleo de
+// rede imprime a cada CORE_LOAD_PERIOD_MS a carga de cada núcleo e a fatia de
+// cada tarefa, com o núcleo a que está presa (inc/task_cores.h). Sem o perfil,
+// core_load_start() não cria nada.
+
+#ifndef CORE_LOAD_PROFILE
+#define CORE_LOAD_PROFILE 0
+#endif
+
+#ifndef CORE_LOAD_PERIOD_MS
+#define CORE_LOAD_PERIOD_MS 10000
+#endif
+
+#ifndef CORE_LOAD_MAX_TASKS
+#define CORE_LOAD_MAX_TASKS 20        // tarefas acompanhadas no relatório por tarefa
+#endif
+
+typedef struct {
+    uint32_t elapsed_us;
+    uint16_t load_permille[configNUMBER_OF_CORES];
+} core_load_t;
+
+typedef struct {
+    uint32_t intervals;
+    uint16_t avg_permille[configNUMBER_OF_CORES];   // média dos intervalos
+    uint16_t max_permille[configNUMBER_OF_CORES];   // pior intervalo
+} core_load_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cria a tarefa de relatório (true sem o perfil, sem fazer nada)
+bool core_load_start(void);
+
+// Carga de cada núcleo desde a chamada anterior (ou desde o início do escalonador)
+bool core_load_sample(core_load_t *out);
+
+void core_load_get_stats(core_load_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
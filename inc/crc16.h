@@ -0,0 +1,16 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE dos registros gravados em flash (inc/journal.c, inc/dev_config.c)
+static inline uint16_t crc16(const void *data, size_t len)
+{
+    const uint8_t *p = data;
+    uint16_t crc = 0xFFFF;
+    while (len--) {
+        crc ^= (uint16_t)(*p++ << 8);
+        for (int i = 0; i < 8; ++i)
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+    }
+    return crc;
+}
@@ -0,0 +1,441 @@
+#include "inc/dev_config.h"
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "core_json.h"
+#include "inc/crc16.h"
+
+#define DEV_CONFIG_MAGIC 0x32474643u    // "CFG2"; muda se o layout de dev_config_t mudar
+#define DEV_CONFIG_PAGE_MAX 256
+
+typedef struct {
+    uint32_t magic;
+    uint32_t counter;       // cresce a cada gravação; o maior válido é o atual
+    dev_config_t cfg;
+    uint16_t len;           // sizeof(dev_config_t)
+    uint16_t crc;
+} rec_t;
+
+static dev_config_t s_padrao;
+static dev_config_t s_vivo;
+static volatile uint32_t s_versao;
+
+static const flash_dev_t *s_dev;
+static uint32_t s_contador;         // contador do último registro gravado
+static uint32_t s_proxima;          // próxima página a tentar
+static bool s_gravada;              // o bloco vivo é o que está na flash
+static uint8_t s_pagina[DEV_CONFIG_PAGE_MAX];
+static dev_config_stats_t s_stats;
+
+// --- Campos aceitos no comando ---
+
+typedef enum {
+    CAMPO_CENTI,    // número com até 2 casas, guardado em int32 x100
+    CAMPO_U32,
+    CAMPO_U16,
+    CAMPO_BOOL,
+    CAMPO_HOST,
+} tipo_campo_t;
+
+typedef struct {
+    const char *nome;
+    tipo_campo_t tipo;
+    size_t off;
+    int32_t min, max;       // faixa do valor (tamanho, para o host)
+} campo_t;
+
+static const campo_t campos[] = {
+    {"temp_threshold_c", CAMPO_CENTI, offsetof(dev_config_t, temp_threshold_c100), -4000, 8500},
+    {"dist_threshold_mm", CAMPO_U32, offsetof(dev_config_t, dist_threshold_mm), 0, 4000},
+    {"sensor_period_ms", CAMPO_U32, offsetof(dev_config_t, sensor_period_ms), 100, 3600000},
+    {"sensor_period_fast_ms", CAMPO_U32, offsetof(dev_config_t, sensor_period_fast_ms), 100, 3600000},
+    {"display_period_ms", CAMPO_U32, offsetof(dev_config_t, display_period_ms), 100, 3600000},
+    {"diag_interval_ms", CAMPO_U32, offsetof(dev_config_t, diag_interval_ms), 1000, 86400000},
+    {"report_by_exception", CAMPO_BOOL, offsetof(dev_config_t, report_by_exception), 0, 1},
+    {"low_power", CAMPO_BOOL, offsetof(dev_config_t, low_power), 0, 1},
+    {"uplink_batch", CAMPO_U16, offsetof(dev_config_t, uplink_batch), 1, DEV_CONFIG_BATCH_MAX},
+    {"broker_host", CAMPO_HOST, offsetof(dev_config_t, broker_host), 1, DEV_CONFIG_HOST_MAX},
+    {"broker_port", CAMPO_U16, offsetof(dev_config_t, broker_port), 1, 65535},
+};
+
+#define N_CAMPOS (sizeof campos / sizeof campos[0])
+
+static const campo_t *acha_campo(const char *nome, size_t len)
+{
+    for (size_t i = 0; i < N_CAMPOS; ++i)
+        if (strlen(campos[i].nome) == len && memcmp(campos[i].nome, nome, len) == 0)
+            return &campos[i];
+    return NULL;
+}
+
+static bool host_valido(const char *h, size_t len)
+{
+    if (len == 0 || len > DEV_CONFIG_HOST_MAX) return false;
+    for (size_t i = 0; i < len; ++i) {
+        char c = h[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '.' || c == '-'))
+            return false;
+    }
+    return true;
+}
+
+bool dev_config_validate(const dev_config_t *c, const char **key)
+{
+    const char *culpada = NULL;
+    for (size_t i = 0; i < N_CAMPOS && !culpada; ++i) {
+        const campo_t *f = &campos[i];
+        const uint8_t *p = (const uint8_t *)c + f->off;
+        int64_t v;
+        switch (f->tipo) {
+        case CAMPO_CENTI:
+            v = *(const int32_t *)p;
+            break;
+        case CAMPO_U32:
+            v = *(const uint32_t *)p;
+            break;
+        case CAMPO_U16:
+            v = *(const uint16_t *)p;
+            break;
+        case CAMPO_BOOL:
+            v = *(const bool *)p;
+            break;
+        default:
+            v = (int64_t)strnlen((const char *)p, DEV_CONFIG_HOST_MAX + 1);
+            if (!host_valido((const char *)p, (size_t)v)) culpada = f->nome;
+            break;
+        }
+        if (v < f->min || v > f->max) culpada = f->nome;
+    }
+    if (!culpada && c->sensor_period_fast_ms > c->sensor_period_ms)
+        culpada = "sensor_period_fast_ms";
+    if (key) *key = culpada;
+    return culpada == NULL;
+}
+
+// --- Números do JSON, sem float ---
+
+// Inteiro sem sinal, só dígitos
+static bool le_uint(const char *s, size_t len, uint32_t *out)
+{
+    uint64_t v = 0;
+    if (len == 0 || len > 10) return false;
+    for (size_t i = 0; i < len; ++i) {
+        if (s[i] < '0' || s[i] > '9') return false;
+        v = v * 10 + (uint32_t)(s[i] - '0');
+    }
+    if (v > UINT32_MAX) return false;
+    *out = (uint32_t)v;
+    return true;
+}
+
+// Decimal com sinal em centésimos; a terceira casa arredonda, expoente não é aceito
+static bool le_centi(const char *s, size_t len, int32_t *out)
+{
+    size_t i = 0;
+    bool neg = len && s[0] == '-';
+    if (neg) i++;
+    int64_t v = 0;
+    int casas = -1;
+    bool digito = false;
+    for (; i < len; ++i) {
+        char c = s[i];
+        if (c == '.' && casas < 0) {
+            casas = 0;
+            continue;
+        }
+        if (c < '0' || c > '9' || v > 100000000) return false;
+        digito = true;
+        if (casas < 2) {
+            v = v * 10 + (c - '0');
+            if (casas >= 0) casas++;
+        } else if (casas == 2) {
+            if (c >= '5') v++;
+            casas++;
+        }
+    }
+    if (!digito) return false;
+    for (int k = casas < 0 ? 0 : (casas > 2 ? 2 : casas); k < 2; ++k)
+        v *= 10;
+    *out = (int32_t)(neg ? -v : v);
+    return true;
+}
+
+// Grava um par "chave": valor do comando no bloco candidato; NULL ou o código do erro
+static const char *atribui(dev_config_t *c, const campo_t *f, const JSONPair_t *par)
+{
+    uint8_t *p = (uint8_t *)c + f->off;
+    uint32_t u;
+    int32_t centi;
+    switch (f->tipo) {
+    case CAMPO_CENTI:
+        if (par->jsonType != JSONNumber || !le_centi(par->value, par->valueLength, &centi)) return "type";
+        if (centi < f->min || centi > f->max) return "range";
+        *(int32_t *)p = centi;
+        return NULL;
+    case CAMPO_U32:
+    case CAMPO_U16:
+        if (par->jsonType != JSONNumber || !le_uint(par->value, par->valueLength, &u)) return "type";
+        if ((int64_t)u < f->min || (int64_t)u > f->max) return "range";
+        if (f->tipo == CAMPO_U16)
+            *(uint16_t *)p = (uint16_t)u;
+        else
+            *(uint32_t *)p = u;
+        return NULL;
+    case CAMPO_BOOL:
+        if (par->jsonType != JSONTrue && par->jsonType != JSONFalse) return "type";
+        *(bool *)p = par->jsonType == JSONTrue;
+        return NULL;
+    case CAMPO_HOST:
+        if (par->jsonType != JSONString) return "type";
+        if (!host_valido(par->value, par->valueLength)) return "range";
+        memcpy(p, par->value, par->valueLength);
+        p[par->valueLength] = '\0';
+        return NULL;
+    }
+    return "type";
+}
+
+// --- Persistência ---
+
+static uint32_t paginas(void)
+{
+    return s_dev->size / s_dev->page_size;
+}
+
+static bool registro_valido(const rec_t *r)
+{
+    return r->magic == DEV_CONFIG_MAGIC && r->len == sizeof(dev_config_t) &&
+           r->crc == crc16(r, offsetof(rec_t, crc)) && dev_config_validate(&r->cfg, NULL);
+}
+
+static bool pagina_livre(uint32_t off)
+{
+    if (!s_dev->read(s_dev, off, s_pagina, s_dev->page_size)) return false;
+    for (uint32_t i = 0; i < s_dev->page_size; ++i)
+        if (s_pagina[i] != 0xFF) return false;
+    return true;
+}
+
+// Procura o registro válido de maior contador; a escrita continua na página seguinte
+static bool carregar(dev_config_t *out)
+{
+    bool achou = false;
+    for (uint32_t p = 0; p < paginas(); ++p) {
+        rec_t r;
+        if (!s_dev->read(s_dev, p * s_dev->page_size, &r, sizeof r) || !registro_valido(&r)) continue;
+        if (!achou || r.counter > s_contador) {
+            *out = r.cfg;
+            s_contador = r.counter;
+            s_proxima = (p + 1) % paginas();
+            achou = true;
+        }
+    }
+    return achou;
+}
+
+// Página nova por gravação; ao entrar num setor ele é apagado (o registro atual está no outro)
+static bool salvar(const dev_config_t *c)
+{
+    uint32_t por_setor = s_dev->sector_size / s_dev->page_size;
+    for (uint32_t tentativa = 0; tentativa < paginas(); ++tentativa) {
+        uint32_t p = s_proxima;
+        uint32_t off = p * s_dev->page_size;
+        s_proxima = (p + 1) % paginas();
+        if (p % por_setor == 0) {
+            if (!s_dev->erase(s_dev, off)) return false;
+        } else if (!pagina_livre(off)) {
+            continue;       // gravação cortada: pula a página
+        }
+        rec_t r;
+        memset(&r, 0, sizeof r);
+        r.magic = DEV_CONFIG_MAGIC;
+        r.counter = s_contador + 1;
+        memcpy(&r.cfg, c, sizeof r.cfg);
+        r.len = sizeof(dev_config_t);
+        r.crc = crc16(&r, offsetof(rec_t, crc));
+        memset(s_pagina, 0xFF, s_dev->page_size);
+        memcpy(s_pagina, &r, sizeof r);
+        if (!s_dev->program(s_dev, off, s_pagina, s_dev->page_size)) return false;
+        rec_t lido;
+        if (!s_dev->read(s_dev, off, &lido, sizeof lido) || memcmp(&lido, &r, sizeof r) != 0) return false;
+        s_contador = r.counter;
+        return true;
+    }
+    return false;
+}
+
+// --- Bloco vivo ---
+
+static void aplica(const dev_config_t *c)
+{
+    taskENTER_CRITICAL();
+    s_vivo = *c;
+    s_versao++;
+    taskEXIT_CRITICAL();
+}
+
+void dev_config_init(const dev_config_t *defaults, const flash_dev_t *dev)
+{
+    s_padrao = *defaults;
+    s_dev = NULL;
+    s_contador = s_proxima = 0;
+    s_gravada = false;
+    memset(&s_stats, 0, sizeof s_stats);
+    // Precisa de dois setores (um sempre com o registro atual) e de uma página que caiba o registro
+    if (dev && dev->size >= 2 * dev->sector_size && dev->page_size >= sizeof(rec_t) &&
+        dev->page_size <= DEV_CONFIG_PAGE_MAX)
+        s_dev = dev;
+
+    dev_config_t c = s_padrao;
+    if (s_dev && carregar(&c)) {
+        s_gravada = true;
+        s_stats.loaded_counter = s_contador;
+    }
+    aplica(&c);
+}
+
+void dev_config_get(dev_config_t *out)
+{
+    taskENTER_CRITICAL();
+    *out = s_vivo;
+    taskEXIT_CRITICAL();
+}
+
+uint32_t dev_config_version(void)
+{
+    return s_versao;
+}
+
+void dev_config_get_stats(dev_config_stats_t *out)
+{
+    *out = s_stats;
+}
+
+// --- Comandos ---
+
+// Campo a campo: o preenchimento da struct não entra na comparação
+static bool iguais(const dev_config_t *a, const dev_config_t *b)
+{
+    return a->temp_threshold_c100 == b->temp_threshold_c100 && a->dist_threshold_mm == b->dist_threshold_mm &&
+           a->sensor_period_ms == b->sensor_period_ms && a->sensor_period_fast_ms == b->sensor_period_fast_ms &&
+           a->display_period_ms == b->display_period_ms && a->diag_interval_ms == b->diag_interval_ms &&
+           a->report_by_exception == b->report_by_exception && a->low_power == b->low_power &&
+           a->uplink_batch == b->uplink_batch && a->broker_port == b->broker_port &&
+           strcmp(a->broker_host, b->broker_host) == 0;
+}
+
+static size_t escreve_centi(char *buf, size_t cap, int32_t v)
+{
+    uint32_t a = (uint32_t)(v < 0 ? -v : v);
+    return (size_t)snprintf(buf, cap, "%s%lu.%02lu", v < 0 ? "-" : "", (unsigned long)(a / 100),
+                            (unsigned long)(a % 100));
+}
+
+// Início da resposta: {"id": N, (sem id, se o comando não trouxe)
+static int abre_resposta(char *resp, size_t cap, bool tem_id, uint32_t id)
+{
+    return tem_id ? snprintf(resp, cap, "{\"id\": %lu, ", (unsigned long)id) : snprintf(resp, cap, "{");
+}
+
+// Chave do comando ecoada no erro só se for um identificador simples (não precisa de escape)
+static bool chave_simples(const char *k, size_t len)
+{
+    if (len == 0 || len > 32) return false;
+    for (size_t i = 0; i < len; ++i)
+        if (!((k[i] >= 'a' && k[i] <= 'z') || (k[i] >= '0' && k[i] <= '9') || k[i] == '_')) return false;
+    return true;
+}
+
+static size_t responde_erro(char *resp, size_t cap, bool tem_id, uint32_t id, const char *erro, const char *key,
+                            size_t key_len)
+{
+    s_stats.rejected++;
+    int n = abre_resposta(resp, cap, tem_id, id);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    if (key && chave_simples(key, key_len))
+        n += snprintf(resp + n, cap - n, "\"ok\": false, \"error\": \"%s\", \"key\": \"%.*s\"}", erro, (int)key_len, key);
+    else
+        n += snprintf(resp + n, cap - n, "\"ok\": false, \"error\": \"%s\"}", erro);
+    return (size_t)n < cap ? (size_t)n : 0;
+}
+
+static size_t responde_config(char *resp, size_t cap, bool tem_id, uint32_t id, const dev_config_t *c)
+{
+    char temp[16];
+    escreve_centi(temp, sizeof temp, c->temp_threshold_c100);
+    int n = abre_resposta(resp, cap, tem_id, id);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    n += snprintf(resp + n, cap - n,
+                  "\"ok\": true, \"version\": %lu, \"saved\": %s, \"config\": {\"temp_threshold_c\": %s, "
+                  "\"dist_threshold_mm\": %lu, \"sensor_period_ms\": %lu, \"sensor_period_fast_ms\": %lu, "
+                  "\"display_period_ms\": %lu, \"diag_interval_ms\": %lu, \"report_by_exception\": %s, "
+                  "\"low_power\": %s, \"uplink_batch\": %u, \"broker_host\": \"%s\", \"broker_port\": %u}}",
+                  (unsigned long)s_versao, s_gravada ? "true" : "false", temp, (unsigned long)c->dist_threshold_mm,
+                  (unsigned long)c->sensor_period_ms, (unsigned long)c->sensor_period_fast_ms,
+                  (unsigned long)c->display_period_ms, (unsigned long)c->diag_interval_ms,
+                  c->report_by_exception ? "true" : "false", c->low_power ? "true" : "false",
+                  (unsigned)c->uplink_batch, c->broker_host, (unsigned)c->broker_port);
+    return (size_t)n < cap ? (size_t)n : 0;
+}
+
+size_t dev_config_command(const char *cmd, size_t len, char *resp, size_t cap)
+{
+    s_stats.commands++;
+    if (JSON_Validate(cmd, len) != JSONSuccess)
+        return responde_erro(resp, cap, false, 0, "json", NULL, 0);
+
+    const char *v;
+    size_t vlen;
+    JSONTypes_t tipo;
+    uint32_t id = 0;
+    bool tem_id = JSON_SearchConst(cmd, len, "id", 2, &v, &vlen, &tipo) == JSONSuccess && tipo == JSONNumber &&
+                  le_uint(v, vlen, &id);
+
+    dev_config_t novo;
+    dev_config_get(&novo);
+    bool muda = false;
+
+    if (JSON_SearchConst(cmd, len, "reset", 5, &v, &vlen, &tipo) == JSONSuccess && tipo == JSONTrue) {
+        novo = s_padrao;
+        muda = true;
+    }
+
+    if (JSON_SearchConst(cmd, len, "set", 3, &v, &vlen, &tipo) == JSONSuccess) {
+        if (tipo != JSONObject)
+            return responde_erro(resp, cap, tem_id, id, "type", "set", 3);
+        size_t inicio = 0, proximo = 0;
+        JSONPair_t par;
+        while (JSON_Iterate(v, vlen, &inicio, &proximo, &par) == JSONSuccess) {
+            const campo_t *f = acha_campo(par.key, par.keyLength);
+            if (!f)
+                return responde_erro(resp, cap, tem_id, id, "unknown_key", par.key, par.keyLength);
+            const char *erro = atribui(&novo, f, &par);
+            if (erro)
+                return responde_erro(resp, cap, tem_id, id, erro, f->nome, strlen(f->nome));
+        }
+        muda = true;
+    }
+
+    if (muda) {
+        const char *culpada;
+        if (!dev_config_validate(&novo, &culpada))
+            return responde_erro(resp, cap, tem_id, id, "range", culpada, strlen(culpada));
+        dev_config_t atual;
+        dev_config_get(&atual);
+        if (!iguais(&novo, &atual)) {
+            aplica(&novo);
+            s_stats.applied++;
+            s_gravada = false;
+            if (s_dev) {
+                if (salvar(&novo)) {
+                    s_gravada = true;
+                    s_stats.saves++;
+                } else {
+                    s_stats.save_errors++;
+                }
+            }
+        }
+    }
+    return responde_config(resp, cap, tem_id, id, &novo);
+}
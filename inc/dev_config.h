@@ -0,0 +1,94 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/flash_dev.h"
+
+// Configuração do dispositivo ajustável em campo, por MQTT, sem regravar o firmware.
+//
+// Os valores do .env (macros do CMake) são só o padrão de fábrica. Um comando
+// JSON em DEV_CONFIG_TOPIC_SET muda um ou mais campos de uma vez:
+//   {"id": 7, "set": {"temp_threshold_c": 28.5, "sensor_period_ms": 5000}}
+//   {"id": 8, "get": true}      {"id": 9, "reset": true}
+// O comando é validado inteiro antes de aplicar (chave desconhecida, tipo ou
+// faixa errados rejeitam tudo). O bloco vivo é trocado de uma vez, numa seção
+// crítica curta, e quem lê copia o bloco inteiro com dev_config_get(). A
+// resposta sai em DEV_CONFIG_TOPIC_RESP com a configuração resultante:
+//   {"id": 7, "ok": true, "version": 3, "saved": true, "config": {...}}
+//   {"id": 7, "ok": false, "error": "range", "key": "sensor_period_ms"}
+//
+// Persistência: cada configuração aplicada vai para uma página nova de uma
+// região de flash própria (dois ou mais setores), com contador e CRC. Na
+// abertura vale o registro válido de maior contador. O setor só é apagado
+// quando a escrita entra nele, então o registro mais recente está sempre no
+// outro setor e uma queda de energia no meio da gravação volta à configuração
+// anterior.
+
+#define DEV_CONFIG_TOPIC_SET "pico_w/config/set"
+#define DEV_CONFIG_TOPIC_RESP "pico_w/config/resp"
+
+#define DEV_CONFIG_HOST_MAX 63
+// Maior comando aceito (o excedente é descartado na recepção)
+#define DEV_CONFIG_CMD_MAX 384
+// Maior resposta: cabeçalho e configuração completa com o host no tamanho máximo
+#define DEV_CONFIG_RESP_MAX 512
+
+// Maior rajada do baixo consumo: metade do anel de amostras (SAMPLE_RING_SIZE),
+// para o laço de aquisição não encontrar o anel cheio
+#define DEV_CONFIG_BATCH_MAX 8
+
+#ifndef DEV_CONFIG_FLASH_SIZE
+#define DEV_CONFIG_FLASH_SIZE (2 * 4096)
+#endif
+
+typedef struct {
+    int32_t temp_threshold_c100;
+    uint32_t dist_threshold_mm;
+    uint32_t sensor_period_ms;       // período mais longo do laço (valores parados)
+    uint32_t sensor_period_fast_ms;  // mais curto, com o relato por exceção
+    uint32_t display_period_ms;
+    uint32_t diag_interval_ms;
+    bool report_by_exception;
+    bool low_power;                  // uplink em rajadas e rádio em economia (inc/power_save.h)
+    uint16_t uplink_batch;           // amostras por rajada no baixo consumo
+    uint16_t broker_port;
+    char broker_host[DEV_CONFIG_HOST_MAX + 1];
+} dev_config_t;
+
+typedef struct {
+    uint32_t commands;
+    uint32_t applied;
+    uint32_t rejected;
+    uint32_t saves;
+    uint32_t save_errors;
+    uint32_t loaded_counter;   // contador do registro lido na abertura (0 = padrão de fábrica)
+} dev_config_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Padrão de fábrica e região de persistência (NULL: só em RAM). Lê o último
+// registro válido da flash; sem nenhum, vale o padrão. Chamada antes de
+// qualquer leitura, por uma tarefa só.
+void dev_config_init(const dev_config_t *defaults, const flash_dev_t *dev);
+
+// Cópia consistente do bloco vivo (qualquer tarefa)
+void dev_config_get(dev_config_t *out);
+
+// Muda a cada configuração aplicada: quem guarda uma cópia compara e relê
+uint32_t dev_config_version(void);
+
+// Trata um comando JSON e escreve a resposta em resp (DEV_CONFIG_RESP_MAX basta).
+// Aplica e grava em flash: chamar da tarefa que pode bloquear na flash, nunca do
+// callback do lwIP. Retorna o tamanho da resposta, ou 0 se não coube.
+size_t dev_config_command(const char *cmd, size_t len, char *resp, size_t cap);
+
+// Confere faixas e coerência entre campos; em erro aponta a chave culpada
+bool dev_config_validate(const dev_config_t *c, const char **key);
+
+void dev_config_get_stats(dev_config_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,118 @@
+#include "inc/diag.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/stats.h"
+#include "inc/cbor.h"
+
+_Static_assert(configGENERATE_RUN_TIME_STATS, "inc/diag.c usa os contadores de tempo de execução do kernel");
+
+static TaskStatus_t s_estado[DIAG_MAX_TASKS];
+static struct {
+    UBaseType_t numero;
+    configRUN_TIME_COUNTER_TYPE tempo;
+} s_ant[DIAG_MAX_TASKS];
+static size_t s_num_ant;
+static configRUN_TIME_COUNTER_TYPE s_total_ant;
+static diag_stats_t s_stats;
+
+static configRUN_TIME_COUNTER_TYPE tempo_anterior(UBaseType_t numero)
+{
+    for (size_t i = 0; i < s_num_ant; ++i)
+        if (s_ant[i].numero == numero) return s_ant[i].tempo;
+    return 0;
+}
+
+static int32_t nucleo(const TaskStatus_t *t)
+{
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    for (int c = 0; c < configNUMBER_OF_CORES; ++c)
+        if (t->uxCoreAffinityMask == (UBaseType_t)1 << c) return c;
+#else
+    (void)t;
+#endif
+    return -1;
+}
+
+#if LWIP_STATS
+static const struct stats_mem *pool(int i)
+{
+    static const memp_t ids[DIAG_POOLS] = {MEMP_PBUF_POOL, MEMP_PBUF, MEMP_TCP_PCB, MEMP_TCP_SEG, MEMP_SYS_TIMEOUT};
+    return lwip_stats.memp[ids[i]];
+}
+#endif
+
+size_t diag_encode(uint8_t *buf, size_t cap)
+{
+    if (cap < DIAG_CBOR_MAX_BYTES) return 0;
+
+    configRUN_TIME_COUNTER_TYPE total;
+    UBaseType_t n = uxTaskGetSystemState(s_estado, DIAG_MAX_TASKS, &total);
+    if (n == 0) s_stats.truncated++;   // vetor pequeno demais: o registro sai sem tarefas
+    uint32_t dt = (uint32_t)(total - s_total_ant);
+
+    size_t len = 0;
+    uint8_t *p = buf;
+    len += cbor_array(&p[len], 11);
+    len += cbor_uint(&p[len], DIAG_CBOR_VERSION);
+    len += cbor_uint(&p[len], (uint32_t)(xTaskGetTickCount() / configTICK_RATE_HZ));
+    len += cbor_uint(&p[len], dt / 1000);
+    len += cbor_uint(&p[len], (uint32_t)xPortGetFreeHeapSize());
+    len += cbor_uint(&p[len], (uint32_t)xPortGetMinimumEverFreeHeapSize());
+
+    len += cbor_array(&p[len], n);
+    for (UBaseType_t i = 0; i < n; ++i) {
+        const TaskStatus_t *t = &s_estado[i];
+        uint32_t d = (uint32_t)(t->ulRunTimeCounter - tempo_anterior(t->xTaskNumber));
+        uint32_t pm = dt ? (uint32_t)((uint64_t)d * 1000u / dt) : 0;
+        size_t nome = strnlen(t->pcTaskName, DIAG_NAME_LEN);
+        len += cbor_array(&p[len], 5);
+        len += cbor_text(&p[len], t->pcTaskName, nome);
+        len += cbor_uint(&p[len], (uint32_t)t->uxCurrentPriority);
+        len += cbor_int(&p[len], nucleo(t));
+        len += cbor_uint(&p[len], (uint32_t)t->usStackHighWaterMark);
+        len += cbor_uint(&p[len], pm > 1000 ? 1000 : pm);
+    }
+    for (UBaseType_t i = 0; i < n; ++i) {
+        s_ant[i].numero = s_estado[i].xTaskNumber;
+        s_ant[i].tempo = s_estado[i].ulRunTimeCounter;
+    }
+    s_num_ant = n;
+    s_total_ant = total;
+
+    // Contadores do lwIP: leitura sem trava, cada campo é atualizado inteiro pelo tcpip_thread
+    len += cbor_array(&p[len], 3);
+#if LWIP_STATS
+    len += cbor_uint(&p[len], (uint32_t)lwip_stats.mem.used);
+    len += cbor_uint(&p[len], (uint32_t)lwip_stats.mem.max);
+    len += cbor_uint(&p[len], (uint32_t)lwip_stats.mem.err);
+#else
+    len += cbor_uint(&p[len], 0);
+    len += cbor_uint(&p[len], 0);
+    len += cbor_uint(&p[len], 0);
+#endif
+    len += cbor_array(&p[len], DIAG_POOLS);
+    for (int i = 0; i < DIAG_POOLS; ++i) {
+        len += cbor_array(&p[len], 3);
+#if LWIP_STATS
+        const struct stats_mem *m = pool(i);
+        len += cbor_uint(&p[len], m ? (uint32_t)m->used : 0);
+        len += cbor_uint(&p[len], m ? (uint32_t)m->max : 0);
+        len += cbor_uint(&p[len], m ? (uint32_t)m->err : 0);
+#else
+        len += cbor_uint(&p[len], 0);
+        len += cbor_uint(&p[len], 0);
+        len += cbor_uint(&p[len], 0);
+#endif
+    }
+    len += sensor_timing_encode(&p[len]);
+    len += net_conn_encode(&p[len]);
+    len += power_save_encode(&p[len]);
+    s_stats.records++;
+    return len;
+}
+
+void diag_get_stats(diag_stats_t *out)
+{
+    *out = s_stats;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/sensor_timing.h"
+#include "inc/net_conn.h"
+#include "inc/power_save.h"
+
+// Diagnóstico de execução publicado em MQTT (DIAG_TOPIC) a cada DIAG_INTERVAL_MS:
+// tarefas (prioridade, núcleo, folga de pilha, fatia de CPU no intervalo), heap
+// do FreeRTOS, memória do lwIP, prazos do laço de aquisição, conexão e energia.
+// Os tempos de execução vêm dos contadores do kernel
+// (configGENERATE_RUN_TIME_STATS, timer de 1 MHz).
+//
+// Registro CBOR, versão 4 (array de 11 itens):
+//   [4, uptime_s, interval_ms, heap_free, heap_min_ever,
+//    [[name, prio, core, stack_free_words, cpu_permille], ...],
+//    [mem_used, mem_max, mem_err],
+//    [[used, max, err], ...],
+//    [period_ms, cycles, overruns, active_max_us, period_err, latency],
+//    [state, sessions, reconnects, drops, wifi_failures, dns_failures,
+//     connect_failures, refused, subscribe_failures, last_connect_ms,
+//     max_connect_ms, total_connect_ms],
+//    [low_power, radio_awake_ms, radio_ps_ms, bursts, tx_msgs, tx_bytes,
+//     airtime_us, core_busy_ms, core_idle_ms, charge_mas]]
+// core é o núcleo a que a tarefa está presa (-1 = qualquer); cpu_permille é a
+// fatia do tempo de um núcleo desde o registro anterior; o nome vem truncado em
+// DIAG_NAME_LEN bytes. Os pools do lwIP seguem a ordem de DIAG_POOLS
+// (pbuf_pool, pbuf, tcp_pcb, tcp_seg, sys_timeout). O item dos prazos vem de
+// inc/sensor_timing.c, com os histogramas acumulados desde o boot no formato
+// [base_us, count, max_us, [bins...]] (faixa i: valores < base_us << i).
+// O item da conexão vem de inc/net_conn.c (tempos em ms, contadores desde o
+// boot). O de energia vem de inc/power_save.c (contabilidade desde o boot; tempo
+// no ar e carga são estimativas). A versão 3 não tinha o item de energia, a 2
+// nem o da conexão e a 1, nem o dos prazos.
+
+#ifndef DIAG_INTERVAL_MS
+#define DIAG_INTERVAL_MS 60000
+#endif
+
+#ifndef DIAG_MAX_TASKS
+#define DIAG_MAX_TASKS 20
+#endif
+
+#ifndef DIAG_NAME_LEN
+#define DIAG_NAME_LEN 8
+#endif
+
+#define DIAG_TOPIC "pico_w/diag"
+#define DIAG_CBOR_VERSION 4
+#define DIAG_POOLS 5
+
+// Pior caso de uma tarefa e do registro inteiro, em bytes
+#define DIAG_CBOR_TASK_MAX (2 + DIAG_NAME_LEN + 2 + 1 + 5 + 3)
+#define DIAG_CBOR_MAX_BYTES \
+    (2 + 4 * 5 + 3 + DIAG_MAX_TASKS * DIAG_CBOR_TASK_MAX + 16 + 1 + DIAG_POOLS * 16 + SENSOR_TIMING_CBOR_MAX_BYTES + \
+     NET_CONN_CBOR_MAX_BYTES + POWER_SAVE_CBOR_MAX_BYTES)
+
+typedef struct {
+    uint32_t records;
+    uint32_t truncated;       // registros com mais tarefas que DIAG_MAX_TASKS
+} diag_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Coleta o estado atual e codifica o registro; retorna o tamanho (0 se não coube)
+size_t diag_encode(uint8_t *buf, size_t cap);
+
+void diag_get_stats(diag_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Região de flash NOR vista por quem grava dados persistentes (inc/journal.c).
+// Semântica de NOR: apagar um setor deixa todos os bytes em 0xFF; programar só
+// leva bits de 1 para 0 (regravar um byte já programado faz AND com o valor novo).
+// Offsets são relativos ao início da região.
+//
+// Implementações: flash_dev_pico() (QSPI do RP2040, inc/flash_dev_pico.c) e o
+// modelo em RAM da simulação (sim/sim_flash.c), usado também nos testes do host.
+
+typedef struct flash_dev {
+    uint32_t size;          // bytes da região (múltiplo de sector_size)
+    uint32_t sector_size;   // unidade de apagamento
+    uint32_t page_size;     // unidade de programação (offset e tamanho alinhados)
+    bool (*read)(const struct flash_dev *dev, uint32_t off, void *dst, size_t len);
+    bool (*erase)(const struct flash_dev *dev, uint32_t off);     // um setor
+    bool (*program)(const struct flash_dev *dev, uint32_t off, const void *src, size_t len);
+    void *ctx;
+} flash_dev_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Região [offset, offset + size) da flash do RP2040 (offset a partir do início da flash).
+// Falha se a região não estiver alinhada a setores, passar do fim da flash ou
+// se sobrepor à imagem do firmware, ou se já houver FLASH_DEV_PICO_MAX regiões abertas.
+bool flash_dev_pico(flash_dev_t *dev, uint32_t offset, uint32_t size);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+#include "inc/flash_dev.h"
+#include <string.h>
+#include "pico/flash.h"
+#include "hardware/flash.h"
+
+// Confere se a região pedida não cai sobre a imagem gravada (a simulação não tem imagem)
+#ifndef FLASH_DEV_CHECK_BINARY
+#define FLASH_DEV_CHECK_BINARY 1
+#endif
+
+// Tempo máximo esperando o outro núcleo parar antes de mexer na flash
+#define FLASH_DEV_LOCKOUT_MS 100
+
+#if FLASH_DEV_CHECK_BINARY
+extern char __flash_binary_end;
+#endif
+
+// Regiões abertas ao mesmo tempo (diário e configuração)
+#ifndef FLASH_DEV_PICO_MAX
+#define FLASH_DEV_PICO_MAX 2
+#endif
+
+typedef struct {
+    uint32_t base;          // offset da região na flash
+    uint32_t size;          // 0 = livre
+} flash_pico_t;
+
+static flash_pico_t s_pico[FLASH_DEV_PICO_MAX];
+
+typedef struct {
+    uint32_t off;
+    const void *src;
+    size_t len;
+} op_t;
+
+// Executadas com o XIP desligado: nada de código em flash nem interrupções no outro núcleo
+static void do_erase(void *param)
+{
+    const op_t *op = param;
+    flash_range_erase(op->off, FLASH_SECTOR_SIZE);
+}
+
+static void do_program(void *param)
+{
+    const op_t *op = param;
+    flash_range_program(op->off, op->src, op->len);
+}
+
+static bool pico_read(const flash_dev_t *dev, uint32_t off, void *dst, size_t len)
+{
+    const flash_pico_t *f = dev->ctx;
+    if (off + len > dev->size) return false;
+    memcpy(dst, (const void *)(XIP_BASE + f->base + off), len);
+    return true;
+}
+
+static bool pico_erase(const flash_dev_t *dev, uint32_t off)
+{
+    const flash_pico_t *f = dev->ctx;
+    if (off % FLASH_SECTOR_SIZE || off >= dev->size) return false;
+    op_t op = {f->base + off, NULL, 0};
+    return flash_safe_execute(do_erase, &op, FLASH_DEV_LOCKOUT_MS) == PICO_OK;
+}
+
+static bool pico_program(const flash_dev_t *dev, uint32_t off, const void *src, size_t len)
+{
+    const flash_pico_t *f = dev->ctx;
+    if (off % FLASH_PAGE_SIZE || len % FLASH_PAGE_SIZE || off + len > dev->size) return false;
+    op_t op = {f->base + off, src, len};
+    return flash_safe_execute(do_program, &op, FLASH_DEV_LOCKOUT_MS) == PICO_OK;
+}
+
+bool flash_dev_pico(flash_dev_t *dev, uint32_t offset, uint32_t size)
+{
+    if (offset % FLASH_SECTOR_SIZE || size % FLASH_SECTOR_SIZE || size == 0 ||
+        offset + size > PICO_FLASH_SIZE_BYTES)
+        return false;
+#if FLASH_DEV_CHECK_BINARY
+    if (offset < (uint32_t)((uintptr_t)&__flash_binary_end - XIP_BASE))
+        return false;
+#endif
+    // Reabrir a mesma região reaproveita a entrada
+    flash_pico_t *f = NULL;
+    for (unsigned i = 0; i < FLASH_DEV_PICO_MAX && !f; ++i)
+        if (s_pico[i].size == 0 || s_pico[i].base == offset) f = &s_pico[i];
+    if (!f)
+        return false;
+    f->base = offset;
+    f->size = size;
+    dev->size = size;
+    dev->sector_size = FLASH_SECTOR_SIZE;
+    dev->page_size = FLASH_PAGE_SIZE;
+    dev->read = pico_read;
+    dev->erase = pico_erase;
+    dev->program = pico_program;
+    dev->ctx = f;
+    return true;
+}
@@ -0,0 +1,235 @@
+#include "inc/i2c_bus.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+#include "inc/task_cores.h"
+
+typedef struct {
+    i2c_bus_id_t id;
+    i2c_bus_job_t job;         // NULL = transferência simples
+    void *ctx;
+    uint8_t addr;
+    const uint8_t *tx;
+    size_t tx_len;
+    uint8_t *rx;
+    size_t rx_len;
+    int resultado;
+    TaskHandle_t cliente;      // NULL = postada sem espera (vaga de s_async)
+    volatile bool ocupado;
+} i2c_bus_req_t;
+
+typedef struct {
+    i2c_inst_t *i2c;
+    QueueHandle_t fila;        // ponteiros para i2c_bus_req_t na pilha do cliente
+    i2c_bus_id_t atual;        // conjunto de pinos selecionado (-1 = nenhum)
+    i2c_bus_stats_t stats;
+} i2c_bus_ctrl_t;
+
+static i2c_bus_pins_t s_pins[I2C_BUS_MAX_PINS];
+static size_t s_num_pins;
+static i2c_bus_ctrl_t s_ctrl[2];
+static i2c_bus_req_t s_async[I2C_BUS_ASYNC_SLOTS];
+
+static void pins_disable(const i2c_bus_pins_t *p)
+{
+    gpio_set_function(p->sda, GPIO_FUNC_NULL);
+    gpio_set_function(p->scl, GPIO_FUNC_NULL);
+    gpio_disable_pulls(p->sda);
+    gpio_disable_pulls(p->scl);
+}
+
+// Desliga os pinos do conjunto anterior antes de ligar os novos: dois pares no
+// mesmo controlador ao mesmo tempo colocariam os dois barramentos em curto lógico
+static void select_pins(i2c_bus_ctrl_t *c, i2c_bus_id_t id)
+{
+    if (c->atual == id) return;
+    const i2c_bus_pins_t *novo = &s_pins[id];
+    if (c->atual >= 0) {
+        const i2c_bus_pins_t *velho = &s_pins[c->atual];
+        pins_disable(velho);
+        c->stats.remuxes++;
+    }
+    gpio_set_function(novo->sda, GPIO_FUNC_I2C);
+    gpio_set_function(novo->scl, GPIO_FUNC_I2C);
+    gpio_pull_up(novo->sda);
+    gpio_pull_up(novo->scl);
+    if (c->atual < 0 || s_pins[c->atual].baudrate != novo->baudrate)
+        i2c_set_baudrate(c->i2c, novo->baudrate);
+    c->atual = id;
+    sleep_us(I2C_BUS_SETTLE_US);
+}
+
+static int execute(i2c_bus_ctrl_t *c, const i2c_bus_req_t *r)
+{
+    if (r->job)
+        return r->job(c->i2c, r->ctx) ? 0 : PICO_ERROR_GENERIC;
+
+    int ret = 0;
+    if (r->tx_len) {
+        ret = i2c_write_blocking(c->i2c, r->addr, r->tx, r->tx_len, r->rx_len > 0);
+        if (ret < 0) return ret;
+    }
+    if (r->rx_len)
+        ret = i2c_read_blocking(c->i2c, r->addr, r->rx, r->rx_len, false);
+    return ret;
+}
+
+static bool tem_bloqueante(i2c_bus_req_t *const *lote, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        if (lote[i]->cliente) return true;
+    return false;
+}
+
+// Atende um conjunto de pinos do lote: primeiro quem está bloqueado esperando,
+// depois as postadas, cada grupo na ordem de chegada
+static size_t atende_conjunto(i2c_bus_ctrl_t *c, i2c_bus_req_t **lote, size_t n, i2c_bus_id_t alvo)
+{
+    size_t feitas = 0;
+    select_pins(c, alvo);
+    for (int postadas = 0; postadas < 2; ++postadas)
+        for (size_t i = 0; i < n; ++i)
+        {
+            i2c_bus_req_t *r = lote[i];
+            if (!r || r->id != alvo || (r->cliente == NULL) != postadas) continue;
+            lote[i] = NULL;
+            feitas++;
+            r->resultado = execute(c, r);
+            c->stats.transactions++;
+            // Após a notificação a requisição (na pilha do cliente) deixa de ser válida
+            if (r->cliente)
+                xTaskNotifyGiveIndexed(r->cliente, I2C_BUS_NOTIFY_INDEX);
+            else
+                r->ocupado = false;
+        }
+    return feitas;
+}
+
+static void tarefaI2C(void *pvParameters)
+{
+    i2c_bus_ctrl_t *c = pvParameters;
+    i2c_bus_req_t *lote[I2C_BUS_BATCH_MAX];
+
+    while (1)
+    {
+        size_t n = 0;
+        xQueueReceive(c->fila, &lote[n++], portMAX_DELAY);
+        while (n < I2C_BUS_BATCH_MAX && xQueueReceive(c->fila, &lote[n], 0) == pdTRUE)
+            n++;
+
+        // Só postadas: ninguém está esperando, então a rodada aguarda a próxima
+        // transação bloqueante do controlador (até I2C_BUS_POST_WAIT_MS) para
+        // ir junto com ela em vez de ocupar o barramento sozinha
+        TickType_t inicio = xTaskGetTickCount();
+        TickType_t espera = pdMS_TO_TICKS(I2C_BUS_POST_WAIT_MS);
+        while (n < I2C_BUS_BATCH_MAX && !tem_bloqueante(lote, n))
+        {
+            TickType_t passou = xTaskGetTickCount() - inicio;
+            if (passou >= espera || xQueueReceive(c->fila, &lote[n], espera - passou) != pdTRUE) break;
+            n++;
+            while (n < I2C_BUS_BATCH_MAX && xQueueReceive(c->fila, &lote[n], 0) == pdTRUE)
+                n++;
+        }
+
+        c->stats.batches++;
+        if (n > c->stats.max_batch) c->stats.max_batch = (uint32_t)n;
+
+        // Atende primeiro o conjunto já selecionado; depois cada conjunto na
+        // ordem de chegada
+        size_t restantes = n;
+        while (restantes)
+        {
+            i2c_bus_id_t alvo = -1;
+            for (size_t i = 0; i < n && alvo < 0; ++i)
+                if (lote[i] && lote[i]->id == c->atual) alvo = c->atual;
+            for (size_t i = 0; i < n && alvo < 0; ++i)
+                if (lote[i]) alvo = lote[i]->id;
+            restantes -= atende_conjunto(c, lote, n, alvo);
+        }
+    }
+}
+
+i2c_bus_id_t i2c_bus_register(const i2c_bus_pins_t *pins)
+{
+    if (s_num_pins == I2C_BUS_MAX_PINS) return -1;
+    unsigned idx = i2c_get_index(pins->i2c);
+    i2c_bus_ctrl_t *c = &s_ctrl[idx];
+
+    if (!c->fila) {
+        c->i2c = pins->i2c;
+        c->atual = -1;
+        i2c_init(pins->i2c, pins->baudrate);
+        c->fila = xQueueCreate(I2C_BUS_QUEUE_LEN, sizeof(i2c_bus_req_t *));
+        if (!c->fila) return -1;
+        if (task_create_on(tarefaI2C, idx ? "I2C1" : "I2C0", 384, c, I2C_BUS_TASK_PRIORITY, I2C_BUS_TASK_CORE,
+                           NULL) != pdPASS)
+            return -1;
+    }
+    s_pins[s_num_pins] = *pins;
+    return (i2c_bus_id_t)s_num_pins++;
+}
+
+static QueueHandle_t fila_de(i2c_bus_id_t id)
+{
+    if (id < 0 || (size_t)id >= s_num_pins) return NULL;
+    return s_ctrl[i2c_get_index(s_pins[id].i2c)].fila;
+}
+
+static int submit(i2c_bus_req_t *r)
+{
+    QueueHandle_t fila = fila_de(r->id);
+    if (!fila) return PICO_ERROR_GENERIC;
+    r->cliente = xTaskGetCurrentTaskHandle();
+    xQueueSend(fila, &r, portMAX_DELAY);
+    ulTaskNotifyTakeIndexed(I2C_BUS_NOTIFY_INDEX, pdTRUE, portMAX_DELAY);
+    return r->resultado;
+}
+
+bool i2c_bus_run(i2c_bus_id_t id, i2c_bus_job_t job, void *ctx)
+{
+    i2c_bus_req_t r = {.id = id, .job = job, .ctx = ctx};
+    return submit(&r) >= 0;
+}
+
+bool i2c_bus_post(i2c_bus_id_t id, i2c_bus_job_t job, void *ctx)
+{
+    QueueHandle_t fila = fila_de(id);
+    if (!fila) return false;
+
+    i2c_bus_req_t *r = NULL;
+    taskENTER_CRITICAL();
+    for (size_t i = 0; i < I2C_BUS_ASYNC_SLOTS && !r; ++i)
+        if (!s_async[i].ocupado) {
+            r = &s_async[i];
+            r->ocupado = true;
+        }
+    taskEXIT_CRITICAL();
+    if (!r) return false;
+
+    r->id = id;
+    r->job = job;
+    r->ctx = ctx;
+    r->tx_len = 0;
+    r->rx_len = 0;
+    r->cliente = NULL;
+    if (xQueueSend(fila, &r, 0) != pdTRUE) {
+        r->ocupado = false;
+        return false;
+    }
+    return true;
+}
+
+int i2c_bus_transfer(i2c_bus_id_t id, uint8_t addr, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len)
+{
+    i2c_bus_req_t r = {.id = id, .addr = addr, .tx = tx, .tx_len = tx_len, .rx = rx, .rx_len = rx_len};
+    return submit(&r);
+}
+
+void i2c_bus_get_stats(unsigned controller, i2c_bus_stats_t *out)
+{
+    taskENTER_CRITICAL();
+    *out = s_ctrl[controller & 1u].stats;
+    taskEXIT_CRITICAL();
+}
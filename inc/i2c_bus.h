@@ -0,0 +1,92 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+// Gerenciador dos controladores I2C. Cada controlador tem uma tarefa dona,
+// que recebe transações por fila marcadas com o conjunto de pinos/velocidade
+// exigido. As transações que estão na fila são atendidas agrupadas por
+// conjunto de pinos, de modo que a troca de pinos (remux) acontece uma vez por
+// grupo e não a cada acesso. O término é sinalizado à tarefa cliente por task
+// notification no índice I2C_BUS_NOTIFY_INDEX.
+// Transações postadas (sem espera) não abrem uma rodada sozinhas: aguardam a
+// próxima transação bloqueante do controlador, por até I2C_BUS_POST_WAIT_MS, e
+// dentro do conjunto de pinos rodam depois dela.
+
+#ifndef I2C_BUS_MAX_PINS
+#define I2C_BUS_MAX_PINS 4        // conjuntos de pinos registrados (somando os dois controladores)
+#endif
+
+#ifndef I2C_BUS_BATCH_MAX
+#define I2C_BUS_BATCH_MAX 8       // transações retiradas da fila por rodada
+#endif
+
+#ifndef I2C_BUS_QUEUE_LEN
+#define I2C_BUS_QUEUE_LEN 8
+#endif
+
+#ifndef I2C_BUS_ASYNC_SLOTS
+#define I2C_BUS_ASYNC_SLOTS 4     // transações postadas sem espera, pendentes ao mesmo tempo
+#endif
+
+#ifndef I2C_BUS_POST_WAIT_MS
+#define I2C_BUS_POST_WAIT_MS 20   // atraso máximo de uma transação postada à espera de companhia
+#endif
+
+#ifndef I2C_BUS_SETTLE_US
+#define I2C_BUS_SETTLE_US 100     // acomodação dos pull-ups após o remux
+#endif
+
+// Índice 0 fica livre para o uso próprio da tarefa (ex.: notificação vinda de ISR)
+#ifndef I2C_BUS_NOTIFY_INDEX
+#define I2C_BUS_NOTIFY_INDEX 1
+#endif
+
+typedef struct {
+    i2c_inst_t *i2c;
+    uint8_t sda;
+    uint8_t scl;
+    uint32_t baudrate;
+} i2c_bus_pins_t;
+
+// Identificador de um conjunto de pinos registrado (negativo = inválido)
+typedef int i2c_bus_id_t;
+
+// Transação composta: executa na tarefa dona do controlador, com os pinos e a
+// velocidade já selecionados. Usada para rodar as rotinas dos drivers sem que
+// outra tarefa toque no barramento no meio da sequência.
+typedef bool (*i2c_bus_job_t)(i2c_inst_t *i2c, void *ctx);
+
+typedef struct {
+    uint32_t transactions;   // transações concluídas
+    uint32_t batches;        // rodadas de atendimento
+    uint32_t remuxes;        // trocas de conjunto de pinos
+    uint32_t max_batch;      // maior rodada
+} i2c_bus_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Registra um conjunto de pinos. Na primeira vez que um controlador aparece,
+// inicializa o periférico e cria a tarefa dona dele.
+i2c_bus_id_t i2c_bus_register(const i2c_bus_pins_t *pins);
+
+// Enfileira a transação e bloqueia a tarefa chamadora até o término.
+bool i2c_bus_run(i2c_bus_id_t id, i2c_bus_job_t job, void *ctx);
+// Enfileira a transação e retorna sem esperar (ctx deve continuar válido até
+// a execução). false se todos os I2C_BUS_ASYNC_SLOTS estiverem ocupados.
+// Postada antes de um i2c_bus_run/i2c_bus_transfer no mesmo conjunto de pinos,
+// roda na mesma rodada e depois dele.
+bool i2c_bus_post(i2c_bus_id_t id, i2c_bus_job_t job, void *ctx);
+// Escreve tx (se tx_len > 0) e lê rx com repeated start (se rx_len > 0).
+// Retorna o número de bytes da última fase ou PICO_ERROR_GENERIC.
+int i2c_bus_transfer(i2c_bus_id_t id, uint8_t addr, const uint8_t *tx, size_t tx_len, uint8_t *rx, size_t rx_len);
+
+// Estatísticas do controlador (0 ou 1)
+void i2c_bus_get_stats(unsigned controller, i2c_bus_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,344 @@
+#include "inc/journal.h"
+#include <string.h>
+#include "inc/crc16.h"
+
+#define JOURNAL_MAGIC 0x314E524Au       // "JRN1"
+#define ERASED32 0xFFFFFFFFu
+
+enum {
+    REC_SAMPLE = 0x5341,
+    REC_RESERVE = 0x5245,
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t gen;
+    uint32_t erase_count;
+    uint32_t seq_limit;
+    uint8_t pad[14];
+    uint16_t crc;
+} hdr_t;
+
+typedef struct {
+    uint32_t seq;           // ERASED32 = posição livre; em REC_RESERVE, o limite reservado
+    uint16_t type;
+    uint16_t sent;          // 0xFFFF pendente; 0 = confirmado (programado depois, fora do CRC)
+    uint32_t t_ms;
+    uint32_t pres_pa;
+    int16_t temp_c100;
+    uint16_t dist_mm;
+    uint16_t bpm_x10;
+    uint16_t spo2_x10;
+    uint8_t pad[6];
+    uint16_t crc;
+} rec_t;
+
+_Static_assert(sizeof(hdr_t) == JOURNAL_RECORD_SIZE, "cabeçalho ocupa uma posição de registro");
+_Static_assert(sizeof(rec_t) == JOURNAL_RECORD_SIZE, "registro de tamanho fixo");
+
+static uint16_t rec_crc(const rec_t *r)
+{
+    rec_t tmp = *r;
+    tmp.sent = 0xFFFF;
+    return crc16(&tmp, offsetof(rec_t, crc));
+}
+
+static bool blank(const void *p, size_t len)
+{
+    const uint8_t *b = p;
+    while (len--)
+        if (*b++ != 0xFF) return false;
+    return true;
+}
+
+static uint32_t sector_off(const journal_t *j, uint16_t sector)
+{
+    return (uint32_t)sector * j->dev->sector_size;
+}
+
+static uint32_t slot_off(const journal_t *j, uint16_t sector, uint16_t slot)
+{
+    return sector_off(j, sector) + (uint32_t)(slot + 1) * JOURNAL_RECORD_SIZE;
+}
+
+// Programa len bytes em off: a página é completada com 0xFF, que não altera o que já está gravado
+static bool program(journal_t *j, uint32_t off, const void *src, size_t len)
+{
+    uint32_t page = j->dev->page_size;
+    uint32_t base = off & ~(page - 1);
+    memset(j->page, 0xFF, page);
+    memcpy(&j->page[off - base], src, len);
+    if (j->dev->program(j->dev, base, j->page, page)) return true;
+    j->stats.write_errors++;
+    return false;
+}
+
+static bool read_hdr(const journal_t *j, uint16_t sector, hdr_t *h)
+{
+    return j->dev->read(j->dev, sector_off(j, sector), h, sizeof *h) && h->magic == JOURNAL_MAGIC &&
+           h->crc == crc16(h, offsetof(hdr_t, crc));
+}
+
+typedef enum { SLOT_FREE, SLOT_BAD, SLOT_OK } slot_state_t;
+
+static slot_state_t read_rec(const journal_t *j, uint16_t sector, uint16_t slot, rec_t *r)
+{
+    if (!j->dev->read(j->dev, slot_off(j, sector, slot), r, sizeof *r)) return SLOT_BAD;
+    if (r->seq == ERASED32 && blank(r, sizeof *r)) return SLOT_FREE;
+    return r->crc == rec_crc(r) ? SLOT_OK : SLOT_BAD;
+}
+
+static void advance(const journal_t *j, uint16_t *sector, uint16_t *slot)
+{
+    if (++*slot < j->slots || *sector == j->head_sector) return;
+    *sector = (uint16_t)((*sector + 1) % j->sectors);
+    *slot = 0;
+}
+
+static bool at_head(const journal_t *j, uint16_t sector, uint16_t slot)
+{
+    return sector == j->head_sector && slot == j->head_slot;
+}
+
+static uint32_t count_samples(const journal_t *j, uint16_t sector, uint16_t slot, uint16_t end_sector, uint16_t end_slot)
+{
+    uint32_t n = 0;
+    rec_t r;
+    while (!(sector == end_sector && slot == end_slot)) {
+        if (read_rec(j, sector, slot, &r) == SLOT_OK && r.type == REC_SAMPLE) n++;
+        if (sector == j->head_sector && slot >= j->head_slot) break;
+        advance(j, &sector, &slot);
+    }
+    return n;
+}
+
+// Apaga o setor e grava o cabeçalho de uma nova geração
+static bool start_sector(journal_t *j, uint16_t sector, uint32_t gen)
+{
+    hdr_t h;
+    uint32_t erases = read_hdr(j, sector, &h) ? h.erase_count : 0;
+
+    j->stats.erases++;
+    if (!j->dev->erase(j->dev, sector_off(j, sector))) {
+        j->stats.write_errors++;
+        return false;
+    }
+    memset(&h, 0xFF, sizeof h);
+    h.magic = JOURNAL_MAGIC;
+    h.gen = gen;
+    h.erase_count = erases + 1;
+    h.seq_limit = j->seq_limit;
+    h.crc = crc16(&h, offsetof(hdr_t, crc));
+    if (h.erase_count > j->stats.max_erase_count) j->stats.max_erase_count = h.erase_count;
+
+    j->head_sector = sector;
+    j->head_slot = 0;
+    j->gen = gen;
+    return program(j, sector_off(j, sector), &h, sizeof h);
+}
+
+// Abre espaço para mais um registro, passando ao próximo setor do anel se preciso
+static bool reserve_slot(journal_t *j)
+{
+    if (j->head_slot < j->slots) return true;
+
+    uint16_t next = (uint16_t)((j->head_sector + 1) % j->sectors);
+    if (j->pending && j->tail_sector == next) {
+        // Anel cheio: as pendentes do setor mais antigo se perdem
+        uint16_t after = (uint16_t)((next + 1) % j->sectors);
+        uint32_t lost = count_samples(j, j->tail_sector, j->tail_slot, after, 0);
+        j->stats.dropped += lost;
+        j->pending -= lost;
+        j->tail_sector = after;
+        j->tail_slot = 0;
+        j->peek_n = 0;
+    }
+    bool vazio = j->pending == 0;
+    bool ok = start_sector(j, next, j->gen + 1);
+    if (vazio) {
+        j->tail_sector = j->head_sector;
+        j->tail_slot = j->head_slot;
+    }
+    return ok;
+}
+
+static bool write_rec(journal_t *j, rec_t *r)
+{
+    if (!reserve_slot(j)) return false;
+    r->crc = rec_crc(r);
+    uint32_t off = slot_off(j, j->head_sector, j->head_slot);
+    j->head_slot++;   // ocupada mesmo se a programação falhar (conteúdo incerto)
+    return program(j, off, r, sizeof *r);
+}
+
+bool journal_open(journal_t *j, const flash_dev_t *dev)
+{
+    memset(j, 0, sizeof *j);
+    j->dev = dev;
+    if (dev->page_size > JOURNAL_PAGE_MAX || dev->page_size % JOURNAL_RECORD_SIZE ||
+        dev->sector_size % dev->page_size || dev->size / dev->sector_size < 2)
+        return false;
+    j->sectors = (uint16_t)(dev->size / dev->sector_size);
+    j->slots = (uint16_t)(dev->sector_size / JOURNAL_RECORD_SIZE - 1);
+
+    // Setor de escrita: o de maior geração
+    hdr_t h;
+    bool achou = false;
+    for (uint16_t s = 0; s < j->sectors; ++s) {
+        if (!read_hdr(j, s, &h)) continue;
+        if (h.erase_count > j->stats.max_erase_count) j->stats.max_erase_count = h.erase_count;
+        if (!achou || h.gen > j->gen) {
+            achou = true;
+            j->gen = h.gen;
+            j->head_sector = s;
+        }
+    }
+    if (!achou)
+        return start_sector(j, 0, 1);   // diário novo: cauda = cabeça = (0, 0)
+
+    // O anel vai do setor de escrita para trás enquanto as gerações forem consecutivas
+    uint16_t oldest = j->head_sector;
+    for (uint16_t d = 1; d < j->sectors; ++d) {
+        uint16_t s = (uint16_t)((j->head_sector + j->sectors - d) % j->sectors);
+        if (!read_hdr(j, s, &h) || h.gen != j->gen - d) break;
+        oldest = s;
+    }
+
+    // Varredura do mais antigo ao de escrita
+    bool algum_seq = false;
+    uint32_t max_seq = 0;
+    bool confirmado = false;
+    uint16_t conf_sector = 0, conf_slot = 0;
+    uint16_t s = oldest;
+    for (;;) {
+        read_hdr(j, s, &h);
+        if (h.seq_limit != ERASED32 && h.seq_limit > j->seq_limit) j->seq_limit = h.seq_limit;
+        uint16_t used = 0;
+        for (uint16_t k = 0; k < j->slots; ++k) {
+            rec_t r;
+            slot_state_t st = read_rec(j, s, k, &r);
+            if (st == SLOT_FREE) continue;
+            used = (uint16_t)(k + 1);
+            if (st == SLOT_BAD) {
+                j->stats.corrupt++;
+                continue;
+            }
+            if (r.type == REC_RESERVE) {
+                if (r.seq > j->seq_limit) j->seq_limit = r.seq;
+            } else if (r.type == REC_SAMPLE) {
+                if (!algum_seq || r.seq > max_seq) max_seq = r.seq;
+                algum_seq = true;
+                if (r.sent != 0xFFFF) {   // marca cortada também conta: o lote já tinha saído
+                    confirmado = true;
+                    conf_sector = s;
+                    conf_slot = k;
+                }
+            }
+        }
+        if (s == j->head_sector) {
+            j->head_slot = used;
+            break;
+        }
+        s = (uint16_t)((s + 1) % j->sectors);
+    }
+
+    // Reservas antigas podem ter ficado acima do que foi gravado: nunca reutiliza
+    j->next_seq = algum_seq && max_seq + 1 > j->seq_limit ? max_seq + 1 : j->seq_limit;
+    j->seq_limit = j->next_seq;
+
+    if (confirmado) {
+        j->tail_sector = conf_sector;
+        j->tail_slot = conf_slot;
+        advance(j, &j->tail_sector, &j->tail_slot);
+    } else {
+        j->tail_sector = oldest;
+        j->tail_slot = 0;
+    }
+    j->pending = count_samples(j, j->tail_sector, j->tail_slot, j->head_sector, j->head_slot);
+    return true;
+}
+
+uint32_t journal_next_seq(journal_t *j)
+{
+    if (j->next_seq >= j->seq_limit) {
+        rec_t r;
+        memset(&r, 0xFF, sizeof r);
+        r.seq = j->next_seq + JOURNAL_SEQ_RESERVE;
+        r.type = REC_RESERVE;
+        // Sem a reserva em flash o número ainda é único nesta execução
+        write_rec(j, &r);
+        j->seq_limit = r.seq;
+    }
+    return j->next_seq++;
+}
+
+bool journal_append(journal_t *j, const telemetry_sample_t *s)
+{
+    rec_t r;
+    memset(&r, 0xFF, sizeof r);
+    r.seq = s->seq;
+    r.type = REC_SAMPLE;
+    r.t_ms = s->t_ms;
+    r.pres_pa = s->pres_pa;
+    r.temp_c100 = s->temp_c100;
+    r.dist_mm = s->dist_mm;
+    r.bpm_x10 = s->bpm_x10;
+    r.spo2_x10 = s->spo2_x10;
+
+    bool vazio = j->pending == 0;
+    if (!write_rec(j, &r)) return false;
+    if (vazio) {
+        j->tail_sector = j->head_sector;
+        j->tail_slot = (uint16_t)(j->head_slot - 1);
+    }
+    j->pending++;
+    j->stats.appended++;
+    return true;
+}
+
+size_t journal_peek(journal_t *j, telemetry_sample_t *out, size_t max)
+{
+    uint16_t sector = j->tail_sector, slot = j->tail_slot;
+    size_t n = 0;
+    while (n < max && !at_head(j, sector, slot)) {
+        rec_t r;
+        if (read_rec(j, sector, slot, &r) == SLOT_OK && r.type == REC_SAMPLE) {
+            if (n && r.seq != out[n - 1].seq + 1) break;   // lacuna: fica para a próxima leitura
+            telemetry_sample_t *s = &out[n++];
+            s->seq = r.seq;
+            s->t_ms = r.t_ms;
+            s->temp_c100 = r.temp_c100;
+            s->pres_pa = r.pres_pa;
+            s->dist_mm = r.dist_mm;
+            s->bpm_x10 = r.bpm_x10;
+            s->spo2_x10 = r.spo2_x10;
+            j->peek_last_sector = sector;
+            j->peek_last_slot = slot;
+        }
+        advance(j, &sector, &slot);
+    }
+    j->peek_sector = sector;
+    j->peek_slot = slot;
+    j->peek_n = (uint32_t)n;
+    return n;
+}
+
+bool journal_ack(journal_t *j)
+{
+    if (j->peek_n == 0) return false;
+
+    uint16_t zero = 0;
+    bool ok = program(j, slot_off(j, j->peek_last_sector, j->peek_last_slot) + offsetof(rec_t, sent), &zero, sizeof zero);
+    // Mesmo sem a marca em flash as amostras saíram: no pior caso voltam após um reinício (seq repetido)
+    j->tail_sector = j->peek_sector;
+    j->tail_slot = j->peek_slot;
+    j->pending -= j->peek_n;
+    j->stats.replayed += j->peek_n;
+    j->peek_n = 0;
+    return ok;
+}
+
+void journal_get_stats(const journal_t *j, journal_stats_t *out)
+{
+    *out = j->stats;
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/flash_dev.h"
+#include "inc/telemetry.h"
+
+// Diário de telemetria em flash (store-and-forward): amostras que não puderam
+// ser publicadas são anexadas em um anel de setores e reenviadas em ordem quando
+// o broker volta.
+//
+// Layout: cada setor começa com um cabeçalho (geração, contagem de apagamentos,
+// limite de sequência reservado) seguido de registros de JOURNAL_RECORD_SIZE
+// bytes. A escrita só avança; ao encher um setor o próximo do anel é apagado,
+// de modo que todos os setores se desgastam por igual. Se o anel encher, o setor
+// mais antigo é sobrescrito (amostras contadas em `dropped`).
+//
+// Cada registro tem CRC (registro cortado por queda de energia é ignorado na
+// abertura). A confirmação de envio zera um campo do último registro do lote
+// reenviado, sem apagar nada: na abertura tudo até a última confirmação conta
+// como enviado.
+//
+// Números de sequência: journal_next_seq() numera toda amostra (ao vivo ou não) e
+// reserva faixas de JOURNAL_SEQ_RESERVE números em flash, então a numeração
+// continua crescente depois de um reinício, mesmo sem nada gravado no diário.
+
+#define JOURNAL_RECORD_SIZE 32
+#define JOURNAL_PAGE_MAX 256           // maior página de programação suportada
+
+#ifndef JOURNAL_SEQ_RESERVE
+#define JOURNAL_SEQ_RESERVE 1024
+#endif
+
+typedef struct {
+    uint32_t appended;
+    uint32_t replayed;        // confirmados com journal_ack()
+    uint32_t dropped;         // pendentes sobrescritos com o anel cheio
+    uint32_t corrupt;         // registros com CRC inválido encontrados
+    uint32_t erases;
+    uint32_t max_erase_count; // maior contagem de apagamentos de um setor
+    uint32_t write_errors;
+} journal_stats_t;
+
+typedef struct {
+    const flash_dev_t *dev;
+    uint16_t sectors;
+    uint16_t slots;                   // registros por setor
+    uint32_t gen;                     // geração do setor de escrita
+    uint16_t head_sector, head_slot;  // próxima posição livre (head_slot == slots: setor cheio)
+    uint16_t tail_sector, tail_slot;  // registro pendente mais antigo
+    uint32_t pending;                 // amostras ainda não confirmadas
+    uint32_t next_seq;
+    uint32_t seq_limit;               // números abaixo deste já estão reservados em flash
+    // Última leitura de journal_peek(), confirmada por journal_ack()
+    uint16_t peek_sector, peek_slot;  // posição seguinte à última amostra lida
+    uint16_t peek_last_sector, peek_last_slot;
+    uint32_t peek_n;
+    journal_stats_t stats;
+    uint8_t page[JOURNAL_PAGE_MAX];
+} journal_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Recupera o estado a partir da flash (formata se não houver diário válido).
+// false se a região não comporta o diário (menos de 2 setores, página grande demais).
+bool journal_open(journal_t *j, const flash_dev_t *dev);
+
+// Próximo número de sequência; grava uma nova reserva quando a atual se esgota
+uint32_t journal_next_seq(journal_t *j);
+
+// Anexa uma amostra já numerada
+bool journal_append(journal_t *j, const telemetry_sample_t *s);
+
+static inline uint32_t journal_pending(const journal_t *j)
+{
+    return j->pending;
+}
+
+// Lê até max amostras pendentes, a partir da mais antiga, sem removê-las.
+// Para antes de uma lacuna na sequência (registro perdido, reinício), então os
+// números de uma leitura são sempre consecutivos, como num lote de inc/telemetry.h.
+size_t journal_peek(journal_t *j, telemetry_sample_t *out, size_t max);
+// Marca como enviadas as amostras da última journal_peek()
+bool journal_ack(journal_t *j);
+
+void journal_get_stats(const journal_t *j, journal_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,196 @@
+#include "inc/log_async.h"
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inc/task_cores.h"
+
+#define MASK (LOG_RING_SIZE - 1u)
+
+// Anéis próprios e, no fim, o compartilhado
+static log_ring_t s_aneis[LOG_RINGS + 1];
+static uint32_t s_registrados;
+static uint32_t s_impressos;
+static uint32_t s_ocupacao_max;
+
+#define COMPARTILHADO (&s_aneis[LOG_RINGS])
+
+static void gravar(log_ring_t *r, uint8_t level, const char *fmt, unsigned n, const uint32_t *args)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    // acquire: a tarefa de log terminou de ler o registro antes de devolvê-lo
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= LOG_RING_SIZE) {
+        atomic_store_explicit(&r->dropped, atomic_load_explicit(&r->dropped, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return;
+    }
+    log_record_t *rec = &r->rec[head & MASK];
+    rec->fmt = fmt;
+    rec->level = level;
+    rec->n = (uint8_t)n;
+    memcpy(rec->args, args, n * sizeof args[0]);
+    atomic_store_explicit(&r->written, atomic_load_explicit(&r->written, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    // release: o registro fica visível antes do novo head
+    atomic_store_explicit(&r->head, head + 1, memory_order_release);
+}
+
+void log_async_write(uint8_t level, const char *fmt, unsigned n, const uint32_t *args)
+{
+    if (n > LOG_ARGS_MAX) n = LOG_ARGS_MAX;
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED) {
+        log_ring_t *r = pvTaskGetThreadLocalStoragePointer(NULL, LOG_TLS_INDEX);
+        if (r) {
+            gravar(r, level, fmt, n, args);
+            return;
+        }
+    }
+    taskENTER_CRITICAL();
+    gravar(COMPARTILHADO, level, fmt, n, args);
+    taskEXIT_CRITICAL();
+}
+
+bool log_async_register(void)
+{
+    if (pvTaskGetThreadLocalStoragePointer(NULL, LOG_TLS_INDEX))
+        return true;
+    log_ring_t *r = NULL;
+    taskENTER_CRITICAL();
+    if (s_registrados < LOG_RINGS)
+        r = &s_aneis[s_registrados++];
+    taskEXIT_CRITICAL();
+    if (!r)
+        return false;
+    vTaskSetThreadLocalStoragePointer(NULL, LOG_TLS_INDEX, r);
+    return true;
+}
+
+static size_t emite(char *out, size_t cap, size_t len, char c)
+{
+    if (len + 1 < cap) out[len] = c;
+    return len + 1;
+}
+
+size_t log_async_format(char *out, size_t cap, const char *fmt, const uint32_t *args, unsigned n)
+{
+    size_t len = 0;
+    unsigned usado = 0;
+    for (const char *p = fmt; *p; ++p) {
+        if (*p != '%') {
+            len = emite(out, cap, len, *p);
+            continue;
+        }
+        const char *inicio = p++;
+        bool zeros = false, esquerda = false;
+        for (;; ++p) {
+            if (*p == '0') zeros = true;
+            else if (*p == '-') esquerda = true;
+            else break;
+        }
+        unsigned largura = 0;
+        while (*p >= '0' && *p <= '9')
+            largura = largura * 10 + (unsigned)(*p++ - '0');
+        while (*p == 'h' || *p == 'l')
+            ++p;
+
+        char dig[12];
+        size_t nd = 0;
+        bool negativo = false;
+        uint32_t v = usado < n ? args[usado] : 0;
+        switch (*p) {
+        case '%':
+            len = emite(out, cap, len, '%');
+            continue;
+        case 'c':
+            dig[nd++] = (char)v;
+            break;
+        case 'd':
+        case 'i':
+            if ((int32_t)v < 0) {
+                negativo = true;
+                v = 0u - v;
+            }
+            /* fall through */
+        case 'u':
+            do
+                dig[nd++] = (char)('0' + v % 10);
+            while (v /= 10);
+            break;
+        case 'x':
+        case 'X': {
+            const char *hex = *p == 'x' ? "0123456789abcdef" : "0123456789ABCDEF";
+            do
+                dig[nd++] = hex[v & 0xF];
+            while (v >>= 4);
+            break;
+        }
+        default:
+            // Conversão não suportada: sai como está no formato
+            for (const char *q = inicio; q <= p && *q; ++q)
+                len = emite(out, cap, len, *q);
+            if (!*p) --p;
+            continue;
+        }
+        usado++;
+
+        // dig está ao contrário (exceto %c, de um caractere só)
+        size_t total = nd + negativo;
+        size_t pad = largura > total ? largura - total : 0;
+        if (!esquerda && !zeros)
+            while (pad) len = emite(out, cap, len, ' '), pad--;
+        if (negativo) len = emite(out, cap, len, '-');
+        if (!esquerda && zeros)
+            while (pad) len = emite(out, cap, len, '0'), pad--;
+        while (nd)
+            len = emite(out, cap, len, dig[--nd]);
+        while (pad) len = emite(out, cap, len, ' '), pad--;
+    }
+    if (cap) out[len < cap ? len : cap - 1] = '\0';
+    return len < cap ? len : (cap ? cap - 1 : 0);
+}
+
+static void tarefaLog(void *arg)
+{
+    (void)arg;
+    static char linha[LOG_LINE_MAX];
+    uint32_t descartes_avisados = 0;
+    for (;;) {
+        for (int i = 0; i <= LOG_RINGS; ++i) {
+            log_ring_t *r = &s_aneis[i];
+            uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+            uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+            if (head - tail > s_ocupacao_max) s_ocupacao_max = head - tail;
+            for (; tail != head; ++tail) {
+                const log_record_t *rec = &r->rec[tail & MASK];
+                log_async_format(linha, sizeof linha, rec->fmt, rec->args, rec->n);
+                fputs(linha, stdout);
+                s_impressos++;
+                // release: o registro foi lido antes de voltar ao produtor
+                atomic_store_explicit(&r->tail, tail + 1, memory_order_release);
+            }
+        }
+        log_async_stats_t st;
+        log_async_get_stats(&st);
+        if (st.dropped != descartes_avisados) {
+            printf("[Log] %lu registros descartados (anel cheio)\n", (unsigned long)(st.dropped - descartes_avisados));
+            descartes_avisados = st.dropped;
+        }
+        vTaskDelay(pdMS_TO_TICKS(LOG_DRAIN_MS));
+    }
+}
+
+bool log_async_start(void)
+{
+    return task_create_on(tarefaLog, "Log", 384, NULL, LOG_TASK_PRIO, CORE_REDE, NULL) == pdPASS;
+}
+
+void log_async_get_stats(log_async_stats_t *out)
+{
+    memset(out, 0, sizeof *out);
+    for (int i = 0; i <= LOG_RINGS; ++i) {
+        out->written += atomic_load_explicit(&s_aneis[i].written, memory_order_relaxed);
+        out->dropped += atomic_load_explicit(&s_aneis[i].dropped, memory_order_relaxed);
+    }
+    out->printed = s_impressos;
+    out->high_water = s_ocupacao_max;
+}
@@ -0,0 +1,154 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Log diferido para os laços quentes (aquisição, publicação MQTT).
+//
+// LOG_I("[Sensor] P: %lu Pa\n", (unsigned long)p) não formata nada: grava no
+// anel o ponteiro do formato (a string fica na flash e serve de identificador)
+// e até LOG_ARGS_MAX argumentos inteiros de 32 bits. A tarefa "Log", de baixa
+// prioridade no núcleo de rede, formata e escreve no stdio (USB CDC) a cada
+// LOG_DRAIN_MS. O chamador não espera o USB nem a formatação.
+//
+// Anéis produtor único / consumidor único: cada tarefa quente pede o seu com
+// log_async_register() e grava sem trava (o M0+ não tem LDREX/STREX para um
+// anel com vários produtores). As demais tarefas dividem um anel protegido por
+// uma seção crítica curta. Não usar em interrupção. A ordem é garantida dentro
+// de cada anel, não entre tarefas. Com o anel cheio o registro é descartado e
+// contado.
+//
+// Formatos aceitos: %d %i %u %x %X %c e %%, com flags '0'/'-', largura e
+// modificadores h/l (ignorados: todo argumento tem 32 bits). Texto (%s) e float
+// ficam com printf nos caminhos frios. O formato é conferido pelo compilador
+// como o de printf, sem ser avaliado.
+//
+// O nível é filtrado na compilação (LOG_LEVEL): os níveis desligados viram
+// ((void)0) e nem os argumentos são avaliados.
+
+#define LOG_LEVEL_OFF 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+#define LOG_ARGS_MAX 5
+
+#ifndef LOG_RING_SIZE
+#define LOG_RING_SIZE 32               // registros por anel, potência de 2
+#endif
+
+#ifndef LOG_RINGS
+#define LOG_RINGS 3                    // anéis próprios para log_async_register()
+#endif
+
+#ifndef LOG_DRAIN_MS
+#define LOG_DRAIN_MS 50
+#endif
+
+// Ponteiro de armazenamento local da tarefa com o seu anel (os índices baixos ficam para o SDK)
+#ifndef LOG_TLS_INDEX
+#define LOG_TLS_INDEX 4
+#endif
+
+// Maior linha formatada; o excedente é cortado
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 160
+#endif
+
+_Static_assert((LOG_RING_SIZE & (LOG_RING_SIZE - 1)) == 0, "LOG_RING_SIZE deve ser potência de 2");
+
+typedef struct {
+    const char *fmt;
+    uint8_t level;
+    uint8_t n;
+    uint32_t args[LOG_ARGS_MAX];
+} log_record_t;
+
+typedef struct {
+    log_record_t rec[LOG_RING_SIZE];
+    _Atomic uint32_t head;     // produtor
+    _Atomic uint32_t tail;     // tarefa de log
+    _Atomic uint32_t written;
+    _Atomic uint32_t dropped;
+} log_ring_t;
+
+typedef struct {
+    uint32_t written;          // registros aceitos
+    uint32_t dropped;          // registros descartados com o anel cheio
+    uint32_t printed;          // linhas já escritas no stdio
+    uint32_t high_water;       // maior ocupação de um anel vista pela tarefa de log
+} log_async_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cria a tarefa que formata e escreve os registros
+bool log_async_start(void);
+
+// Dá à tarefa atual um anel próprio, sem trava; false se acabaram (usa o compartilhado)
+bool log_async_register(void);
+
+void log_async_write(uint8_t level, const char *fmt, unsigned n, const uint32_t *args);
+
+// Formata um registro em out (sempre terminado em zero); retorna o tamanho
+size_t log_async_format(char *out, size_t cap, const char *fmt, const uint32_t *args, unsigned n);
+
+void log_async_get_stats(log_async_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+// --- Macros de chamada ---
+#define LOG_CONTA_(f, a, b, c, d, e, n, ...) n
+#define LOG_CONTA(...) LOG_CONTA_(__VA_ARGS__, 5, 4, 3, 2, 1, 0, 0)
+#define LOG_FORMATO_(f, ...) f
+#define LOG_FORMATO(...) LOG_FORMATO_(__VA_ARGS__, 0)
+#define LOG_A0(f)
+#define LOG_A1(f, a) (uint32_t)(a)
+#define LOG_A2(f, a, b) (uint32_t)(a), (uint32_t)(b)
+#define LOG_A3(f, a, b, c) (uint32_t)(a), (uint32_t)(b), (uint32_t)(c)
+#define LOG_A4(f, a, b, c, d) (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)
+#define LOG_A5(f, a, b, c, d, e) (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d), (uint32_t)(e)
+#define LOG_CAT_(a, b) a##b
+#define LOG_CAT(a, b) LOG_CAT_(a, b)
+
+// O primeiro elemento do vetor só existe para aceitar zero argumentos
+#define LOG_EMIT(level, ...)                                                                      \
+    do {                                                                                          \
+        (void)sizeof(printf(__VA_ARGS__));                                                        \
+        log_async_write(level, LOG_FORMATO(__VA_ARGS__), LOG_CONTA(__VA_ARGS__),                  \
+                        (const uint32_t[LOG_ARGS_MAX + 1]){0, LOG_CAT(LOG_A, LOG_CONTA(__VA_ARGS__))(__VA_ARGS__)} + 1); \
+    } while (0)
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_E(...) LOG_EMIT(LOG_LEVEL_ERROR, __VA_ARGS__)
+#else
+#define LOG_E(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_W(...) LOG_EMIT(LOG_LEVEL_WARN, __VA_ARGS__)
+#else
+#define LOG_W(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_I(...) LOG_EMIT(LOG_LEVEL_INFO, __VA_ARGS__)
+#else
+#define LOG_I(...) ((void)0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_D(...) LOG_EMIT(LOG_LEVEL_DEBUG, __VA_ARGS__)
+#else
+#define LOG_D(...) ((void)0)
+#endif
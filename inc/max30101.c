@@ -1,52 +1,36 @@
 #include "inc/max30101.h"
+#include "inc/sensor_reg.h"
 #include "pico/stdlib.h"
 
-static bool write_reg(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t val) {
-    uint8_t buf[2] = {reg, val};
-    int ret = i2c_write_blocking(i2c, addr, buf, 2, false);
-    return ret == 2;
-}
-
-static bool read_reg(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *val) {
-    int ret = i2c_write_blocking(i2c, addr, &reg, 1, true);
-    if (ret != 1) return false;
-    ret = i2c_read_blocking(i2c, addr, val, 1, false);
-    return ret == 1;
-}
-
-static bool read_regs(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *buf, size_t len) {
-    int ret = i2c_write_blocking(i2c, addr, &reg, 1, true);
-    if (ret != 1) return false;
-    ret = i2c_read_blocking(i2c, addr, buf, len, false);
-    return ret == (int)len;
-}
-
 bool max30101_read_part_id(i2c_inst_t *i2c, uint8_t addr, uint8_t *out_id) {
-    return read_reg(i2c, addr, MAX30101_REG_PART_ID, out_id);
+    return sensor_reg_read8(i2c, addr, MAX30101_REG_PART_ID, out_id);
 }
 
 bool max30101_init(i2c_inst_t *i2c, uint8_t addr) {
     // Reset device
-    if (!write_reg(i2c, addr, MAX30101_REG_MODE_CONFIG, 0x40)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_MODE_CONFIG, 0x40)) return false;
     sleep_ms(10);
 
     // Clear FIFO pointers
-    if (!write_reg(i2c, addr, MAX30101_REG_FIFO_WR_PTR, 0x00)) return false;
-    if (!write_reg(i2c, addr, MAX30101_REG_OVF_COUNTER, 0x00)) return false;
-    if (!write_reg(i2c, addr, MAX30101_REG_FIFO_RD_PTR, 0x00)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_FIFO_WR_PTR, 0x00)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_OVF_COUNTER, 0x00)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_FIFO_RD_PTR, 0x00)) return false;
 
     // FIFO config: sample avg = 4 (0b010 << 5), rollover disabled, almost full = 0x0F
-    if (!write_reg(i2c, addr, MAX30101_REG_FIFO_CONFIG, (0x02 << 5) | 0x0F)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_FIFO_CONFIG, (0x02 << 5) | 0x0F)) return false;
+    // A_FULL sempre habilitado, mesmo sem a linha INT: max30101_fifo_pending usa o
+    // flag para separar FIFO cheia de vazia
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_INT_ENABLE1, MAX30101_INT_A_FULL)) return false;
 
     // SPO2 config: ADC range 4096nA (0x3 << 5), SR=100Hz (0x3 << 2), LED_PW=411us/18-bit (0x3)
-    if (!write_reg(i2c, addr, MAX30101_REG_SPO2_CONFIG, (0x3 << 5) | (0x3 << 2) | 0x3)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_SPO2_CONFIG, (0x3 << 5) | (0x3 << 2) | 0x3)) return false;
 
     // LED currents (tune as needed)
-    if (!write_reg(i2c, addr, MAX30101_REG_LED1_PA, 0x24)) return false; // RED
-    if (!write_reg(i2c, addr, MAX30101_REG_LED2_PA, 0x24)) return false; // IR
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_LED1_PA, 0x24)) return false; // RED
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_LED2_PA, 0x24)) return false; // IR
 
     // Mode: SpO2 (RED+IR)
-    if (!write_reg(i2c, addr, MAX30101_REG_MODE_CONFIG, 0x03)) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_MODE_CONFIG, 0x03)) return false;
 
     return true;
 }
@@ -54,10 +38,62 @@ bool max30101_init(i2c_inst_t *i2c, uint8_t addr) {
 bool max30101_read_ir(i2c_inst_t *i2c, uint8_t addr, uint32_t *ir_out) {
     // Read one pair (RED, IR) = 6 bytes
     uint8_t data[6];
-    if (!read_regs(i2c, addr, MAX30101_REG_FIFO_DATA, data, sizeof data)) return false;
+    if (!sensor_reg_read(i2c, addr, MAX30101_REG_FIFO_DATA, data, sizeof data)) return false;
 
     // IR is bytes 3..5 in SpO2 mode
     uint32_t ir = ((uint32_t)(data[3] & 0x03) << 16) | ((uint32_t)data[4] << 8) | data[5];
     *ir_out = ir;
     return true;
 }
+
+static uint32_t sample_18bit(const uint8_t *p) {
+    return ((uint32_t)(p[0] & 0x03) << 16) | ((uint32_t)p[1] << 8) | p[2];
+}
+
+int max30101_fifo_pending(i2c_inst_t *i2c, uint8_t addr, uint8_t *overflow) {
+    // FIFO_WR_PTR, OVF_COUNTER e FIFO_RD_PTR são consecutivos: uma leitura só
+    uint8_t ptr[3];
+    if (!sensor_reg_read(i2c, addr, MAX30101_REG_FIFO_WR_PTR, ptr, sizeof ptr)) return -1;
+    uint8_t ovf = ptr[1] & 0x1F;
+    if (overflow) *overflow = ovf;
+    if (ovf) return MAX30101_FIFO_DEPTH;
+    if (ptr[0] != ptr[2]) return (ptr[0] - ptr[2]) & (MAX30101_FIFO_DEPTH - 1);
+
+    // Ponteiros iguais sem perda: vazia ou com as 32 amostras (a seguinte já
+    // contaria em OVF_COUNTER). Com a FIFO esvaziada e INT_STATUS1 lido depois
+    // (max30101_read_fifo + max30101_read_int_status), A_FULL pendente só pode
+    // vir de uma FIFO que voltou a encher
+    uint8_t status;
+    if (!max30101_read_int_status(i2c, addr, &status)) return -1;
+    return (status & MAX30101_INT_A_FULL) ? MAX30101_FIFO_DEPTH : 0;
+}
+
+int max30101_read_fifo(i2c_inst_t *i2c, uint8_t addr, max30101_sample_t *out, size_t max, uint8_t *overflow) {
+    int pending = max30101_fifo_pending(i2c, addr, overflow);
+    if (pending <= 0) return pending;
+    size_t n = (size_t)pending < max ? (size_t)pending : max;
+
+    // FIFO_DATA não auto-incrementa o ponteiro de registrador: cada 6 bytes
+    // lidos avançam FIFO_RD_PTR, então a rajada drena as n amostras de uma vez
+    uint8_t data[MAX30101_FIFO_DEPTH * MAX30101_SAMPLE_BYTES];
+    if (!sensor_reg_read(i2c, addr, MAX30101_REG_FIFO_DATA, data, n * MAX30101_SAMPLE_BYTES)) return -1;
+
+    for (size_t i = 0; i < n; ++i) {
+        out[i].red = sample_18bit(&data[i * MAX30101_SAMPLE_BYTES]);
+        out[i].ir = sample_18bit(&data[i * MAX30101_SAMPLE_BYTES + 3]);
+    }
+    return (int)n;
+}
+
+bool max30101_enable_almost_full(i2c_inst_t *i2c, uint8_t addr, uint8_t free_slots) {
+    // Mantém a média de 4 amostras de max30101_init, rollover desabilitado
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_FIFO_CONFIG, (0x02 << 5) | (free_slots & 0x0F))) return false;
+    if (!sensor_reg_write8(i2c, addr, MAX30101_REG_INT_ENABLE1, MAX30101_INT_A_FULL)) return false;
+    // Status pendente de antes da configuração manteria a linha em nível baixo
+    uint8_t status;
+    return max30101_read_int_status(i2c, addr, &status);
+}
+
+bool max30101_read_int_status(i2c_inst_t *i2c, uint8_t addr, uint8_t *status) {
+    return sensor_reg_read8(i2c, addr, MAX30101_REG_INT_STATUS1, status);
+}
@@ -21,6 +21,23 @@
 #define MAX30101_REG_LED2_PA       0x0D // IR
 #define MAX30101_REG_PART_ID       0xFF
 
+#define MAX30101_PART_ID           0x15
+
+// INT_STATUS1 / INT_ENABLE1
+#define MAX30101_INT_A_FULL        0x80 // FIFO com FIFO_A_FULL vagas ou menos
+#define MAX30101_INT_PPG_RDY       0x40
+
+#define MAX30101_FIFO_DEPTH        32
+#define MAX30101_SAMPLE_BYTES      6    // RED + IR, 3 bytes cada (modo SpO2)
+
+// Taxa efetiva de amostras na FIFO com a configuração de max30101_init (100 Hz, média de 4)
+#define MAX30101_SAMPLE_RATE_HZ    25
+
+typedef struct {
+    uint32_t red;
+    uint32_t ir;
+} max30101_sample_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -29,6 +46,19 @@ bool max30101_init(i2c_inst_t *i2c, uint8_t addr);
 bool max30101_read_part_id(i2c_inst_t *i2c, uint8_t addr, uint8_t *out_id);
 bool max30101_read_ir(i2c_inst_t *i2c, uint8_t addr, uint32_t *ir_out);
 
+// Amostras pendentes na FIFO (FIFO_WR_PTR - FIFO_RD_PTR, ou FIFO cheia se OVF_COUNTER != 0).
+// Com os ponteiros iguais (vazia ou cheia) decide pelo A_FULL de INT_STATUS1, que
+// é lido e limpo: quem esvazia a FIFO lê INT_STATUS1 depois, para não deixar A_FULL velho.
+// -1 em erro de barramento. overflow (opcional) recebe as amostras perdidas.
+int max30101_fifo_pending(i2c_inst_t *i2c, uint8_t addr, uint8_t *overflow);
+// Esvazia até max amostras pendentes numa única leitura em rajada de FIFO_DATA.
+// Retorna o número de amostras lidas ou -1.
+int max30101_read_fifo(i2c_inst_t *i2c, uint8_t addr, max30101_sample_t *out, size_t max, uint8_t *overflow);
+// Interrupção A_FULL quando restarem free_slots (0..15) posições livres na FIFO
+bool max30101_enable_almost_full(i2c_inst_t *i2c, uint8_t addr, uint8_t free_slots);
+// Lê (e com isso limpa) INT_STATUS1; a linha INT volta ao nível alto
+bool max30101_read_int_status(i2c_inst_t *i2c, uint8_t addr, uint8_t *status);
+
 #ifdef __cplusplus
 }
 #endif
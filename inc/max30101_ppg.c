@@ -0,0 +1,130 @@
+#include "inc/max30101_ppg.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inc/task_cores.h"
+
+static i2c_bus_id_t s_bus;
+static uint8_t s_addr;
+static int s_int_pin;
+static TaskHandle_t s_task;
+// Consulta de fallback encontrou a FIFO além do A_FULL: a linha INT não está ligada
+static bool s_sem_int;
+
+static ppg_dsp_t s_dsp;
+static ppg_result_t s_result;
+static max30101_ppg_stats_t s_stats;
+
+typedef struct {
+    max30101_sample_t amostras[MAX30101_FIFO_DEPTH];
+    int n;
+    uint8_t overflow;
+} lote_t;
+
+// Só a tarefa PPG usa o lote; fora da pilha para não pesar nela
+static lote_t s_lote;
+
+static void max30101_gpio_irq(void)
+{
+    uint32_t events = gpio_get_irq_event_mask((uint)s_int_pin);
+    if (!(events & GPIO_IRQ_EDGE_FALL)) return;
+    gpio_acknowledge_irq((uint)s_int_pin, events);
+
+    s_stats.interrupts++;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Executa na tarefa dona do I2C: esvazia a FIFO e depois limpa INT_STATUS1 (libera
+// a linha). Nessa ordem o A_FULL que fica pendente é sempre de amostras novas, e
+// max30101_fifo_pending distingue por ele a FIFO cheia da vazia
+static bool job_lote(i2c_inst_t *i2c, void *ctx)
+{
+    lote_t *l = ctx;
+    uint8_t status;
+    l->n = max30101_read_fifo(i2c, s_addr, l->amostras, MAX30101_FIFO_DEPTH, &l->overflow);
+    return l->n >= 0 && max30101_read_int_status(i2c, s_addr, &status);
+}
+
+static bool job_partida(i2c_inst_t *i2c, void *ctx)
+{
+    (void)ctx;
+    return max30101_enable_almost_full(i2c, s_addr, MAX30101_PPG_FREE_SLOTS);
+}
+
+static void tarefaPPG(void *pvParameters)
+{
+    (void)pvParameters;
+    while (1)
+    {
+        uint32_t espera = (s_int_pin >= 0 && !s_sem_int) ? MAX30101_PPG_FALLBACK_MS : MAX30101_PPG_POLL_MS;
+        bool irq = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(espera)) > 0;
+
+        bool ok = i2c_bus_run(s_bus, job_lote, &s_lote);
+        taskENTER_CRITICAL();
+        if (!irq) s_stats.fallback_polls++;
+        if (!ok) s_stats.read_errors++;
+        taskEXIT_CRITICAL();
+        if (!ok || s_lote.n == 0) continue;
+        if (!irq && s_lote.n >= MAX30101_FIFO_DEPTH - MAX30101_PPG_FREE_SLOTS)
+            s_sem_int = true;
+
+        ppg_result_t r;
+        ppg_dsp_process(&s_dsp, s_lote.amostras, (size_t)s_lote.n);
+        ppg_dsp_result(&s_dsp, &r);
+
+        taskENTER_CRITICAL();
+        s_stats.batches++;
+        s_stats.samples += (uint32_t)s_lote.n;
+        s_stats.overflows += s_lote.overflow;
+        if ((uint32_t)s_lote.n > s_stats.max_batch) s_stats.max_batch = (uint32_t)s_lote.n;
+        s_result = r;
+        taskEXIT_CRITICAL();
+    }
+}
+
+bool max30101_ppg_start(i2c_bus_id_t bus, uint8_t addr, int int_pin)
+{
+    s_bus = bus;
+    s_addr = addr;
+    s_int_pin = int_pin;
+    ppg_dsp_init(&s_dsp, MAX30101_SAMPLE_RATE_HZ);
+
+    if (int_pin >= 0) {
+        // INT é dreno aberto: entrada com pull-up, borda de descida = FIFO quase cheia
+        gpio_init((uint)int_pin);
+        gpio_set_dir((uint)int_pin, GPIO_IN);
+        gpio_pull_up((uint)int_pin);
+        if (!i2c_bus_run(bus, job_partida, NULL)) return false;
+    }
+
+    if (task_create_on(tarefaPPG, "PPG", 256, NULL, MAX30101_PPG_TASK_PRIO, MAX30101_PPG_TASK_CORE, &s_task) != pdPASS)
+        return false;
+
+    if (int_pin >= 0) {
+        gpio_add_raw_irq_handler((uint)int_pin, max30101_gpio_irq);
+        gpio_set_irq_enabled((uint)int_pin, GPIO_IRQ_EDGE_FALL, true);
+        irq_set_enabled(IO_IRQ_BANK0, true);
+    }
+    return true;
+}
+
+bool max30101_ppg_latest(ppg_result_t *out)
+{
+    taskENTER_CRITICAL();
+    bool ok = s_result.valid;
+    if (ok) *out = s_result;
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+void max30101_ppg_get_stats(max30101_ppg_stats_t *out)
+{
+    taskENTER_CRITICAL();
+    *out = s_stats;
+    taskEXIT_CRITICAL();
+}
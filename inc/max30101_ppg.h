@@ -0,0 +1,52 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/i2c_bus.h"
+#include "inc/ppg_dsp.h"
+
+// Aquisição do MAX30101 por lotes: a interrupção A_FULL (INT, ativo em nível
+// baixo) acorda uma tarefa que esvazia a FIFO inteira numa só leitura em rajada
+// e passa o lote pelo processamento de inc/ppg_dsp.c. Só os valores derivados
+// (BPM, SpO2) ficam disponíveis para publicação; as amostras brutas não saem da tarefa.
+
+#ifndef MAX30101_PPG_FREE_SLOTS
+#define MAX30101_PPG_FREE_SLOTS 8     // A_FULL com 24 amostras na FIFO (~1 s a 25 Hz)
+#endif
+
+// Sem borda de INT dentro deste prazo a FIFO é consultada mesmo assim (borda
+// perdida); abaixo dos 32 níveis a 25 Hz, acima do A_FULL
+#ifndef MAX30101_PPG_FALLBACK_MS
+#define MAX30101_PPG_FALLBACK_MS 1200
+#endif
+
+// Período de leitura sem linha INT: meia FIFO por consulta
+#ifndef MAX30101_PPG_POLL_MS
+#define MAX30101_PPG_POLL_MS 640
+#endif
+
+typedef struct {
+    uint32_t interrupts;
+    uint32_t batches;         // leituras da FIFO com pelo menos uma amostra
+    uint32_t samples;
+    uint32_t max_batch;
+    uint32_t overflows;       // amostras perdidas (OVF_COUNTER)
+    uint32_t fallback_polls;
+    uint32_t read_errors;
+} max30101_ppg_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Habilita A_FULL e cria a tarefa. O sensor já deve ter passado por max30101_init().
+// int_pin < 0 (ou linha INT que nunca dispara): a FIFO é lida a cada MAX30101_PPG_POLL_MS.
+bool max30101_ppg_start(i2c_bus_id_t bus, uint8_t addr, int int_pin);
+
+// Últimos valores derivados (BPM x10, SpO2 x10). false sem medição válida
+// (sem dedo no sensor ou filtros ainda acomodando).
+bool max30101_ppg_latest(ppg_result_t *out);
+void max30101_ppg_get_stats(max30101_ppg_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,120 @@
+#include "inc/mqtt_tls.h"
+#include <string.h>
+#include "pico/stdlib.h"
+#include "lwip/altcp_tls.h"
+#include "mbedtls/ssl.h"
+#include "inc/log_async.h"
+
+// mbedTLS 3.x esconde os campos da sessão atrás de MBEDTLS_PRIVATE (o
+// mbedtls_config.h libera com MBEDTLS_ALLOW_PRIVATE_ACCESS); no 2.x são públicos
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(m) m
+#endif
+
+static struct altcp_tls_config *s_config;
+static mbedtls_ssl_session s_sessao;
+static bool s_sessao_ok;
+static char s_host[MQTT_TLS_HOST_MAX + 1];   // host dono da sessão guardada
+static bool s_oferecida;                      // a tentativa em curso ofereceu a sessão
+static uint32_t s_ofertas_sem_sucesso;
+static uint64_t s_inicio_us;
+static mqtt_tls_stats_t s_stats;
+
+static void esquecer_sessao(void)
+{
+    mbedtls_ssl_session_free(&s_sessao);
+    mbedtls_ssl_session_init(&s_sessao);
+    s_sessao_ok = false;
+    s_ofertas_sem_sucesso = 0;
+}
+
+bool mqtt_tls_init(const char *ca_pem)
+{
+    mbedtls_ssl_session_init(&s_sessao);
+    if (ca_pem)
+        s_config = altcp_tls_create_config_client((const u8_t *)ca_pem, strlen(ca_pem) + 1);
+    else
+    {
+        LOG_W("[TLS] Sem CA (MQTT_TLS_INSECURE): certificado do broker NÃO verificado\n");
+        s_config = altcp_tls_create_config_client(NULL, 0);
+    }
+    return s_config != NULL;
+}
+
+struct altcp_tls_config *mqtt_tls_config(void)
+{
+    return s_config;
+}
+
+void mqtt_tls_start(struct altcp_pcb *conn, const char *host)
+{
+    mbedtls_ssl_context *ssl = altcp_tls_context(conn);
+    s_inicio_us = time_us_64();
+    s_oferecida = false;
+    if (!ssl)
+        return;
+
+    // SNI: brokers atrás de um proxy ou com vários certificados escolhem por ele
+    mbedtls_ssl_set_hostname(ssl, host);
+
+    if (strncmp(host, s_host, MQTT_TLS_HOST_MAX) != 0)
+    {
+        esquecer_sessao();
+        strncpy(s_host, host, MQTT_TLS_HOST_MAX);
+    }
+    else if (s_sessao_ok)
+    {
+        s_oferecida = mbedtls_ssl_set_session(ssl, &s_sessao) == 0;
+    }
+}
+
+void mqtt_tls_established(struct altcp_pcb *conn)
+{
+    mbedtls_ssl_context *ssl = altcp_tls_context(conn);
+    uint32_t ms = (uint32_t)((time_us_64() - s_inicio_us) / 1000);
+    if (!ssl)
+        return;
+
+    // Retomada: o broker aceitou a sessão oferecida e o segredo mestre é o
+    // mesmo; num handshake completo ele é derivado de novo
+    const mbedtls_ssl_session *atual = ssl->MBEDTLS_PRIVATE(session);
+    bool retomada = s_oferecida && atual &&
+                    memcmp(atual->MBEDTLS_PRIVATE(master), s_sessao.MBEDTLS_PRIVATE(master),
+                           sizeof s_sessao.MBEDTLS_PRIVATE(master)) == 0;
+    if (retomada)
+    {
+        bool ticket = s_sessao.MBEDTLS_PRIVATE(ticket_len) > 0;
+        s_stats.resumed++;
+        s_stats.resumed_ticket += ticket;
+        s_stats.last_resumed_ms = ms;
+        LOG_I("[TLS] Sessão retomada em %lu ms (ticket %d)\n", (unsigned long)ms, (int)ticket);
+    }
+    else
+    {
+        s_stats.full++;
+        s_stats.last_full_ms = ms;
+        LOG_I("[TLS] Handshake completo em %lu ms\n", (unsigned long)ms);
+    }
+
+    // Guarda a sessão desta conexão (com o ticket novo, se veio) para a próxima
+    esquecer_sessao();
+    s_sessao_ok = mbedtls_ssl_get_session(ssl, &s_sessao) == 0;
+}
+
+void mqtt_tls_failed(void)
+{
+    s_stats.failures++;
+    // Broker fora do ar também falha aqui; só depois de algumas ofertas
+    // seguidas a sessão deixa de ser tentada
+    if (s_oferecida && ++s_ofertas_sem_sucesso >= MQTT_TLS_OFFER_RETRIES)
+    {
+        LOG_W("[TLS] Sessão descartada depois de %d tentativas\n", MQTT_TLS_OFFER_RETRIES);
+        esquecer_sessao();
+    }
+    s_oferecida = false;
+}
+
+void mqtt_tls_get_stats(mqtt_tls_stats_t *out)
+{
+    *out = s_stats;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+
+// Transporte TLS do MQTT (MQTT_TLS=1): altcp_tls do lwIP sobre o mbedTLS do
+// pico-sdk, TLS 1.2 só com ECDHE + AES-128-GCM (mbedtls_config.h).
+//
+// O gerenciador da conexão (inc/net_conn.c) chama mqtt_tls_start() logo depois
+// do mqtt_client_connect(), ainda com o lwIP travado: o ClientHello só sai
+// quando o TCP sobe, então dá tempo de pôr o SNI (e o nome conferido no
+// certificado) e de oferecer a sessão guardada, sem o patch do lwIP
+// (mqtt-sni.patch).
+//
+// Retomada: depois de cada CONNACK a sessão negociada (ID de sessão e, se o
+// broker mandou, o ticket) é guardada em RAM para o mesmo host. A reconexão
+// seguinte a oferece, e um broker que a aceita pula o ECDHE, a assinatura e a
+// cadeia de certificados: uma ida e volta a menos e nenhuma conta de curva
+// elíptica no M0+. O broker que recusa cai no handshake completo sem erro.
+// Uma sessão oferecida em MQTT_TLS_OFFER_RETRIES tentativas seguidas sem
+// sucesso é descartada.
+
+#ifndef MQTT_TLS_OFFER_RETRIES
+#define MQTT_TLS_OFFER_RETRIES 3
+#endif
+
+#define MQTT_TLS_HOST_MAX 63
+
+struct altcp_pcb;
+struct altcp_tls_config;
+
+typedef struct {
+    uint32_t full;              // handshakes completos
+    uint32_t resumed;           // sessões retomadas (por ID ou ticket)
+    uint32_t resumed_ticket;    // das retomadas, as que usaram ticket
+    uint32_t failures;          // tentativas sem CONNACK
+    uint32_t last_full_ms;      // do connect ao CONNACK (TCP + TLS + MQTT)
+    uint32_t last_resumed_ms;
+} mqtt_tls_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Configuração do cliente com a CA do broker em PEM (terminada em NUL); NULL
+// aceita qualquer certificado (só para testes, MQTT_TLS_INSECURE=1) e fica
+// registrado no log. Depois de cyw43_arch_init().
+bool mqtt_tls_init(const char *ca_pem);
+
+// Para mqtt_connect_client_info_t.tls_config
+struct altcp_tls_config *mqtt_tls_config(void);
+
+// Conexão recém-criada pelo mqtt_client_connect(), com o lwIP travado: SNI e
+// sessão guardada, se for do mesmo host
+void mqtt_tls_start(struct altcp_pcb *conn, const char *host);
+
+// CONNACK recebido (lwIP travado): conta o handshake e guarda a sessão
+void mqtt_tls_established(struct altcp_pcb *conn);
+
+// Tentativa sem CONNACK
+void mqtt_tls_failed(void);
+
+void mqtt_tls_get_stats(mqtt_tls_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,125 @@
+#include "inc/mqtt_transport.h"
+#include <errno.h>
+#include <string.h>
+#include "lwip/sockets.h"
+
+// Vetores por lwip_writev(): o PUBLISH usa até 4, o SUBSCRIBE até
+// MQTT_SUB_UNSUB_MAX_VECTORS
+#define IOV_MAX_LOTE 8
+
+static bool sem_dados(void)
+{
+    return errno == EWOULDBLOCK || errno == EAGAIN;
+}
+
+static int esperar(int fd, bool escrita, uint32_t timeout_ms)
+{
+    fd_set fds;
+    FD_ZERO(&fds);
+    FD_SET(fd, &fds);
+    struct timeval tv = {.tv_sec = timeout_ms / 1000, .tv_usec = (timeout_ms % 1000) * 1000};
+    return lwip_select(fd + 1, escrita ? NULL : &fds, escrita ? &fds : NULL, NULL, &tv);
+}
+
+bool mqtt_transport_connect(NetworkContext_t *ctx, uint32_t addr, uint16_t port, uint32_t timeout_ms)
+{
+    ctx->fd = lwip_socket(AF_INET, SOCK_STREAM, 0);
+    if (ctx->fd < 0)
+        return false;
+
+    struct sockaddr_in sa;
+    memset(&sa, 0, sizeof sa);
+    sa.sin_family = AF_INET;
+    sa.sin_port = lwip_htons(port);
+    sa.sin_addr.s_addr = addr;
+
+    // Não bloqueante só no connect(), para o prazo valer também para o SYN
+    lwip_fcntl(ctx->fd, F_SETFL, O_NONBLOCK);
+    int r = lwip_connect(ctx->fd, (struct sockaddr *)&sa, sizeof sa);
+    if (r < 0 && errno == EINPROGRESS && esperar(ctx->fd, true, timeout_ms) == 1) {
+        int erro = 0;
+        socklen_t n = sizeof erro;
+        r = lwip_getsockopt(ctx->fd, SOL_SOCKET, SO_ERROR, &erro, &n) == 0 && erro == 0 ? 0 : -1;
+    }
+    lwip_fcntl(ctx->fd, F_SETFL, 0);
+
+    const struct timeval prazo = {
+        .tv_sec = MQTT_TRANSPORT_SEND_TIMEOUT_MS / 1000,
+        .tv_usec = (MQTT_TRANSPORT_SEND_TIMEOUT_MS % 1000) * 1000,
+    };
+    const int um = 1;
+    if (r != 0 || lwip_setsockopt(ctx->fd, SOL_SOCKET, SO_SNDTIMEO, &prazo, sizeof prazo) != 0) {
+        mqtt_transport_close(ctx);
+        return false;
+    }
+    // Publicações pequenas saem na hora, sem esperar o ACK da anterior (Nagle)
+    lwip_setsockopt(ctx->fd, IPPROTO_TCP, TCP_NODELAY, &um, sizeof um);
+    return true;
+}
+
+void mqtt_transport_close(NetworkContext_t *ctx)
+{
+    if (ctx->fd >= 0)
+        lwip_close(ctx->fd);
+    ctx->fd = -1;
+}
+
+int mqtt_transport_wait(NetworkContext_t *ctx, uint32_t timeout_ms)
+{
+    if (ctx->fd < 0)
+        return -1;
+    int r = esperar(ctx->fd, false, timeout_ms);
+    return r < 0 ? -1 : r > 0;
+}
+
+static int32_t transporte_recv(NetworkContext_t *ctx, void *buf, size_t len)
+{
+    int pronto = mqtt_transport_wait(ctx, MQTT_TRANSPORT_RECV_WAIT_MS);
+    if (pronto <= 0)
+        return pronto;
+    int r = lwip_recv(ctx->fd, buf, len, MSG_DONTWAIT);
+    if (r > 0)
+        return r;
+    // select() pronto e nada lido: conexão fechada pelo broker
+    return r < 0 && sem_dados() ? 0 : -1;
+}
+
+static int32_t transporte_send(NetworkContext_t *ctx, const void *buf, size_t len)
+{
+    int r = lwip_send(ctx->fd, buf, len, 0);
+    return r >= 0 ? r : -1;
+}
+
+static int32_t transporte_writev(NetworkContext_t *ctx, TransportOutVector_t *vec, size_t n)
+{
+    struct iovec iov[IOV_MAX_LOTE];
+    int32_t total = 0;
+    while (n > 0) {
+        size_t k = n < IOV_MAX_LOTE ? n : IOV_MAX_LOTE;
+        size_t esperado = 0;
+        for (size_t i = 0; i < k; ++i) {
+            iov[i].iov_base = (void *)vec[i].iov_base;
+            iov[i].iov_len = vec[i].iov_len;
+            esperado += vec[i].iov_len;
+        }
+        int r = lwip_writev(ctx->fd, iov, (int)k);
+        if (r < 0)
+            return total > 0 ? total : -1;
+        total += r;
+        // Envio parcial: o coreMQTT chama de novo com o que faltou
+        if ((size_t)r < esperado)
+            break;
+        vec += k;
+        n -= k;
+    }
+    return total;
+}
+
+void mqtt_transport_interface(NetworkContext_t *ctx, TransportInterface_t *out)
+{
+    memset(out, 0, sizeof *out);
+    out->pNetworkContext = ctx;
+    out->recv = transporte_recv;
+    out->send = transporte_send;
+    out->writev = transporte_writev;
+}
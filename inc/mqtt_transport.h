@@ -0,0 +1,45 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "transport_interface.h"
+
+// Transporte do coreMQTT (MQTT_STACK=coremqtt) sobre os sockets do lwIP
+// (LWIP_SOCKET=1): TCP simples, sem TLS.
+//
+// O coreMQTT não tem laço próprio: quem chama MQTT_ProcessLoop() (a tarefa de
+// conexão, inc/net_conn.c) espera os dados com mqtt_transport_wait() e só então
+// entra na biblioteca. recv() espera no máximo MQTT_TRANSPORT_RECV_WAIT_MS e
+// devolve 0 sem dados, como o coreMQTT espera; o par que fechou a conexão vira
+// erro. send() e writev() bloqueiam até MQTT_TRANSPORT_SEND_TIMEOUT_MS
+// (SO_SNDTIMEO); writev() entrega o cabeçalho e o payload do PUBLISH numa
+// chamada só, sem cópia para um buffer intermediário.
+
+#ifndef MQTT_TRANSPORT_RECV_WAIT_MS
+#define MQTT_TRANSPORT_RECV_WAIT_MS 10
+#endif
+
+#ifndef MQTT_TRANSPORT_SEND_TIMEOUT_MS
+#define MQTT_TRANSPORT_SEND_TIMEOUT_MS 5000
+#endif
+
+struct NetworkContext {
+    int fd;                     // < 0 sem conexão
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// TCP até addr (IPv4, ordem de rede, como ip_addr_t.addr):port em até timeout_ms
+bool mqtt_transport_connect(NetworkContext_t *ctx, uint32_t addr, uint16_t port, uint32_t timeout_ms);
+void mqtt_transport_close(NetworkContext_t *ctx);
+
+// 1 com dados (ou fim de conexão) para ler, 0 no prazo esgotado, -1 sem conexão
+int mqtt_transport_wait(NetworkContext_t *ctx, uint32_t timeout_ms);
+
+// recv/send/writev para MQTT_Init()
+void mqtt_transport_interface(NetworkContext_t *ctx, TransportInterface_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,625 @@
+#include "inc/net_conn.h"
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include "pico/stdlib.h"
+#include "pico/rand.h"
+#include "pico/cyw43_arch.h"
+#include "lwip/dns.h"
+#include "backoff_algorithm.h"
+#include "inc/task_cores.h"
+#include "inc/log_async.h"
+#include "inc/cbor.h"
+#if MQTT_COREMQTT
+#include "semphr.h"
+#include "core_mqtt.h"
+#include "inc/mqtt_transport.h"
+#else
+#include "lwip/apps/mqtt.h"
+#endif
+#if MQTT_TLS
+#include "lwip/apps/mqtt_priv.h"
+#include "inc/mqtt_tls.h"
+#endif
+
+_Static_assert(NET_CONN_BACKOFF_MAX_MS <= UINT16_MAX, "backoffAlgorithm limita a espera a uint16_t");
+#if MQTT_COREMQTT && MQTT_TLS
+#error "MQTT_STACK=coremqtt ainda não tem transporte TLS"
+#endif
+
+// Bits do grupo de eventos: os callbacks do lwIP (tcpip_thread) sinalizam, a tarefa espera
+#define EV_DNS (1u << 0)
+#define EV_CONNACK (1u << 1)
+#define EV_QUEDA (1u << 2)
+#define EV_BROKER (1u << 3)
+#define EV_SUB_ERRO (1u << 4)
+#define EV_SUBACK(i) (1u << (8 + (i)))
+#define EV_SUBACKS (((1u << NET_CONN_MAX_SUBS) - 1) << 8)
+
+static net_conn_config_t s_cfg;
+static EventGroupHandle_t s_eventos;
+static volatile net_conn_state_t s_estado;
+static net_conn_stats_t s_stats;
+
+// Broker pedido (net_conn_set_broker) e o que a tarefa está usando
+static char s_host[NET_CONN_HOST_MAX + 1];
+static uint16_t s_porta;
+static ip_addr_t s_endereco;
+static uint16_t s_porta_atual;
+#if MQTT_TLS
+static char s_host_atual[NET_CONN_HOST_MAX + 1];   // SNI e dono da sessão TLS
+#endif
+
+// Resposta do DNS; a consulta que esgotou o prazo ainda pode responder depois
+static ip_addr_t s_resolvido;
+static volatile uint32_t s_consulta;
+
+#if MQTT_COREMQTT
+static NetworkContext_t s_rede = {.fd = -1};
+static MQTTContext_t s_mqtt;
+static uint8_t s_buffer[NET_CONN_MQTT_BUFFER];
+static MQTTPubAckInfo_t s_qos_saida[NET_CONN_QOS_RECORDS];
+static MQTTPubAckInfo_t s_qos_entrada[NET_CONN_QOS_RECORDS];
+// O coreMQTT não é reentrante: ProcessLoop() na tarefa de conexão, PUBLISH em quem publica
+static SemaphoreHandle_t s_trava;
+static uint16_t s_sub_pid;
+static char s_topico[NET_CONN_TOPIC_MAX + 1];
+#else
+static mqtt_client_t *s_cliente;
+static struct mqtt_connect_client_info_t s_info;
+static mqtt_connection_status_t s_status;
+#endif
+static BackoffAlgorithmContext_t s_backoff;
+static uint32_t s_inicio_ms;     // início da tentativa em curso (boot, queda ou troca de broker)
+static bool s_reserva;           // próxima consulta usa o host reserva
+
+static uint32_t agora_ms(void)
+{
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+static void dns_cb(const char *name, const ip_addr_t *ipaddr, void *arg)
+{
+    (void)name;
+    if ((uint32_t)(uintptr_t)arg != s_consulta)
+        return;
+    if (ipaddr)
+        s_resolvido = *ipaddr;
+    xEventGroupSetBits(s_eventos, EV_DNS);
+}
+
+#if MQTT_COREMQTT
+static uint32_t agora_ms_mqtt(void)
+{
+    return agora_ms();
+}
+
+// Pacotes recebidos, de dentro do MQTT_ProcessLoop() (tarefa de conexão, com s_trava)
+_Static_assert(MQTT_STREAM_LARGE_PUBLISH == 1, "payload em pedaços (core_mqtt_config.h)");
+// Cabeçalho fixo (até 5 B), tópico com o tamanho e packet ID, e ainda sobra
+_Static_assert(NET_CONN_MQTT_BUFFER > 5 + 2 + NET_CONN_TOPIC_MAX + 2, "tópico cabe no buffer de recepção");
+
+static void evento_cb(MQTTContext_t *ctx, MQTTPacketInfo_t *pacote, MQTTDeserializedInfo_t *info)
+{
+    (void)ctx;
+    if ((pacote->type & 0xF0U) == MQTT_PACKET_TYPE_PUBLISH)
+    {
+        // Payload maior que o buffer chega em pedaços, como no lwIP: o tópico e
+        // o tamanho total só no primeiro
+        const MQTTPublishInfo_t *pub = info->pPublishInfo;
+        if (info->payloadOffset == 0)
+        {
+            // O tópico vem dentro do pacote, sem NUL; os callbacks esperam o do lwIP
+            size_t n = pub->topicNameLength < NET_CONN_TOPIC_MAX ? pub->topicNameLength : NET_CONN_TOPIC_MAX;
+            memcpy(s_topico, pub->pTopicName, n);
+            s_topico[n] = '\0';
+            if (s_cfg.pub_cb)
+                s_cfg.pub_cb(NULL, s_topico, (uint32_t)info->payloadTotalLength);
+        }
+        bool ultimo = info->payloadOffset + pub->payloadLength == info->payloadTotalLength;
+        if (s_cfg.data_cb)
+            s_cfg.data_cb(NULL, pub->pPayload, (uint16_t)pub->payloadLength, ultimo ? NET_CONN_DATA_LAST : 0);
+    }
+    else if (pacote->type == MQTT_PACKET_TYPE_SUBACK && info->packetIdentifier == s_sub_pid)
+    {
+        // Um SUBSCRIBE com todos os filtros: um SUBACK com um código por filtro
+        uint8_t *codigos;
+        size_t n;
+        bool ok = MQTT_GetSubAckStatusCodes(pacote, &codigos, &n) == MQTTSuccess && n == s_cfg.sub_count;
+        for (size_t i = 0; ok && i < n; ++i)
+            ok = codigos[i] != (uint8_t)MQTTSubAckFailure;
+        xEventGroupSetBits(s_eventos, ok ? EV_SUBACKS : EV_SUB_ERRO);
+    }
+}
+
+// Espera dados até espera_ms e passa uma vez pelo coreMQTT (entrada e keep-alive)
+static bool processar(uint32_t espera_ms)
+{
+    if (mqtt_transport_wait(&s_rede, espera_ms) < 0)
+        return false;
+    xSemaphoreTake(s_trava, portMAX_DELAY);
+    MQTTStatus_t st = MQTT_ProcessLoop(&s_mqtt);
+    xSemaphoreGive(s_trava);
+    if (st == MQTTSuccess || st == MQTTNeedMoreBytes)
+        return true;
+    LOG_W("[MQTT] Erro no coreMQTT: %d\n", (int)st);
+    return false;
+}
+#else
+_Static_assert(NET_CONN_DATA_LAST == MQTT_DATA_FLAG_LAST, "flags de data_cb repassadas do lwIP");
+
+static void conexao_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status)
+{
+    (void)client;
+    (void)arg;
+    s_status = status;
+    xEventGroupSetBits(s_eventos, status == MQTT_CONNECT_ACCEPTED ? EV_CONNACK : EV_QUEDA);
+}
+
+static void assinatura_cb(void *arg, err_t err)
+{
+    xEventGroupSetBits(s_eventos, err == ERR_OK ? EV_SUBACK((uintptr_t)arg) : EV_SUB_ERRO);
+}
+#endif
+
+static void reiniciar_backoff(void)
+{
+    BackoffAlgorithm_InitializeParams(&s_backoff, NET_CONN_BACKOFF_BASE_MS, NET_CONN_BACKOFF_MAX_MS,
+                                      BACKOFF_ALGORITHM_RETRY_FOREVER);
+}
+
+static bool enlace_ok(void)
+{
+    cyw43_arch_lwip_begin();
+    int st = cyw43_tcpip_link_status(&cyw43_state, CYW43_ITF_STA);
+    cyw43_arch_lwip_end();
+    return st == CYW43_LINK_UP;
+}
+
+// Espera um dos bits até o prazo; a troca de broker interrompe qualquer espera
+static EventBits_t esperar(EventBits_t bits, uint32_t prazo_ms)
+{
+    return xEventGroupWaitBits(s_eventos, bits | EV_BROKER, pdFALSE, pdFALSE, pdMS_TO_TICKS(prazo_ms));
+}
+
+static bool associar(void)
+{
+    if (enlace_ok())
+        return true;
+    printf("[Wi-Fi] Conectando a %s...\n", s_cfg.ssid);
+    if (cyw43_arch_wifi_connect_timeout_ms(s_cfg.ssid, s_cfg.password, s_cfg.auth, NET_CONN_WIFI_TIMEOUT_MS) == 0)
+    {
+        LOG_I("[Wi-Fi] Online\n");
+        return true;
+    }
+    s_stats.wifi_failures++;
+    return false;
+}
+
+// Host configurado que não resolve: a consulta seguinte tenta o reserva, para o
+// dispositivo continuar alcançável e poder receber uma configuração corrigida
+static bool resolver(void)
+{
+    char host[NET_CONN_HOST_MAX + 1];
+    uint16_t porta;
+    taskENTER_CRITICAL();
+    memcpy(host, s_host, sizeof host);
+    porta = s_porta;
+    taskEXIT_CRITICAL();
+    if (s_reserva && s_cfg.fallback_host)
+    {
+        strncpy(host, s_cfg.fallback_host, NET_CONN_HOST_MAX);
+        porta = s_cfg.fallback_port;
+    }
+
+    printf("[DNS] Resolvendo %s...\n", host);
+    xEventGroupClearBits(s_eventos, EV_DNS);
+    s_resolvido.addr = 0;
+    cyw43_arch_lwip_begin();
+    // ERR_OK: já estava no cache e foi escrito direto; ERR_INPROGRESS: dns_cb responde depois
+    err_t err = dns_gethostbyname(host, &s_resolvido, dns_cb, (void *)(uintptr_t)++s_consulta);
+    cyw43_arch_lwip_end();
+    if (err == ERR_INPROGRESS)
+        esperar(EV_DNS, NET_CONN_DNS_TIMEOUT_MS);
+    s_consulta++;
+
+    if (s_resolvido.addr == 0)
+    {
+        printf("[DNS] %s não resolvido\n", host);
+        s_stats.dns_failures++;
+        s_reserva = !s_reserva;
+        return false;
+    }
+    printf("[DNS] Resolvido: %s\n", ip4addr_ntoa(&s_resolvido));
+    s_endereco = s_resolvido;
+    s_porta_atual = porta;
+#if MQTT_TLS
+    memcpy(s_host_atual, host, sizeof s_host_atual);
+#endif
+    return true;
+}
+
+#if MQTT_COREMQTT
+// Desfaz a sessão, completa ou pela metade; quem publica passa a receber false
+static void desconectar(void)
+{
+    xSemaphoreTake(s_trava, portMAX_DELAY);
+    if (s_mqtt.connectStatus == MQTTConnected)
+        MQTT_Disconnect(&s_mqtt);
+    s_mqtt.connectStatus = MQTTNotConnected;
+    mqtt_transport_close(&s_rede);
+    xSemaphoreGive(s_trava);
+}
+
+// TCP pelo socket e CONNECT; MQTT_Connect() espera o CONNACK no próprio socket
+static bool conectar(void)
+{
+    xEventGroupClearBits(s_eventos, EV_QUEDA);
+    if (!mqtt_transport_connect(&s_rede, s_endereco.addr, s_porta_atual, NET_CONN_CONNECT_TIMEOUT_MS))
+    {
+        LOG_W("[MQTT] Erro na conexão TCP\n");
+        s_stats.connect_failures++;
+        return false;
+    }
+
+    // Contexto refeito a cada conexão: nada de um pacote pela metade da sessão anterior
+    TransportInterface_t transporte;
+    mqtt_transport_interface(&s_rede, &transporte);
+    const MQTTFixedBuffer_t buffer = {.pBuffer = s_buffer, .size = sizeof s_buffer};
+    const MQTTConnectInfo_t info = {
+        .cleanSession = true,
+        .keepAliveSeconds = s_cfg.keep_alive_s,
+        .pClientIdentifier = s_cfg.client_id,
+        .clientIdentifierLength = (uint16_t)strlen(s_cfg.client_id),
+    };
+    bool sessao_presente;
+    xSemaphoreTake(s_trava, portMAX_DELAY);
+    MQTTStatus_t st = MQTT_Init(&s_mqtt, &transporte, agora_ms_mqtt, evento_cb, &buffer);
+    if (st == MQTTSuccess)
+        st = MQTT_InitStatefulQoS(&s_mqtt, s_qos_saida, NET_CONN_QOS_RECORDS, s_qos_entrada, NET_CONN_QOS_RECORDS);
+    if (st == MQTTSuccess)
+        st = MQTT_Connect(&s_mqtt, &info, NULL, NET_CONN_CONNECT_TIMEOUT_MS, &sessao_presente);
+    xSemaphoreGive(s_trava);
+    if (st == MQTTSuccess)
+        return true;
+    if (st == MQTTServerRefused)
+    {
+        LOG_W("[MQTT] Conexão recusada pelo broker\n");
+        s_stats.refused++;
+    }
+    else
+    {
+        LOG_W("[MQTT] Erro na conexão: coreMQTT %d\n", (int)st);
+        s_stats.connect_failures++;
+    }
+    return false;
+}
+
+static bool assinar(void)
+{
+    MQTTSubscribeInfo_t subs[NET_CONN_MAX_SUBS];
+    EventBits_t todas = 0;
+    for (size_t i = 0; i < s_cfg.sub_count; ++i)
+    {
+        subs[i] = (MQTTSubscribeInfo_t){
+            .qos = (MQTTQoS_t)s_cfg.subs[i].qos,
+            .pTopicFilter = s_cfg.subs[i].topic,
+            .topicFilterLength = (uint16_t)strlen(s_cfg.subs[i].topic),
+        };
+        todas |= EV_SUBACK(i);
+    }
+    xEventGroupClearBits(s_eventos, EV_SUBACKS | EV_SUB_ERRO);
+    xSemaphoreTake(s_trava, portMAX_DELAY);
+    s_sub_pid = MQTT_GetPacketId(&s_mqtt);
+    MQTTStatus_t st = MQTT_Subscribe(&s_mqtt, subs, s_cfg.sub_count, s_sub_pid);
+    xSemaphoreGive(s_trava);
+
+    // O SUBACK chega pelo ProcessLoop(); até ele, o erro, a troca de broker ou o prazo
+    uint32_t limite = agora_ms() + NET_CONN_SUBSCRIBE_TIMEOUT_MS;
+    EventBits_t b = 0;
+    bool ok = st == MQTTSuccess;
+    while (ok && (b & todas) != todas && !(b & (EV_SUB_ERRO | EV_BROKER)))
+    {
+        int32_t falta = (int32_t)(limite - agora_ms());
+        if (falta <= 0)
+            break;
+        ok = processar(falta < NET_CONN_RX_POLL_MS ? (uint32_t)falta : NET_CONN_RX_POLL_MS);
+        b = xEventGroupGetBits(s_eventos);
+    }
+    if (ok && (b & todas) == todas)
+        return true;
+    if (!(b & EV_BROKER))
+    {
+        LOG_W("[MQTT] Assinaturas não confirmadas (coreMQTT %d)\n", (int)st);
+        s_stats.subscribe_failures++;
+    }
+    return false;
+}
+#else
+static void desconectar(void)
+{
+    cyw43_arch_lwip_begin();
+    mqtt_disconnect(s_cliente);
+    cyw43_arch_lwip_end();
+}
+
+static bool conectar(void)
+{
+    xEventGroupClearBits(s_eventos, EV_CONNACK | EV_QUEDA);
+    cyw43_arch_lwip_begin();
+    // Resto de uma tentativa anterior: desconectar não chama o callback
+    mqtt_disconnect(s_cliente);
+    err_t err = mqtt_client_connect(s_cliente, &s_endereco, s_porta_atual, conexao_cb, NULL, &s_info);
+    // mqtt_client_connect() zera o cliente: os callbacks de entrada voltam a cada conexão
+    mqtt_set_inpub_callback(s_cliente, s_cfg.pub_cb, s_cfg.data_cb, NULL);
+#if MQTT_TLS
+    // O handshake só começa quando o TCP sobe, depois de soltar o lwIP
+    if (err == ERR_OK)
+        mqtt_tls_start(s_cliente->conn, s_host_atual);
+#endif
+    cyw43_arch_lwip_end();
+
+    EventBits_t b = err == ERR_OK ? esperar(EV_CONNACK | EV_QUEDA, NET_CONN_CONNECT_TIMEOUT_MS) : 0;
+#if MQTT_TLS
+    cyw43_arch_lwip_begin();
+    if ((b & EV_CONNACK) && s_cliente->conn)
+        mqtt_tls_established(s_cliente->conn);
+    else if (!(b & EV_BROKER))
+        mqtt_tls_failed();
+    cyw43_arch_lwip_end();
+#endif
+    if (b & EV_CONNACK)
+        return true;
+    if (b & EV_BROKER)
+        return false;
+    if ((b & EV_QUEDA) && s_status < MQTT_CONNECT_DISCONNECTED)
+    {
+        LOG_W("[MQTT] Conexão recusada pelo broker: %d\n", (int)s_status);
+        s_stats.refused++;
+    }
+    else
+    {
+        LOG_W("[MQTT] Erro na conexão: %d (err %d)\n", (int)((b & EV_QUEDA) ? s_status : MQTT_CONNECT_TIMEOUT), (int)err);
+        s_stats.connect_failures++;
+    }
+    return false;
+}
+
+static bool assinar(void)
+{
+    EventBits_t todas = 0;
+    err_t err = ERR_OK;
+    xEventGroupClearBits(s_eventos, EV_SUBACKS | EV_SUB_ERRO);
+    cyw43_arch_lwip_begin();
+    for (size_t i = 0; i < s_cfg.sub_count && err == ERR_OK; ++i)
+    {
+        err = mqtt_sub_unsub(s_cliente, s_cfg.subs[i].topic, s_cfg.subs[i].qos, assinatura_cb, (void *)(uintptr_t)i, 1);
+        todas |= EV_SUBACK(i);
+    }
+    cyw43_arch_lwip_end();
+
+    // Todos os SUBACK, ou o primeiro erro, a queda ou o prazo
+    uint32_t limite = agora_ms() + NET_CONN_SUBSCRIBE_TIMEOUT_MS;
+    EventBits_t b = 0;
+    while (err == ERR_OK && (b & todas) != todas && !(b & (EV_SUB_ERRO | EV_QUEDA | EV_BROKER)))
+    {
+        int32_t falta = (int32_t)(limite - agora_ms());
+        if (falta <= 0)
+            break;
+        b = esperar(todas | EV_SUB_ERRO | EV_QUEDA, (uint32_t)falta);
+    }
+    if (err == ERR_OK && (b & todas) == todas)
+        return true;
+    if (!(b & EV_BROKER))
+    {
+        LOG_W("[MQTT] Assinaturas não confirmadas (err %d)\n", (int)err);
+        s_stats.subscribe_failures++;
+    }
+    return false;
+}
+#endif
+
+static void sessao_completa(void)
+{
+    uint32_t dt = agora_ms() - s_inicio_ms;
+    s_stats.last_connect_ms = dt;
+    if (dt > s_stats.max_connect_ms)
+        s_stats.max_connect_ms = dt;
+    s_stats.total_connect_ms += dt;
+    if (s_stats.sessions++)
+        s_stats.reconnects++;
+    reiniciar_backoff();
+    s_estado = NET_CONN_ONLINE;
+    LOG_I("[MQTT] Conectado ao broker em %lu ms (sessão %lu)\n", (unsigned long)dt, (unsigned long)s_stats.sessions);
+    if (s_cfg.on_change)
+        s_cfg.on_change(true);
+}
+
+// Online: volta quando a sessão cai, o enlace some ou o broker muda
+#if MQTT_COREMQTT
+static void manter(void)
+{
+    uint32_t proximo_enlace = agora_ms() + NET_CONN_LINK_POLL_MS;
+    while (processar(NET_CONN_RX_POLL_MS) && !(xEventGroupGetBits(s_eventos) & (EV_QUEDA | EV_BROKER)))
+    {
+        if ((int32_t)(agora_ms() - proximo_enlace) < 0)
+            continue;
+        if (!enlace_ok())
+            break;
+        proximo_enlace = agora_ms() + NET_CONN_LINK_POLL_MS;
+    }
+}
+#else
+static void manter(void)
+{
+    while (!(esperar(EV_QUEDA, NET_CONN_LINK_POLL_MS) & (EV_QUEDA | EV_BROKER)) && enlace_ok())
+        ;
+}
+#endif
+
+static void encerrar(bool queda)
+{
+    desconectar();
+    if (queda)
+    {
+        s_stats.drops++;
+        LOG_W("[MQTT] Sessão perdida\n");
+    }
+    s_inicio_ms = agora_ms();
+    s_reserva = false;
+    s_estado = NET_CONN_WIFI;
+    if (s_cfg.on_change)
+        s_cfg.on_change(false);
+}
+
+static void tarefaConexao(void *pvParameters)
+{
+    (void)pvParameters;
+    reiniciar_backoff();
+    s_inicio_ms = agora_ms();
+
+    while (1)
+    {
+        // Troca de broker: recomeça do início, sem esperar
+        if (xEventGroupClearBits(s_eventos, EV_BROKER) & EV_BROKER)
+        {
+            s_inicio_ms = agora_ms();
+            s_reserva = false;
+            reiniciar_backoff();
+        }
+
+        bool ok;
+        s_estado = NET_CONN_WIFI;
+        ok = associar();
+        if (ok)
+        {
+            s_estado = NET_CONN_DNS;
+            ok = resolver();
+        }
+        if (ok)
+        {
+            s_estado = NET_CONN_CONNECT;
+            ok = conectar();
+        }
+        if (ok)
+        {
+            s_estado = NET_CONN_SUBSCRIBE;
+            ok = assinar();
+        }
+        if (ok)
+        {
+            sessao_completa();
+            manter();
+            encerrar(!(xEventGroupGetBits(s_eventos) & EV_BROKER));
+        }
+        else
+        {
+            // Tentativa que não completou não deixa sessão pela metade
+            desconectar();
+        }
+        if (xEventGroupGetBits(s_eventos) & EV_BROKER)
+            continue;
+
+        // Jitter completo: espera sorteada entre 0 e o teto atual, que dobra a cada falha
+        uint16_t espera = 0;
+        BackoffAlgorithm_GetNextBackoff(&s_backoff, get_rand_32(), &espera);
+        s_stats.backoff_ms = espera;
+        s_estado = NET_CONN_BACKOFF;
+        LOG_D("[Conexão] Nova tentativa em %u ms\n", (unsigned)espera);
+        esperar(0, espera);
+    }
+}
+
+bool net_conn_start(const net_conn_config_t *cfg, const char *host, uint16_t port)
+{
+    if (cfg->sub_count > NET_CONN_MAX_SUBS)
+        return false;
+    s_cfg = *cfg;
+    strncpy(s_host, host, NET_CONN_HOST_MAX);
+    s_porta = port;
+    s_eventos = xEventGroupCreate();
+#if MQTT_COREMQTT
+    s_trava = xSemaphoreCreateMutex();
+    if (!s_eventos || !s_trava)
+        return false;
+#else
+    s_info.client_id = cfg->client_id;
+    s_info.keep_alive = cfg->keep_alive_s;
+#if MQTT_TLS
+    s_info.tls_config = mqtt_tls_config();
+#endif
+    cyw43_arch_lwip_begin();
+    s_cliente = mqtt_client_new();
+    cyw43_arch_lwip_end();
+    if (!s_eventos || !s_cliente)
+        return false;
+#endif
+    return task_create_on(tarefaConexao, "Conexao", NET_CONN_TASK_STACK, NULL, NET_CONN_TASK_PRIO, CORE_REDE, NULL) ==
+           pdPASS;
+}
+
+void net_conn_set_broker(const char *host, uint16_t port)
+{
+    taskENTER_CRITICAL();
+    strncpy(s_host, host, NET_CONN_HOST_MAX);
+    s_porta = port;
+    taskEXIT_CRITICAL();
+    xEventGroupSetBits(s_eventos, EV_BROKER);
+}
+
+bool net_conn_online(void)
+{
+    return s_estado == NET_CONN_ONLINE;
+}
+
+bool net_conn_publish(const char *topic, const void *payload, size_t len, uint8_t qos)
+{
+#if MQTT_COREMQTT
+    const MQTTPublishInfo_t pub = {
+        .qos = (MQTTQoS_t)qos,
+        .pTopicName = topic,
+        .topicNameLength = (uint16_t)strlen(topic),
+        .pPayload = payload,
+        .payloadLength = len,
+    };
+    xSemaphoreTake(s_trava, portMAX_DELAY);
+    MQTTStatus_t st = MQTTBadParameter;
+    if (s_mqtt.connectStatus == MQTTConnected)
+        st = MQTT_Publish(&s_mqtt, &pub, qos ? MQTT_GetPacketId(&s_mqtt) : 0);
+    xSemaphoreGive(s_trava);
+    // Envio que falhou deixa o fluxo TCP no meio de um pacote: a sessão não se recupera
+    if (st == MQTTSendFailed)
+        xEventGroupSetBits(s_eventos, EV_QUEDA);
+    return st == MQTTSuccess;
+#else
+    cyw43_arch_lwip_begin();
+    err_t err = ERR_CONN;
+    if (mqtt_client_is_connected(s_cliente))
+        err = mqtt_publish(s_cliente, topic, payload, (u16_t)len, qos, 0, NULL, NULL);
+    cyw43_arch_lwip_end();
+    return err == ERR_OK;
+#endif
+}
+
+void net_conn_get_stats(net_conn_stats_t *out)
+{
+    *out = s_stats;
+    out->state = s_estado;
+}
+
+size_t net_conn_encode(uint8_t *p)
+{
+    net_conn_stats_t st;
+    net_conn_get_stats(&st);
+    const uint32_t v[NET_CONN_CBOR_ITEMS] = {
+        st.state,         st.sessions,           st.reconnects,      st.drops,
+        st.wifi_failures, st.dns_failures,       st.connect_failures, st.refused,
+        st.subscribe_failures, st.last_connect_ms, st.max_connect_ms, st.total_connect_ms,
+    };
+    size_t len = cbor_array(p, NET_CONN_CBOR_ITEMS);
+    for (int i = 0; i < NET_CONN_CBOR_ITEMS; ++i)
+        len += cbor_uint(&p[len], v[i]);
+    return len;
+}
@@ -0,0 +1,197 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Gerenciador da conexão: Wi-Fi → DNS → TCP/MQTT → assinaturas, numa tarefa
+// própria no núcleo de rede ("Conexao").
+//
+// Cada etapa dispara a operação do lwIP/CYW43 e espera o callback num grupo de
+// eventos, com prazo próprio: nada fica em laço de consulta e nenhuma etapa
+// espera para sempre. Falha em qualquer etapa (associação, DNS, CONNACK
+// recusado ou ausente, SUBACK com erro) leva a uma espera sorteada pelo
+// backoffAlgorithm do FreeRTOS (exponencial com jitter completo, de
+// NET_CONN_BACKOFF_BASE_MS até NET_CONN_BACKOFF_MAX_MS) e volta à primeira
+// etapa que ainda falta: sem enlace, ao Wi-Fi; com enlace, ao DNS. A sessão
+// completa zera o backoff.
+//
+// Online, a tarefa espera a queda (callback do lwIP) e confere o enlace do
+// CYW43 a cada NET_CONN_LINK_POLL_MS: um AP reiniciado é percebido em segundos,
+// sem esperar o keep-alive do MQTT. Um broker novo (net_conn_set_broker) derruba
+// a sessão e recomeça pelo DNS sem backoff.
+//
+// TCP e CONNECT do MQTT são uma etapa só: o mqtt_client_connect() do lwIP não
+// avisa quando o TCP sobe. A causa da falha separa os contadores (recusa do
+// broker x queda ou prazo esgotado). Com MQTT_TLS=1 o handshake TLS também
+// entra nessa etapa, com o SNI e a sessão guardada postos por inc/mqtt_tls.c.
+//
+// Tempo até conectar: do boot, da queda ou da troca de broker até a última
+// assinatura confirmada.
+//
+// Pilha MQTT escolhida na compilação (MQTT_STACK no .env):
+//  - lwip (MQTT_COREMQTT=0): o mqtt_client do lwIP, que roda na tcpip_thread e
+//    avisa por callback; cada PUBLISH é copiado para o buffer de saída
+//    (MQTT_OUTPUT_RINGBUF_SIZE) antes de ir para o TCP.
+//  - coremqtt (MQTT_COREMQTT=1): o coreMQTT do FreeRTOS-LTS sobre os sockets do
+//    lwIP (inc/mqtt_transport.c). A biblioteca não tem tarefa própria: online,
+//    a tarefa de conexão espera dados no socket por até NET_CONN_RX_POLL_MS e
+//    roda MQTT_ProcessLoop() (entrada, PUBACK, keep-alive). O PUBLISH sai com
+//    writev, cabeçalho e payload direto do chamador. Sem TLS por enquanto.
+// Os callbacks de entrada e net_conn_publish() são os mesmos nas duas.
+
+#ifndef NET_CONN_WIFI_TIMEOUT_MS
+#define NET_CONN_WIFI_TIMEOUT_MS 15000
+#endif
+
+#ifndef NET_CONN_DNS_TIMEOUT_MS
+#define NET_CONN_DNS_TIMEOUT_MS 10000
+#endif
+
+// CONNACK; o prazo do próprio lwIP (MQTT_CONNECT_TIMOUT) é de 100 s. Com TLS,
+// o handshake completo (ECDHE e verificação da cadeia no M0+) leva segundos.
+#ifndef NET_CONN_CONNECT_TIMEOUT_MS
+#if MQTT_TLS
+#define NET_CONN_CONNECT_TIMEOUT_MS 20000
+#else
+#define NET_CONN_CONNECT_TIMEOUT_MS 10000
+#endif
+#endif
+
+#ifndef NET_CONN_SUBSCRIBE_TIMEOUT_MS
+#define NET_CONN_SUBSCRIBE_TIMEOUT_MS 10000
+#endif
+
+#ifndef NET_CONN_LINK_POLL_MS
+#define NET_CONN_LINK_POLL_MS 1000
+#endif
+
+// Teto da espera perto do intervalo fixo antigo (5 s em média), para não atrasar
+// a volta depois de uma queda longa; o backoffAlgorithm limita a 65 s (uint16_t)
+#ifndef NET_CONN_BACKOFF_BASE_MS
+#define NET_CONN_BACKOFF_BASE_MS 500
+#endif
+
+#ifndef NET_CONN_BACKOFF_MAX_MS
+#define NET_CONN_BACKOFF_MAX_MS 10000
+#endif
+
+#ifndef MQTT_COREMQTT
+#define MQTT_COREMQTT 0
+#endif
+
+#if MQTT_COREMQTT
+// Maior espera no socket entre duas passadas do laço online: limita o atraso
+// para perceber a troca de broker ou uma publicação que falhou
+#ifndef NET_CONN_RX_POLL_MS
+#define NET_CONN_RX_POLL_MS 100
+#endif
+// Recepção do coreMQTT: cabeçalho, tópico (até NET_CONN_TOPIC_MAX) e um pedaço
+// do payload; payload maior chega em pedaços (MQTT_STREAM_LARGE_PUBLISH), então
+// o comando de configuração (DEV_CONFIG_CMD_MAX) não precisa caber. O que sai
+// não passa por aqui
+#ifndef NET_CONN_MQTT_BUFFER
+#define NET_CONN_MQTT_BUFFER 128
+#endif
+// Publicações QoS 1 sem PUBACK, em cada sentido
+#ifndef NET_CONN_QOS_RECORDS
+#define NET_CONN_QOS_RECORDS 4
+#endif
+#endif
+
+// Pilha da tarefa de conexão (palavras): no coreMQTT, ProcessLoop() e a
+// serialização dos pacotes rodam nela
+#define NET_CONN_TASK_STACK_LWIP 384
+#define NET_CONN_TASK_STACK_COREMQTT 640
+#if MQTT_COREMQTT
+#define NET_CONN_TASK_STACK NET_CONN_TASK_STACK_COREMQTT
+#else
+#define NET_CONN_TASK_STACK NET_CONN_TASK_STACK_LWIP
+#endif
+
+#define NET_CONN_MAX_SUBS 8
+#define NET_CONN_HOST_MAX 63
+#define NET_CONN_TOPIC_MAX 63
+
+// flags de data_cb: último pedaço da mensagem (MQTT_DATA_FLAG_LAST do lwIP)
+#define NET_CONN_DATA_LAST 1
+
+typedef enum {
+    NET_CONN_WIFI,
+    NET_CONN_DNS,
+    NET_CONN_CONNECT,
+    NET_CONN_SUBSCRIBE,
+    NET_CONN_ONLINE,
+    NET_CONN_BACKOFF,
+} net_conn_state_t;
+
+typedef struct {
+    const char *topic;
+    uint8_t qos;
+} net_conn_sub_t;
+
+typedef struct {
+    const char *ssid;
+    const char *password;
+    uint32_t auth;
+    // Host alternado com o configurado quando o DNS falha (NULL: sem reserva)
+    const char *fallback_host;
+    uint16_t fallback_port;
+    const char *client_id;
+    uint16_t keep_alive_s;
+    const net_conn_sub_t *subs;
+    size_t sub_count;
+    // Mensagem recebida: o tópico (terminado em NUL) e o tamanho total, depois o
+    // payload em um ou mais pedaços, o último com NET_CONN_DATA_LAST. Na
+    // tcpip_thread (lwip) ou na tarefa de conexão (coremqtt); arg é sempre NULL.
+    void (*pub_cb)(void *arg, const char *topic, uint32_t tot_len);
+    void (*data_cb)(void *arg, const uint8_t *data, uint16_t len, uint8_t flags);
+    // Sessão completa (true) ou perdida (false); chamada da tarefa de conexão
+    void (*on_change)(bool online);
+} net_conn_config_t;
+
+typedef struct {
+    uint32_t state;            // net_conn_state_t
+    uint32_t sessions;         // sessões completas (CONNACK e todos os SUBACK)
+    uint32_t reconnects;       // sessões completas depois da primeira (queda ou troca de broker)
+    uint32_t drops;            // sessões perdidas (callback do lwIP ou enlace caído)
+    uint32_t wifi_failures;
+    uint32_t dns_failures;
+    uint32_t connect_failures; // TCP, queda antes do CONNACK ou prazo esgotado
+    uint32_t refused;          // CONNACK com recusa do broker
+    uint32_t subscribe_failures;
+    uint32_t last_connect_ms;  // tempo até conectar: último, maior e soma
+    uint32_t max_connect_ms;
+    uint32_t total_connect_ms;
+    uint32_t backoff_ms;       // última espera sorteada
+} net_conn_stats_t;
+
+// [state, sessions, reconnects, drops, wifi_failures, dns_failures,
+//  connect_failures, refused, subscribe_failures, last_connect_ms,
+//  max_connect_ms, total_connect_ms]
+#define NET_CONN_CBOR_ITEMS 12
+#define NET_CONN_CBOR_MAX_BYTES (1 + NET_CONN_CBOR_ITEMS * 5)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Cria o cliente MQTT e a tarefa de conexão. O CYW43 já deve ter passado por
+// cyw43_arch_init(); cfg (e o que ele aponta) precisa durar para sempre.
+bool net_conn_start(const net_conn_config_t *cfg, const char *host, uint16_t port);
+
+// Broker novo: a sessão atual cai e a conexão recomeça pelo DNS (qualquer tarefa)
+void net_conn_set_broker(const char *host, uint16_t port);
+
+// Sessão completa, com as assinaturas confirmadas
+bool net_conn_online(void);
+
+// Publica sem retain (qualquer tarefa). false sem conexão com o broker ou
+// mensagem recusada pela pilha; no coreMQTT, o erro de envio derruba a sessão.
+bool net_conn_publish(const char *topic, const void *payload, size_t len, uint8_t qos);
+
+void net_conn_get_stats(net_conn_stats_t *out);
+size_t net_conn_encode(uint8_t *p);
+
+#ifdef __cplusplus
+}
+#endif
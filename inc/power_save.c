@@ -0,0 +1,202 @@
+#include "inc/power_save.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "inc/cbor.h"
+#include "inc/log_async.h"
+#include "inc/task_cores.h"
+#if configUSE_IDLE_HOOK || configUSE_PASSIVE_IDLE_HOOK
+#include "hardware/sync.h"
+#endif
+
+_Static_assert(configGENERATE_RUN_TIME_STATS, "inc/power_save.c usa os contadores de tempo de execução do kernel");
+
+// Entre rajadas: PM1, escuta a cada POWER_SAVE_LISTEN_DTIM DTIMs. Na rajada: o
+// PM2 do SDK, que só volta a dormir 200 ms depois do último pacote.
+#ifndef POWER_SAVE_PM_IDLE
+#define POWER_SAVE_PM_IDLE cyw43_pm_value(CYW43_PM1_POWERSAVE_MODE, 10, 1, POWER_SAVE_LISTEN_DTIM, 10)
+#endif
+#ifndef POWER_SAVE_PM_BURST
+#define POWER_SAVE_PM_BURST CYW43_PERFORMANCE_PM
+#endif
+
+typedef enum {
+    RADIO_NORMAL,
+    RADIO_RAJADA,
+    RADIO_ECONOMIA,
+} radio_t;
+
+static volatile bool s_baixo_consumo;   // lido pelas tarefas ociosas
+static radio_t s_radio;
+static uint32_t s_ultimo_tx_ms;
+
+// Acumuladores em µs (carga em µA·µs) desde o boot
+static uint64_t s_marca_us;
+static configRUN_TIME_COUNTER_TYPE s_ocioso_ant[configNUMBER_OF_CORES];
+static uint64_t s_acordado_us, s_economia_us, s_ocupado_us, s_ocioso_us, s_ar_us;
+static uint64_t s_carga;
+static power_save_stats_t s_stats;
+
+static uint32_t agora_ms(void)
+{
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+// Tempo desde a última passagem no estado atual do rádio e dos núcleos
+static void contabilizar(void)
+{
+    uint64_t agora = time_us_64();
+    uint64_t dt = agora - s_marca_us;
+    s_marca_us = agora;
+
+    uint64_t carga = POWER_SAVE_UA_BASE * dt;
+    if (s_radio == RADIO_ECONOMIA) {
+        s_economia_us += dt;
+        carga += POWER_SAVE_UA_RADIO_PS * dt;
+    } else {
+        s_acordado_us += dt;
+        carga += POWER_SAVE_UA_RADIO_ON * dt;
+    }
+
+    // O ocioso de cada núcleo é o tempo de execução da sua tarefa ociosa, presa a
+    // ele por task_pin_idle(); só em baixo consumo, e com os ganchos das tarefas
+    // ociosas, ela dorme em WFI
+    bool wfi = s_baixo_consumo && configUSE_IDLE_HOOK;
+    for (int c = 0; c < configNUMBER_OF_CORES; ++c) {
+        configRUN_TIME_COUNTER_TYPE t = task_idle_run_time(c);
+        uint64_t ocioso = (uint32_t)(t - s_ocioso_ant[c]);
+        s_ocioso_ant[c] = t;
+        if (ocioso > dt)
+            ocioso = dt;
+        s_ocioso_us += ocioso;
+        s_ocupado_us += dt - ocioso;
+        carga += POWER_SAVE_UA_CORE_ACTIVE * (dt - ocioso) +
+                 (wfi ? POWER_SAVE_UA_CORE_WFI : POWER_SAVE_UA_CORE_ACTIVE) * ocioso;
+    }
+    s_carga += carga;
+}
+
+static void aplicar(radio_t r)
+{
+    contabilizar();
+    s_radio = r;
+    uint32_t pm = r == RADIO_ECONOMIA ? POWER_SAVE_PM_IDLE : r == RADIO_RAJADA ? POWER_SAVE_PM_BURST : CYW43_DEFAULT_PM;
+    cyw43_arch_lwip_begin();
+    int err = cyw43_wifi_pm(&cyw43_state, pm);
+    cyw43_arch_lwip_end();
+    if (err)
+        LOG_W("[Energia] Modo do rádio não aplicado: %d\n", err);
+}
+
+void power_save_init(bool low_power)
+{
+    s_marca_us = time_us_64();
+    for (int c = 0; c < configNUMBER_OF_CORES; ++c)
+        s_ocioso_ant[c] = task_idle_run_time(c);
+    s_baixo_consumo = low_power;
+    s_radio = low_power ? RADIO_ECONOMIA : RADIO_NORMAL;
+}
+
+void power_save_set_mode(bool low_power)
+{
+    if (low_power == s_baixo_consumo)
+        return;
+    contabilizar();
+    s_baixo_consumo = low_power;
+    aplicar(low_power ? RADIO_ECONOMIA : RADIO_NORMAL);
+    LOG_I("[Energia] Baixo consumo %d\n", (int)low_power);
+}
+
+void power_save_link_up(void)
+{
+    aplicar(s_radio);
+}
+
+void power_save_wake(void)
+{
+    if (s_radio == RADIO_ECONOMIA) {
+        aplicar(RADIO_RAJADA);
+        s_stats.bursts++;
+    }
+    s_ultimo_tx_ms = agora_ms();
+}
+
+void power_save_sent(size_t bytes)
+{
+    // Quadros de até um MSS, cada um com cabeçalhos e o custo fixo de acesso ao meio
+    uint32_t quadros = (uint32_t)(bytes + POWER_SAVE_MSS - 1) / POWER_SAVE_MSS;
+    uint32_t ar = quadros * POWER_SAVE_FRAME_US +
+                  (uint32_t)(bytes + quadros * POWER_SAVE_FRAME_BYTES) * 8 / POWER_SAVE_PHY_MBPS;
+    s_ar_us += ar;
+    s_carga += (uint64_t)(POWER_SAVE_UA_RADIO_TX - POWER_SAVE_UA_RADIO_ON) * ar;
+    s_stats.tx_msgs++;
+    s_stats.tx_bytes += (uint32_t)bytes;
+    s_ultimo_tx_ms = agora_ms();
+}
+
+bool power_save_awake(void)
+{
+    return s_radio != RADIO_ECONOMIA;
+}
+
+bool power_save_poll(uint32_t *end_ms)
+{
+    if (s_radio == RADIO_RAJADA && (int32_t)(agora_ms() - s_ultimo_tx_ms) >= POWER_SAVE_QUIET_MS)
+        aplicar(RADIO_ECONOMIA);
+    else
+        contabilizar();
+    if (s_radio != RADIO_RAJADA)
+        return false;
+    *end_ms = s_ultimo_tx_ms + POWER_SAVE_QUIET_MS;
+    return true;
+}
+
+void power_save_get_stats(power_save_stats_t *out)
+{
+    *out = s_stats;
+    out->low_power = s_baixo_consumo;
+    out->radio_awake_ms = (uint32_t)(s_acordado_us / 1000);
+    out->radio_ps_ms = (uint32_t)(s_economia_us / 1000);
+    out->airtime_us = (uint32_t)s_ar_us;
+    out->core_busy_ms = (uint32_t)(s_ocupado_us / 1000);
+    out->core_idle_ms = (uint32_t)(s_ocioso_us / 1000);
+    out->charge_mas = (uint32_t)(s_carga / 1000000000u);   // µA·µs → mA·s
+}
+
+size_t power_save_encode(uint8_t *p)
+{
+    power_save_stats_t st;
+    power_save_get_stats(&st);
+    const uint32_t v[POWER_SAVE_CBOR_ITEMS] = {
+        st.low_power, st.radio_awake_ms, st.radio_ps_ms, st.bursts,       st.tx_msgs,
+        st.tx_bytes,  st.airtime_us,     st.core_busy_ms, st.core_idle_ms, st.charge_mas,
+    };
+    size_t len = cbor_array(p, POWER_SAVE_CBOR_ITEMS);
+    for (int i = 0; i < POWER_SAVE_CBOR_ITEMS; ++i)
+        len += cbor_uint(&p[len], v[i]);
+    return len;
+}
+
+// Tarefas ociosas: em baixo consumo o núcleo para até a próxima interrupção
+#if configUSE_IDLE_HOOK || configUSE_PASSIVE_IDLE_HOOK
+static inline void ocioso(void)
+{
+    if (s_baixo_consumo)
+        __wfi();
+}
+#endif
+
+#if configUSE_IDLE_HOOK
+void vApplicationIdleHook(void)
+{
+    ocioso();
+}
+#endif
+
+#if configUSE_PASSIVE_IDLE_HOOK
+void vApplicationPassiveIdleHook(void)
+{
+    ocioso();
+}
+#endif
@@ -0,0 +1,128 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Modo de baixo consumo (campo low_power da configuração, LOW_POWER no .env):
+// uplink em rajadas e rádio em economia de energia entre elas.
+//
+// Com o modo ligado, tarefaMQTT junta uplink_batch amostras no anel e publica
+// todas de uma vez; o diagnóstico espera a rajada seguinte. Na rajada o CYW43
+// fica em POWER_SAVE_PM_BURST (PM2: acordado enquanto há tráfego) e, depois de
+// POWER_SAVE_QUIET_MS sem publicar, volta a POWER_SAVE_PM_IDLE (PM1: o rádio só
+// acorda a cada POWER_SAVE_LISTEN_DTIM beacons DTIM para buscar o que o AP
+// guardou). A associação e a sessão MQTT continuam de pé, o keep-alive sai
+// nesses despertares e um comando de configuração chega com o atraso de um
+// deles. Fora do modo vale o PM padrão do SDK (CYW43_DEFAULT_PM).
+//
+// Núcleos: com o modo ligado, a tarefa ociosa de cada núcleo executa WFI
+// (vApplicationIdleHook e vApplicationPassiveIdleHook) e o núcleo fica parado até
+// a próxima interrupção: tick no núcleo 0, FIFO entre núcleos (o escalonador
+// acordando o outro), IRQ do rádio ou dos sensores. Tickless idle
+// (configUSE_TICKLESS_IDLE) existe no port do RP2040, mas fica desligado: os
+// temporizadores do async_context do CYW43 (verificação de sono do barramento
+// SPI do rádio, a cada CYW43_SLEEP_CHECK_MS) e do lwIP (TCP a cada 250 ms com a
+// sessão aberta) acordam o núcleo com frequência de qualquer jeito, e o tick de
+// 1 ms custa pouco perto do rádio. O sono dormente do RP2040 também fica
+// de fora: ele para os osciladores, e o CYW43 (SPI por PIO) e o núcleo de rede
+// não sobrevivem sem reassociar a cada rajada.
+//
+// Contabilidade desde o boot, para comparar os modos: tempo do rádio acordado
+// (modo normal ou rajada) e em economia, rajadas, mensagens e bytes publicados,
+// tempo no ar estimado, tempo ocupado e ocioso dos núcleos (contadores de tempo
+// de execução do kernel) e a carga estimada com as correntes POWER_SAVE_UA_*.
+// As correntes são valores típicos de catálogo, não medida: servem para
+// comparar modos, e uma calibração com amperímetro troca as macros.
+
+// Sem publicar por este tempo, a rajada acaba e o rádio volta ao PM1
+#ifndef POWER_SAVE_QUIET_MS
+#define POWER_SAVE_QUIET_MS 500
+#endif
+
+// Intervalo de escuta entre rajadas, em períodos DTIM do AP
+#ifndef POWER_SAVE_LISTEN_DTIM
+#define POWER_SAVE_LISTEN_DTIM 3
+#endif
+
+// Tempo no ar: taxa PHY suposta e custo fixo por quadro (preâmbulo, DIFS,
+// backoff médio, SIFS e ACK), mais os cabeçalhos MQTT, TCP/IP e 802.11
+#ifndef POWER_SAVE_PHY_MBPS
+#define POWER_SAVE_PHY_MBPS 24
+#endif
+#define POWER_SAVE_FRAME_US 180
+#define POWER_SAVE_FRAME_BYTES 80
+#define POWER_SAVE_MSS 1460
+
+// Correntes típicas (µA, 3,3 V): rádio associado e acordado, em PM1 (média com
+// os despertares de DTIM), transmitindo; núcleo executando, em WFI; o resto da
+// placa (regulador, flash, sensores)
+#ifndef POWER_SAVE_UA_RADIO_ON
+#define POWER_SAVE_UA_RADIO_ON 30000
+#endif
+#ifndef POWER_SAVE_UA_RADIO_PS
+#define POWER_SAVE_UA_RADIO_PS 1500
+#endif
+#ifndef POWER_SAVE_UA_RADIO_TX
+#define POWER_SAVE_UA_RADIO_TX 280000
+#endif
+#ifndef POWER_SAVE_UA_CORE_ACTIVE
+#define POWER_SAVE_UA_CORE_ACTIVE 10000
+#endif
+#ifndef POWER_SAVE_UA_CORE_WFI
+#define POWER_SAVE_UA_CORE_WFI 2000
+#endif
+#ifndef POWER_SAVE_UA_BASE
+#define POWER_SAVE_UA_BASE 5000
+#endif
+
+typedef struct {
+    uint32_t low_power;        // modo atual
+    uint32_t radio_awake_ms;   // modo normal ou rajada
+    uint32_t radio_ps_ms;      // PM1, entre rajadas
+    uint32_t bursts;
+    uint32_t tx_msgs;
+    uint32_t tx_bytes;         // tópico e payload
+    uint32_t airtime_us;       // estimado
+    uint32_t core_busy_ms;     // soma dos núcleos
+    uint32_t core_idle_ms;
+    uint32_t charge_mas;       // carga estimada, mA·s
+} power_save_stats_t;
+
+// [low_power, radio_awake_ms, radio_ps_ms, bursts, tx_msgs, tx_bytes,
+//  airtime_us, core_busy_ms, core_idle_ms, charge_mas]
+#define POWER_SAVE_CBOR_ITEMS 10
+#define POWER_SAVE_CBOR_MAX_BYTES (1 + POWER_SAVE_CBOR_ITEMS * 5)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Depois de cyw43_arch_init() e de task_pin_idle(), com o escalonador rodando;
+// todas as funções abaixo são da mesma tarefa (tarefaMQTT)
+void power_save_init(bool low_power);
+
+// Liga ou desliga o modo (configuração nova)
+void power_save_set_mode(bool low_power);
+
+// Enlace (re)associado: a associação volta ao PM padrão do SDK, o modo é reaplicado
+void power_save_link_up(void);
+
+// Antes de publicar: começa uma rajada se o rádio estava em economia
+void power_save_wake(void);
+
+// Publicação aceita pelo lwIP, com tópico e payload
+void power_save_sent(size_t bytes);
+
+// Rádio acordado (modo normal ou rajada em curso): publicar agora não custa um despertar
+bool power_save_awake(void);
+
+// Encerra a rajada depois de POWER_SAVE_QUIET_MS quieta e contabiliza; com
+// rajada em curso, devolve true e o instante (ms) em que ela acaba
+bool power_save_poll(uint32_t *end_ms);
+
+void power_save_get_stats(power_save_stats_t *out);
+size_t power_save_encode(uint8_t *p);
+
+#ifdef __cplusplus
+}
+#endif
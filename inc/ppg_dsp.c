@@ -0,0 +1,135 @@
+#include "inc/ppg_dsp.h"
+#include <string.h>
+
+static void channel_reset(ppg_channel_t *c, uint32_t x)
+{
+    memset(c, 0, sizeof *c);
+    c->dc_q8 = (int32_t)(x << 8);   // parte do nível atual: sem transitório de partida
+}
+
+static void channel_step(ppg_channel_t *c, uint32_t x, uint8_t idx)
+{
+    int32_t x_q8 = (int32_t)(x << 8);
+    c->dc_q8 += (x_q8 - c->dc_q8) >> PPG_DC_SHIFT;
+    int32_t hp = x_q8 - c->dc_q8;
+
+    c->ma_sum += hp - c->ma[idx];
+    c->ma[idx] = hp;
+    c->ac = c->ma_sum / PPG_MA_LEN;
+
+    if (c->ac > c->ac_max) c->ac_max = c->ac;
+    if (c->ac < c->ac_min) c->ac_min = c->ac;
+}
+
+static void restart(ppg_dsp_t *d, const max30101_sample_t *s)
+{
+    channel_reset(&d->red, s->red);
+    channel_reset(&d->ir, s->ir);
+    d->ma_idx = 0;
+    d->n = 0;
+    d->last_peak = 0;
+    d->prev[0] = d->prev[1] = 0;
+    d->threshold = 0;
+    d->n_intervals = d->idx_interval = 0;
+}
+
+// Razão das razões R = (AC_red/DC_red) / (AC_ir/DC_ir) no batimento que terminou;
+// SpO2 = 110 - 25 R (aproximação linear usual, sem calibração por sensor)
+static void update_spo2(ppg_dsp_t *d)
+{
+    int64_t ac_red = d->red.ac_max - d->red.ac_min;
+    int64_t ac_ir = d->ir.ac_max - d->ir.ac_min;
+    if (ac_red <= 0 || ac_ir <= 0 || d->red.dc_q8 <= 0) return;
+
+    int64_t r_q8 = (ac_red * d->ir.dc_q8 * 256) / ((int64_t)d->red.dc_q8 * ac_ir);
+    int32_t spo2 = 1100 - (int32_t)((250 * r_q8) >> 8);
+    if (spo2 < 0) spo2 = 0;
+    if (spo2 > 1000) spo2 = 1000;
+    d->spo2_x10 = d->spo2_x10 ? (uint16_t)((3 * d->spo2_x10 + spo2) / 4) : (uint16_t)spo2;
+}
+
+static void beat(ppg_dsp_t *d, uint32_t idx, int32_t peak)
+{
+    d->threshold = peak / 2;
+    d->beats++;
+
+    if (d->last_peak) {
+        uint32_t interval = idx - d->last_peak;
+        if (interval <= (uint32_t)d->fs_hz * 60 / PPG_BPM_MIN) {
+            d->intervals[d->idx_interval] = (uint16_t)interval;
+            d->idx_interval = (uint8_t)((d->idx_interval + 1) % PPG_INTERVALS);
+            if (d->n_intervals < PPG_INTERVALS) d->n_intervals++;
+            update_spo2(d);
+        } else {
+            d->n_intervals = 0;
+        }
+    }
+    if (d->n_intervals) {
+        uint32_t soma = 0;
+        for (uint8_t i = 0; i < d->n_intervals; ++i)
+            soma += d->intervals[i];
+        d->bpm_x10 = (uint16_t)(600u * d->fs_hz * d->n_intervals / soma);
+    }
+
+    // Próxima janela de AC começa neste pico
+    d->red.ac_max = d->red.ac_min = d->red.ac;
+    d->ir.ac_max = d->ir.ac_min = d->ir.ac;
+    d->last_peak = idx;
+}
+
+void ppg_dsp_init(ppg_dsp_t *d, uint16_t fs_hz)
+{
+    memset(d, 0, sizeof *d);
+    d->fs_hz = fs_hz;
+}
+
+void ppg_dsp_process(ppg_dsp_t *d, const max30101_sample_t *s, size_t n)
+{
+    const uint32_t refratario = (uint32_t)d->fs_hz * 60 / PPG_BPM_MAX;
+    const uint32_t perdido = 2u * d->fs_hz * 60 / PPG_BPM_MIN;
+    const uint32_t acomodacao = 2u * d->fs_hz;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (s[i].ir < PPG_FINGER_MIN) {
+            d->finger = false;
+            continue;
+        }
+        if (!d->finger) {
+            d->finger = true;
+            d->bpm_x10 = d->spo2_x10 = 0;
+            restart(d, &s[i]);
+        }
+
+        channel_step(&d->red, s[i].red, d->ma_idx);
+        channel_step(&d->ir, s[i].ir, d->ma_idx);
+        d->ma_idx = (uint8_t)((d->ma_idx + 1) % PPG_MA_LEN);
+        d->n++;
+
+        // Mais sangue no tecido = menos luz refletida: o pulso é o AC do IR invertido
+        int32_t pulso = -d->ir.ac;
+        if (d->n > acomodacao) {
+            d->threshold -= d->threshold >> 5;
+            if (d->prev[1] > d->prev[0] && d->prev[1] >= pulso && d->prev[1] > d->threshold &&
+                (!d->last_peak || d->n - 1 - d->last_peak >= refratario))
+                beat(d, d->n - 1, d->prev[1]);
+            else if (d->last_peak && d->n - d->last_peak > perdido) {
+                d->last_peak = 0;
+                d->n_intervals = 0;
+            }
+        } else {
+            d->ir.ac_max = d->ir.ac_min = d->ir.ac;
+            d->red.ac_max = d->red.ac_min = d->red.ac;
+        }
+        d->prev[0] = d->prev[1];
+        d->prev[1] = pulso;
+    }
+}
+
+void ppg_dsp_result(const ppg_dsp_t *d, ppg_result_t *out)
+{
+    out->valid = d->finger && d->n_intervals >= 2 && d->spo2_x10 > 0;
+    out->bpm_x10 = d->bpm_x10;
+    out->spo2_x10 = d->spo2_x10;
+    out->beats = d->beats;
+}
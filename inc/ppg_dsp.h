@@ -0,0 +1,71 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/max30101.h"
+
+// Processamento incremental do sinal PPG do MAX30101, só com inteiros:
+// remoção de DC (passa-altas de 1ª ordem), passa-baixas por média móvel,
+// detecção de picos no IR e SpO2 pela razão das razões (AC/DC vermelho sobre
+// AC/DC infravermelho) a cada batimento. Cada lote lido da FIFO é processado
+// na chegada; o estado carrega de um lote para o outro.
+
+#ifndef PPG_DC_SHIFT
+#define PPG_DC_SHIFT 5            // constante de tempo do DC: 2^5 amostras (~1,3 s a 25 Hz)
+#endif
+
+#ifndef PPG_MA_LEN
+#define PPG_MA_LEN 4              // média móvel (zero em fs/4 = 6,25 Hz)
+#endif
+
+#ifndef PPG_FINGER_MIN
+#define PPG_FINGER_MIN 50000      // IR bruto (18 bits) abaixo disso = sem dedo no sensor
+#endif
+
+#define PPG_BPM_MIN 40
+#define PPG_BPM_MAX 200
+#define PPG_INTERVALS 4           // intervalos entre batimentos na média do BPM
+
+typedef struct {
+    int32_t dc_q8;                // nível DC, Q8
+    int32_t ma[PPG_MA_LEN];
+    int32_t ma_sum;
+    int32_t ac;                   // saída filtrada, Q8
+    int32_t ac_max, ac_min;       // extremos desde o último batimento
+} ppg_channel_t;
+
+typedef struct {
+    uint16_t fs_hz;
+    bool finger;
+    uint8_t ma_idx;
+    ppg_channel_t red, ir;
+    uint32_t n;                   // amostras processadas desde que o dedo foi detectado
+    uint32_t last_peak;           // índice do último batimento (0 = nenhum)
+    int32_t prev[2];              // pulso IR nas duas amostras anteriores
+    int32_t threshold;            // limiar adaptativo do pico, decai entre batimentos
+    uint16_t intervals[PPG_INTERVALS];
+    uint8_t n_intervals, idx_interval;
+    uint16_t bpm_x10;
+    uint16_t spo2_x10;
+    uint32_t beats;
+} ppg_dsp_t;
+
+typedef struct {
+    bool valid;                   // dedo presente e pelo menos dois intervalos medidos
+    uint16_t bpm_x10;
+    uint16_t spo2_x10;
+    uint32_t beats;
+} ppg_result_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void ppg_dsp_init(ppg_dsp_t *d, uint16_t fs_hz);
+// Processa um lote na ordem da FIFO (da mais antiga para a mais nova)
+void ppg_dsp_process(ppg_dsp_t *d, const max30101_sample_t *s, size_t n);
+void ppg_dsp_result(const ppg_dsp_t *d, ppg_result_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,121 @@
+#include "inc/rbe.h"
+#include <string.h>
+
+void rbe_default_config(rbe_config_t *cfg, int32_t temp_threshold_c100, uint32_t dist_threshold_mm,
+                        uint32_t period_fast_ms, uint32_t period_slow_ms)
+{
+    memset(cfg, 0, sizeof *cfg);
+    cfg->abs[RBE_TEMP] = RBE_TEMP_DEADBAND_C100;
+    cfg->abs[RBE_PRES] = RBE_PRES_DEADBAND_PA;
+    cfg->abs[RBE_DIST] = RBE_DIST_DEADBAND_MM;
+    cfg->rel_permille[RBE_DIST] = RBE_DIST_DEADBAND_PERMILLE;
+    cfg->abs[RBE_BPM] = RBE_BPM_DEADBAND_X10;
+    cfg->abs[RBE_SPO2] = RBE_SPO2_DEADBAND_X10;
+    cfg->temp_threshold_c100 = temp_threshold_c100;
+    cfg->dist_threshold_mm = dist_threshold_mm;
+    cfg->max_silence_ms = RBE_MAX_SILENCE_MS;
+    cfg->period_fast_ms = period_fast_ms;
+    cfg->period_slow_ms = period_slow_ms > period_fast_ms ? period_slow_ms : period_fast_ms;
+    cfg->stable_cycles = RBE_STABLE_CYCLES;
+}
+
+void rbe_init(rbe_t *r, const rbe_config_t *cfg)
+{
+    memset(r, 0, sizeof *r);
+    r->cfg = *cfg;
+    r->period_ms = cfg->period_fast_ms;
+    r->stats.period_ms = r->period_ms;
+}
+
+void rbe_set_config(rbe_t *r, const rbe_config_t *cfg)
+{
+    r->cfg = *cfg;
+    if (r->period_ms < cfg->period_fast_ms) r->period_ms = cfg->period_fast_ms;
+    if (r->period_ms > cfg->period_slow_ms) r->period_ms = cfg->period_slow_ms;
+    r->stable = 0;
+    r->stats.period_ms = r->period_ms;
+}
+
+static void canais(const telemetry_sample_t *s, int32_t v[RBE_CHANNELS])
+{
+    v[RBE_TEMP] = s->temp_c100;
+    v[RBE_PRES] = (int32_t)s->pres_pa;
+    v[RBE_DIST] = s->dist_mm;
+    v[RBE_BPM] = s->bpm_x10;
+    v[RBE_SPO2] = s->spo2_x10;
+}
+
+static uint32_t distancia(int32_t a, int32_t b)
+{
+    return a > b ? (uint32_t)(a - b) : (uint32_t)(b - a);
+}
+
+// Maior entre a zona morta absoluta e a relativa ao último valor publicado
+static uint32_t zona_morta(const rbe_t *r, int c)
+{
+    uint32_t ref = distancia(r->reported[c], 0);
+    uint32_t rel = (uint32_t)((uint64_t)ref * r->cfg.rel_permille[c] / 1000u);
+    return rel > r->cfg.abs[c] ? rel : r->cfg.abs[c];
+}
+
+// O lado do limiar mudou entre o último valor publicado e o atual
+static bool cruzou(const rbe_t *r, const int32_t v[RBE_CHANNELS])
+{
+    bool quente_antes = r->reported[RBE_TEMP] >= r->cfg.temp_threshold_c100;
+    bool quente = v[RBE_TEMP] >= r->cfg.temp_threshold_c100;
+    bool perto_antes = (uint32_t)r->reported[RBE_DIST] < r->cfg.dist_threshold_mm;
+    bool perto = (uint32_t)v[RBE_DIST] < r->cfg.dist_threshold_mm;
+    return quente != quente_antes || perto != perto_antes;
+}
+
+bool rbe_update(rbe_t *r, const telemetry_sample_t *s)
+{
+    int32_t v[RBE_CHANNELS];
+    canais(s, v);
+    r->stats.samples++;
+
+    bool mudou = false, rapido = false;
+    for (int c = 0; c < RBE_CHANNELS; ++c) {
+        uint32_t zm = zona_morta(r, c);
+        if (r->has_reported && distancia(v[c], r->reported[c]) > zm)
+            mudou = true;
+        // Meia zona morta entre duas amostras: o valor deve sair da faixa em poucos ciclos
+        if (r->has_previous && 2 * distancia(v[c], r->previous[c]) > zm)
+            rapido = true;
+    }
+    memcpy(r->previous, v, sizeof v);
+    r->has_previous = true;
+
+    bool limiar = r->has_reported && cruzou(r, v);
+    bool batimento = r->has_reported && s->t_ms - r->last_report_ms >= r->cfg.max_silence_ms;
+    bool publica = !r->has_reported || mudou || limiar || batimento;
+
+    // Período interno: cai pela metade com movimento, dobra depois de stable_cycles paradas
+    if (rapido || limiar) {
+        r->period_ms /= 2;
+        if (r->period_ms < r->cfg.period_fast_ms) r->period_ms = r->cfg.period_fast_ms;
+        r->stable = 0;
+    } else if (++r->stable >= r->cfg.stable_cycles) {
+        r->period_ms *= 2;
+        if (r->period_ms > r->cfg.period_slow_ms) r->period_ms = r->cfg.period_slow_ms;
+        r->stable = 0;
+    }
+    r->stats.period_ms = r->period_ms;
+
+    if (!publica) {
+        r->stats.suppressed++;
+        return false;
+    }
+    if (limiar) r->stats.crossings++;
+    else if (batimento && !mudou) r->stats.heartbeats++;
+    memcpy(r->reported, v, sizeof v);
+    r->has_reported = true;
+    r->last_report_ms = s->t_ms;
+    r->stats.reported++;
+    return true;
+}
+
+void rbe_get_stats(const rbe_t *r, rbe_stats_t *out)
+{
+    *out = r->stats;
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "inc/telemetry.h"
+
+// Relato por exceção (report-by-exception) entre a aquisição e tarefaMQTT.
+//
+// Cada amostra do laço passa por rbe_update(). Ela só vai para o anel (e daí
+// para o broker) se algum canal saiu da zona morta em relação ao último valor
+// publicado. Também vai se a temperatura ou a distância cruzou o seu limiar
+// (TEMP_THRESHOLD_C, DIST_THRESHOLD_MM: a troca QUENTE/FRIO sempre é
+// publicada), ou se passaram max_silence_ms sem publicação (batimento). A zona
+// morta de um canal é o maior entre o valor absoluto e a fração rel_permille do
+// último valor publicado.
+//
+// O período de amostragem interno se adapta entre period_fast_ms e
+// period_slow_ms. Quando algum canal anda meia zona morta entre duas amostras,
+// o período cai pela metade. Depois de stable_cycles amostras paradas, ele
+// dobra. As amostras suprimidas não recebem número de sequência, então o
+// backend não vê buracos.
+
+typedef enum {
+    RBE_TEMP,    // temp_c100
+    RBE_PRES,    // pres_pa
+    RBE_DIST,    // dist_mm
+    RBE_BPM,     // bpm_x10
+    RBE_SPO2,    // spo2_x10
+    RBE_CHANNELS
+} rbe_channel_t;
+
+#ifndef RBE_TEMP_DEADBAND_C100
+#define RBE_TEMP_DEADBAND_C100 20      // 0,2 °C
+#endif
+#ifndef RBE_PRES_DEADBAND_PA
+#define RBE_PRES_DEADBAND_PA 50
+#endif
+#ifndef RBE_DIST_DEADBAND_MM
+#define RBE_DIST_DEADBAND_MM 20
+#endif
+#ifndef RBE_DIST_DEADBAND_PERMILLE
+#define RBE_DIST_DEADBAND_PERMILLE 50  // 5% da distância
+#endif
+#ifndef RBE_BPM_DEADBAND_X10
+#define RBE_BPM_DEADBAND_X10 20        // 2 bpm
+#endif
+#ifndef RBE_SPO2_DEADBAND_X10
+#define RBE_SPO2_DEADBAND_X10 10       // 1 ponto de SpO2
+#endif
+
+// Batimento: publica ao menos uma amostra nesse intervalo, mesmo sem mudança
+#ifndef RBE_MAX_SILENCE_MS
+#define RBE_MAX_SILENCE_MS 60000
+#endif
+
+#ifndef RBE_STABLE_CYCLES
+#define RBE_STABLE_CYCLES 5
+#endif
+
+typedef struct {
+    uint32_t abs[RBE_CHANNELS];           // zona morta absoluta, na unidade do canal
+    uint16_t rel_permille[RBE_CHANNELS];  // zona morta relativa (0 = só a absoluta)
+    int32_t temp_threshold_c100;
+    uint32_t dist_threshold_mm;
+    uint32_t max_silence_ms;
+    uint32_t period_fast_ms;
+    uint32_t period_slow_ms;
+    uint32_t stable_cycles;
+} rbe_config_t;
+
+typedef struct {
+    uint32_t samples;
+    uint32_t reported;
+    uint32_t suppressed;
+    uint32_t heartbeats;       // publicadas só pelo batimento
+    uint32_t crossings;        // publicadas por cruzar um limiar
+    uint32_t period_ms;        // período interno atual
+} rbe_stats_t;
+
+typedef struct {
+    rbe_config_t cfg;
+    int32_t reported[RBE_CHANNELS];
+    int32_t previous[RBE_CHANNELS];
+    bool has_reported;
+    bool has_previous;
+    uint32_t last_report_ms;
+    uint32_t period_ms;
+    uint32_t stable;
+    rbe_stats_t stats;
+} rbe_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Zonas mortas e batimento padrão (macros RBE_*), limiares e faixa de período do chamador
+void rbe_default_config(rbe_config_t *cfg, int32_t temp_threshold_c100, uint32_t dist_threshold_mm,
+                        uint32_t period_fast_ms, uint32_t period_slow_ms);
+
+// Começa no período rápido, sem nada publicado: a primeira amostra sempre sai
+void rbe_init(rbe_t *r, const rbe_config_t *cfg);
+
+// Troca zonas mortas, limiares e faixa de período sem esquecer o último valor
+// publicado; o período atual é trazido para dentro da faixa nova
+void rbe_set_config(rbe_t *r, const rbe_config_t *cfg);
+
+// true se a amostra deve ser publicada; atualiza o período interno
+bool rbe_update(rbe_t *r, const telemetry_sample_t *s);
+
+// Período até a próxima amostra
+static inline uint32_t rbe_period_ms(const rbe_t *r)
+{
+    return r->period_ms;
+}
+
+void rbe_get_stats(const rbe_t *r, rbe_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,81 @@
+#include "inc/sample_ring.h"
+#include <string.h>
+
+#define MASK (SAMPLE_RING_SIZE - 1u)
+
+void sample_ring_init(sample_ring_t *r, TaskHandle_t consumer)
+{
+    memset(r->slots, 0, sizeof r->slots);
+    atomic_init(&r->head, 0);
+    atomic_init(&r->tail, 0);
+    atomic_init(&r->high_water, 0);
+    atomic_init(&r->drops, 0);
+    atomic_init(&r->commits, 0);
+    r->consumer = consumer;
+}
+
+telemetry_sample_t *sample_ring_claim(sample_ring_t *r)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+    // acquire: o consumidor terminou de ler o slot antes de devolvê-lo
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (head - tail >= SAMPLE_RING_SIZE) {
+        atomic_store_explicit(&r->drops, atomic_load_explicit(&r->drops, memory_order_relaxed) + 1,
+                              memory_order_relaxed);
+        return NULL;
+    }
+    return &r->slots[head & MASK];
+}
+
+void sample_ring_commit(sample_ring_t *r)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_relaxed) + 1;
+    uint32_t used = head - atomic_load_explicit(&r->tail, memory_order_relaxed);
+    if (used > atomic_load_explicit(&r->high_water, memory_order_relaxed))
+        atomic_store_explicit(&r->high_water, used, memory_order_relaxed);
+    atomic_store_explicit(&r->commits, atomic_load_explicit(&r->commits, memory_order_relaxed) + 1,
+                          memory_order_relaxed);
+    traceSAMPLE_RING_COMMIT(r);
+    // release: o conteúdo do slot fica visível antes do novo head
+    atomic_store_explicit(&r->head, head, memory_order_release);
+    if (r->consumer)
+        xTaskNotifyGiveIndexed(r->consumer, SAMPLE_RING_NOTIFY_INDEX);
+}
+
+size_t sample_ring_count(const sample_ring_t *r)
+{
+    uint32_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    return head - atomic_load_explicit(&r->tail, memory_order_relaxed);
+}
+
+telemetry_sample_t *sample_ring_at(sample_ring_t *r, size_t i)
+{
+    return &r->slots[(atomic_load_explicit(&r->tail, memory_order_relaxed) + i) & MASK];
+}
+
+void sample_ring_release(sample_ring_t *r, size_t n)
+{
+    if (n == 0) return;
+    uint32_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, tail + (uint32_t)n, memory_order_release);
+}
+
+bool sample_ring_wait(sample_ring_t *r, TickType_t timeout)
+{
+    // A notificação acumula: um commit entre a última verificação e a espera não se perde
+    ulTaskNotifyTakeIndexed(SAMPLE_RING_NOTIFY_INDEX, pdTRUE, timeout);
+    return sample_ring_count(r) > 0;
+}
+
+void sample_ring_wake(sample_ring_t *r)
+{
+    xTaskNotifyGiveIndexed(r->consumer, SAMPLE_RING_NOTIFY_INDEX);
+}
+
+void sample_ring_get_stats(const sample_ring_t *r, sample_ring_stats_t *out)
+{
+    out->capacity = SAMPLE_RING_SIZE;
+    out->high_water = atomic_load_explicit(&r->high_water, memory_order_relaxed);
+    out->drops = atomic_load_explicit(&r->drops, memory_order_relaxed);
+    out->commits = atomic_load_explicit(&r->commits, memory_order_relaxed);
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inc/telemetry.h"
+
+// Anel produtor único / consumidor único de amostras pré-alocadas, entre
+// tarefaSensorBMP280 (produtor) e tarefaMQTT (consumidor), que no SMP rodam em
+// núcleos diferentes.
+//
+// O produtor reserva o próximo slot (sample_ring_claim), preenche no lugar e
+// publica (sample_ring_commit). O consumidor enxerga as amostras publicadas por
+// índice (sample_ring_at), codifica direto do slot e só libera os slots
+// (sample_ring_release) depois de publicá-los ou guardá-los no diário: a amostra
+// não é copiada no caminho.
+//
+// Cada índice tem um único escritor: head só o produtor, tail só o consumidor.
+// A publicação de head é store-release e a leitura do outro lado é load-acquire,
+// então o conteúdo do slot fica visível antes do índice no outro núcleo; o mesmo
+// vale para tail na devolução dos slots. Não há RMW atômico (o M0+ não tem
+// LDREX/STREX), só loads e stores.
+
+#ifndef SAMPLE_RING_SIZE
+#define SAMPLE_RING_SIZE 16            // potência de 2
+#endif
+
+// Índice de notificação usado para acordar o consumidor
+#ifndef SAMPLE_RING_NOTIFY_INDEX
+#define SAMPLE_RING_NOTIFY_INDEX 0
+#endif
+
+// Gancho de trace (a simulação mede a latência amostra -> publicação)
+#ifndef traceSAMPLE_RING_COMMIT
+#define traceSAMPLE_RING_COMMIT(ring)
+#endif
+
+_Static_assert((SAMPLE_RING_SIZE & (SAMPLE_RING_SIZE - 1)) == 0, "SAMPLE_RING_SIZE deve ser potência de 2");
+
+typedef struct {
+    uint32_t capacity;
+    uint32_t high_water;      // maior ocupação já vista pelo produtor
+    uint32_t drops;           // amostras recusadas com o anel cheio
+    uint32_t commits;
+} sample_ring_stats_t;
+
+typedef struct {
+    telemetry_sample_t slots[SAMPLE_RING_SIZE];
+    _Atomic uint32_t head;    // próximo slot a publicar (produtor)
+    _Atomic uint32_t tail;    // slot mais antigo ainda com o consumidor
+    TaskHandle_t consumer;
+    _Atomic uint32_t high_water;
+    _Atomic uint32_t drops;
+    _Atomic uint32_t commits;
+} sample_ring_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sample_ring_init(sample_ring_t *r, TaskHandle_t consumer);
+
+// Produtor: slot livre para preencher, ou NULL com o anel cheio (conta em drops)
+telemetry_sample_t *sample_ring_claim(sample_ring_t *r);
+// Produtor: publica o slot reservado e acorda o consumidor
+void sample_ring_commit(sample_ring_t *r);
+
+// Consumidor: amostras publicadas e ainda não liberadas
+size_t sample_ring_count(const sample_ring_t *r);
+// Consumidor: i-ésima amostra publicada (0 = mais antiga), i < sample_ring_count()
+telemetry_sample_t *sample_ring_at(sample_ring_t *r, size_t i);
+// Consumidor: devolve as n amostras mais antigas ao produtor
+void sample_ring_release(sample_ring_t *r, size_t n);
+// Consumidor: espera uma publicação nova (ou o timeout); true se há amostras
+bool sample_ring_wait(sample_ring_t *r, TickType_t timeout);
+// Qualquer tarefa: tira o consumidor de sample_ring_wait() sem amostra nova
+void sample_ring_wake(sample_ring_t *r);
+
+void sample_ring_get_stats(const sample_ring_t *r, sample_ring_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,224 @@
+#include "inc/sensor_hal.h"
+#include <stdio.h>
+#include <string.h>
+#include "pico/stdlib.h"
+#if SENSOR_HAL_VL53L0X
+#include "inc/vl53l0x.h"
+#endif
+#if SENSOR_HAL_VL53L1X
+#include "inc/vl53l1x.h"
+#include "inc/vl53l1x_ranging.h"
+#endif
+#if SENSOR_HAL_MAX30101
+#include "inc/max30101.h"
+#include "inc/max30101_ppg.h"
+#endif
+
+// Acrescenta uma leitura mantendo só as max mais novas
+static size_t anexar(sensor_reading_t *out, size_t n, size_t max, const sensor_reading_t *r)
+{
+    if (n == max) {
+        memmove(out, out + 1, (max - 1) * sizeof *out);
+        --n;
+    }
+    out[n] = *r;
+    return n + 1;
+}
+
+// --- VL53L0X: medição única sob demanda, na tarefa dona do controlador ---
+#if SENSOR_HAL_VL53L0X
+static bool l0x_probe(i2c_inst_t *i2c, uint8_t addr)
+{
+    (void)addr;
+    uint8_t id;
+    return vl53l0x_read_model_id(i2c, &id) && id == VL53L0X_MODEL_ID;
+}
+
+static bool job_l0x_read(i2c_inst_t *i2c, void *ctx)
+{
+    return vl53l0x_read_distance_mm(i2c, (uint16_t *)ctx);
+}
+
+static size_t l0x_read_batch(i2c_bus_id_t bus, uint8_t addr, sensor_reading_t *out, size_t max)
+{
+    (void)addr;
+    uint16_t mm;
+    if (max == 0 || !i2c_bus_run(bus, job_l0x_read, &mm))
+        return 0;
+    out[0] = (sensor_reading_t){.t_us = time_us_64(), .distance = {.mm = mm}};
+    return 1;
+}
+#endif
+
+// --- VL53L1X: ranging contínuo em inc/vl53l1x_ranging.c; aqui só se esvazia o buffer ---
+#if SENSOR_HAL_VL53L1X
+static bool l1x_probe(i2c_inst_t *i2c, uint8_t addr)
+{
+    uint16_t id;
+    return vl53l1x_read_model_id(i2c, addr, &id) && id == VL53L1X_MODEL_ID;
+}
+
+static bool l1x_start(i2c_bus_id_t bus, uint8_t addr, const sensor_wiring_t *wiring)
+{
+    return vl53l1x_ranging_start(bus, addr, (uint)wiring->int_pin, wiring->period_ms);
+}
+
+static size_t l1x_read_batch(i2c_bus_id_t bus, uint8_t addr, sensor_reading_t *out, size_t max)
+{
+    (void)bus;
+    (void)addr;
+    vl53l1x_sample_t a[8];
+    size_t n = 0, k;
+    if (max == 0)
+        return 0;
+    while ((k = vl53l1x_ranging_read(a, 8)) > 0)
+        for (size_t i = 0; i < k; ++i) {
+            sensor_reading_t r = {
+                .t_us = a[i].timestamp_us,
+                .distance = {.mm = a[i].distance_mm, .status = a[i].range_status, .stream = a[i].stream_count},
+            };
+            n = anexar(out, n, max, &r);
+        }
+    return n;
+}
+#endif
+
+// --- MAX30101: FIFO esvaziada pela tarefa PPG; a leitura entrega os derivados ---
+#if SENSOR_HAL_MAX30101
+static bool max_probe(i2c_inst_t *i2c, uint8_t addr)
+{
+    uint8_t id;
+    return max30101_read_part_id(i2c, addr, &id) && id == MAX30101_PART_ID;
+}
+
+static bool max_start(i2c_bus_id_t bus, uint8_t addr, const sensor_wiring_t *wiring)
+{
+    return max30101_ppg_start(bus, addr, wiring->int_pin);
+}
+
+static size_t max_read_batch(i2c_bus_id_t bus, uint8_t addr, sensor_reading_t *out, size_t max)
+{
+    (void)bus;
+    (void)addr;
+    if (max == 0 || !max30101_ppg_latest(&out[0].ppg))
+        return 0;
+    out[0].t_us = time_us_64();
+    return 1;
+}
+#endif
+
+// --- TCS34725: integração contínua; a leitura pega o último RGBC ---
+#if SENSOR_HAL_TCS34725
+static bool tcs_probe(i2c_inst_t *i2c, uint8_t addr)
+{
+    uint8_t id;
+    return tcs34725_read_id(i2c, addr, &id) && (id == TCS34725_ID || id == TCS34727_ID);
+}
+
+typedef struct {
+    uint8_t addr;
+    tcs34725_rgbc_t *out;
+} LeituraCor;
+
+static bool job_tcs_read(i2c_inst_t *i2c, void *ctx)
+{
+    LeituraCor *l = ctx;
+    return tcs34725_read_rgbc(i2c, l->addr, l->out);
+}
+
+static size_t tcs_read_batch(i2c_bus_id_t bus, uint8_t addr, sensor_reading_t *out, size_t max)
+{
+    LeituraCor l = {.addr = addr, .out = &out[0].color};
+    if (max == 0 || !i2c_bus_run(bus, job_tcs_read, &l))
+        return 0;
+    out[0].t_us = time_us_64();
+    return 1;
+}
+#endif
+
+// Ordem de sondagem: IDs em registradores de 8 bits antes do VL53L1X (ver sensor_hal.h)
+static const sensor_driver_t s_drivers[] = {
+#if SENSOR_HAL_VL53L0X
+    {"VL53L0X", SENSOR_DISTANCE, VL53L0X_I2C_ADDR, l0x_probe, NULL, NULL, l0x_read_batch},
+#endif
+#if SENSOR_HAL_TCS34725
+    {"TCS34725", SENSOR_COLOR, TCS34725_I2C_ADDR, tcs_probe, tcs34725_init, NULL, tcs_read_batch},
+#endif
+#if SENSOR_HAL_VL53L1X
+    {"VL53L1X", SENSOR_DISTANCE, VL53L1X_I2C_ADDR, l1x_probe, vl53l1x_init, l1x_start, l1x_read_batch},
+#endif
+#if SENSOR_HAL_MAX30101
+    {"MAX30101", SENSOR_PPG, MAX30101_I2C_ADDR, max_probe, max30101_init, max_start, max_read_batch},
+#endif
+    {0},
+};
+
+// Driver ativo de cada tipo; escrito só em sensor_hal_discover()
+static struct {
+    const sensor_driver_t *drv;
+    i2c_bus_id_t bus;
+} s_ativos[SENSOR_KIND_COUNT];
+
+static bool job_scan(i2c_inst_t *i2c, void *ctx)
+{
+    sensor_scan_t *scan = ctx;
+    for (int addr = 0x03; addr <= 0x77; addr++) {
+        uint8_t dummy;
+        if (i2c_read_timeout_us(i2c, addr, &dummy, 1, false, 2000) == 1)
+            scan->present[addr / 32] |= 1u << (addr % 32);
+    }
+    return true;
+}
+
+void sensor_hal_scan(i2c_bus_id_t bus, sensor_scan_t *out)
+{
+    memset(out, 0, sizeof *out);
+    i2c_bus_run(bus, job_scan, out);
+}
+
+static bool job_sondar(i2c_inst_t *i2c, void *ctx)
+{
+    const sensor_driver_t *d = ctx;
+    return d->probe(i2c, d->addr);
+}
+
+static bool job_iniciar(i2c_inst_t *i2c, void *ctx)
+{
+    const sensor_driver_t *d = ctx;
+    return d->init(i2c, d->addr);
+}
+
+size_t sensor_hal_discover(i2c_bus_id_t bus, const sensor_scan_t *scan, const sensor_wiring_t wiring[SENSOR_KIND_COUNT])
+{
+    sensor_scan_t reconhecidos = {0};
+    size_t ativos = 0;
+    for (const sensor_driver_t *d = s_drivers; d->name; ++d) {
+        if (s_ativos[d->kind].drv || !sensor_scan_has(scan, d->addr) || sensor_scan_has(&reconhecidos, d->addr))
+            continue;
+        // i2c_bus_run não altera o contexto: o descritor continua na flash
+        if (!i2c_bus_run(bus, job_sondar, (void *)d))
+            continue;
+        reconhecidos.present[d->addr / 32] |= 1u << (d->addr % 32);
+        if ((d->init && !i2c_bus_run(bus, job_iniciar, (void *)d)) ||
+            (d->start && !d->start(bus, d->addr, &wiring[d->kind]))) {
+            printf("[%s] Detectado em 0x%02X, falha ao inicializar.\n", d->name, d->addr);
+            continue;
+        }
+        s_ativos[d->kind].drv = d;
+        s_ativos[d->kind].bus = bus;
+        ativos++;
+        printf("[%s] Detectado em 0x%02X e pronto.\n", d->name, d->addr);
+    }
+    return ativos;
+}
+
+const sensor_driver_t *sensor_hal_get(sensor_kind_t kind)
+{
+    return s_ativos[kind].drv;
+}
+
+size_t sensor_hal_read(sensor_kind_t kind, sensor_reading_t *out, size_t max)
+{
+    const sensor_driver_t *d = s_ativos[kind].drv;
+    return d ? d->read_batch(s_ativos[kind].bus, d->addr, out, max) : 0;
+}
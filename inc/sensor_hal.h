@@ -0,0 +1,108 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/i2c_bus.h"
+#include "inc/ppg_dsp.h"
+#include "inc/tcs34725.h"
+
+// Camada de sensores do barramento de GP2/GP3: tabela de drivers, descoberta a
+// partir de uma varredura só e leitura em lote por tipo de grandeza.
+//
+// Cada driver é um descritor constante (fica na flash) com probe (confere o ID
+// do chip), init, start (cria a aquisição em segundo plano, se houver) e
+// read_batch. sensor_hal_discover() percorre a tabela na ordem, pula endereços
+// que não responderam na varredura e registra o primeiro driver de cada tipo
+// cujo probe passar; um endereço já reconhecido não é mais sondado, de modo que
+// VL53L0X, TCS34725 e VL53L1X dividem 0x29 sem que um driver escreva no chip do
+// outro. Os drivers de ID de 8 bits vêm antes do VL53L1X, cujo endereço de
+// registrador de 16 bits seria lido pelos outros como escrita.
+//
+// Seleção em tempo de compilação: SENSOR_HAL_<DRIVER>=0 tira a entrada da
+// tabela; sem outra referência, o driver e a aquisição dele saem da imagem
+// (--gc-sections do SDK). O TCS34725 vem desligado: a telemetria não tem campo
+// de cor.
+
+#ifndef SENSOR_HAL_VL53L0X
+#define SENSOR_HAL_VL53L0X 1
+#endif
+#ifndef SENSOR_HAL_VL53L1X
+#define SENSOR_HAL_VL53L1X 1
+#endif
+#ifndef SENSOR_HAL_MAX30101
+#define SENSOR_HAL_MAX30101 1
+#endif
+#ifndef SENSOR_HAL_TCS34725
+#define SENSOR_HAL_TCS34725 0
+#endif
+
+typedef enum {
+    SENSOR_DISTANCE,
+    SENSOR_PPG,
+    SENSOR_COLOR,
+    SENSOR_KIND_COUNT,
+} sensor_kind_t;
+
+typedef struct {
+    uint64_t t_us;                  // instante da medição (time_us_64)
+    union {
+        struct {
+            uint16_t mm;
+            uint8_t status;         // RANGE_STATUS do VL53L1X; 0 no VL53L0X
+            uint8_t stream;
+        } distance;
+        ppg_result_t ppg;           // derivados; as amostras brutas ficam na tarefa PPG
+        tcs34725_rgbc_t color;
+    };
+} sensor_reading_t;
+
+// Ligação de placa de cada tipo: linha de interrupção (< 0 = sem) e período
+typedef struct {
+    int int_pin;
+    uint32_t period_ms;
+} sensor_wiring_t;
+
+// Endereços que responderam, um bit por endereço de 7 bits
+typedef struct {
+    uint32_t present[4];
+} sensor_scan_t;
+
+typedef struct sensor_driver {
+    const char *name;
+    sensor_kind_t kind;
+    uint8_t addr;
+    // Na tarefa dona do controlador (job de inc/i2c_bus.c)
+    bool (*probe)(i2c_inst_t *i2c, uint8_t addr);
+    bool (*init)(i2c_inst_t *i2c, uint8_t addr);
+    // Na tarefa que chama sensor_hal_discover(); NULL = nada a iniciar
+    bool (*start)(i2c_bus_id_t bus, uint8_t addr, const sensor_wiring_t *wiring);
+    // Até max leituras novas, da mais antiga para a mais nova; descarta as mais
+    // antigas que não couberem
+    size_t (*read_batch)(i2c_bus_id_t bus, uint8_t addr, sensor_reading_t *out, size_t max);
+} sensor_driver_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Varre 0x03..0x77 numa transação do gerenciador de barramento
+void sensor_hal_scan(i2c_bus_id_t bus, sensor_scan_t *out);
+
+static inline bool sensor_scan_has(const sensor_scan_t *scan, uint8_t addr)
+{
+    return (scan->present[addr / 32] >> (addr % 32)) & 1u;
+}
+
+// Registra os sensores encontrados em scan (wiring indexado por sensor_kind_t).
+// Chamada uma vez, antes de qualquer sensor_hal_read(). Retorna quantos ficaram ativos.
+size_t sensor_hal_discover(i2c_bus_id_t bus, const sensor_scan_t *scan, const sensor_wiring_t wiring[SENSOR_KIND_COUNT]);
+
+// Driver ativo do tipo, ou NULL
+const sensor_driver_t *sensor_hal_get(sensor_kind_t kind);
+
+// read_batch do driver ativo; 0 sem driver ou sem leitura nova
+size_t sensor_hal_read(sensor_kind_t kind, sensor_reading_t *out, size_t max);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,43 @@
+#include "inc/sensor_reg.h"
+#include <string.h>
+
+// Endereço do registrador (1 ou 2 bytes) e leitura com repeated start
+static bool ler(i2c_inst_t *i2c, uint8_t addr, const uint8_t *reg, size_t reg_len, uint8_t *buf, size_t len)
+{
+    if (i2c_write_blocking(i2c, addr, reg, reg_len, true) != (int)reg_len)
+        return false;
+    return i2c_read_blocking(i2c, addr, buf, len, false) == (int)len;
+}
+
+static bool escrever(i2c_inst_t *i2c, uint8_t addr, const uint8_t *reg, size_t reg_len, const uint8_t *buf,
+                     size_t len)
+{
+    uint8_t quadro[2 + SENSOR_REG_WRITE_MAX];
+    if (len > SENSOR_REG_WRITE_MAX)
+        return false;
+    memcpy(quadro, reg, reg_len);
+    memcpy(&quadro[reg_len], buf, len);
+    return i2c_write_blocking(i2c, addr, quadro, reg_len + len, false) == (int)(reg_len + len);
+}
+
+bool sensor_reg_read(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *buf, size_t len)
+{
+    return ler(i2c, addr, &reg, 1, buf, len);
+}
+
+bool sensor_reg_write(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, const uint8_t *buf, size_t len)
+{
+    return escrever(i2c, addr, &reg, 1, buf, len);
+}
+
+bool sensor_reg16_read(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t *buf, size_t len)
+{
+    const uint8_t r[2] = {(uint8_t)(reg >> 8), (uint8_t)reg};
+    return ler(i2c, addr, r, 2, buf, len);
+}
+
+bool sensor_reg16_write(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, const uint8_t *buf, size_t len)
+{
+    const uint8_t r[2] = {(uint8_t)(reg >> 8), (uint8_t)reg};
+    return escrever(i2c, addr, r, 2, buf, len);
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+// Acesso a registradores comum aos drivers I2C: endereço do registrador de 8
+// bits (BMP280, VL53L0X, MAX30101, TCS34725) ou de 16 bits, big-endian
+// (VL53L1X). A leitura escreve o endereço e lê com repeated start; a escrita vai
+// numa transação só, endereço seguido dos dados. Roda no contexto de quem já tem
+// o barramento (job de inc/i2c_bus.c ou a tarefa dona do controlador).
+
+// Maior escrita (dados, sem o endereço do registrador)
+#ifndef SENSOR_REG_WRITE_MAX
+#define SENSOR_REG_WRITE_MAX 8
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool sensor_reg_read(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *buf, size_t len);
+// false se len passar de SENSOR_REG_WRITE_MAX
+bool sensor_reg_write(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, const uint8_t *buf, size_t len);
+
+bool sensor_reg16_read(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t *buf, size_t len);
+bool sensor_reg16_write(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, const uint8_t *buf, size_t len);
+
+static inline bool sensor_reg_read8(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t *val)
+{
+    return sensor_reg_read(i2c, addr, reg, val, 1);
+}
+
+static inline bool sensor_reg_write8(i2c_inst_t *i2c, uint8_t addr, uint8_t reg, uint8_t val)
+{
+    return sensor_reg_write(i2c, addr, reg, &val, 1);
+}
+
+#ifdef __cplusplus
+}
+#endif
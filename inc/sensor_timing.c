@@ -0,0 +1,83 @@
+#include "inc/sensor_timing.h"
+#include "pico/stdlib.h"
+#include "inc/cbor.h"
+
+static sensor_timing_t s_t = {
+    .period_err = {.base_us = SENSOR_TIMING_PERIOD_BASE_US},
+    .latency = {.base_us = SENSOR_TIMING_LATENCY_BASE_US},
+};
+static uint64_t s_acordou_us;
+
+void timing_hist_add(timing_hist_t *h, uint32_t us)
+{
+    unsigned i = 0;
+    while (i < SENSOR_TIMING_BINS - 1 && us >= h->base_us << i)
+        i++;
+    h->bins[i]++;
+    if (us > h->max_us) h->max_us = us;
+    h->count++;
+}
+
+size_t timing_hist_encode(uint8_t *p, const timing_hist_t *h)
+{
+    unsigned n = SENSOR_TIMING_BINS;
+    while (n && h->bins[n - 1] == 0)
+        n--;
+    size_t len = cbor_array(p, 4);
+    len += cbor_uint(&p[len], h->base_us);
+    len += cbor_uint(&p[len], h->count);
+    len += cbor_uint(&p[len], h->max_us);
+    len += cbor_array(&p[len], n);
+    for (unsigned i = 0; i < n; ++i)
+        len += cbor_uint(&p[len], h->bins[i]);
+    return len;
+}
+
+void sensor_timing_start(uint32_t period_ms)
+{
+    s_t.period_ms = period_ms;
+    s_acordou_us = time_us_64();
+}
+
+void sensor_timing_wake(bool atrasado)
+{
+    uint64_t agora = time_us_64();
+    int64_t erro = (int64_t)(agora - s_acordou_us) - (int64_t)s_t.period_ms * 1000;
+    s_acordou_us = agora;
+    timing_hist_add(&s_t.period_err, (uint32_t)(erro < 0 ? -erro : erro));
+    if (atrasado) s_t.overruns++;
+    s_t.cycles++;
+}
+
+void sensor_timing_set_period(uint32_t period_ms)
+{
+    s_t.period_ms = period_ms;
+}
+
+void sensor_timing_cycle_end(void)
+{
+    uint32_t ativo = (uint32_t)(time_us_64() - s_acordou_us);
+    if (ativo > s_t.active_max_us) s_t.active_max_us = ativo;
+}
+
+void sensor_timing_published(uint32_t t_us)
+{
+    timing_hist_add(&s_t.latency, time_us_32() - t_us);
+}
+
+void sensor_timing_get(sensor_timing_t *out)
+{
+    *out = s_t;
+}
+
+size_t sensor_timing_encode(uint8_t *p)
+{
+    size_t len = cbor_array(p, 6);
+    len += cbor_uint(&p[len], s_t.period_ms);
+    len += cbor_uint(&p[len], s_t.cycles);
+    len += cbor_uint(&p[len], s_t.overruns);
+    len += cbor_uint(&p[len], s_t.active_max_us);
+    len += timing_hist_encode(&p[len], &s_t.period_err);
+    len += timing_hist_encode(&p[len], &s_t.latency);
+    return len;
+}
@@ -0,0 +1,77 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Prazos do laço de aquisição (tarefaSensorBMP280) e latência até a publicação.
+//
+// O laço acorda em prazos absolutos (xTaskDelayUntil), então o período não
+// acumula o tempo gasto com I2C, printf e display. Aqui ficam, em histogramas
+// de faixas em potência de 2:
+//   - erro de período: |intervalo entre dois despertares - período nominal|;
+//   - latência: instante da amostra (t_us, em µs) até a publicação ao vivo ser
+//     aceita pelo lwIP (amostras reenviadas do diário não entram).
+// Também conta ciclos, prazos perdidos (o ciclo passou do prazo seguinte) e o
+// maior tempo ativo de um ciclo. Os valores vão no registro de diagnóstico
+// (inc/diag.c).
+//
+// O laço roda no núcleo de aquisição e a publicação no de rede: cada campo é
+// escrito por uma tarefa só e lido sem trava, em palavras inteiras.
+
+#define SENSOR_TIMING_BINS 16
+
+// Faixa i: valores < base_us << i; a última recebe o que sobrar
+#ifndef SENSOR_TIMING_PERIOD_BASE_US
+#define SENSOR_TIMING_PERIOD_BASE_US 250
+#endif
+
+#ifndef SENSOR_TIMING_LATENCY_BASE_US
+#define SENSOR_TIMING_LATENCY_BASE_US 1000
+#endif
+
+typedef struct {
+    uint32_t base_us;
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t bins[SENSOR_TIMING_BINS];
+} timing_hist_t;
+
+typedef struct {
+    uint32_t period_ms;
+    uint32_t cycles;
+    uint32_t overruns;
+    uint32_t active_max_us;
+    timing_hist_t period_err;
+    timing_hist_t latency;
+} sensor_timing_t;
+
+// CBOR de um histograma: [base_us, count, max_us, [bins...]], sem as faixas vazias do fim
+#define TIMING_HIST_CBOR_MAX_BYTES (1 + 3 * 5 + 1 + SENSOR_TIMING_BINS * 5)
+// [period_ms, cycles, overruns, active_max_us, period_err, latency]
+#define SENSOR_TIMING_CBOR_MAX_BYTES (1 + 4 * 5 + 2 * TIMING_HIST_CBOR_MAX_BYTES)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void timing_hist_add(timing_hist_t *h, uint32_t us);
+size_t timing_hist_encode(uint8_t *p, const timing_hist_t *h);
+
+// Chamadas do laço: início (antes do primeiro prazo), a cada despertar e no fim
+// do trabalho do ciclo (atrasado = xTaskDelayUntil não precisou esperar)
+void sensor_timing_start(uint32_t period_ms);
+void sensor_timing_wake(bool atrasado);
+void sensor_timing_cycle_end(void);
+// Período do próximo ciclo, quando o laço o ajusta (relato por exceção, inc/rbe.c)
+void sensor_timing_set_period(uint32_t period_ms);
+
+// Amostra de instante t_us (time_us_32) publicada ao vivo; a diferença em 32
+// bits vale até ~71 min, bem acima do que uma amostra espera no anel
+void sensor_timing_published(uint32_t t_us);
+
+void sensor_timing_get(sensor_timing_t *out);
+size_t sensor_timing_encode(uint8_t *p);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,14 +1,54 @@
 #include "ssd1306.h"
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#if SSD1306_USE_DMA
+#include "hardware/dma.h"
+#include "hardware/irq.h"
+#endif
 
 #define SSD1306_WIDTH 128
 #define SSD1306_HEIGHT 64
+#define SSD1306_PAGES (SSD1306_HEIGHT / 8)
+
+// Cabeçalho de cada janela: 6 comandos com Co=1 (0x80 + cmd) e o byte de controle 0x40
+#define SSD1306_WINDOW_HDR 13
+#define SSD1306_TX_MAX (SSD1306_WIDTH * SSD1306_PAGES + SSD1306_PAGES * SSD1306_WINDOW_HDR)
 
 static i2c_inst_t *g_i2c = NULL;
 static uint8_t g_addr = 0x3C; // padrão
 static uint8_t fb[SSD1306_WIDTH * SSD1306_HEIGHT / 8];
 
+// Conteúdo que a GDDRAM tem (ou terá, após o envio preparado): base da comparação
+static uint8_t shadow[sizeof(fb)];
+static uint8_t dirty_pages;      // bit p = página p pode ter mudado desde a última preparação
+static bool full_refresh;        // GDDRAM com conteúdo desconhecido (após init)
+
+// Janelas preparadas, no formato do IC_DATA_CMD (bit 9 = STOP no último byte de cada janela)
+static uint16_t tx[SSD1306_TX_MAX];
+static size_t tx_len;
+static uint8_t tx_windows;
+static volatile bool flush_busy;
+static ssd1306_stats_t g_stats;
+
+#if SSD1306_USE_DMA
+#define SSD1306_I2C_IRQ_BITS (I2C_IC_INTR_MASK_M_STOP_DET_BITS | I2C_IC_INTR_MASK_M_TX_ABRT_BITS)
+
+static int dma_chan = -1;
+static TaskHandle_t dma_waiter;
+static TaskHandle_t i2c_waiter;
+static void ssd1306_i2c_irq(void);
+
+static void ssd1306_dma_irq(void) {
+    if (dma_chan < 0 || !dma_channel_get_irq1_status((uint)dma_chan)) return;
+    dma_channel_acknowledge_irq1((uint)dma_chan);
+    BaseType_t woken = pdFALSE;
+    if (dma_waiter) vTaskNotifyGiveFromISR(dma_waiter, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
 static inline int clamp(int v, int lo, int hi) { return v < lo ? lo : (v > hi ? hi : v); }
 
 static void ssd1306_write_cmd(uint8_t cmd) {
@@ -16,24 +56,27 @@ static void ssd1306_write_cmd(uint8_t cmd) {
     i2c_write_blocking(g_i2c, g_addr, buf, 2, false);
 }
 
-static void ssd1306_write_data(const uint8_t *data, size_t len) {
-    // Envia em blocos com control byte 0x40
-    const size_t chunk = 16;
-    uint8_t out[1 + chunk];
-    out[0] = 0x40;
-    while (len) {
-        size_t n = len > chunk ? chunk : len;
-        for (size_t i = 0; i < n; ++i) out[1 + i] = data[i];
-        i2c_write_blocking(g_i2c, g_addr, out, 1 + n, false);
-        data += n;
-        len -= n;
-    }
-}
-
 bool ssd1306_init(i2c_inst_t *i2c, uint8_t addr) {
     g_i2c = i2c;
     g_addr = addr;
 
+#if SSD1306_USE_DMA
+    if (dma_chan < 0) {
+        dma_chan = dma_claim_unused_channel(false);
+        if (dma_chan >= 0) {
+            irq_add_shared_handler(DMA_IRQ_1, ssd1306_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(DMA_IRQ_1, true);
+            dma_channel_set_irq1_enabled((uint)dma_chan, true);
+            // Os drivers bloqueantes do SDK leem raw_intr_stat: a máscara fica
+            // fechada e só ssd1306_wait_idle a abre
+            uint irq = i2c_get_index(i2c) ? I2C1_IRQ : I2C0_IRQ;
+            i2c->hw->intr_mask = 0;
+            irq_add_shared_handler(irq, ssd1306_i2c_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+            irq_set_enabled(irq, true);
+        }
+    }
+#endif
+
     // Init sequence (internal VCC, horizontal addressing)
     ssd1306_write_cmd(0xAE); // display off
     ssd1306_write_cmd(0xD5); ssd1306_write_cmd(0x80); // clock
@@ -52,10 +95,8 @@ bool ssd1306_init(i2c_inst_t *i2c, uint8_t addr) {
     ssd1306_write_cmd(0xA6); // normal display
     ssd1306_write_cmd(0x2E); // deactivate scroll
 
-    // set column/page range
-    ssd1306_write_cmd(0x21); ssd1306_write_cmd(0x00); ssd1306_write_cmd(SSD1306_WIDTH - 1);
-    ssd1306_write_cmd(0x22); ssd1306_write_cmd(0x00); ssd1306_write_cmd((SSD1306_HEIGHT/8) - 1);
-
+    // GDDRAM tem lixo após o power-up: a primeira atualização envia a tela inteira
+    full_refresh = true;
     ssd1306_clear();
     ssd1306_update();
     ssd1306_write_cmd(0xAF); // display on
@@ -64,12 +105,222 @@ bool ssd1306_init(i2c_inst_t *i2c, uint8_t addr) {
 
 void ssd1306_clear(void) {
     for (size_t i = 0; i < sizeof(fb); ++i) fb[i] = 0x00;
+    dirty_pages = 0xFF;
+}
+
+static void tx_put(uint16_t w) { tx[tx_len++] = w; }
+
+static void tx_cmd(uint8_t cmd) {
+    tx_put(0x80);   // Co=1, D/C=0: um comando e volta a esperar byte de controle
+    tx_put(cmd);
+}
+
+// Uma janela = uma escrita I2C: endereçamento 0x21/0x22 + dados do retângulo
+static void tx_window(int p0, int p1, int c0, int c1) {
+    tx_cmd(0x21); tx_cmd((uint8_t)c0); tx_cmd((uint8_t)c1);
+    tx_cmd(0x22); tx_cmd((uint8_t)p0); tx_cmd((uint8_t)p1);
+    tx_put(0x40);   // Co=0, D/C=1: o restante da transação é GDDRAM
+    for (int p = p0; p <= p1; ++p) {
+        const uint8_t *src = &fb[p * SSD1306_WIDTH];
+        uint8_t *dst = &shadow[p * SSD1306_WIDTH];
+        for (int c = c0; c <= c1; ++c) {
+            tx_put(src[c]);
+            dst[c] = src[c];
+        }
+    }
+    tx[tx_len - 1] |= SSD1306_TX_STOP;
+    tx_windows++;
+    g_stats.data_bytes += (uint32_t)((p1 - p0 + 1) * (c1 - c0 + 1));
+}
+
+bool ssd1306_flush_prepare(void) {
+    if (flush_busy) return false;
+    tx_len = 0;
+    tx_windows = 0;
+
+    if (full_refresh) {
+        full_refresh = false;
+        dirty_pages = 0;
+        tx_window(0, SSD1306_PAGES - 1, 0, SSD1306_WIDTH - 1);
+    } else {
+        // Faixa de colunas realmente alterada em cada página
+        int lo[SSD1306_PAGES], hi[SSD1306_PAGES];
+        for (int p = 0; p < SSD1306_PAGES; ++p) {
+            lo[p] = SSD1306_WIDTH;
+            hi[p] = -1;
+            if (!(dirty_pages & (1u << p))) continue;
+            const uint8_t *a = &fb[p * SSD1306_WIDTH];
+            const uint8_t *b = &shadow[p * SSD1306_WIDTH];
+            for (int c = 0; c < SSD1306_WIDTH; ++c) {
+                if (a[c] == b[c]) continue;
+                if (lo[p] == SSD1306_WIDTH) lo[p] = c;
+                hi[p] = c;
+            }
+        }
+        dirty_pages = 0;
+
+        // Junta páginas consecutivas num retângulo quando isso custa menos
+        // bytes que abrir outra janela (cabeçalho de SSD1306_WINDOW_HDR bytes)
+        int p = 0;
+        while (p < SSD1306_PAGES) {
+            if (hi[p] < 0) { p++; continue; }
+            int p0 = p, c0 = lo[p], c1 = hi[p];
+            int custo = c1 - c0 + 1;
+            while (p + 1 < SSD1306_PAGES && hi[p + 1] >= 0) {
+                int n0 = lo[p + 1] < c0 ? lo[p + 1] : c0;
+                int n1 = hi[p + 1] > c1 ? hi[p + 1] : c1;
+                int junto = (p + 2 - p0) * (n1 - n0 + 1);
+                int separado = custo + SSD1306_WINDOW_HDR + (hi[p + 1] - lo[p + 1] + 1);
+                if (junto > separado) break;
+                c0 = n0; c1 = n1; custo = junto;
+                p++;
+            }
+            tx_window(p0, p, c0, c1);
+            p++;
+        }
+    }
+
+    if (!tx_windows) return false;
+    flush_busy = true;
+    return true;
+}
+
+#if SSD1306_USE_DMA
+static bool ssd1306_i2c_idle(const i2c_hw_t *hw) {
+    return (hw->status & I2C_IC_STATUS_TFE_BITS) && !(hw->status & I2C_IC_STATUS_MST_ACTIVITY_BITS);
+}
+
+// Interrupção do controlador só durante ssd1306_wait_idle (STOP_DET/TX_ABRT):
+// mascara de novo e acorda a tarefa, que confere o estado e rearma
+static void ssd1306_i2c_irq(void) {
+    if (!g_i2c || !i2c_waiter || !(g_i2c->hw->intr_stat & SSD1306_I2C_IRQ_BITS)) return;
+    g_i2c->hw->intr_mask = 0;
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(i2c_waiter, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+// Fim da transmissão não visto no prazo (barramento preso, escravo segurando
+// SCL): aborta no controlador, que esvazia a FIFO e gera STOP, e para a DMA
+static void ssd1306_abort(void) {
+    i2c_hw_t *hw = g_i2c->hw;
+    dma_channel_abort((uint)dma_chan);
+    hw->enable = I2C_IC_ENABLE_ENABLE_BITS | I2C_IC_ENABLE_ABORT_BITS;
+    uint64_t prazo = time_us_64() + SSD1306_IDLE_TIMEOUT_US;
+    while ((hw->enable & I2C_IC_ENABLE_ABORT_BITS) && time_us_64() < prazo)
+        tight_loop_contents();
+    // Sem STOP nem assim: desliga o controlador para descartar a transferência
+    if (hw->enable & I2C_IC_ENABLE_ABORT_BITS) {
+        hw->enable = 0;
+        hw->enable = I2C_IC_ENABLE_ENABLE_BITS;
+    }
+    (void)hw->clr_tx_abrt;
+}
+
+// A DMA termina ao colocar o último byte na FIFO; espera a FIFO esvaziar e o
+// STOP final sair (no máximo 16 bytes, ~360 us a 400 kHz), dormindo entre as
+// interrupções de STOP de cada janela. Sem fim em SSD1306_IDLE_TIMEOUT_US, aborta.
+static bool ssd1306_wait_idle(void) {
+    i2c_hw_t *hw = g_i2c->hw;
+    uint64_t prazo = time_us_64() + SSD1306_IDLE_TIMEOUT_US;
+    bool idle;
+    i2c_waiter = xTaskGetCurrentTaskHandle();
+    while (!(idle = ssd1306_i2c_idle(hw)) && !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        uint64_t agora = time_us_64();
+        if (agora >= prazo) break;
+        (void)hw->clr_stop_det;
+        hw->intr_mask = SSD1306_I2C_IRQ_BITS;
+        // O STOP pode ter saído antes de a máscara ser armada
+        if (ssd1306_i2c_idle(hw)) continue;
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS((uint32_t)(prazo - agora) / 1000) + 1);
+    }
+    hw->intr_mask = 0;
+    i2c_waiter = NULL;
+    if (!idle && !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS)) {
+        ssd1306_abort();
+        return false;
+    }
+    // Abortada pelo próprio controlador (NACK): a FIFO é descartada em seguida
+    while (!ssd1306_i2c_idle(hw) && time_us_64() < prazo)
+        tight_loop_contents();
+    bool ok = hw->tx_abrt_source == 0;
+    (void)hw->clr_tx_abrt;
+    return ok;
+}
+
+static bool ssd1306_send_dma(void) {
+    i2c_hw_t *hw = g_i2c->hw;
+    hw->enable = 0;
+    hw->tar = g_addr;
+    hw->dma_tdlr = 8;
+    hw->dma_cr = I2C_IC_DMA_CR_TDMAE_BITS;
+    hw->enable = 1;
+
+    dma_channel_config cfg = dma_channel_get_default_config((uint)dma_chan);
+    channel_config_set_transfer_data_size(&cfg, DMA_SIZE_16);
+    channel_config_set_read_increment(&cfg, true);
+    channel_config_set_write_increment(&cfg, false);
+    channel_config_set_dreq(&cfg, i2c_get_dreq(g_i2c, true));
+
+    // Todas as janelas num único disparo: o STOP de cada uma encerra a escrita I2C
+    // e o byte seguinte abre a próxima, sem a CPU intervir entre elas
+    dma_waiter = xTaskGetCurrentTaskHandle();
+    ulTaskNotifyTake(pdTRUE, 0);   // descarta notificação atrasada de um envio anterior
+    dma_channel_configure((uint)dma_chan, &cfg, &hw->data_cmd, tx, tx_len, true);
+
+    // ~25 ms para a tela inteira a 400 kHz
+    bool ok = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SSD1306_DMA_TIMEOUT_MS)) > 0;
+    dma_waiter = NULL;
+    if (!ok) dma_channel_abort((uint)dma_chan);
+    ok = ssd1306_wait_idle() && ok;
+    hw->dma_cr = 0;
+    return ok;
+}
+#else
+// Sem DMA: a mesma sequência de janelas, uma i2c_write_blocking por janela
+static bool ssd1306_send_blocking(void) {
+    static uint8_t out[SSD1306_TX_MAX];
+    bool ok = true;
+    size_t n = 0;
+    for (size_t i = 0; i < tx_len; ++i) {
+        out[n++] = (uint8_t)tx[i];
+        if (!(tx[i] & SSD1306_TX_STOP)) continue;
+        ok = i2c_write_blocking(g_i2c, g_addr, out, n, false) == (int)n && ok;
+        n = 0;
+    }
+    return ok;
+}
+#endif
+
+bool ssd1306_flush_send(void) {
+    if (!flush_busy) return true;
+#if SSD1306_USE_DMA
+    bool ok = dma_chan >= 0 ? ssd1306_send_dma() : false;
+#else
+    bool ok = ssd1306_send_blocking();
+#endif
+    g_stats.flushes++;
+    g_stats.windows += tx_windows;
+    // Em caso de falha a GDDRAM fica indefinida: reenvia tudo na próxima vez
+    if (!ok) {
+        g_stats.errors++;
+        full_refresh = true;
+    }
+    flush_busy = false;
+    return ok;
+}
+
+bool ssd1306_flush_busy(void) {
+    return flush_busy;
 }
 
 void ssd1306_update(void) {
-    ssd1306_write_cmd(0x21); ssd1306_write_cmd(0x00); ssd1306_write_cmd(SSD1306_WIDTH - 1);
-    ssd1306_write_cmd(0x22); ssd1306_write_cmd(0x00); ssd1306_write_cmd((SSD1306_HEIGHT/8) - 1);
-    ssd1306_write_data(fb, sizeof(fb));
+    if (ssd1306_flush_prepare())
+        ssd1306_flush_send();
+}
+
+void ssd1306_get_stats(ssd1306_stats_t *out) {
+    *out = g_stats;
 }
 
 void ssd1306_set_pixel(int x, int y, bool on) {
@@ -78,6 +329,7 @@ void ssd1306_set_pixel(int x, int y, bool on) {
     int bit = y & 7;
     size_t idx = page * SSD1306_WIDTH + x;
     if (on) fb[idx] |= (1u << bit); else fb[idx] &= ~(1u << bit);
+    dirty_pages |= (uint8_t)(1u << page);
 }
 
 void ssd1306_draw_line(int x0, int y0, int x1, int y1, bool on) {
@@ -4,10 +4,50 @@
 #include <stdbool.h>
 
 // SSD1306 128x64 I2C driver (minimal)
+//
+// O framebuffer é comparado com uma cópia do que já está na GDDRAM; só os
+// retângulos alterados são enviados, cada um numa única escrita I2C com o
+// endereçamento 0x21/0x22 embutido (bytes de controle com Co=1). Com
+// SSD1306_USE_DMA a escrita é alimentada por DMA e a tarefa que envia dorme
+// até a interrupção de fim de transferência (notificação no índice 0).
+
+#ifndef SSD1306_USE_DMA
+#define SSD1306_USE_DMA 1
+#endif
+
+#ifndef SSD1306_DMA_TIMEOUT_MS
+#define SSD1306_DMA_TIMEOUT_MS 100
+#endif
+
+// Depois da DMA: FIFO do controlador esvaziando e STOP final; vencido, a transferência é abortada
+#ifndef SSD1306_IDLE_TIMEOUT_US
+#define SSD1306_IDLE_TIMEOUT_US 2000
+#endif
+
+// Bit de STOP do registrador IC_DATA_CMD do RP2040
+#define SSD1306_TX_STOP (1u << 9)
+
+typedef struct {
+    uint32_t flushes;      // envios concluídos
+    uint32_t windows;      // janelas (escritas I2C) enviadas
+    uint32_t data_bytes;   // bytes de GDDRAM enviados
+    uint32_t errors;
+} ssd1306_stats_t;
 
 bool ssd1306_init(i2c_inst_t *i2c, uint8_t addr);
 void ssd1306_clear(void);
+// Prepara e envia na hora (bloqueia até o fim)
 void ssd1306_update(void);
+// Envio em duas etapas, para não bloquear quem desenha:
+//   ssd1306_flush_prepare() copia as janelas alteradas para o buffer de
+//   transmissão (só CPU, sem barramento); false se nada mudou ou se o envio
+//   anterior ainda está pendente (as alterações ficam para a próxima vez).
+//   ssd1306_flush_send() transmite o que foi preparado; o framebuffer pode ser
+//   redesenhado enquanto isso.
+bool ssd1306_flush_prepare(void);
+bool ssd1306_flush_send(void);
+bool ssd1306_flush_busy(void);
+void ssd1306_get_stats(ssd1306_stats_t *out);
 void ssd1306_set_pixel(int x, int y, bool on);
 void ssd1306_draw_line(int x0, int y0, int x1, int y1, bool on);
 void ssd1306_draw_circle(int cx, int cy, int r, bool on);
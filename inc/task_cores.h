@@ -0,0 +1,123 @@
+#pragma once
+#include "FreeRTOS.h"
+#include "task.h"
+
+// Mapa de núcleos e prioridades das tarefas do firmware (FreeRTOS SMP no RP2040).
+//
+// Núcleo 0 (CORE_REDE): tick do kernel, tarefa do driver CYW43 (async_context),
+// tcpip_thread do lwIP, gerenciador da conexão (inc/net_conn.c) e tarefaMQTT. A interrupção do CYW43 é instalada por
+// cyw43_arch_init(), chamada de tarefaMQTT, e por isso também fica no núcleo 0.
+//
+// Núcleo 1 (CORE_AQUISICAO): tarefas donas do I2C, aquisição do ToF e do
+// MAX30101, laço do sensor/display e botão. As interrupções de GPIO e DMA desses
+// drivers são habilitadas a partir dessas tarefas e ficam no núcleo 1.
+//
+// Uma rajada de tráfego Wi-Fi disputa CPU só com a rede; a aquisição não perde o prazo.
+// Prioridade maior = mais urgente. Em cada núcleo, quem atende o barramento fica
+// acima de quem espera por ele.
+
+#define TASK_CORE_ANY (-1)
+
+#ifndef CORE_REDE
+#define CORE_REDE 0
+#endif
+
+#ifndef CORE_AQUISICAO
+#define CORE_AQUISICAO 1
+#endif
+
+// --- Núcleo de rede (tcpip_thread: TCPIP_THREAD_PRIO = 5 em lwipopts.h) ---
+#ifndef CYW43_TASK_PRIO
+#define CYW43_TASK_PRIO 4
+#endif
+
+#ifndef NET_CONN_TASK_PRIO
+#define NET_CONN_TASK_PRIO 3          // quase sempre bloqueada à espera de um callback do lwIP
+#endif
+
+#ifndef MQTT_TASK_PRIO
+#define MQTT_TASK_PRIO 2
+#endif
+
+#ifndef CORE_LOAD_TASK_PRIO
+#define CORE_LOAD_TASK_PRIO 1         // relatório do perfil de carga (inc/core_load.c)
+#endif
+
+#ifndef LOG_TASK_PRIO
+#define LOG_TASK_PRIO 1               // formatação do log diferido (inc/log_async.c)
+#endif
+
+// --- Núcleo de aquisição ---
+#ifndef I2C_BUS_TASK_PRIORITY
+#define I2C_BUS_TASK_PRIORITY 4
+#endif
+#ifndef I2C_BUS_TASK_CORE
+#define I2C_BUS_TASK_CORE CORE_AQUISICAO
+#endif
+
+#ifndef VL53L1X_RANGING_TASK_PRIO
+#define VL53L1X_RANGING_TASK_PRIO 3
+#endif
+#ifndef VL53L1X_RANGING_TASK_CORE
+#define VL53L1X_RANGING_TASK_CORE CORE_AQUISICAO
+#endif
+
+#ifndef MAX30101_PPG_TASK_PRIO
+#define MAX30101_PPG_TASK_PRIO 3
+#endif
+#ifndef MAX30101_PPG_TASK_CORE
+#define MAX30101_PPG_TASK_CORE CORE_AQUISICAO
+#endif
+
+#ifndef SENSOR_TASK_PRIO
+#define SENSOR_TASK_PRIO 2
+#endif
+
+#ifndef BOTAO_TASK_PRIO
+#define BOTAO_TASK_PRIO 1
+#endif
+
+// Cria a tarefa já presa ao núcleo `core` (TASK_CORE_ANY = sem afinidade).
+// Sem SMP/afinidade no kernel (simulação no host) o núcleo é ignorado.
+static inline BaseType_t task_create_on(TaskFunction_t fn, const char *name, configSTACK_DEPTH_TYPE stack,
+                                        void *arg, UBaseType_t prio, int core, TaskHandle_t *out)
+{
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    if (core >= 0)
+        return xTaskCreateAffinitySet(fn, name, stack, arg, prio, (UBaseType_t)1 << core, out);
+#else
+    (void)core;
+#endif
+    return xTaskCreate(fn, name, stack, arg, prio, out);
+}
+
+// Prende ao núcleo uma tarefa criada por outro código (ex.: tcpip_thread do lwIP)
+static inline void task_pin(TaskHandle_t t, int core)
+{
+#if configUSE_CORE_AFFINITY && configNUMBER_OF_CORES > 1
+    if (t && core >= 0)
+        vTaskCoreAffinitySet(t, (UBaseType_t)1 << core);
+#else
+    (void)t;
+    (void)core;
+#endif
+}
+
+// Prende a tarefa ociosa de cada núcleo a ele. O kernel cria as ociosas com
+// configTASK_DEFAULT_CORE_AFFINITY (sem afinidade) e elas trocam de núcleo; a
+// carga por núcleo (inc/core_load.c) toma o tempo de execução da ociosa c como
+// o ocioso do núcleo c e só vale com elas presas. Chamar com o escalonador já
+// rodando, antes da primeira amostra.
+static inline void task_pin_idle(void)
+{
+    for (int c = 0; c < configNUMBER_OF_CORES; ++c)
+        task_pin(xTaskGetIdleTaskHandleForCore(c), c);
+}
+
+#if configGENERATE_RUN_TIME_STATS
+// Tempo ocioso acumulado do núcleo `core` (depois de task_pin_idle())
+static inline configRUN_TIME_COUNTER_TYPE task_idle_run_time(int core)
+{
+    return ulTaskGetRunTimeCounter(xTaskGetIdleTaskHandleForCore(core));
+}
+#endif
@@ -0,0 +1,28 @@
+#include "inc/tcs34725.h"
+#include "inc/sensor_reg.h"
+#include "pico/stdlib.h"
+
+bool tcs34725_read_id(i2c_inst_t *i2c, uint8_t addr, uint8_t *out_id) {
+    return sensor_reg_read8(i2c, addr, TCS34725_CMD | TCS34725_REG_ID, out_id);
+}
+
+bool tcs34725_init(i2c_inst_t *i2c, uint8_t addr) {
+    if (!sensor_reg_write8(i2c, addr, TCS34725_CMD | TCS34725_REG_ATIME, TCS34725_ATIME_24MS)) return false;
+    if (!sensor_reg_write8(i2c, addr, TCS34725_CMD | TCS34725_REG_CONTROL, TCS34725_GAIN_4X)) return false;
+    // PON primeiro; o ADC só pode ser habilitado 2,4 ms depois
+    if (!sensor_reg_write8(i2c, addr, TCS34725_CMD | TCS34725_REG_ENABLE, TCS34725_ENABLE_PON)) return false;
+    sleep_ms(3);
+    return sensor_reg_write8(i2c, addr, TCS34725_CMD | TCS34725_REG_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+}
+
+bool tcs34725_read_rgbc(i2c_inst_t *i2c, uint8_t addr, tcs34725_rgbc_t *out) {
+    // STATUS e os 8 bytes de dados são consecutivos: uma leitura só
+    uint8_t buf[9];
+    if (!sensor_reg_read(i2c, addr, TCS34725_CMD_AUTO_INC | TCS34725_REG_STATUS, buf, sizeof buf)) return false;
+    if (!(buf[0] & TCS34725_STATUS_AVALID)) return false;
+    out->clear = (uint16_t)(buf[1] | buf[2] << 8);
+    out->red = (uint16_t)(buf[3] | buf[4] << 8);
+    out->green = (uint16_t)(buf[5] | buf[6] << 8);
+    out->blue = (uint16_t)(buf[7] | buf[8] << 8);
+    return true;
+}
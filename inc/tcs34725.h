@@ -0,0 +1,49 @@
+#pragma once
+#include <stdbool.h>
+#include <stdint.h>
+#include "hardware/i2c.h"
+
+#define TCS34725_I2C_ADDR 0x29   // o mesmo dos sensores ToF: um ou outro no barramento
+
+// Todo acesso leva o bit de comando; com TCS34725_CMD_AUTO_INC o endereço avança a cada byte
+#define TCS34725_CMD               0x80
+#define TCS34725_CMD_AUTO_INC      0xA0
+
+#define TCS34725_REG_ENABLE        0x00
+#define TCS34725_REG_ATIME         0x01
+#define TCS34725_REG_CONTROL       0x0F
+#define TCS34725_REG_ID            0x12
+#define TCS34725_REG_STATUS        0x13
+#define TCS34725_REG_CDATAL        0x14   // C, R, G, B: 16 bits cada, little-endian
+
+#define TCS34725_ENABLE_PON        0x01
+#define TCS34725_ENABLE_AEN        0x02
+#define TCS34725_STATUS_AVALID     0x01
+
+#define TCS34725_ID                0x44   // TCS34721/TCS34725
+#define TCS34727_ID                0x4D   // TCS34723/TCS34727
+
+// Integração de 24 ms (ATIME = 256 - 24 / 2,4), ganho 4x
+#define TCS34725_ATIME_24MS        0xF6
+#define TCS34725_GAIN_4X           0x01
+
+typedef struct {
+    uint16_t clear;
+    uint16_t red;
+    uint16_t green;
+    uint16_t blue;
+} tcs34725_rgbc_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool tcs34725_read_id(i2c_inst_t *i2c, uint8_t addr, uint8_t *out_id);
+// Liga o oscilador e o ADC RGBC, integrando continuamente
+bool tcs34725_init(i2c_inst_t *i2c, uint8_t addr);
+// false também enquanto a primeira integração não terminou (AVALID)
+bool tcs34725_read_rgbc(i2c_inst_t *i2c, uint8_t addr, tcs34725_rgbc_t *out);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,91 @@
+#include "inc/telemetry.h"
+#include "inc/cbor.h"
+#include <stdio.h>
+#include <string.h>
+
+_Static_assert(TELEMETRY_BATCH_MAX >= 1 && TELEMETRY_BATCH_MAX <= 23,
+               "o contador do lote ocupa um único byte de cabeçalho CBOR");
+
+// Decimal com duas casas a partir de centésimos, sem passar por float
+static int fmt_c100(char *buf, size_t cap, int32_t v)
+{
+    uint32_t a = v < 0 ? (uint32_t)-v : (uint32_t)v;
+    return snprintf(buf, cap, "%s%lu.%02lu", v < 0 ? "-" : "", (unsigned long)(a / 100), (unsigned long)(a % 100));
+}
+
+size_t telemetry_encode_json(const telemetry_sample_t *s, const telemetry_meta_t *meta, char *buf, size_t cap)
+{
+    char temp[12], limiar[12];
+    fmt_c100(temp, sizeof temp, s->temp_c100);
+    fmt_c100(limiar, sizeof limiar, meta->temp_threshold_c100);
+
+    int n = snprintf(buf, cap, "{\"seq\": %lu, \"temp\": %s, \"pres\": %lu, \"dist\": %u, \"threshold_mm\": %u, \"temp_threshold_c\": %s",
+                     (unsigned long)s->seq, temp, (unsigned long)s->pres_pa, (unsigned)s->dist_mm, (unsigned)meta->dist_threshold_mm, limiar);
+    // Oxímetro só entra no payload com medição válida
+    if (s->bpm_x10 && n > 0 && (size_t)n < cap)
+        n += snprintf(buf + n, cap - n, ", \"bpm\": %u.%u, \"spo2\": %u.%u", s->bpm_x10 / 10, s->bpm_x10 % 10,
+                      s->spo2_x10 / 10, s->spo2_x10 % 10);
+    if (n > 0 && (size_t)n < cap)
+        n += snprintf(buf + n, cap - n, "}");
+    return (n > 0 && (size_t)n < cap) ? (size_t)n : 0;
+}
+
+void telemetry_batch_begin(telemetry_batch_t *b, uint8_t *buf, size_t cap, const telemetry_meta_t *meta)
+{
+    memset(b, 0, sizeof *b);
+    b->buf = buf;
+    b->cap = cap;
+    b->meta = *meta;
+}
+
+bool telemetry_batch_add(telemetry_batch_t *b, const telemetry_sample_t *s)
+{
+    if (b->count == TELEMETRY_BATCH_MAX) return false;
+    if (b->count && s->seq != b->seq0 + b->count) return false;
+
+    uint8_t tmp[TELEMETRY_CBOR_HEADER_MAX + TELEMETRY_CBOR_SAMPLE_MAX];
+    size_t n = 0;
+    size_t count_pos = 0;
+    uint32_t dt = 0;
+
+    if (b->count == 0) {
+        n += cbor_array(&tmp[n], 6);
+        n += cbor_uint(&tmp[n], TELEMETRY_CBOR_VERSION);
+        n += cbor_uint(&tmp[n], s->seq);
+        n += cbor_uint(&tmp[n], s->t_ms);
+        n += cbor_uint(&tmp[n], b->meta.dist_threshold_mm);
+        n += cbor_int(&tmp[n], b->meta.temp_threshold_c100);
+        count_pos = n;
+        tmp[n++] = 0x80;   // array de amostras; contagem ajustada em telemetry_batch_finish
+        b->seq0 = s->seq;
+        b->t0_ms = s->t_ms;
+    } else {
+        dt = s->t_ms - b->t_prev_ms;
+    }
+
+    bool ppg = s->bpm_x10 != 0;
+    n += cbor_array(&tmp[n], ppg ? 6 : 4);
+    n += cbor_uint(&tmp[n], dt);
+    n += cbor_int(&tmp[n], s->temp_c100);
+    n += cbor_uint(&tmp[n], s->pres_pa);
+    n += cbor_uint(&tmp[n], s->dist_mm);
+    if (ppg) {
+        n += cbor_uint(&tmp[n], s->bpm_x10);
+        n += cbor_uint(&tmp[n], s->spo2_x10);
+    }
+
+    if (b->len + n > b->cap) return false;
+    memcpy(b->buf + b->len, tmp, n);
+    if (b->count == 0) b->count_pos = b->len + count_pos;
+    b->len += n;
+    b->count++;
+    b->t_prev_ms = s->t_ms;
+    return true;
+}
+
+size_t telemetry_batch_finish(telemetry_batch_t *b)
+{
+    if (b->count == 0) return 0;
+    b->buf[b->count_pos] = (uint8_t)(0x80 | b->count);
+    return b->len;
+}
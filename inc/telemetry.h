@@ -0,0 +1,93 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Codificação da telemetria publicada em MQTT.
+//   TELEMETRY_JSON: um objeto JSON por amostra no tópico TELEMETRY_TOPIC_JSON
+//                   (formato histórico; números formatados a partir de inteiros)
+//   TELEMETRY_CBOR: até TELEMETRY_BATCH_MAX amostras por publicação em CBOR
+//                   (RFC 8949) no tópico TELEMETRY_TOPIC_CBOR, com tempo em delta
+//
+// Lote CBOR, versão 2 (array de 6 itens):
+//   [2, seq0, t0_ms, dist_threshold_mm, temp_threshold_c100,
+//    [[dt_ms, temp_c100, pres_pa, dist_mm (, bpm_x10, spo2_x10)], ...]]
+// As amostras de um lote têm números de sequência consecutivos a partir de seq0;
+// dt_ms é relativo à amostra anterior (0 na primeira, que vale t0_ms);
+// bpm/spo2 só aparecem quando há medição do oxímetro.
+// A versão 1 era igual sem seq0 (array de 5 itens).
+//
+// O número de sequência é único por dispositivo, inclusive entre reinícios
+// (inc/journal.c), e identifica amostras repetidas na reenvio após queda do broker.
+
+#define TELEMETRY_JSON 0
+#define TELEMETRY_CBOR 1
+
+#ifndef TELEMETRY_FORMAT
+#define TELEMETRY_FORMAT TELEMETRY_CBOR
+#endif
+
+#ifndef TELEMETRY_BATCH_MAX
+#define TELEMETRY_BATCH_MAX 6          // amostras por publicação em CBOR (máx 23)
+#endif
+
+// Lote incompleto é publicado quando a amostra mais antiga chega a esta idade
+#ifndef TELEMETRY_BATCH_AGE_MS
+#define TELEMETRY_BATCH_AGE_MS 60000
+#endif
+
+#define TELEMETRY_TOPIC_JSON "pico_w/sensor"
+#define TELEMETRY_TOPIC_CBOR "pico_w/sensor/cbor"
+
+#define TELEMETRY_CBOR_VERSION 2
+// Pior caso de uma amostra e do cabeçalho do lote, em bytes
+#define TELEMETRY_CBOR_SAMPLE_MAX 23
+#define TELEMETRY_CBOR_HEADER_MAX 21
+#define TELEMETRY_CBOR_BATCH_MAX_BYTES (TELEMETRY_CBOR_HEADER_MAX + TELEMETRY_BATCH_MAX * TELEMETRY_CBOR_SAMPLE_MAX)
+
+typedef struct {
+    uint32_t seq;           // número de sequência (deduplicação no backend)
+    uint32_t t_ms;          // instante da amostra (ms desde o boot)
+    int16_t temp_c100;      // °C x100
+    uint32_t pres_pa;
+    uint16_t dist_mm;
+    uint16_t bpm_x10;       // 0 = sem medição do oxímetro
+    uint16_t spo2_x10;
+    uint32_t t_us;          // mesmo instante em µs (time_us_32), só para a latência local; não é publicado
+} telemetry_sample_t;
+
+// Parâmetros do firmware enviados junto (uma vez por lote em CBOR)
+typedef struct {
+    uint16_t dist_threshold_mm;
+    int16_t temp_threshold_c100;
+} telemetry_meta_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t cap;
+    size_t len;
+    size_t count_pos;       // byte do cabeçalho do array de amostras
+    uint8_t count;
+    uint32_t seq0;
+    uint32_t t0_ms;
+    uint32_t t_prev_ms;
+    telemetry_meta_t meta;
+} telemetry_batch_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Objeto JSON de uma amostra; retorna o tamanho (sem o '\0') ou 0 se não couber
+size_t telemetry_encode_json(const telemetry_sample_t *s, const telemetry_meta_t *meta, char *buf, size_t cap);
+
+void telemetry_batch_begin(telemetry_batch_t *b, uint8_t *buf, size_t cap, const telemetry_meta_t *meta);
+// false se o lote está cheio (TELEMETRY_BATCH_MAX), a amostra não cabe no buffer
+// ou não segue a sequência do lote (seq != seq0 + count)
+bool telemetry_batch_add(telemetry_batch_t *b, const telemetry_sample_t *s);
+// Fecha o lote; retorna o tamanho do payload (0 = lote vazio)
+size_t telemetry_batch_finish(telemetry_batch_t *b);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,320 @@
+#include "inc/topic_trie.h"
+#include <string.h>
+#if !TOPIC_TRIE_STATIC_POOL
+#include <stdlib.h>
+#endif
+
+#if TOPIC_TRIE_STATIC_POOL
+_Static_assert((TOPIC_TRIE_SLOTS & (TOPIC_TRIE_SLOTS - 1)) == 0, "TOPIC_TRIE_SLOTS é potência de 2");
+_Static_assert(TOPIC_TRIE_SLOTS >= 2 * TOPIC_TRIE_MAX_NODES, "tabela no máximo metade ocupada");
+_Static_assert(TOPIC_TRIE_MAX_NODES < UINT16_MAX && TOPIC_TRIE_MAX_FILTERS < UINT16_MAX,
+               "índices de 16 bits");
+_Static_assert(TOPIC_TRIE_LABEL_BYTES <= UINT16_MAX, "deslocamento do rótulo de 16 bits");
+#define SLOTS(t) ((uint32_t)TOPIC_TRIE_SLOTS)
+#else
+#define SLOTS(t) ((t)->slot_count)
+#endif
+
+static bool curinga(const char *s, size_t n, char c)
+{
+    return n == 1 && s[0] == c;
+}
+
+// FNV-1a sobre o pai e o rótulo
+static uint32_t espalha(uint16_t pai, const char *s, size_t n)
+{
+    uint32_t h = 2166136261u;
+    h = (h ^ (pai & 0xFF)) * 16777619u;
+    h = (h ^ (pai >> 8)) * 16777619u;
+    for (size_t i = 0; i < n; i++)
+        h = (h ^ (uint8_t)s[i]) * 16777619u;
+    return h;
+}
+
+// Filho literal de pai com o rótulo [s, s + n) (índice + 1; 0 = não há)
+static uint16_t literal(const topic_trie_t *t, uint16_t pai, const char *s, size_t n)
+{
+    if (SLOTS(t) == 0)
+        return 0;
+    uint32_t mask = SLOTS(t) - 1;
+    uint32_t h = espalha(pai, s, n);
+    for (uint32_t i = h & mask;; i = (i + 1) & mask)
+    {
+        uint16_t f = t->slots[i];
+        if (f == 0)
+            return 0;
+        const topic_trie_node_t *no = &t->nodes[f - 1];
+        if (no->hash == h && no->parent == pai && no->label_len == n && memcmp(&t->labels[no->label], s, n) == 0)
+            return f;
+    }
+}
+
+static uint16_t filho(const topic_trie_t *t, uint16_t pai, const char *s, size_t n)
+{
+    if (curinga(s, n, '+'))
+        return t->nodes[pai].plus;
+    if (curinga(s, n, '#'))
+        return t->nodes[pai].wild;
+    return literal(t, pai, s, n);
+}
+
+static void ocupa_slot(topic_trie_t *t, uint16_t i)
+{
+    uint32_t mask = SLOTS(t) - 1;
+    uint32_t s = t->nodes[i].hash & mask;
+    while (t->slots[s])
+        s = (s + 1) & mask;
+    t->slots[s] = (uint16_t)(i + 1);
+}
+
+static uint16_t cria_filho(topic_trie_t *t, uint16_t pai, const char *s, size_t n)
+{
+    uint16_t i = t->node_count++;
+    topic_trie_node_t *no = &t->nodes[i];
+    memset(no, 0, sizeof *no);
+    no->parent = pai;
+    if (curinga(s, n, '+'))
+        t->nodes[pai].plus = (uint16_t)(i + 1);
+    else if (curinga(s, n, '#'))
+        t->nodes[pai].wild = (uint16_t)(i + 1);
+    else
+    {
+        no->label = (uint16_t)t->label_used;
+        no->label_len = (uint16_t)n;
+        memcpy(&t->labels[t->label_used], s, n);
+        t->label_used += n;
+        no->hash = espalha(pai, s, n);
+        ocupa_slot(t, i);
+    }
+    return i;
+}
+
+// Garante espaço para mais nos nós e bytes de rótulo e um filtro; a raiz conta
+// entre os nós quando a árvore ainda não tem memória
+static bool reserva(topic_trie_t *t, uint32_t nos, uint32_t bytes)
+{
+    nos += t->node_count;
+    bytes += t->label_used;
+    uint32_t fins = t->end_count + 1u;
+#if TOPIC_TRIE_STATIC_POOL
+    return nos <= TOPIC_TRIE_MAX_NODES && fins <= TOPIC_TRIE_MAX_FILTERS && bytes <= TOPIC_TRIE_LABEL_BYTES;
+#else
+    if (nos >= UINT16_MAX || fins >= UINT16_MAX || bytes > UINT16_MAX)
+        return false;
+    if (nos > t->node_cap)
+    {
+        uint32_t cap = t->node_cap ? t->node_cap : 16;
+        while (cap < nos)
+            cap *= 2;
+        void *p = realloc(t->nodes, cap * sizeof *t->nodes);
+        if (!p)
+            return false;
+        t->nodes = p;
+        t->node_cap = cap;
+    }
+    if (fins > t->end_cap)
+    {
+        uint32_t cap = t->end_cap ? t->end_cap * 2 : 16;
+        void *p = realloc(t->ends, cap * sizeof *t->ends);
+        if (!p)
+            return false;
+        t->ends = p;
+        t->end_cap = cap;
+    }
+    if (bytes > t->label_cap)
+    {
+        uint32_t cap = t->label_cap ? t->label_cap : 256;
+        while (cap < bytes)
+            cap *= 2;
+        void *p = realloc(t->labels, cap);
+        if (!p)
+            return false;
+        t->labels = p;
+        t->label_cap = cap;
+    }
+    if (2 * nos > t->slot_count)
+    {
+        // Tabela nova com o dobro; os filhos literais voltam pelo hash guardado
+        uint32_t n = t->slot_count ? t->slot_count : 32;
+        while (n < 2 * nos)
+            n *= 2;
+        uint16_t *slots = calloc(n, sizeof *slots);
+        if (!slots)
+            return false;
+        free(t->slots);
+        t->slots = slots;
+        t->slot_count = n;
+        for (uint16_t i = 1; i < t->node_count; i++)
+        {
+            const topic_trie_node_t *pai = &t->nodes[t->nodes[i].parent];
+            if (pai->plus != i + 1 && pai->wild != i + 1)
+                ocupa_slot(t, i);
+        }
+    }
+    return true;
+#endif
+}
+
+void topic_trie_init(topic_trie_t *t)
+{
+#if TOPIC_TRIE_STATIC_POOL
+    memset(t->slots, 0, sizeof t->slots);
+    memset(&t->nodes[0], 0, sizeof t->nodes[0]);
+    t->node_count = 1;
+#else
+    memset(t, 0, sizeof *t);
+#endif
+    t->end_count = 0;
+    t->label_used = 0;
+}
+
+void topic_trie_free(topic_trie_t *t)
+{
+#if !TOPIC_TRIE_STATIC_POOL
+    free(t->nodes);
+    free(t->ends);
+    free(t->slots);
+    free(t->labels);
+#endif
+    topic_trie_init(t);
+}
+
+bool topic_trie_add(topic_trie_t *t, const char *filter, size_t filter_len, uint16_t id)
+{
+    if (!filter || filter_len == 0 || filter_len > UINT16_MAX)
+        return false;
+
+    // Primeira passada: valida e conta os nós e bytes que faltam
+    uint32_t niveis = 0, nos = t->node_count ? 0 : 1, bytes = 0;
+    bool existe = t->node_count != 0;
+    uint16_t no = 0;
+    for (size_t p = 0;;)
+    {
+        const char *s = &filter[p];
+        const char *barra = memchr(s, '/', filter_len - p);
+        size_t n = barra ? (size_t)(barra - s) : filter_len - p;
+        if (++niveis > TOPIC_TRIE_MAX_LEVELS)
+            return false;
+        bool mais = memchr(s, '+', n) != NULL, grade = memchr(s, '#', n) != NULL;
+        if ((mais || grade) && n != 1)
+            return false;
+        if (grade && barra)
+            return false;
+        uint16_t f = existe ? filho(t, no, s, n) : 0;
+        if (f)
+            no = f - 1;
+        else
+        {
+            existe = false;
+            nos++;
+            bytes += (mais || grade) ? 0 : (uint32_t)n;
+        }
+        if (!barra)
+            break;
+        p += n + 1;
+    }
+    if (!reserva(t, nos, bytes))
+        return false;
+    if (t->node_count == 0)
+    {
+        memset(&t->nodes[0], 0, sizeof t->nodes[0]);
+        t->node_count = 1;
+    }
+
+    // Segunda passada: desce criando o que falta
+    no = 0;
+    for (size_t p = 0;;)
+    {
+        const char *s = &filter[p];
+        const char *barra = memchr(s, '/', filter_len - p);
+        size_t n = barra ? (size_t)(barra - s) : filter_len - p;
+        uint16_t f = filho(t, no, s, n);
+        no = f ? f - 1 : cria_filho(t, no, s, n);
+        if (!barra)
+            break;
+        p += n + 1;
+    }
+
+    // Fim do filtro no fim da lista do nó: ids na ordem de inclusão
+    uint16_t e = t->end_count++;
+    t->ends[e].id = id;
+    t->ends[e].next = 0;
+    uint16_t *elo = &t->nodes[no].ends;
+    while (*elo)
+        elo = &t->ends[*elo - 1].next;
+    *elo = (uint16_t)(e + 1);
+    return true;
+}
+
+static size_t coleta(const topic_trie_t *t, uint16_t fim, uint16_t *ids, size_t max, size_t n)
+{
+    for (; fim; fim = t->ends[fim - 1].next, n++)
+        if (n < max)
+            ids[n] = t->ends[fim - 1].id;
+    return n;
+}
+
+size_t topic_trie_match(const topic_trie_t *t, const char *topic, size_t topic_len, uint16_t *ids, size_t max)
+{
+    if (t->node_count == 0 || !topic || topic_len == 0 || topic_len > UINT16_MAX)
+        return 0;
+
+    // Busca em profundidade: cada nó visitado empilha no máximo o filho literal
+    // e o '+', e a árvore não passa de TOPIC_TRIE_MAX_LEVELS níveis, então fica
+    // no máximo uma entrada pendente por nível. pos é o início do próximo nível
+    // do tópico; topic_len + 1 quando o tópico acabou.
+    struct {
+        uint16_t no;
+        uint32_t pos;
+    } pilha[TOPIC_TRIE_MAX_LEVELS + 1];
+    unsigned topo = 0;
+    size_t n = 0;
+    bool sistema = topic[0] == '$';
+    pilha[topo].no = 0;
+    pilha[topo++].pos = 0;
+    while (topo)
+    {
+        --topo;
+        uint16_t i = pilha[topo].no;
+        uint32_t pos = pilha[topo].pos;
+        const topic_trie_node_t *no = &t->nodes[i];
+        // '$SYS/...' não casa '#' nem '+' no primeiro nível
+        bool curingas = !(sistema && i == 0);
+
+        // '#' casa o resto do tópico, inclusive nada ("a/#" casa "a")
+        if (no->wild && curingas)
+            n = coleta(t, t->nodes[no->wild - 1].ends, ids, max, n);
+        if (pos > topic_len)
+        {
+            n = coleta(t, no->ends, ids, max, n);
+            continue;
+        }
+
+        const char *s = &topic[pos];
+        const char *barra = memchr(s, '/', topic_len - pos);
+        size_t len = barra ? (size_t)(barra - s) : topic_len - pos;
+        uint32_t prox = barra ? pos + (uint32_t)len + 1 : (uint32_t)topic_len + 1;
+        uint16_t f = literal(t, i, s, len);
+        if (f)
+        {
+            pilha[topo].no = f - 1;
+            pilha[topo++].pos = prox;
+        }
+        if (no->plus && curingas)
+        {
+            pilha[topo].no = no->plus - 1;
+            pilha[topo++].pos = prox;
+        }
+    }
+    return n;
+}
+
+size_t topic_trie_bytes(const topic_trie_t *t)
+{
+#if TOPIC_TRIE_STATIC_POOL
+    return sizeof *t;
+#else
+    return sizeof *t + t->node_cap * sizeof *t->nodes + t->end_cap * sizeof *t->ends +
+           t->slot_count * sizeof *t->slots + t->label_cap;
+#endif
+}
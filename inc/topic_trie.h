@@ -0,0 +1,110 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Despacho de PUBLISH recebidos pelas assinaturas: uma árvore montada uma vez
+// sobre os níveis dos filtros ("a/+/c", "a/#"), consultada por tópico.
+//
+// Comparar o tópico com cada filtro (MQTT_MatchTopic em laço) custa O(filtros)
+// por mensagem. Na árvore, cada nível do tópico segue no máximo três ramos do
+// nó atual: o nível literal, '+' e '#'. O custo passa a depender da
+// profundidade do tópico e de quantos '+' casam, não do número de filtros, e
+// uma passada devolve todos os filtros que casam.
+//
+// Regras do MQTT 3.1.1 (as mesmas de MQTT_MatchTopic):
+//  - '+' casa exatamente um nível, inclusive vazio ("a//b");
+//  - '#' é o último nível e casa o pai e qualquer descendente ("a/#" casa "a");
+//  - tópicos que começam com '$' não casam filtros que começam com curinga.
+//
+// Os filhos literais de todos os nós ficam numa tabela de espalhamento só,
+// chaveada por (pai, rótulo); '+' e '#' são campos do nó. Os índices são de
+// 16 bits (índice + 1; 0 = nenhum), como no resto da pilha MQTT.
+//
+// Memória: com TOPIC_TRIE_STATIC_POOL=1 (padrão, firmware) os nós, os rótulos
+// e a tabela são vetores dentro de topic_trie_t, com TOPIC_TRIE_MAX_* fixos:
+// topic_trie_add() recusa o filtro que não cabe e a árvore fica como estava.
+// Com TOPIC_TRIE_STATIC_POOL=0 os vetores crescem com realloc() (host, milhares
+// de filtros) e topic_trie_free() os devolve.
+//
+// Montagem e consulta não se misturam: a árvore é montada antes de a conexão
+// subir e depois só é lida, então a consulta dispensa trava.
+
+#ifndef TOPIC_TRIE_STATIC_POOL
+#define TOPIC_TRIE_STATIC_POOL 1
+#endif
+
+// Profundidade máxima dos filtros (a consulta usa uma pilha desse tamanho)
+#ifndef TOPIC_TRIE_MAX_LEVELS
+#define TOPIC_TRIE_MAX_LEVELS 16
+#endif
+
+#if TOPIC_TRIE_STATIC_POOL
+#ifndef TOPIC_TRIE_MAX_NODES
+#define TOPIC_TRIE_MAX_NODES 32        // inclui a raiz
+#endif
+#ifndef TOPIC_TRIE_MAX_FILTERS
+#define TOPIC_TRIE_MAX_FILTERS 16
+#endif
+#ifndef TOPIC_TRIE_LABEL_BYTES
+#define TOPIC_TRIE_LABEL_BYTES 256
+#endif
+// Tabela dos filhos literais: potência de 2, no máximo metade ocupada
+#ifndef TOPIC_TRIE_SLOTS
+#define TOPIC_TRIE_SLOTS (2 * TOPIC_TRIE_MAX_NODES)
+#endif
+#endif
+
+typedef struct {
+    uint32_t hash;       // de (pai, rótulo), para a tabela e para refazê-la
+    uint16_t parent;
+    uint16_t label;      // deslocamento do rótulo em labels
+    uint16_t label_len;
+    uint16_t plus;       // filho '+' (índice + 1)
+    uint16_t wild;       // filho '#' (índice + 1)
+    uint16_t ends;       // primeiro filtro que termina aqui (índice + 1)
+} topic_trie_node_t;
+
+typedef struct {
+    uint16_t id;         // valor do chamador (índice do tratador)
+    uint16_t next;
+} topic_trie_end_t;
+
+typedef struct {
+#if TOPIC_TRIE_STATIC_POOL
+    topic_trie_node_t nodes[TOPIC_TRIE_MAX_NODES];
+    topic_trie_end_t ends[TOPIC_TRIE_MAX_FILTERS];
+    uint16_t slots[TOPIC_TRIE_SLOTS];
+    char labels[TOPIC_TRIE_LABEL_BYTES];
+#else
+    topic_trie_node_t *nodes;
+    topic_trie_end_t *ends;
+    uint16_t *slots;
+    char *labels;
+    uint32_t node_cap, end_cap, slot_count, label_cap;
+#endif
+    uint16_t node_count;
+    uint16_t end_count;
+    uint32_t label_used;
+} topic_trie_t;
+
+// Árvore vazia (só a raiz). Com TOPIC_TRIE_STATIC_POOL=0 ainda não aloca nada.
+void topic_trie_init(topic_trie_t *t);
+
+// Devolve a memória (TOPIC_TRIE_STATIC_POOL=0) e deixa a árvore vazia.
+void topic_trie_free(topic_trie_t *t);
+
+// Acrescenta um filtro; id volta em topic_trie_match() para cada tópico que o
+// casa. Falso para filtro inválido ('+' ou '#' que não ocupam o nível inteiro,
+// '#' fora do fim, mais de TOPIC_TRIE_MAX_LEVELS níveis) ou sem espaço; nesse
+// caso nada muda. Filtro repetido devolve os dois ids.
+bool topic_trie_add(topic_trie_t *t, const char *filter, size_t filter_len, uint16_t id);
+
+// Uma passada pela árvore: escreve em ids até max ids dos filtros que casam o
+// tópico (ordem da árvore, não da inclusão) e devolve quantos casam, mesmo que
+// sejam mais que max.
+size_t topic_trie_match(const topic_trie_t *t, const char *topic, size_t topic_len, uint16_t *ids, size_t max);
+
+// Nós em uso (raiz incluída) e bytes ocupados pela árvore
+static inline uint16_t topic_trie_nodes(const topic_trie_t *t) { return t->node_count; }
+size_t topic_trie_bytes(const topic_trie_t *t);
@@ -11,10 +11,13 @@
 #define VL53L0X_REG_RESULT_RANGE_STATUS       0x14
 #define VL53L0X_REG_RESULT_RANGE_MM           0x1E
 
+#define VL53L0X_MODEL_ID                      0xEE
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+bool vl53l0x_read_model_id(i2c_inst_t *i2c, uint8_t *out_id);
 bool vl53l0x_init(i2c_inst_t *i2c);
 bool vl53l0x_read_distance_mm(i2c_inst_t *i2c, uint16_t *out_mm);
 
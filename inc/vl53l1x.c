@@ -1,50 +1,36 @@
 #include "inc/vl53l1x.h"
+#include "inc/sensor_reg.h"
 #include "pico/stdlib.h"
 
-static bool write_addr(i2c_inst_t *i2c, uint8_t addr, const uint8_t *buf, size_t len) {
-    int ret = i2c_write_blocking(i2c, addr, buf, len, false);
-    return ret == (int)len;
+bool vl53l1x_write8(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t val) {
+    return sensor_reg16_write(i2c, addr, reg, &val, 1);
 }
 
-static bool write_reg8(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t val) {
-    uint8_t buf[3] = { (uint8_t)(reg >> 8), (uint8_t)(reg & 0xFF), val };
-    return write_addr(i2c, addr, buf, 3);
+bool vl53l1x_write16(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint16_t val) {
+    uint8_t buf[2] = { (uint8_t)(val >> 8), (uint8_t)(val & 0xFF) };
+    return sensor_reg16_write(i2c, addr, reg, buf, 2);
 }
 
-static bool write_reg16(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint16_t val) {
-    uint8_t buf[4] = { (uint8_t)(reg >> 8), (uint8_t)(reg & 0xFF), (uint8_t)(val >> 8), (uint8_t)(val & 0xFF) };
-    return write_addr(i2c, addr, buf, 4);
+bool vl53l1x_write32(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint32_t val) {
+    uint8_t buf[4] = { (uint8_t)(val >> 24), (uint8_t)(val >> 16), (uint8_t)(val >> 8), (uint8_t)(val & 0xFF) };
+    return sensor_reg16_write(i2c, addr, reg, buf, 4);
 }
 
-static bool write_reg32(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint32_t val) {
-    uint8_t buf[6] = { (uint8_t)(reg >> 8), (uint8_t)(reg & 0xFF),
-                       (uint8_t)(val >> 24), (uint8_t)(val >> 16), (uint8_t)(val >> 8), (uint8_t)(val & 0xFF) };
-    return write_addr(i2c, addr, buf, 6);
-}
-
-static bool read_reg(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t *buf, size_t len) {
-    uint8_t regbuf[2] = { (uint8_t)(reg >> 8), (uint8_t)(reg & 0xFF) };
-    int wr = i2c_write_blocking(i2c, addr, regbuf, 2, true);
-    if (wr != 2) return false;
-    int rd = i2c_read_blocking(i2c, addr, buf, len, false);
-    return rd == (int)len;
-}
-
-bool vl53l1x_write8(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t val) { return write_reg8(i2c, addr, reg, val); }
-bool vl53l1x_write16(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint16_t val) { return write_reg16(i2c, addr, reg, val); }
-bool vl53l1x_write32(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint32_t val) { return write_reg32(i2c, addr, reg, val); }
-
 bool vl53l1x_read8(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t *val) {
-    return read_reg(i2c, addr, reg, val, 1);
+    return sensor_reg16_read(i2c, addr, reg, val, 1);
 }
 
 bool vl53l1x_read16(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint16_t *val) {
     uint8_t buf[2];
-    if (!read_reg(i2c, addr, reg, buf, 2)) return false;
+    if (!sensor_reg16_read(i2c, addr, reg, buf, 2)) return false;
     *val = ((uint16_t)buf[0] << 8) | buf[1];
     return true;
 }
 
+bool vl53l1x_read_model_id(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_id) {
+    return vl53l1x_read16(i2c, addr, VL53L1X_IDENTIFICATION__MODEL_ID, out_id);
+}
+
 // Cached oscillator values used for timing
 static uint16_t s_fast_osc_frequency = 0;
 static uint16_t s_osc_calibrate_val = 0;
@@ -165,26 +151,30 @@ bool vl53l1x_read_distance_mm(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_mm) {
 
 bool vl53l1x_read_range_block(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_mm, uint8_t *out_status, uint8_t *out_stream) {
     // Read 17 bytes starting at RESULT__RANGE_STATUS (0x0089)
-    uint8_t regbuf[2] = { (uint8_t)(VL53L1X_RESULT__RANGE_STATUS >> 8), (uint8_t)(VL53L1X_RESULT__RANGE_STATUS & 0xFF) };
-    int wr = i2c_write_blocking(i2c, addr, regbuf, 2, true);
-    if (wr != 2) return false;
     uint8_t buf[17];
-    int rd = i2c_read_blocking(i2c, addr, buf, sizeof buf, false);
-    if (rd != (int)sizeof buf) return false;
+    if (!sensor_reg16_read(i2c, addr, VL53L1X_RESULT__RANGE_STATUS, buf, sizeof buf)) return false;
 
     uint8_t range_status = buf[0];
     uint8_t stream_count = buf[2];
     uint16_t final_range = ((uint16_t)buf[13] << 8) | buf[14];
 
-    // Apply gain factor ~2011/2048 as in Pololu
-    uint16_t scaled = (uint32_t)final_range * 2011u;
+    // Apply gain factor ~2011/2048 as in Pololu (32-bit product: final_range * 2011 overflows 16 bits)
+    uint32_t scaled = (uint32_t)final_range * 2011u;
     scaled = (scaled + 0x0400u) >> 11; // divide by 2048 with rounding
 
     if (out_status) *out_status = range_status;
     if (out_stream) *out_stream = stream_count;
-    if (out_mm) *out_mm = scaled;
+    if (out_mm) *out_mm = (uint16_t)scaled;
 
     // clear interrupt
     vl53l1x_write8(i2c, addr, VL53L1X_SYSTEM__INTERRUPT_CLEAR, 0x01);
     return true;
 }
+
+bool vl53l1x_set_interrupt_polarity(i2c_inst_t *i2c, uint8_t addr, bool active_low) {
+    // GPIO_HV_MUX__CTRL bit 4: 1 = active low (per ST ULD VL53L1X_SetInterruptPolarity)
+    uint8_t ctrl = 0;
+    if (!vl53l1x_read8(i2c, addr, VL53L1X_GPIO_HV_MUX__CTRL, &ctrl)) return false;
+    ctrl = active_low ? (uint8_t)(ctrl | 0x10) : (uint8_t)(ctrl & ~0x10);
+    return vl53l1x_write8(i2c, addr, VL53L1X_GPIO_HV_MUX__CTRL, ctrl);
+}
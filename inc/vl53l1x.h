@@ -16,6 +16,10 @@
 #define VL53L1X_RESULT__FINAL_RANGE_MM_SD0 0x0096
 #define VL53L1X_SYSTEM__INTERMEASUREMENT_PERIOD 0x006C
 #define VL53L1X_RESULT__OSC_CALIBRATE_VAL  0x00DE
+#define VL53L1X_GPIO_HV_MUX__CTRL          0x0030
+#define VL53L1X_IDENTIFICATION__MODEL_ID   0x010F
+
+#define VL53L1X_MODEL_ID                   0xEACC // model ID (0xEA) e module type (0xCC)
 
 // System/grouped parameter hold and seed config
 #define VL53L1X_SYSTEM__GROUPED_PARAMETER_HOLD_0 0x0071
@@ -49,11 +53,14 @@ bool vl53l1x_write32(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint32_t val);
 bool vl53l1x_read8(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint8_t *val);
 bool vl53l1x_read16(i2c_inst_t *i2c, uint8_t addr, uint16_t reg, uint16_t *val);
 
+bool vl53l1x_read_model_id(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_id);
 bool vl53l1x_init(i2c_inst_t *i2c, uint8_t addr);
 bool vl53l1x_start_continuous(i2c_inst_t *i2c, uint8_t addr, uint32_t period_ms);
 bool vl53l1x_data_ready(i2c_inst_t *i2c, uint8_t addr);
 bool vl53l1x_read_distance_mm(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_mm);
 bool vl53l1x_read_range_block(i2c_inst_t *i2c, uint8_t addr, uint16_t *out_mm, uint8_t *out_status, uint8_t *out_stream);
+// GPIO1 (data-ready): active_low=true faz o pino descer a cada nova medição
+bool vl53l1x_set_interrupt_polarity(i2c_inst_t *i2c, uint8_t addr, bool active_low);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,152 @@
+#include "inc/vl53l1x_ranging.h"
+#include "inc/vl53l1x.h"
+#include "pico/stdlib.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "inc/task_cores.h"
+
+static i2c_bus_id_t s_bus;
+static uint8_t s_addr;
+static uint s_int_pin;
+static TaskHandle_t s_task;
+
+// Carimbo de tempo capturado na ISR; a tarefa o associa à leitura seguinte
+static volatile uint64_t s_irq_timestamp_us;
+
+static vl53l1x_sample_t s_ring[VL53L1X_RANGING_RING_LEN];
+static uint32_t s_head;   // total gravado
+static uint32_t s_tail;   // total consumido
+static vl53l1x_ranging_stats_t s_stats;
+
+static void vl53l1x_gpio_irq(void)
+{
+    uint32_t events = gpio_get_irq_event_mask(s_int_pin);
+    if (!(events & GPIO_IRQ_EDGE_FALL)) return;
+    gpio_acknowledge_irq(s_int_pin, events);
+
+    s_irq_timestamp_us = time_us_64();
+    s_stats.interrupts++;
+
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(s_task, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void ring_push(const vl53l1x_sample_t *s)
+{
+    taskENTER_CRITICAL();
+    if (s_head - s_tail == VL53L1X_RANGING_RING_LEN) {
+        s_tail++;
+        s_stats.overruns++;
+    }
+    s_ring[s_head % VL53L1X_RANGING_RING_LEN] = *s;
+    s_head++;
+    s_stats.samples++;
+    taskEXIT_CRITICAL();
+}
+
+typedef struct {
+    bool irq;
+    bool pronto;
+    vl53l1x_sample_t amostra;
+} leitura_t;
+
+// Executa na tarefa dona do I2C: status (se preciso) + bloco de resultado numa só transação
+static bool job_leitura(i2c_inst_t *i2c, void *ctx)
+{
+    leitura_t *l = ctx;
+    l->pronto = l->irq || vl53l1x_data_ready(i2c, s_addr);
+    if (!l->pronto) return true;
+    return vl53l1x_read_range_block(i2c, s_addr, &l->amostra.distance_mm,
+                                    &l->amostra.range_status, &l->amostra.stream_count);
+}
+
+typedef struct {
+    uint32_t period_ms;
+} partida_t;
+
+static bool job_partida(i2c_inst_t *i2c, void *ctx)
+{
+    const partida_t *p = ctx;
+    return vl53l1x_set_interrupt_polarity(i2c, s_addr, true) &&
+           vl53l1x_start_continuous(i2c, s_addr, p->period_ms);
+}
+
+static void tarefaRangingVL53L1X(void *pvParameters)
+{
+    (void)pvParameters;
+    while (1)
+    {
+        // Sem borda dentro do prazo: consulta o status (linha GPIO1 ausente ou borda perdida)
+        bool irq = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(VL53L1X_RANGING_FALLBACK_MS)) > 0;
+        if (!irq) s_stats.fallback_polls++;
+
+        leitura_t l = {.irq = irq};
+        bool ok = i2c_bus_run(s_bus, job_leitura, &l);
+
+        if (ok && !l.pronto) continue;
+        if (!ok) {
+            s_stats.read_errors++;
+            continue;
+        }
+        l.amostra.timestamp_us = irq ? s_irq_timestamp_us : time_us_64();
+        ring_push(&l.amostra);
+    }
+}
+
+bool vl53l1x_ranging_start(i2c_bus_id_t bus, uint8_t addr, uint int_pin, uint32_t period_ms)
+{
+    s_bus = bus;
+    s_addr = addr;
+    s_int_pin = int_pin;
+
+    // GPIO1 é dreno aberto no módulo: entrada com pull-up, borda de descida = nova medição
+    gpio_init(int_pin);
+    gpio_set_dir(int_pin, GPIO_IN);
+    gpio_pull_up(int_pin);
+
+    partida_t p = {.period_ms = period_ms};
+    if (!i2c_bus_run(bus, job_partida, &p)) return false;
+
+    if (task_create_on(tarefaRangingVL53L1X, "ToF", 256, NULL, VL53L1X_RANGING_TASK_PRIO,
+                       VL53L1X_RANGING_TASK_CORE, &s_task) != pdPASS)
+        return false;
+
+    gpio_add_raw_irq_handler(int_pin, vl53l1x_gpio_irq);
+    gpio_set_irq_enabled(int_pin, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    return true;
+}
+
+bool vl53l1x_ranging_latest(vl53l1x_sample_t *out)
+{
+    bool ok = false;
+    taskENTER_CRITICAL();
+    if (s_head > 0) {
+        *out = s_ring[(s_head - 1) % VL53L1X_RANGING_RING_LEN];
+        ok = true;
+    }
+    taskEXIT_CRITICAL();
+    return ok;
+}
+
+size_t vl53l1x_ranging_read(vl53l1x_sample_t *out, size_t max)
+{
+    size_t n = 0;
+    taskENTER_CRITICAL();
+    while (n < max && s_tail != s_head) {
+        out[n++] = s_ring[s_tail % VL53L1X_RANGING_RING_LEN];
+        s_tail++;
+    }
+    taskEXIT_CRITICAL();
+    return n;
+}
+
+void vl53l1x_ranging_get_stats(vl53l1x_ranging_stats_t *out)
+{
+    taskENTER_CRITICAL();
+    *out = s_stats;
+    taskEXIT_CRITICAL();
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "inc/i2c_bus.h"
+
+// Ranging contínuo do VL53L1X dirigido pela interrupção de GPIO1 (data-ready).
+// A ISR notifica uma tarefa dedicada, que lê o bloco de resultado e grava a
+// amostra com carimbo de tempo num buffer circular. Se a linha de interrupção
+// não estiver ligada, a tarefa cai para consulta a cada VL53L1X_RANGING_FALLBACK_MS.
+
+#ifndef VL53L1X_RANGING_RING_LEN
+#define VL53L1X_RANGING_RING_LEN 32   // 1,6 s a 50 ms por medição
+#endif
+
+#ifndef VL53L1X_RANGING_FALLBACK_MS
+#define VL53L1X_RANGING_FALLBACK_MS 200
+#endif
+
+typedef struct {
+    uint64_t timestamp_us;   // instante da interrupção (time_us_64)
+    uint16_t distance_mm;
+    uint8_t range_status;
+    uint8_t stream_count;
+} vl53l1x_sample_t;
+
+typedef struct {
+    uint32_t interrupts;     // bordas recebidas na ISR
+    uint32_t samples;        // medições gravadas no buffer
+    uint32_t overruns;       // amostras sobrescritas antes de serem lidas
+    uint32_t fallback_polls; // esperas que terminaram por timeout (sem IRQ)
+    uint32_t read_errors;
+} vl53l1x_ranging_stats_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Configura GPIO1 ativo em nível baixo, inicia o modo temporizado com period_ms
+// e cria a tarefa de ranging. O sensor já deve ter passado por vl53l1x_init().
+// Todo acesso ao sensor passa pelo gerenciador de barramento (conjunto de pinos bus).
+bool vl53l1x_ranging_start(i2c_bus_id_t bus, uint8_t addr, uint int_pin, uint32_t period_ms);
+
+// Copia a amostra mais recente (não consome). false se ainda não houve medição.
+bool vl53l1x_ranging_latest(vl53l1x_sample_t *out);
+// Consome até max amostras pendentes, da mais antiga para a mais nova.
+size_t vl53l1x_ranging_read(vl53l1x_sample_t *out, size_t max);
+void vl53l1x_ranging_get_stats(vl53l1x_ranging_stats_t *out);
+
+#ifdef __cplusplus
+}
+#endif
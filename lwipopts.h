@@ -8,6 +8,8 @@
 
 #define LWIP_NETCONN                1
 #define LWIP_SOCKET                 1
+// Prazo de envio do transporte do coreMQTT (inc/mqtt_transport.c)
+#define LWIP_SO_SNDTIMEO            1
 
 // --- FIX PARA O ERRO DE REDEFINIÇÃO DE TIMEVAL ---
 #define LWIP_TIMEVAL_PRIVATE        0 
@@ -60,21 +62,29 @@
 #define LWIP_NETIF_TX_SINGLE_PBUF   1
 
 // --- SEGURANÇA (TLS/MQTT) ---
-// Como você está usando a porta 1883, o TLS não é necessário.
-// Desativar estas opções resolve o erro de compilação do SDK.
-#define LWIP_ALTCP                  0 
-#define LWIP_ALTCP_TLS              0 
-#define LWIP_ALTCP_TLS_MBEDTLS      0 
-
-// FIX CRÍTICO: Desativa o cache que causa o erro 'mbedtls_ssl_session'
-#define LWIP_ALTCP_TLS_SESSION_CACHE 0 
+// altcp_tls (mbedTLS) só com MQTT_TLS=1 no .env (inc/mqtt_tls.c); na porta 1883
+// o MQTT usa o TCP direto. A retomada de sessão do cliente é feita em
+// inc/mqtt_tls.c com a API do mbedTLS: as opções de cache e tickets do
+// altcp_tls_mbedtls (ALTCP_MBEDTLS_USE_SESSION_*) são do lado servidor.
+#ifndef MQTT_TLS
+#define MQTT_TLS                    0
+#endif
+#define LWIP_ALTCP                  MQTT_TLS
+#define LWIP_ALTCP_TLS              MQTT_TLS
+#define LWIP_ALTCP_TLS_MBEDTLS      MQTT_TLS
 
 // Necessário para o mbedtls 
 #define MEMP_NUM_SYS_TIMEOUT        (LWIP_NUM_SYS_TIMEOUT_INTERNAL + 1)
 
+// Contadores de memória (MEM/MEMP) publicados no diagnóstico (inc/diag.c), também em release
+#define LWIP_STATS                  1
+#define LWIP_STATS_DISPLAY          0
+
+// O registro de diagnóstico (pior caso ~760 B: 20 tarefas e histogramas cheios) precisa caber inteiro no buffer de saída do MQTT
+#define MQTT_OUTPUT_RINGBUF_SIZE    1024
+
 #ifndef NDEBUG
 #define LWIP_DEBUG                  1
-#define LWIP_STATS                  1
 #define ALTCP_MBEDTLS_DEBUG         LWIP_DBG_OFF
 #define MQTT_DEBUG                  LWIP_DBG_ON
 #endif
@@ -30,8 +30,15 @@
 /* MACROS MQTT */
 #define DEBUG_printf printf
 #define MQTT_SERVER_HOST "test.mosquitto.org"
-#define MQTT_SERVER_PORT 1883
+// MQTT_TLS vem do .env (CMakeLists.txt); com TLS a porta padrão é a 8883
+#ifndef MQTT_TLS
 #define MQTT_TLS 0
+#endif
+#if MQTT_TLS
+#define MQTT_SERVER_PORT 8883
+#else
+#define MQTT_SERVER_PORT 1883
+#endif
 #define BUFFER_SIZE 256
 /* END*/
 
@@ -54,7 +61,6 @@ typedef struct MQTT_CLIENT_T_ {
 void pinos_start();
 void gpio5_callback(uint gpio, uint32_t events);
 static MQTT_CLIENT_T* mqtt_client_init(void);
-void run_dns_lookup(MQTT_CLIENT_T *state);
 void mqtt_run_test(MQTT_CLIENT_T *state);
 void gpio_event_string(char *buf, uint32_t events);
 void js();
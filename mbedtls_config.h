@@ -1,6 +1,14 @@
 /* Workaround for some mbedtls source files using INT_MAX without including limits.h */
 #include <limits.h>
 
+/*
+ * Cliente TLS 1.2 do MQTT (inc/mqtt_tls.c), só o que o handshake com o broker
+ * usa. Troca de chaves ECDHE (sigilo futuro) com certificado ECDSA ou RSA do
+ * broker, cifra AES-128-GCM; sem troca de chaves RSA, CBC, MD5, SHA-1 nem curvas
+ * que nenhum broker usa. A lista de suítes oferecidas vai fixa no ClientHello.
+ * sim/bench_tls.c mede o handshake com esta configuração.
+ */
+
 #define MBEDTLS_NO_PLATFORM_ENTROPY
 #define MBEDTLS_ENTROPY_HARDWARE_ALT
 
@@ -9,58 +17,54 @@
 #define MBEDTLS_ALLOW_PRIVATE_ACCESS
 //#define MBEDTLS_HAVE_TIME
 
-#define MBEDTLS_CIPHER_MODE_CBC
-#define MBEDTLS_ECP_DP_SECP192R1_ENABLED
-#define MBEDTLS_ECP_DP_SECP224R1_ENABLED
+/* TLS 1.2: suítes e curvas */
+#define MBEDTLS_SSL_PROTO_TLS1_2
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
+#define MBEDTLS_KEY_EXCHANGE_ECDHE_RSA_ENABLED
+#define MBEDTLS_SSL_CIPHERSUITES \
+    MBEDTLS_TLS_ECDHE_ECDSA_WITH_AES_128_GCM_SHA256, \
+    MBEDTLS_TLS_ECDHE_RSA_WITH_AES_128_GCM_SHA256
 #define MBEDTLS_ECP_DP_SECP256R1_ENABLED
-#define MBEDTLS_ECP_DP_SECP384R1_ENABLED
-#define MBEDTLS_ECP_DP_SECP521R1_ENABLED
-#define MBEDTLS_ECP_DP_SECP192K1_ENABLED
-#define MBEDTLS_ECP_DP_SECP224K1_ENABLED
-#define MBEDTLS_ECP_DP_SECP256K1_ENABLED
-#define MBEDTLS_ECP_DP_BP256R1_ENABLED
-#define MBEDTLS_ECP_DP_BP384R1_ENABLED
-#define MBEDTLS_ECP_DP_BP512R1_ENABLED
+#define MBEDTLS_ECP_DP_SECP384R1_ENABLED   /* cadeias de CA em P-384 */
 #define MBEDTLS_ECP_DP_CURVE25519_ENABLED
-#define MBEDTLS_KEY_EXCHANGE_RSA_ENABLED
-#define MBEDTLS_PKCS1_V15
-#define MBEDTLS_SHA256_SMALLER
+#define MBEDTLS_ECP_NIST_OPTIM
+#define MBEDTLS_PKCS1_V15                  /* certificados RSA */
+#define MBEDTLS_SSL_EXTENDED_MASTER_SECRET
+
+/* Retomada (ID de sessão e tickets do RFC 5077) e SNI */
+#define MBEDTLS_SSL_SESSION_TICKETS
 #define MBEDTLS_SSL_SERVER_NAME_INDICATION
+
+/* Módulos */
 #define MBEDTLS_AES_C
+#define MBEDTLS_AES_FEWER_TABLES
 #define MBEDTLS_ASN1_PARSE_C
+#define MBEDTLS_ASN1_WRITE_C
 #define MBEDTLS_BIGNUM_C
 #define MBEDTLS_CIPHER_C
 #define MBEDTLS_CTR_DRBG_C
+#define MBEDTLS_ECDH_C
+#define MBEDTLS_ECDSA_C
+#define MBEDTLS_ECP_C
 #define MBEDTLS_ENTROPY_C
 #define MBEDTLS_ERROR_C
+#define MBEDTLS_GCM_C
 #define MBEDTLS_MD_C
-#define MBEDTLS_MD5_C
 #define MBEDTLS_OID_C
-#define MBEDTLS_PKCS5_C
 #define MBEDTLS_PK_C
 #define MBEDTLS_PK_PARSE_C
 #define MBEDTLS_PLATFORM_C
 #define MBEDTLS_RSA_C
-#define MBEDTLS_SHA1_C
 #define MBEDTLS_SHA224_C
 #define MBEDTLS_SHA256_C
+#define MBEDTLS_SHA256_SMALLER
+#define MBEDTLS_SHA384_C                   /* assinaturas ecdsa-with-SHA384 */
 #define MBEDTLS_SHA512_C
 #define MBEDTLS_SSL_CLI_C
-#define MBEDTLS_SSL_SRV_C
 #define MBEDTLS_SSL_TLS_C
 #define MBEDTLS_X509_CRT_PARSE_C
 #define MBEDTLS_X509_USE_C
-#define MBEDTLS_AES_FEWER_TABLES
-
-/* TLS 1.2 */
-#define MBEDTLS_SSL_PROTO_TLS1_2
-#define MBEDTLS_KEY_EXCHANGE_ECDHE_ECDSA_ENABLED
-#define MBEDTLS_GCM_C
-#define MBEDTLS_ECDH_C
-#define MBEDTLS_ECP_C
-#define MBEDTLS_ECDSA_C
-#define MBEDTLS_ASN1_WRITE_C
 
 // The following is needed to parse a certificate
 #define MBEDTLS_PEM_PARSE_C
-#define MBEDTLS_BASE64_C
\ No newline at end of file
+#define MBEDTLS_BASE64_C
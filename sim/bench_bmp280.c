@@ -0,0 +1,222 @@
+// Benchmark no host da compensação do BMP280: caminho de ponto flutuante
+// (inteiro 32 bits + altitude com powf, BMP280_FIXED_POINT=0) contra o
+// caminho só com inteiros (64 bits Q24.8 + altitude por tabela).
+// A referência são as fórmulas em double da seção 8.1 do datasheet.
+//   cmake --build build_sim --target bmp280_bench && ./build_sim/bmp280_bench
+// Os ciclos medidos aqui são do host; no RP2040 (sem FPU) o custo relativo do
+// powf emulado em software é bem maior.
+#include <math.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include "bmp280.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_TSC 1
+#endif
+
+#define T_MIN_C   -40
+#define T_MAX_C    85
+#define T_STEP_C    5
+#define P_MIN_HPA 300
+#define P_MAX_HPA 1100
+#define P_STEP_HPA  5
+#define REPETICOES 200
+
+// Calibração de exemplo do datasheet (seção 3.12)
+static const calibration_param_t dig = {
+    .T1 = 27504, .T2 = 26435, .T3 = -1000,
+    .P1 = 36477, .P2 = -10685, .P3 = 3024, .P4 = 2855, .P5 = 140,
+    .P6 = -7, .P7 = 15500, .P8 = -14600, .P9 = 6000,
+};
+
+typedef struct {
+    int32_t adc_T;
+    int32_t adc_P;
+    double t_c;      // referência
+    double p_pa;
+    double h_m;
+} ponto_t;
+
+// Camada de baixo nível sem barramento: o bench só chama a compensação
+void bmp280_i2c_init() {}
+void bmp280_read_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength) {}
+void bmp280_write_array(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength) {}
+output_status_t bmp280_read_burst(uint8_t deviceAddress, uint8_t startRegisterAddress, uint8_t *data, uint8_t dataLength)
+{
+    return BMP280_FALSE;
+}
+output_status_t bmp280_write_register(uint8_t deviceAddress, uint8_t registerAddress, uint8_t value)
+{
+    return BMP280_FALSE;
+}
+void delay_function(uint32_t delayMS) {}
+float power_function(float x, float y)
+{
+    return powf(x, y);   // mesma implementação de bmp280_low_level.c
+}
+
+static double ref_t_fine(int32_t adc_T)
+{
+    double var1 = ((double)adc_T / 16384.0 - (double)dig.T1 / 1024.0) * (double)dig.T2;
+    double d = (double)adc_T / 131072.0 - (double)dig.T1 / 8192.0;
+    double var2 = d * d * (double)dig.T3;
+    return var1 + var2;
+}
+
+static double ref_pressure(int32_t adc_P, double t_fine)
+{
+    double var1 = t_fine / 2.0 - 64000.0;
+    double var2 = var1 * var1 * (double)dig.P6 / 32768.0;
+    var2 = var2 + var1 * (double)dig.P5 * 2.0;
+    var2 = var2 / 4.0 + (double)dig.P4 * 65536.0;
+    var1 = ((double)dig.P3 * var1 * var1 / 524288.0 + (double)dig.P2 * var1) / 524288.0;
+    var1 = (1.0 + var1 / 32768.0) * (double)dig.P1;
+    if (var1 == 0.0) return 0;
+    double p = 1048576.0 - (double)adc_P;
+    p = (p - var2 / 4096.0) * 6250.0 / var1;
+    var1 = (double)dig.P9 * p * p / 2147483648.0;
+    var2 = p * (double)dig.P8 / 32768.0;
+    return p + (var1 + var2 + (double)dig.P7) / 16.0;
+}
+
+static double ref_altitude(double p_pa)
+{
+    return 44330.0 * (1.0 - pow(p_pa / 101325.0, 0.190284));
+}
+
+// Valores brutos de 20 bits que produzem a temperatura/pressão pedidas
+static int32_t busca_adc_T(double t_c)
+{
+    int32_t lo = 0, hi = (1 << 20) - 1;   // temperatura cresce com adc_T
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (ref_t_fine(mid) / 5120.0 < t_c) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+static int32_t busca_adc_P(double p_pa, double t_fine)
+{
+    int32_t lo = 0, hi = (1 << 20) - 1;   // pressão decresce com adc_P
+    while (lo < hi) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if (ref_pressure(mid, t_fine) > p_pa) lo = mid + 1; else hi = mid;
+    }
+    return lo;
+}
+
+typedef struct {
+    double max_p, soma_p;   // Pa
+    double max_h, soma_h;   // m
+} erro_t;
+
+static void acumula(erro_t *e, double dp, double dh)
+{
+    dp = fabs(dp);
+    dh = fabs(dh);
+    if (dp > e->max_p) e->max_p = dp;
+    if (dh > e->max_h) e->max_h = dh;
+    e->soma_p += dp;
+    e->soma_h += dh;
+}
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t ciclos(void)
+{
+#ifdef BENCH_HAS_TSC
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+static volatile float s_sink_f;
+static volatile int32_t s_sink_i;
+
+static void caminho_float(const ponto_t *pt)
+{
+    int32_t t_fine;
+    int32_t t = bmp280_compensate_temperature(&dig, pt->adc_T, &t_fine);
+    uint32_t p = bmp280_compensate_pressure(&dig, pt->adc_P, t_fine);
+    s_sink_f = (float)t / 100 + bmp280_calculate_altitude_quick(0, p);
+}
+
+static void caminho_fixo(const ponto_t *pt)
+{
+    int32_t t_fine;
+    int32_t t = bmp280_compensate_temperature(&dig, pt->adc_T, &t_fine);
+    uint32_t p = bmp280_compensate_pressure_q24_8(&dig, pt->adc_P, t_fine);
+    s_sink_i = t + bmp280_altitude_cm(p);
+}
+
+static void mede(const char *nome, void (*f)(const ponto_t *), const ponto_t *pts, size_t n)
+{
+    uint64_t c0 = ciclos(), t0 = agora_ns();
+    for (int r = 0; r < REPETICOES; ++r)
+        for (size_t i = 0; i < n; ++i)
+            f(&pts[i]);
+    uint64_t t1 = agora_ns(), c1 = ciclos();
+    double chamadas = (double)REPETICOES * (double)n;
+    printf("%-7s %8.1f ns/chamada", nome, (double)(t1 - t0) / chamadas);
+#ifdef BENCH_HAS_TSC
+    printf("  %8.1f ciclos/chamada", (double)(c1 - c0) / chamadas);
+#else
+    (void)c0; (void)c1;
+#endif
+    printf("\n");
+}
+
+int main(void)
+{
+    static ponto_t pts[((T_MAX_C - T_MIN_C) / T_STEP_C + 1) * ((P_MAX_HPA - P_MIN_HPA) / P_STEP_HPA + 1)];
+    size_t n = 0;
+
+    for (int tc = T_MIN_C; tc <= T_MAX_C; tc += T_STEP_C) {
+        int32_t adc_T = busca_adc_T(tc);
+        double t_fine = ref_t_fine(adc_T);
+        for (int hpa = P_MIN_HPA; hpa <= P_MAX_HPA; hpa += P_STEP_HPA) {
+            ponto_t *pt = &pts[n++];
+            pt->adc_T = adc_T;
+            pt->adc_P = busca_adc_P(hpa * 100.0, t_fine);
+            pt->t_c = t_fine / 5120.0;
+            pt->p_pa = ref_pressure(pt->adc_P, t_fine);
+            pt->h_m = ref_altitude(pt->p_pa);
+        }
+    }
+
+    erro_t ef = {0}, ei = {0};
+    double max_t = 0;
+    for (size_t i = 0; i < n; ++i) {
+        const ponto_t *pt = &pts[i];
+        int32_t t_fine;
+        int32_t t = bmp280_compensate_temperature(&dig, pt->adc_T, &t_fine);
+        if (fabs(t / 100.0 - pt->t_c) > max_t) max_t = fabs(t / 100.0 - pt->t_c);
+
+        uint32_t p32 = bmp280_compensate_pressure(&dig, pt->adc_P, t_fine);
+        float h = bmp280_calculate_altitude_quick(0, p32);
+        acumula(&ef, p32 - pt->p_pa, h - pt->h_m);
+
+        uint32_t q = bmp280_compensate_pressure_q24_8(&dig, pt->adc_P, t_fine);
+        int32_t hcm = bmp280_altitude_cm(q);
+        acumula(&ei, q / 256.0 - pt->p_pa, hcm / 100.0 - pt->h_m);
+    }
+
+    printf("BMP280: %zu pontos, %d..%d C x %d..%d hPa, referência em double (datasheet 8.1)\n",
+           n, T_MIN_C, T_MAX_C, P_MIN_HPA, P_MAX_HPA);
+    printf("temperatura (comum aos dois caminhos): erro máx %.3f C\n", max_t);
+    printf("%-7s pressão máx %6.3f Pa  média %6.3f Pa | altitude máx %6.3f m  média %6.3f m\n",
+           "float", ef.max_p, ef.soma_p / n, ef.max_h, ef.soma_h / n);
+    printf("%-7s pressão máx %6.3f Pa  média %6.3f Pa | altitude máx %6.3f m  média %6.3f m\n",
+           "inteiro", ei.max_p, ei.soma_p / n, ei.max_h, ei.soma_h / n);
+
+    mede("float", caminho_float, pts, n);
+    mede("inteiro", caminho_fixo, pts, n);
+    return 0;
+}
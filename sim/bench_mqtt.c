@@ -0,0 +1,410 @@
+// Benchmark no host das duas pilhas MQTT do firmware (MQTT_STACK, inc/net_conn.h)
+// contra o broker local da simulação (sim_mqtt.c), pelo mesmo caminho de bytes:
+//  - lwip: a API de lwip/apps/mqtt.h do modelo em sim_mqtt.c (o mqtt_client do
+//    lwIP não está no host): cópia para o anel de saída e dele para o TCP;
+//  - coremqtt: o coreMQTT do FreeRTOS-LTS com o transporte do firmware
+//    (inc/mqtt_transport.c) sobre os sockets de sim_socket.c: writev direto.
+// Mede vazão e latência por publicação (QoS 0; QoS 1 até o PUBACK) para alguns
+// tamanhos de payload, e a RAM estática de cada cliente com a configuração do
+// firmware (lwipopts.h, inc/net_conn.h). Depois compara, no coremqtt, o
+// MQTT_Publish() com o MQTT_PublishBatch() em lotes de 4 a 64 publicações:
+// vazão e chamadas do transporte (writev) por publicação.
+//   cmake --build build_sim --target mqtt_bench && ./build_sim/mqtt_bench [publicações]
+// Tempos são do host e a metade lwip é um modelo: servem para comparar o custo
+// de serialização e cópia das duas pilhas, não para prever o tempo no RP2040.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "lwip/apps/mqtt.h"
+#include "lwip/sockets.h"
+#include "lwipopts.h"
+#include "core_mqtt.h"
+#include "inc/mqtt_transport.h"
+#include "inc/net_conn.h"
+#include "sim_mqtt.h"
+#include "sim_pico.h"
+
+#define TOPICO "pico_w/sensor/cbor"
+#define PUBLICACOES_PADRAO 20000
+
+static const size_t s_tamanhos[] = {16, 128, 512, 768};
+static uint32_t s_publicacoes = PUBLICACOES_PADRAO;
+static uint64_t *s_lat;
+static uint8_t s_payload[1024];
+
+typedef struct {
+    const char *nome;
+    bool (*conectar)(void);
+    bool (*publicar)(const void *payload, size_t len, uint8_t qos);
+    void (*desconectar)(void);
+} pilha_t;
+
+// Gancho do traceTASK_DELAY_UNTIL do kernel do host (sim/FreeRTOSConfig.h); o
+// sim_trace.c depende das tarefas de blink.c e fica fora deste binário
+void sim_trace_task_delay_until(unsigned long wake_tick)
+{
+    (void)wake_tick;
+}
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// --- lwip (modelo) ---
+
+static mqtt_client_t *s_lwip;
+static volatile int s_lwip_conectado, s_lwip_acks;
+
+static void lwip_conexao_cb(mqtt_client_t *client, void *arg, mqtt_connection_status_t status)
+{
+    (void)client;
+    (void)arg;
+    s_lwip_conectado = status == MQTT_CONNECT_ACCEPTED;
+}
+
+static void lwip_pedido_cb(void *arg, err_t err)
+{
+    (void)arg;
+    if (err == ERR_OK)
+        s_lwip_acks++;
+}
+
+static bool lwip_conectar(void)
+{
+    static const struct mqtt_connect_client_info_t ci = {.client_id = "bench", .keep_alive = 60};
+    static const ip_addr_t ip = {0x0100007Fu};
+    s_lwip = mqtt_client_new();
+    s_lwip_conectado = 0;
+    return mqtt_client_connect(s_lwip, &ip, 1883, lwip_conexao_cb, NULL, &ci) == ERR_OK && s_lwip_conectado;
+}
+
+// QoS 1: o broker responde dentro da chamada, então o PUBACK já passou pelo callback
+static bool lwip_publicar(const void *payload, size_t len, uint8_t qos)
+{
+    int acks = s_lwip_acks;
+    err_t err = mqtt_publish(s_lwip, TOPICO, payload, (u16_t)len, qos, 0, qos ? lwip_pedido_cb : NULL, NULL);
+    return err == ERR_OK && (qos == 0 || s_lwip_acks == acks + 1);
+}
+
+static void lwip_desconectar(void)
+{
+    mqtt_disconnect(s_lwip);
+}
+
+// --- coremqtt ---
+
+static NetworkContext_t s_rede = {.fd = -1};
+static MQTTContext_t s_mqtt;
+static uint8_t s_buffer[NET_CONN_MQTT_BUFFER];
+static MQTTPubAckInfo_t s_qos_saida[NET_CONN_QOS_RECORDS], s_qos_entrada[NET_CONN_QOS_RECORDS];
+static volatile int s_core_acks;
+
+// Chamadas de envio do transporte do firmware, contadas por cima dele
+static TransportSend_t s_send_real;
+static TransportWritev_t s_writev_real;
+static uint32_t s_chamadas;
+
+static int32_t contar_send(NetworkContext_t *ctx, const void *buf, size_t len)
+{
+    s_chamadas++;
+    return s_send_real(ctx, buf, len);
+}
+
+static int32_t contar_writev(NetworkContext_t *ctx, TransportOutVector_t *vetores, size_t n)
+{
+    s_chamadas++;
+    return s_writev_real(ctx, vetores, n);
+}
+
+static uint32_t core_tempo_ms(void)
+{
+    return (uint32_t)(time_us_64() / 1000);
+}
+
+static void core_evento_cb(MQTTContext_t *ctx, MQTTPacketInfo_t *pacote, MQTTDeserializedInfo_t *info)
+{
+    (void)ctx;
+    (void)info;
+    if (pacote->type == MQTT_PACKET_TYPE_PUBACK)
+        s_core_acks++;
+}
+
+static bool core_conectar_com(MQTTPubAckInfo_t *saida, MQTTPubAckInfo_t *entrada, size_t registros)
+{
+    if (!mqtt_transport_connect(&s_rede, 0x0100007Fu, 1883, 1000))
+        return false;
+    TransportInterface_t transporte;
+    mqtt_transport_interface(&s_rede, &transporte);
+    s_send_real = transporte.send;
+    s_writev_real = transporte.writev;
+    transporte.send = contar_send;
+    transporte.writev = contar_writev;
+    const MQTTFixedBuffer_t buffer = {.pBuffer = s_buffer, .size = sizeof s_buffer};
+    const MQTTConnectInfo_t info = {
+        .cleanSession = true,
+        .keepAliveSeconds = 60,
+        .pClientIdentifier = "bench",
+        .clientIdentifierLength = 5,
+    };
+    bool presente;
+    return MQTT_Init(&s_mqtt, &transporte, core_tempo_ms, core_evento_cb, &buffer) == MQTTSuccess &&
+           MQTT_InitStatefulQoS(&s_mqtt, saida, registros, entrada, registros) == MQTTSuccess &&
+           MQTT_Connect(&s_mqtt, &info, NULL, 1000, &presente) == MQTTSuccess;
+}
+
+static bool core_conectar(void)
+{
+    memset(s_qos_saida, 0, sizeof s_qos_saida);
+    memset(s_qos_entrada, 0, sizeof s_qos_entrada);
+    return core_conectar_com(s_qos_saida, s_qos_entrada, NET_CONN_QOS_RECORDS);
+}
+
+// QoS 1: o PUBACK já está no socket; uma passada do ProcessLoop() o consome,
+// como faria a tarefa de conexão
+static bool core_publicar(const void *payload, size_t len, uint8_t qos)
+{
+    const MQTTPublishInfo_t pub = {
+        .qos = (MQTTQoS_t)qos,
+        .pTopicName = TOPICO,
+        .topicNameLength = sizeof TOPICO - 1,
+        .pPayload = payload,
+        .payloadLength = len,
+    };
+    int acks = s_core_acks;
+    if (MQTT_Publish(&s_mqtt, &pub, qos ? MQTT_GetPacketId(&s_mqtt) : 0) != MQTTSuccess)
+        return false;
+    return qos == 0 || (MQTT_ProcessLoop(&s_mqtt) == MQTTSuccess && s_core_acks == acks + 1);
+}
+
+static void core_desconectar(void)
+{
+    MQTT_Disconnect(&s_mqtt);
+    mqtt_transport_close(&s_rede);
+}
+
+// --- coremqtt em lotes ---
+
+#define LOTE_MAX 64
+
+static const size_t s_lotes[] = {1, 4, 16, LOTE_MAX};
+static const size_t s_tamanhos_lote[] = {16, 128};
+static MQTTPubAckInfo_t s_lote_saida[LOTE_MAX], s_lote_entrada[LOTE_MAX];
+// Cabeçalho fixo, tópico e packet ID de cada publicação do lote
+static uint8_t s_cabecalhos[LOTE_MAX * (9 + sizeof TOPICO - 1)];
+
+// Os PUBACKs de um lote chegam juntos: a primeira passada do ProcessLoop() lê
+// todos e cada passada trata um. Nas seguintes o socket está vazio e o recv()
+// do transporte do firmware esperaria MQTT_TRANSPORT_RECV_WAIT_MS em cada uma
+static int32_t recv_sem_espera(NetworkContext_t *ctx, void *buf, size_t len)
+{
+    int r = lwip_recv(ctx->fd, buf, len, MSG_DONTWAIT);
+    return r >= 0 ? r : (errno == EWOULDBLOCK ? 0 : -1);
+}
+
+// Lote 1 é o MQTT_Publish(); os demais, um MQTT_PublishBatch() por lote. No
+// QoS 1 os PUBACKs do lote já estão no socket e o ProcessLoop() os consome
+static void rodada_lote(size_t len, uint8_t qos, size_t lote)
+{
+    MQTTPublishInfo_t pubs[LOTE_MAX];
+    uint16_t ids[LOTE_MAX];
+    const MQTTFixedBuffer_t cabecalhos = {.pBuffer = s_cabecalhos, .size = sizeof s_cabecalhos};
+    for (size_t i = 0; i < lote; ++i)
+        pubs[i] = (MQTTPublishInfo_t){
+            .qos = (MQTTQoS_t)qos,
+            .pTopicName = TOPICO,
+            .topicNameLength = sizeof TOPICO - 1,
+            .pPayload = s_payload,
+            .payloadLength = len,
+        };
+
+    memset(s_lote_saida, 0, sizeof s_lote_saida);
+    memset(s_lote_entrada, 0, sizeof s_lote_entrada);
+    if (!core_conectar_com(s_lote_saida, s_lote_entrada, LOTE_MAX)) {
+        printf("coremqtt sem conexão com o broker local\n");
+        exit(1);
+    }
+    s_mqtt.transportInterface.recv = recv_sem_espera;
+    uint32_t publicacoes = s_publicacoes / lote * lote, falhas = 0;
+    sim_mqtt_reset_stats();
+    s_chamadas = 0;
+    int acks = s_core_acks;
+    uint64_t t0 = agora_ns();
+    for (uint32_t k = 0; k < publicacoes; k += lote) {
+        for (size_t i = 0; i < lote; ++i)
+            ids[i] = qos ? MQTT_GetPacketId(&s_mqtt) : 0;
+        MQTTStatus_t st = lote == 1 ? MQTT_Publish(&s_mqtt, &pubs[0], ids[0])
+                                    : MQTT_PublishBatch(&s_mqtt, pubs, ids, lote, &cabecalhos);
+        if (st != MQTTSuccess)
+            falhas++;
+        for (size_t i = 0; qos && i < lote && st == MQTTSuccess; ++i)
+            if (MQTT_ProcessLoop(&s_mqtt) != MQTTSuccess)
+                falhas++;
+    }
+    uint64_t total = agora_ns() - t0;
+    uint32_t chamadas = s_chamadas;
+    core_desconectar();
+
+    const sim_mqtt_stats_t *st = sim_mqtt_stats();
+    bool conferido = falhas == 0 && st->publishes == publicacoes &&
+                     st->payload_bytes == (uint64_t)publicacoes * len &&
+                     (qos == 0 || s_core_acks - acks == (int)publicacoes);
+    printf("%5u %4u %5u %12.0f %10.2f %10.3f  %s\n", (unsigned)len, (unsigned)qos, (unsigned)lote,
+           publicacoes * 1e9 / total, (double)publicacoes * len / (total / 1e9) / 1e6, (double)chamadas / publicacoes,
+           conferido ? "ok" : "FALHOU");
+}
+
+// Falhas que não podem deixar nada enviado nem registro preso: registros de
+// QoS insuficientes, buffer de cabeçalhos pequeno, packet ID repetido no lote
+static bool conferir_lote(void)
+{
+    MQTTPublishInfo_t pubs[NET_CONN_QOS_RECORDS + 2];
+    uint16_t ids[NET_CONN_QOS_RECORDS + 2];
+    size_t n = sizeof pubs / sizeof pubs[0];
+    for (size_t i = 0; i < n; ++i)
+        pubs[i] = (MQTTPublishInfo_t){.qos = MQTTQoS1, .pTopicName = TOPICO, .topicNameLength = sizeof TOPICO - 1,
+                                      .pPayload = s_payload, .payloadLength = 16};
+    const MQTTFixedBuffer_t cabecalhos = {.pBuffer = s_cabecalhos, .size = sizeof s_cabecalhos};
+    const MQTTFixedBuffer_t pequeno = {.pBuffer = s_cabecalhos, .size = 2 * (9 + sizeof TOPICO - 1)};
+    if (!core_conectar())
+        return false;
+    s_mqtt.transportInterface.recv = recv_sem_espera;
+    sim_mqtt_reset_stats();
+    s_chamadas = 0;
+
+    for (size_t i = 0; i < n; ++i)
+        ids[i] = MQTT_GetPacketId(&s_mqtt);
+    bool ok = MQTT_PublishBatch(&s_mqtt, pubs, ids, n, &cabecalhos) == MQTTNoMemory;
+    ok = ok && MQTT_PublishBatch(&s_mqtt, pubs, ids, 3, &pequeno) == MQTTNoMemory;
+    ids[1] = ids[0];
+    ok = ok && MQTT_PublishBatch(&s_mqtt, pubs, ids, 2, &cabecalhos) == MQTTStateCollision;
+    ok = ok && s_chamadas == 0 && sim_mqtt_stats()->publishes == 0;
+
+    // Todos os registros livres de novo: um lote que os ocupa todos passa
+    int acks = s_core_acks;
+    for (size_t i = 0; i < NET_CONN_QOS_RECORDS; ++i)
+        ids[i] = MQTT_GetPacketId(&s_mqtt);
+    ok = ok && MQTT_PublishBatch(&s_mqtt, pubs, ids, NET_CONN_QOS_RECORDS, &cabecalhos) == MQTTSuccess;
+    for (size_t i = 0; ok && i < NET_CONN_QOS_RECORDS; ++i)
+        ok = MQTT_ProcessLoop(&s_mqtt) == MQTTSuccess;
+    ok = ok && s_chamadas == 1 && sim_mqtt_stats()->publishes == NET_CONN_QOS_RECORDS &&
+         s_core_acks - acks == NET_CONN_QOS_RECORDS;
+    core_desconectar();
+    return ok;
+}
+
+static void lotes(void)
+{
+    bool conferido = conferir_lote();
+    printf("\nConferência do MQTT_PublishBatch() (falta de registros, buffer pequeno, colisão): %s\n",
+           conferido ? "ok" : "FALHOU");
+    if (!conferido)
+        exit(1);
+    printf("coremqtt: MQTT_Publish() (lote 1) x MQTT_PublishBatch(), até %u vetores por writev\n",
+           (unsigned)MQTT_PUBLISH_BATCH_MAX_VECTORS);
+    printf("%5s %4s %5s %12s %10s %10s\n", "bytes", "qos", "lote", "pub/s", "MB/s", "envios/pub");
+    for (size_t t = 0; t < sizeof s_tamanhos_lote / sizeof s_tamanhos_lote[0]; ++t)
+        for (uint8_t qos = 0; qos <= 1; ++qos)
+            for (size_t l = 0; l < sizeof s_lotes / sizeof s_lotes[0]; ++l)
+                rodada_lote(s_tamanhos_lote[t], qos, s_lotes[l]);
+}
+
+// --- Medição ---
+
+static int compara(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void rodada(const pilha_t *p, size_t len, uint8_t qos)
+{
+    sim_mqtt_reset_stats();
+    uint32_t falhas = 0;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < s_publicacoes; ++i) {
+        s_payload[0] = (uint8_t)i;
+        uint64_t a = agora_ns();
+        if (!p->publicar(s_payload, len, qos))
+            falhas++;
+        s_lat[i] = agora_ns() - a;
+    }
+    uint64_t total = agora_ns() - t0;
+    qsort(s_lat, s_publicacoes, sizeof s_lat[0], compara);
+
+    const sim_mqtt_stats_t *st = sim_mqtt_stats();
+    bool conferido = falhas == 0 && st->publishes == s_publicacoes &&
+                     st->payload_bytes == (uint64_t)s_publicacoes * len;
+    printf("%-9s %5u %4u %12.0f %10.2f %8.2f %8.2f %8.2f  %s\n", p->nome, (unsigned)len, (unsigned)qos,
+           s_publicacoes * 1e9 / total, (double)s_publicacoes * len / (total / 1e9) / 1e6,
+           total / 1e3 / s_publicacoes, s_lat[s_publicacoes / 2] / 1e3, s_lat[s_publicacoes * 99 / 100] / 1e3,
+           conferido ? "ok" : "FALHOU");
+}
+
+static void memoria(void)
+{
+    size_t lwip_cliente = sim_mqtt_lwip_client_size();
+    size_t core_ctx = sizeof(MQTTContext_t);
+    size_t core_qos = 2 * NET_CONN_QOS_RECORDS * sizeof(MQTTPubAckInfo_t);
+    size_t core_total = core_ctx + NET_CONN_MQTT_BUFFER + core_qos + sizeof(NetworkContext_t);
+    size_t pilha = (NET_CONN_TASK_STACK_COREMQTT - NET_CONN_TASK_STACK_LWIP) * 4;
+
+    printf("\nRAM estática do cliente (ABI do host: ponteiros de %u bytes)\n", (unsigned)sizeof(void *));
+    printf("  lwip      mqtt_client_t %u B (anel de saída %u B)\n", (unsigned)lwip_cliente,
+           (unsigned)MQTT_OUTPUT_RINGBUF_SIZE);
+    printf("  coremqtt  %u B: MQTTContext_t %u B, buffer de rede %u B, %u registros QoS %u B, NetworkContext %u B\n",
+           (unsigned)core_total, (unsigned)core_ctx, (unsigned)NET_CONN_MQTT_BUFFER, 2 * NET_CONN_QOS_RECORDS,
+           (unsigned)core_qos, (unsigned)sizeof(NetworkContext_t));
+    printf("            + %u B de pilha da tarefa de conexão no RP2040 (%u -> %u palavras)\n", (unsigned)pilha,
+           NET_CONN_TASK_STACK_LWIP, NET_CONN_TASK_STACK_COREMQTT);
+    printf("  Diferença: %+d B (coremqtt - lwip, com a pilha)\n", (int)(core_total + pilha) - (int)lwip_cliente);
+    printf("  Fora da conta: o socket do lwIP (netconn, lwip_sock, mailbox de recepção) no coremqtt,\n"
+           "  e pcb/segmentos TCP, iguais nas duas\n");
+}
+
+static void tarefaBench(void *pvParameters)
+{
+    (void)pvParameters;
+    static const pilha_t pilhas[] = {
+        {"lwip", lwip_conectar, lwip_publicar, lwip_desconectar},
+        {"coremqtt", core_conectar, core_publicar, core_desconectar},
+    };
+    s_lat = malloc(s_publicacoes * sizeof s_lat[0]);
+    memset(s_payload, 0xA5, sizeof s_payload);
+
+    printf("Publicações por rodada: %lu, tópico %s\n\n", (unsigned long)s_publicacoes, TOPICO);
+    printf("%-9s %5s %4s %12s %10s %8s %8s %8s\n", "pilha", "bytes", "qos", "pub/s", "MB/s", "média", "p50", "p99");
+    printf("%-9s %5s %4s %12s %10s %8s %8s %8s\n", "", "", "", "", "", "(µs)", "(µs)", "(µs)");
+    for (size_t t = 0; t < sizeof s_tamanhos / sizeof s_tamanhos[0]; ++t)
+        for (uint8_t qos = 0; qos <= 1; ++qos)
+            for (size_t i = 0; i < sizeof pilhas / sizeof pilhas[0]; ++i) {
+                if (!pilhas[i].conectar()) {
+                    printf("%-9s sem conexão com o broker local\n", pilhas[i].nome);
+                    exit(1);
+                }
+                rodada(&pilhas[i], s_tamanhos[t], qos);
+                pilhas[i].desconectar();
+            }
+    memoria();
+    lotes();
+    free(s_lat);
+    exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        s_publicacoes = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (s_publicacoes == 0)
+        s_publicacoes = PUBLICACOES_PADRAO;
+    sim_pico_init();
+    xTaskCreate(tarefaBench, "Bench", 4096, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
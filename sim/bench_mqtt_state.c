@@ -0,0 +1,483 @@
+// Benchmark e conferência no host dos registros de estado QoS do coreMQTT
+// (core_mqtt_state.c) nas duas organizações de MQTT_STATE_HASHED_RECORDS:
+// mqtt_state_bench usa o vetor compactado original, mqtt_state_bench_hashed a
+// tabela por packet ID. Para 16, 256 e 1024 publicações QoS 1 em voo mede:
+//  - PUBACK na ordem + reserva da próxima (janela deslizante, envio em rajada);
+//  - PUBACK fora de ordem + reserva da próxima;
+//  - o ciclo completo MQTT_Publish() + PUBACK pelo MQTT_ProcessLoop(), com um
+//    transporte em memória.
+// Antes confere a API de estado contra um modelo de referência: ordem de
+// reenvio, colisão, falta de espaço, QoS 2 com PUBREC/PUBREL/PUBCOMP e a
+// limpeza dos registros numa sessão nova.
+//   cmake --build build_sim --target mqtt_state_bench mqtt_state_bench_hashed
+//   ./build_sim/mqtt_state_bench [iterações] && ./build_sim/mqtt_state_bench_hashed [iterações]
+// Os tempos são do host; a razão entre as organizações é o que vale para o RP2040.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "core_mqtt.h"
+#include "core_mqtt_state.h"
+
+#define EM_VOO_MAX 1024
+#define ITERACOES_PADRAO 200000
+#define CONFERE_OPERACOES 200000
+
+static const size_t s_em_voo[] = {16, 256, 1024};
+static uint32_t s_iteracoes = ITERACOES_PADRAO;
+
+// --- Transporte em memória ---
+
+struct NetworkContext {
+    uint8_t rx[4 * EM_VOO_MAX];
+    size_t ini, fim;
+    uint64_t enviados;
+};
+
+static NetworkContext_t s_rede;
+static MQTTContext_t s_mqtt;
+static MQTTPubAckInfo_t s_saida[EM_VOO_MAX], s_entrada[EM_VOO_MAX];
+static uint8_t s_buffer[256];
+static uint32_t s_pubacks;
+
+static int32_t rede_recv(NetworkContext_t *ctx, void *buf, size_t len)
+{
+    size_t n = ctx->fim - ctx->ini;
+    if (n > len)
+        n = len;
+    memcpy(buf, &ctx->rx[ctx->ini], n);
+    ctx->ini += n;
+    if (ctx->ini == ctx->fim)
+        ctx->ini = ctx->fim = 0;
+    return (int32_t)n;
+}
+
+static int32_t rede_send(NetworkContext_t *ctx, const void *buf, size_t len)
+{
+    (void)buf;
+    ctx->enviados += len;
+    return (int32_t)len;
+}
+
+static int32_t rede_writev(NetworkContext_t *ctx, TransportOutVector_t *vetores, size_t n)
+{
+    size_t total = 0;
+    for (size_t i = 0; i < n; ++i)
+        total += vetores[i].iov_len;
+    ctx->enviados += total;
+    return (int32_t)total;
+}
+
+static void rede_entregar(const uint8_t *pacote, size_t len)
+{
+    memcpy(&s_rede.rx[s_rede.fim], pacote, len);
+    s_rede.fim += len;
+}
+
+static void entregar_puback(uint16_t id)
+{
+    const uint8_t puback[] = {0x40, 0x02, (uint8_t)(id >> 8), (uint8_t)id};
+    rede_entregar(puback, sizeof puback);
+}
+
+static uint32_t tempo_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void evento_cb(MQTTContext_t *ctx, MQTTPacketInfo_t *pacote, MQTTDeserializedInfo_t *info)
+{
+    (void)ctx;
+    (void)info;
+    if (pacote->type == MQTT_PACKET_TYPE_PUBACK)
+        s_pubacks++;
+}
+
+// Contexto novo, registros zerados, como depois de um MQTT_Init() no firmware
+static void iniciar(size_t registros)
+{
+    memset(s_saida, 0, sizeof s_saida);
+    memset(s_entrada, 0, sizeof s_entrada);
+    memset(&s_rede, 0, sizeof s_rede);
+    const TransportInterface_t transporte = {
+        .recv = rede_recv, .send = rede_send, .writev = rede_writev, .pNetworkContext = &s_rede};
+    const MQTTFixedBuffer_t buffer = {.pBuffer = s_buffer, .size = sizeof s_buffer};
+    if (MQTT_Init(&s_mqtt, &transporte, tempo_ms, evento_cb, &buffer) != MQTTSuccess ||
+        MQTT_InitStatefulQoS(&s_mqtt, s_saida, registros, s_entrada, registros) != MQTTSuccess) {
+        printf("MQTT_Init/MQTT_InitStatefulQoS falhou\n");
+        exit(1);
+    }
+}
+
+// --- Conferência contra o modelo ---
+
+// Registro do modelo: a ordem no vetor é a ordem de publicação
+typedef struct {
+    uint16_t id;
+    MQTTQoS_t qos;
+    MQTTPublishState_t estado;
+} modelo_t;
+
+typedef struct {
+    modelo_t r[EM_VOO_MAX];
+    size_t n;
+} tabela_modelo_t;
+
+static tabela_modelo_t s_mod_saida, s_mod_entrada;
+static uint32_t s_semente = 12345;
+static uint32_t s_erros;
+
+static uint32_t sorteio(uint32_t n)
+{
+    s_semente = s_semente * 1103515245u + 12345u;
+    return (s_semente >> 8) % n;
+}
+
+static int modelo_busca(const tabela_modelo_t *t, uint16_t id)
+{
+    for (size_t i = 0; i < t->n; ++i)
+        if (t->r[i].id == id)
+            return (int)i;
+    return -1;
+}
+
+static void modelo_remove(tabela_modelo_t *t, int i)
+{
+    memmove(&t->r[i], &t->r[i + 1], (t->n - (size_t)i - 1) * sizeof t->r[0]);
+    t->n--;
+}
+
+static void confere(bool ok, const char *o_que, uint16_t id, MQTTStatus_t st)
+{
+    if (!ok && s_erros++ < 10)
+        printf("  divergência: %s (packet ID %u, %s)\n", o_que, id, MQTT_Status_strerror(st));
+}
+
+// Resultado esperado de uma adição: colisão, sem espaço ou sucesso
+static MQTTStatus_t modelo_adiciona(tabela_modelo_t *t, size_t capacidade, uint16_t id, MQTTQoS_t qos,
+                                    MQTTPublishState_t estado)
+{
+    if (modelo_busca(t, id) >= 0)
+        return MQTTStateCollision;
+    if (t->n == capacidade)
+        return MQTTNoMemory;
+    t->r[t->n++] = (modelo_t){id, qos, estado};
+    return MQTTSuccess;
+}
+
+// Ordem de reenvio depois de uma reconexão com sessão: publicações e PUBRELs
+static void confere_reenvio(void)
+{
+    MQTTStateCursor_t cursor = MQTT_STATE_CURSOR_INITIALIZER;
+    size_t i = 0;
+    uint16_t id;
+    while ((id = MQTT_PublishToResend(&s_mqtt, &cursor)) != MQTT_PACKET_ID_INVALID) {
+        while (i < s_mod_saida.n && s_mod_saida.r[i].estado != MQTTPublishSend &&
+               s_mod_saida.r[i].estado != MQTTPubAckPending && s_mod_saida.r[i].estado != MQTTPubRecPending)
+            i++;
+        confere(i < s_mod_saida.n && s_mod_saida.r[i].id == id, "ordem do MQTT_PublishToResend", id, MQTTSuccess);
+        i++;
+    }
+    for (; i < s_mod_saida.n; ++i)
+        confere(s_mod_saida.r[i].estado != MQTTPublishSend && s_mod_saida.r[i].estado != MQTTPubAckPending &&
+                    s_mod_saida.r[i].estado != MQTTPubRecPending,
+                "publicação faltando no MQTT_PublishToResend", s_mod_saida.r[i].id, MQTTSuccess);
+
+    cursor = MQTT_STATE_CURSOR_INITIALIZER;
+    i = 0;
+    MQTTPublishState_t estado;
+    while ((id = MQTT_PubrelToResend(&s_mqtt, &cursor, &estado)) != MQTT_PACKET_ID_INVALID) {
+        while (i < s_mod_saida.n && s_mod_saida.r[i].estado != MQTTPubRelSend &&
+               s_mod_saida.r[i].estado != MQTTPubCompPending)
+            i++;
+        confere(i < s_mod_saida.n && s_mod_saida.r[i].id == id && estado == MQTTPubRelSend,
+                "ordem do MQTT_PubrelToResend", id, MQTTSuccess);
+        i++;
+    }
+    for (; i < s_mod_saida.n; ++i)
+        confere(s_mod_saida.r[i].estado != MQTTPubRelSend && s_mod_saida.r[i].estado != MQTTPubCompPending,
+                "PUBREL faltando no MQTT_PubrelToResend", s_mod_saida.r[i].id, MQTTSuccess);
+}
+
+// Publicação de saída: reserva e, quase sempre, o envio
+static void op_publica(size_t capacidade, uint16_t id_max)
+{
+    uint16_t id = (uint16_t)(1 + sorteio(id_max));
+    MQTTQoS_t qos = sorteio(3) ? MQTTQoS1 : MQTTQoS2;
+    MQTTStatus_t esperado = modelo_adiciona(&s_mod_saida, capacidade, id, qos, MQTTPublishSend);
+    MQTTStatus_t st = MQTT_ReserveState(&s_mqtt, id, qos);
+    confere(st == esperado, "MQTT_ReserveState", id, st);
+    if (st != MQTTSuccess || sorteio(8) == 0)
+        return;
+    MQTTPublishState_t novo;
+    st = MQTT_UpdateStatePublish(&s_mqtt, id, MQTT_SEND, qos, &novo);
+    MQTTPublishState_t esperado_estado = qos == MQTTQoS1 ? MQTTPubAckPending : MQTTPubRecPending;
+    confere(st == MQTTSuccess && novo == esperado_estado, "MQTT_UpdateStatePublish (envio)", id, st);
+    s_mod_saida.r[modelo_busca(&s_mod_saida, id)].estado = esperado_estado;
+}
+
+// Confirmação de uma publicação de saída, na maioria das vezes a certa para o estado
+static void op_confirma_saida(uint16_t id_max)
+{
+    uint16_t id;
+    int i = -1;
+    if (s_mod_saida.n > 0 && sorteio(8) != 0) {
+        i = (int)sorteio((uint32_t)s_mod_saida.n);
+        id = s_mod_saida.r[i].id;
+    } else {
+        id = (uint16_t)(1 + sorteio(id_max));
+        i = modelo_busca(&s_mod_saida, id);
+    }
+
+    MQTTPubAckType_t tipo = MQTTPuback;
+    MQTTStateOperation_t op = MQTT_RECEIVE;
+    MQTTPublishState_t esperado_estado = MQTTPublishDone;
+    MQTTStatus_t esperado = MQTTBadResponse; // sem registro
+    if (i >= 0) {
+        modelo_t *r = &s_mod_saida.r[i];
+        esperado = MQTTSuccess;
+        if (sorteio(10) == 0 || r->estado == MQTTPublishSend) {
+            // PUBACK fora de hora (QoS 2 ou ainda não enviada)
+            if (!(r->qos == MQTTQoS1 && r->estado == MQTTPubAckPending))
+                esperado = MQTTIllegalState;
+        } else if (r->estado == MQTTPubRecPending) {
+            tipo = MQTTPubrec;
+            esperado_estado = MQTTPubRelSend;
+        } else if (r->estado == MQTTPubRelSend) {
+            tipo = MQTTPubrel;
+            op = MQTT_SEND;
+            esperado_estado = MQTTPubCompPending;
+        } else if (r->estado == MQTTPubCompPending) {
+            tipo = MQTTPubcomp;
+        }
+    }
+
+    MQTTPublishState_t novo = MQTTStateNull;
+    MQTTStatus_t st = MQTT_UpdateStateAck(&s_mqtt, id, tipo, op, &novo);
+    confere(st == esperado && (st != MQTTSuccess || novo == esperado_estado), "MQTT_UpdateStateAck (saída)", id, st);
+    if (esperado != MQTTSuccess)
+        return;
+    if (esperado_estado == MQTTPublishDone) {
+        modelo_remove(&s_mod_saida, i);
+    } else if (esperado_estado == MQTTPubRelSend) {
+        // PUBREC: o registro vai para o fim, na ordem dos PUBRELs
+        modelo_t r = s_mod_saida.r[i];
+        r.estado = MQTTPubRelSend;
+        modelo_remove(&s_mod_saida, i);
+        s_mod_saida.r[s_mod_saida.n++] = r;
+    } else {
+        s_mod_saida.r[i].estado = esperado_estado;
+    }
+}
+
+// Cancelamento de uma publicação de saída (MQTT_CancelCallback)
+static void op_remove(uint16_t id_max)
+{
+    uint16_t id = s_mod_saida.n > 0 && sorteio(4) != 0 ? s_mod_saida.r[sorteio((uint32_t)s_mod_saida.n)].id
+                                                       : (uint16_t)(1 + sorteio(id_max));
+    int i = modelo_busca(&s_mod_saida, id);
+    MQTTStatus_t st = MQTT_RemoveStateRecord(&s_mqtt, id);
+    confere(st == (i >= 0 ? MQTTSuccess : MQTTBadParameter), "MQTT_RemoveStateRecord", id, st);
+    if (i >= 0)
+        modelo_remove(&s_mod_saida, i);
+}
+
+// Publicação de entrada e as confirmações que o cliente manda/recebe
+static void op_entrada(size_t capacidade, uint16_t id_max)
+{
+    if (s_mod_entrada.n == 0 || sorteio(2) == 0) {
+        uint16_t id = (uint16_t)(1 + sorteio(id_max));
+        MQTTQoS_t qos = sorteio(2) ? MQTTQoS1 : MQTTQoS2;
+        MQTTPublishState_t esperado_estado = qos == MQTTQoS1 ? MQTTPubAckSend : MQTTPubRecSend;
+        MQTTStatus_t esperado = modelo_adiciona(&s_mod_entrada, capacidade, id, qos, esperado_estado);
+        MQTTPublishState_t novo = MQTTStateNull;
+        MQTTStatus_t st = MQTT_UpdateStatePublish(&s_mqtt, id, MQTT_RECEIVE, qos, &novo);
+        confere(st == esperado && (st != MQTTSuccess || novo == esperado_estado), "MQTT_UpdateStatePublish (entrada)",
+                id, st);
+        return;
+    }
+    int i = (int)sorteio((uint32_t)s_mod_entrada.n);
+    modelo_t *r = &s_mod_entrada.r[i];
+    MQTTPubAckType_t tipo = MQTTPuback;
+    MQTTStateOperation_t op = MQTT_SEND;
+    MQTTPublishState_t esperado_estado = MQTTPublishDone;
+    if (r->estado == MQTTPubRecSend) {
+        tipo = MQTTPubrec;
+        esperado_estado = MQTTPubRelPending;
+    } else if (r->estado == MQTTPubRelPending) {
+        tipo = MQTTPubrel;
+        op = MQTT_RECEIVE;
+        esperado_estado = MQTTPubCompSend;
+    } else if (r->estado == MQTTPubCompSend) {
+        tipo = MQTTPubcomp;
+    }
+    MQTTPublishState_t novo = MQTTStateNull;
+    MQTTStatus_t st = MQTT_UpdateStateAck(&s_mqtt, r->id, tipo, op, &novo);
+    confere(st == MQTTSuccess && novo == esperado_estado, "MQTT_UpdateStateAck (entrada)", r->id, st);
+    if (esperado_estado == MQTTPublishDone)
+        modelo_remove(&s_mod_entrada, i);
+    else
+        r->estado = esperado_estado;
+}
+
+// Sessão nova (CONNACK sem sessão presente): os registros são apagados
+static void op_sessao_nova(void)
+{
+    const uint8_t connack[] = {0x20, 0x02, 0x00, 0x00};
+    const MQTTConnectInfo_t info = {.cleanSession = true, .pClientIdentifier = "bench", .clientIdentifierLength = 5};
+    bool presente = true;
+    rede_entregar(connack, sizeof connack);
+    MQTTStatus_t st = MQTT_Connect(&s_mqtt, &info, NULL, 100, &presente);
+    confere(st == MQTTSuccess && !presente, "MQTT_Connect (sessão nova)", 0, st);
+    s_mod_saida.n = s_mod_entrada.n = 0;
+}
+
+// Operações sorteadas: IDs de uma faixa pequena forçam colisões e sondagens
+// longas na tabela; IDs de 1 a 65535 exercitam o caso espalhado
+static bool conferir(void)
+{
+    static const struct {
+        size_t capacidade;
+        uint16_t id_max;
+    } casos[] = {{1, 4}, {4, 8}, {8, 64}, {64, 96}, {256, 65535}};
+    uint32_t operacoes = 0;
+    s_erros = 0;
+    for (size_t c = 0; c < sizeof casos / sizeof casos[0]; ++c) {
+        iniciar(casos[c].capacidade);
+        s_mod_saida.n = s_mod_entrada.n = 0;
+        for (uint32_t k = 0; k < CONFERE_OPERACOES / 5; ++k, ++operacoes) {
+            uint32_t o = sorteio(100);
+            if (o < 40)
+                op_publica(casos[c].capacidade, casos[c].id_max);
+            else if (o < 75)
+                op_confirma_saida(casos[c].id_max);
+            else if (o < 80)
+                op_remove(casos[c].id_max);
+            else if (o < 99)
+                op_entrada(casos[c].capacidade, casos[c].id_max);
+            else if (sorteio(50) == 0)
+                op_sessao_nova();
+            if (k % 64 == 0)
+                confere_reenvio();
+        }
+        confere_reenvio();
+    }
+    printf("Conferência contra o modelo: %lu operações, %s\n", (unsigned long)operacoes,
+           s_erros ? "FALHOU" : "ok");
+    return s_erros == 0;
+}
+
+// --- Medição ---
+
+// Janela de publicações em voo: ids[] na ordem de envio
+static uint16_t s_ids[EM_VOO_MAX];
+
+static void publica_estado(uint16_t id)
+{
+    MQTTPublishState_t novo;
+    if (MQTT_ReserveState(&s_mqtt, id, MQTTQoS1) != MQTTSuccess ||
+        MQTT_UpdateStatePublish(&s_mqtt, id, MQTT_SEND, MQTTQoS1, &novo) != MQTTSuccess) {
+        printf("reserva de %u falhou\n", id);
+        exit(1);
+    }
+}
+
+static void confirma_estado(uint16_t id)
+{
+    MQTTPublishState_t novo;
+    if (MQTT_UpdateStateAck(&s_mqtt, id, MQTTPuback, MQTT_RECEIVE, &novo) != MQTTSuccess) {
+        printf("PUBACK de %u falhou\n", id);
+        exit(1);
+    }
+}
+
+// PUBACK de uma publicação em voo (a mais antiga ou uma sorteada) e a próxima publicação
+static double rodada_estado(size_t em_voo, bool fora_de_ordem)
+{
+    iniciar(em_voo);
+    for (size_t i = 0; i < em_voo; ++i)
+        publica_estado(s_ids[i] = MQTT_GetPacketId(&s_mqtt));
+    size_t mais_antiga = 0;
+    uint64_t t0 = agora_ns();
+    for (uint32_t k = 0; k < s_iteracoes; ++k) {
+        size_t i = fora_de_ordem ? sorteio((uint32_t)em_voo) : mais_antiga;
+        confirma_estado(s_ids[i]);
+        publica_estado(s_ids[i] = MQTT_GetPacketId(&s_mqtt));
+        mais_antiga = mais_antiga + 1 == em_voo ? 0 : mais_antiga + 1;
+    }
+    return (double)(agora_ns() - t0) / s_iteracoes;
+}
+
+static void publica_mqtt(uint16_t id)
+{
+    static const uint8_t payload[24];
+    const MQTTPublishInfo_t pub = {.qos = MQTTQoS1,
+                                   .pTopicName = "pico_w/sensor/cbor",
+                                   .topicNameLength = 18,
+                                   .pPayload = payload,
+                                   .payloadLength = sizeof payload};
+    if (MQTT_Publish(&s_mqtt, &pub, id) != MQTTSuccess) {
+        printf("MQTT_Publish de %u falhou\n", id);
+        exit(1);
+    }
+}
+
+// Ciclo da biblioteca: o PUBACK chega pelo transporte e passa pelo
+// MQTT_ProcessLoop(); a publicação seguinte sai pelo MQTT_Publish()
+static double rodada_laco(size_t em_voo)
+{
+    iniciar(em_voo);
+    for (size_t i = 0; i < em_voo; ++i)
+        publica_mqtt(s_ids[i] = MQTT_GetPacketId(&s_mqtt));
+    s_pubacks = 0;
+    size_t mais_antiga = 0;
+    uint64_t t0 = agora_ns();
+    for (uint32_t k = 0; k < s_iteracoes; ++k) {
+        entregar_puback(s_ids[mais_antiga]);
+        if (MQTT_ProcessLoop(&s_mqtt) != MQTTSuccess) {
+            printf("MQTT_ProcessLoop falhou\n");
+            exit(1);
+        }
+        publica_mqtt(s_ids[mais_antiga] = MQTT_GetPacketId(&s_mqtt));
+        mais_antiga = mais_antiga + 1 == em_voo ? 0 : mais_antiga + 1;
+    }
+    double ns = (double)(agora_ns() - t0) / s_iteracoes;
+    if (s_pubacks != s_iteracoes) {
+        printf("PUBACKs entregues %lu de %lu\n", (unsigned long)s_pubacks, (unsigned long)s_iteracoes);
+        exit(1);
+    }
+    return ns;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        s_iteracoes = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (s_iteracoes == 0)
+        s_iteracoes = ITERACOES_PADRAO;
+
+    printf("Registros de estado QoS: %s (MQTT_STATE_HASHED_RECORDS=%d), %u B por registro\n",
+           MQTT_STATE_HASHED_RECORDS ? "tabela por packet ID" : "vetor compactado", MQTT_STATE_HASHED_RECORDS,
+           (unsigned)sizeof(MQTTPubAckInfo_t));
+    if (!conferir())
+        return 1;
+
+    printf("\n%lu iterações por rodada, ns por PUBACK + nova publicação\n", (unsigned long)s_iteracoes);
+    printf("%8s %14s %14s %16s\n", "em voo", "na ordem", "fora de ordem", "Publish+Process");
+    for (size_t i = 0; i < sizeof s_em_voo / sizeof s_em_voo[0]; ++i) {
+        double ordem = rodada_estado(s_em_voo[i], false);
+        double fora = rodada_estado(s_em_voo[i], true);
+        double laco = rodada_laco(s_em_voo[i]);
+        printf("%8u %14.1f %14.1f %16.1f\n", (unsigned)s_em_voo[i], ordem, fora, laco);
+    }
+    return 0;
+}
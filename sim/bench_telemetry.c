@@ -0,0 +1,146 @@
+// Benchmark no host da codificação da telemetria: payload JSON histórico
+// (snprintf com %.2f por amostra), JSON a partir de inteiros e lote CBOR de
+// TELEMETRY_BATCH_MAX amostras. Mede bytes por amostra (payload e no fio, com o
+// cabeçalho PUBLISH QoS 0) e tempo de codificação; confere o lote CBOR com o
+// decodificador do host.
+//   cmake --build build_sim --target telemetry_bench && ./build_sim/telemetry_bench
+// Tempos são do host; no RP2040 o %.2f passa pela formatação de float da newlib
+// (emulada em software), então a diferença para os caminhos inteiros cresce.
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "telemetry.h"
+#include "telemetry_decode.h"
+
+#define AMOSTRAS 1200
+#define REPETICOES 200
+#define PERIODO_MS 10000
+
+static telemetry_sample_t s_amostras[AMOSTRAS];
+static const telemetry_meta_t s_meta = {.dist_threshold_mm = 200, .temp_threshold_c100 = 3000};
+static volatile size_t s_sink;
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Cabeçalho fixo (2) + tamanho do tópico (2) + tópico; QoS 0 não leva packet id
+static size_t publish_overhead(const char *topic)
+{
+    return 2 + 2 + strlen(topic);
+}
+
+// Payload como era montado em tarefaMQTT antes da camada de codificação (sem BPM/SpO2)
+static size_t json_float(const telemetry_sample_t *s, char *buf, size_t cap)
+{
+    int n = snprintf(buf, cap, "{\"temp\": %.2f, \"pres\": %lu, \"dist\": %u, \"threshold_mm\": %u, \"temp_threshold_c\": %.2f}",
+                     s->temp_c100 / 100.0f, (unsigned long)s->pres_pa, (unsigned)s->dist_mm, 200u, 30.0);
+    return n > 0 ? (size_t)n : 0;
+}
+
+static void gera(void)
+{
+    uint32_t rng = 1;
+    for (size_t i = 0; i < AMOSTRAS; ++i) {
+        rng = rng * 1103515245u + 12345u;
+        telemetry_sample_t *s = &s_amostras[i];
+        s->seq = 1000u + (uint32_t)i;
+        s->t_ms = 5000u + (uint32_t)i * PERIODO_MS + ((rng >> 16) & 0x3F);   // jitter de alguns ms
+        s->temp_c100 = (int16_t)(1750 + (int)((rng >> 8) % 1500));
+        s->pres_pa = 100500u + (rng >> 20) % 1500u;
+        s->dist_mm = (uint16_t)(150 + (rng >> 4) % 500);
+        if (i % 2) {
+            s->bpm_x10 = (uint16_t)(660 + (rng >> 12) % 120);
+            s->spo2_x10 = (uint16_t)(960 + (rng >> 24) % 30);
+        }
+    }
+}
+
+static size_t codifica_cbor(uint8_t *buf, size_t cap, size_t inicio, size_t *usadas)
+{
+    telemetry_batch_t b;
+    telemetry_batch_begin(&b, buf, cap, &s_meta);
+    size_t i = inicio;
+    while (i < AMOSTRAS && telemetry_batch_add(&b, &s_amostras[i]))
+        i++;
+    *usadas = i - inicio;
+    return telemetry_batch_finish(&b);
+}
+
+static bool confere(void)
+{
+    uint8_t buf[TELEMETRY_CBOR_BATCH_MAX_BYTES];
+    for (size_t i = 0; i < AMOSTRAS;) {
+        size_t usadas;
+        size_t len = codifica_cbor(buf, sizeof buf, i, &usadas);
+        telemetry_decoded_t d;
+        if (telemetry_decode_cbor(buf, len, &d) != len || d.count != usadas) return false;
+        if (d.meta.dist_threshold_mm != s_meta.dist_threshold_mm || d.meta.temp_threshold_c100 != s_meta.temp_threshold_c100)
+            return false;
+        for (size_t k = 0; k < usadas; ++k) {
+            const telemetry_sample_t *a = &d.samples[k], *e = &s_amostras[i + k];
+            if (a->seq != e->seq || a->t_ms != e->t_ms || a->temp_c100 != e->temp_c100 || a->pres_pa != e->pres_pa ||
+                a->dist_mm != e->dist_mm || a->bpm_x10 != e->bpm_x10 || a->spo2_x10 != e->spo2_x10)
+                return false;
+        }
+        i += usadas;
+    }
+    return true;
+}
+
+int main(void)
+{
+    gera();
+    char txt[256];
+    uint8_t bin[TELEMETRY_CBOR_BATCH_MAX_BYTES];
+
+    // Tamanhos
+    size_t bytes_float = 0, bytes_json = 0, bytes_cbor = 0, lotes = 0;
+    for (size_t i = 0; i < AMOSTRAS; ++i) {
+        bytes_float += json_float(&s_amostras[i], txt, sizeof txt);
+        bytes_json += telemetry_encode_json(&s_amostras[i], &s_meta, txt, sizeof txt);
+    }
+    for (size_t i = 0; i < AMOSTRAS; lotes++) {
+        size_t usadas;
+        bytes_cbor += codifica_cbor(bin, sizeof bin, i, &usadas);
+        i += usadas;
+    }
+    size_t fio_json = bytes_json + AMOSTRAS * publish_overhead(TELEMETRY_TOPIC_JSON);
+    size_t fio_float = bytes_float + AMOSTRAS * publish_overhead(TELEMETRY_TOPIC_JSON);
+    size_t fio_cbor = bytes_cbor + lotes * publish_overhead(TELEMETRY_TOPIC_CBOR);
+
+    // Tempos
+    uint64_t t0 = agora_ns();
+    for (int r = 0; r < REPETICOES; ++r)
+        for (size_t i = 0; i < AMOSTRAS; ++i)
+            s_sink += json_float(&s_amostras[i], txt, sizeof txt);
+    uint64_t t1 = agora_ns();
+    for (int r = 0; r < REPETICOES; ++r)
+        for (size_t i = 0; i < AMOSTRAS; ++i)
+            s_sink += telemetry_encode_json(&s_amostras[i], &s_meta, txt, sizeof txt);
+    uint64_t t2 = agora_ns();
+    for (int r = 0; r < REPETICOES; ++r)
+        for (size_t i = 0; i < AMOSTRAS;) {
+            size_t usadas;
+            s_sink += codifica_cbor(bin, sizeof bin, i, &usadas);
+            i += usadas;
+        }
+    uint64_t t3 = agora_ns();
+    double n = (double)REPETICOES * AMOSTRAS;
+
+    printf("Telemetria: %d amostras (metade com BPM/SpO2), lote CBOR de %d\n", AMOSTRAS, TELEMETRY_BATCH_MAX);
+    printf("%-16s %7s %9s %10s %12s\n", "formato", "publ.", "B/amostra", "fio/amostra", "ns/amostra");
+    printf("%-16s %7d %9.1f %10.1f %12.1f\n", "JSON %.2f", AMOSTRAS, (double)bytes_float / AMOSTRAS,
+           (double)fio_float / AMOSTRAS, (double)(t1 - t0) / n);
+    printf("%-16s %7d %9.1f %10.1f %12.1f\n", "JSON inteiro", AMOSTRAS, (double)bytes_json / AMOSTRAS,
+           (double)fio_json / AMOSTRAS, (double)(t2 - t1) / n);
+    printf("%-16s %7zu %9.1f %10.1f %12.1f\n", "CBOR em lote", lotes, (double)bytes_cbor / AMOSTRAS,
+           (double)fio_cbor / AMOSTRAS, (double)(t3 - t2) / n);
+
+    bool ok = confere();
+    printf("Decodificação CBOR: %s\n", ok ? "idêntica às amostras" : "DIVERGENTE");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,437 @@
+// Benchmark no host do handshake TLS do MQTT: o cliente com o mbedtls_config.h
+// do firmware contra um broker local (servidor mbedTLS no mesmo processo, ligado
+// por dois buffers em memória, sem rede). Para certificado ECDSA P-256 e RSA-2048,
+// handshake completo x retomado, por ID de sessão (cache do servidor) e por
+// ticket (RFC 5077). Mede:
+//   - tempo de CPU do cliente e do servidor por handshake;
+//   - pico do heap do cliente (contexto SSL + handshake) e o que fica na sessão aberta;
+//   - tamanho da sessão guardada para a retomada;
+//   - bytes no fio e voos; idas e vindas até o cliente poder mandar o CONNECT.
+// Cada retomada oferece a sessão do handshake anterior, como inc/mqtt_tls.c, e é
+// conferida pelo mesmo critério (segredo mestre igual ao da sessão oferecida).
+//   cmake -S sim -B build_sim -DMBEDTLS_DIR=$PICO_SDK_PATH/lib/mbedtls
+//   cmake --build build_sim --target tls_bench && ./build_sim/tls_bench [repetições]
+// Tempos são do host. No M0+ (sem multiplicador largo nem aceleração de curva) o
+// handshake completo custa segundos e o retomado só o hash e o AES-GCM, então a
+// razão entre os dois cresce; os bytes, voos e o heap valem como no alvo.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "mbedtls/version.h"
+#include "mbedtls/platform.h"
+#include "mbedtls/entropy.h"
+#include "mbedtls/ctr_drbg.h"
+#include "mbedtls/x509_crt.h"
+#include "mbedtls/pk.h"
+#include "mbedtls/ssl.h"
+#include "mbedtls/ssl_cache.h"
+#include "mbedtls/ssl_ticket.h"
+#include "bench_tls_certs.h"
+
+#ifndef MBEDTLS_PRIVATE
+#define MBEDTLS_PRIVATE(m) m
+#endif
+
+#define HOST "broker.local"
+#define REPETICOES 20
+#define CANO_CAP (32 * 1024)
+#define PASSOS_MAX 64
+
+enum { CLIENTE, SERVIDOR };
+
+// Entropia do mbedtls_config.h (MBEDTLS_ENTROPY_HARDWARE_ALT); no alvo vem do
+// pico_rand, aqui basta o rand() — só para o benchmark
+int mbedtls_hardware_poll(void *data, unsigned char *output, size_t len, size_t *olen)
+{
+    (void)data;
+    for (size_t i = 0; i < len; ++i)
+        output[i] = (unsigned char)rand();
+    *olen = len;
+    return 0;
+}
+
+// --- Heap por lado: cada bloco leva o tamanho e o dono num cabeçalho ---
+
+typedef union {
+    struct {
+        size_t tam;
+        int lado;
+    } c;
+    max_align_t alinhamento;
+} cabecalho_t;
+
+static int s_lado;
+static size_t s_heap[2], s_pico[2];
+
+static void *conta_calloc(size_t n, size_t tam)
+{
+    if (tam && n > (SIZE_MAX - sizeof(cabecalho_t)) / tam)
+        return NULL;
+    cabecalho_t *h = calloc(1, sizeof *h + n * tam);
+    if (!h)
+        return NULL;
+    h->c.tam = n * tam;
+    h->c.lado = s_lado;
+    s_heap[s_lado] += h->c.tam;
+    if (s_heap[s_lado] > s_pico[s_lado])
+        s_pico[s_lado] = s_heap[s_lado];
+    return h + 1;
+}
+
+static void conta_free(void *p)
+{
+    if (!p)
+        return;
+    cabecalho_t *h = (cabecalho_t *)p - 1;
+    s_heap[h->c.lado] -= h->c.tam;
+    free(h);
+}
+
+// --- Fio: um buffer por sentido, contando bytes e voos ---
+
+typedef struct {
+    unsigned char buf[CANO_CAP];
+    size_t ini, fim;
+} cano_t;
+
+// Ponta de cada lado: escreve num cano e lê do outro
+typedef struct {
+    int lado;
+    cano_t *tx, *rx;
+} ponta_t;
+
+static cano_t s_c2s, s_s2c;
+static ponta_t s_ponta_cli = {CLIENTE, &s_c2s, &s_s2c};
+static ponta_t s_ponta_srv = {SERVIDOR, &s_s2c, &s_c2s};
+static size_t s_bytes[2];
+static int s_ultimo_envio;
+static int s_voos;
+
+static int envia(void *ctx, const unsigned char *buf, size_t len)
+{
+    const ponta_t *p = ctx;
+    cano_t *c = p->tx;
+    int lado = p->lado;
+    if (len > CANO_CAP - c->fim)
+        return MBEDTLS_ERR_SSL_WANT_WRITE;
+    memcpy(&c->buf[c->fim], buf, len);
+    c->fim += len;
+    s_bytes[lado] += len;
+    if (lado != s_ultimo_envio)
+        s_voos++;
+    s_ultimo_envio = lado;
+    return (int)len;
+}
+
+static int recebe(void *ctx, unsigned char *buf, size_t len)
+{
+    cano_t *c = ((const ponta_t *)ctx)->rx;
+    size_t n = c->fim - c->ini;
+    if (n == 0)
+        return MBEDTLS_ERR_SSL_WANT_READ;
+    if (n > len)
+        n = len;
+    memcpy(buf, &c->buf[c->ini], n);
+    c->ini += n;
+    if (c->ini == c->fim)
+        c->ini = c->fim = 0;
+    return (int)n;
+}
+
+static uint64_t cpu_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// --- Configurações ---
+
+static mbedtls_entropy_context s_entropia;
+static mbedtls_ctr_drbg_context s_drbg;
+static mbedtls_x509_crt s_ca;
+
+typedef enum { POR_ID, POR_TICKET } retomada_t;
+
+typedef struct {
+    const char *nome;
+    mbedtls_x509_crt crt;
+    mbedtls_pk_context chave;
+} certificado_t;
+
+typedef struct {
+    mbedtls_ssl_config cli, srv;
+    mbedtls_ssl_cache_context cache;
+    mbedtls_ssl_ticket_context ticket;
+} cenario_t;
+
+static void falha(const char *onde, int rc)
+{
+    printf("FALHA: %s: -0x%04x\n", onde, (unsigned)-rc);
+    exit(1);
+}
+
+static void carrega_certificado(certificado_t *c, const char *nome, const char *crt, const char *chave)
+{
+    int rc;
+    c->nome = nome;
+    mbedtls_x509_crt_init(&c->crt);
+    mbedtls_pk_init(&c->chave);
+    if ((rc = mbedtls_x509_crt_parse(&c->crt, (const unsigned char *)crt, strlen(crt) + 1)) != 0)
+        falha("certificado do broker", rc);
+#if MBEDTLS_VERSION_MAJOR >= 3
+    rc = mbedtls_pk_parse_key(&c->chave, (const unsigned char *)chave, strlen(chave) + 1, NULL, 0,
+                              mbedtls_ctr_drbg_random, &s_drbg);
+#else
+    rc = mbedtls_pk_parse_key(&c->chave, (const unsigned char *)chave, strlen(chave) + 1, NULL, 0);
+#endif
+    if (rc != 0)
+        falha("chave do broker", rc);
+}
+
+// Cliente como o altcp_tls_create_config_client() do lwIP com a CA; servidor com
+// só um dos mecanismos de retomada, para medir cada um isolado
+static void monta_cenario(cenario_t *s, const certificado_t *c, retomada_t modo)
+{
+    int rc;
+    s_lado = CLIENTE;
+    mbedtls_ssl_config_init(&s->cli);
+    if ((rc = mbedtls_ssl_config_defaults(&s->cli, MBEDTLS_SSL_IS_CLIENT, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+        falha("config do cliente", rc);
+    mbedtls_ssl_conf_rng(&s->cli, mbedtls_ctr_drbg_random, &s_drbg);
+    mbedtls_ssl_conf_authmode(&s->cli, MBEDTLS_SSL_VERIFY_REQUIRED);
+    mbedtls_ssl_conf_ca_chain(&s->cli, &s_ca, NULL);
+    mbedtls_ssl_conf_session_tickets(&s->cli, modo == POR_TICKET ? MBEDTLS_SSL_SESSION_TICKETS_ENABLED
+                                                                 : MBEDTLS_SSL_SESSION_TICKETS_DISABLED);
+
+    s_lado = SERVIDOR;
+    mbedtls_ssl_config_init(&s->srv);
+    if ((rc = mbedtls_ssl_config_defaults(&s->srv, MBEDTLS_SSL_IS_SERVER, MBEDTLS_SSL_TRANSPORT_STREAM,
+                                          MBEDTLS_SSL_PRESET_DEFAULT)) != 0)
+        falha("config do servidor", rc);
+    mbedtls_ssl_conf_rng(&s->srv, mbedtls_ctr_drbg_random, &s_drbg);
+    if ((rc = mbedtls_ssl_conf_own_cert(&s->srv, (mbedtls_x509_crt *)&c->crt, (mbedtls_pk_context *)&c->chave)) != 0)
+        falha("certificado do servidor", rc);
+    mbedtls_ssl_cache_init(&s->cache);
+    mbedtls_ssl_ticket_init(&s->ticket);
+    if (modo == POR_ID)
+    {
+        mbedtls_ssl_conf_session_cache(&s->srv, &s->cache, mbedtls_ssl_cache_get, mbedtls_ssl_cache_set);
+    }
+    else
+    {
+        if ((rc = mbedtls_ssl_ticket_setup(&s->ticket, mbedtls_ctr_drbg_random, &s_drbg, MBEDTLS_CIPHER_AES_128_GCM,
+                                           86400)) != 0)
+            falha("chave dos tickets", rc);
+        mbedtls_ssl_conf_session_tickets_cb(&s->srv, mbedtls_ssl_ticket_write, mbedtls_ssl_ticket_parse, &s->ticket);
+    }
+}
+
+static void desmonta_cenario(cenario_t *s)
+{
+    s_lado = CLIENTE;
+    mbedtls_ssl_config_free(&s->cli);
+    s_lado = SERVIDOR;
+    mbedtls_ssl_config_free(&s->srv);
+    mbedtls_ssl_cache_free(&s->cache);
+    mbedtls_ssl_ticket_free(&s->ticket);
+}
+
+// --- Um handshake ---
+
+typedef struct {
+    uint64_t cli_ns, srv_ns;
+    size_t cli_pico;     // heap do cliente: do mbedtls_ssl_setup ao fim do handshake
+    size_t cli_aberta;   // o que fica com a sessão aberta (buffers de registro)
+    size_t sessao;       // sessão guardada para a próxima conexão
+    size_t bytes_c2s, bytes_s2c;
+    int voos;
+    const char *suite;
+    int retomado;
+} medida_t;
+
+// Oferece a sessão 'oferta' (NULL: handshake completo) e guarda a negociada em 'guarda'
+static void handshake(cenario_t *s, const mbedtls_ssl_session *oferta, mbedtls_ssl_session *guarda, medida_t *m)
+{
+    mbedtls_ssl_context cli, srv;
+    int rc, rc_cli = MBEDTLS_ERR_SSL_WANT_READ, rc_srv = MBEDTLS_ERR_SSL_WANT_READ;
+    int oferecida;
+    unsigned char master[48];
+
+    memset(m, 0, sizeof *m);
+    s_c2s.ini = s_c2s.fim = s_s2c.ini = s_s2c.fim = 0;
+    s_bytes[CLIENTE] = s_bytes[SERVIDOR] = 0;
+    s_ultimo_envio = -1;
+    s_voos = 0;
+
+    s_lado = CLIENTE;
+    size_t base = s_heap[CLIENTE];
+    s_pico[CLIENTE] = base;
+    mbedtls_ssl_init(&cli);
+    if ((rc = mbedtls_ssl_setup(&cli, &s->cli)) != 0)
+        falha("setup do cliente", rc);
+    mbedtls_ssl_set_hostname(&cli, HOST);
+    mbedtls_ssl_set_bio(&cli, &s_ponta_cli, envia, recebe, NULL);
+    oferecida = oferta != NULL && mbedtls_ssl_set_session(&cli, oferta) == 0;
+    if (oferecida)
+        memcpy(master, oferta->MBEDTLS_PRIVATE(master), sizeof master);
+
+    s_lado = SERVIDOR;
+    mbedtls_ssl_init(&srv);
+    if ((rc = mbedtls_ssl_setup(&srv, &s->srv)) != 0)
+        falha("setup do servidor", rc);
+    mbedtls_ssl_set_bio(&srv, &s_ponta_srv, envia, recebe, NULL);
+
+    for (int passo = 0; (rc_cli != 0 || rc_srv != 0) && passo < PASSOS_MAX; ++passo)
+    {
+        if (rc_cli != 0)
+        {
+            s_lado = CLIENTE;
+            uint64_t t0 = cpu_ns();
+            rc_cli = mbedtls_ssl_handshake(&cli);
+            m->cli_ns += cpu_ns() - t0;
+            if (rc_cli != 0 && rc_cli != MBEDTLS_ERR_SSL_WANT_READ && rc_cli != MBEDTLS_ERR_SSL_WANT_WRITE)
+                falha("handshake do cliente", rc_cli);
+        }
+        if (rc_srv != 0)
+        {
+            s_lado = SERVIDOR;
+            uint64_t t0 = cpu_ns();
+            rc_srv = mbedtls_ssl_handshake(&srv);
+            m->srv_ns += cpu_ns() - t0;
+            if (rc_srv != 0 && rc_srv != MBEDTLS_ERR_SSL_WANT_READ && rc_srv != MBEDTLS_ERR_SSL_WANT_WRITE)
+                falha("handshake do servidor", rc_srv);
+        }
+    }
+    if (rc_cli != 0 || rc_srv != 0)
+        falha("handshake sem fim", rc_cli ? rc_cli : rc_srv);
+
+    m->cli_pico = s_pico[CLIENTE] - base;
+    m->cli_aberta = s_heap[CLIENTE] - base;
+    m->bytes_c2s = s_bytes[CLIENTE];
+    m->bytes_s2c = s_bytes[SERVIDOR];
+    m->voos = s_voos;
+    m->suite = mbedtls_ssl_get_ciphersuite(&cli);
+    m->retomado = oferecida && memcmp(cli.MBEDTLS_PRIVATE(session)->MBEDTLS_PRIVATE(master), master, sizeof master) == 0;
+
+    // Sessão para a próxima conexão, como mqtt_tls_established()
+    s_lado = CLIENTE;
+    mbedtls_ssl_session_free(guarda);
+    mbedtls_ssl_session_init(guarda);
+    size_t antes = s_heap[CLIENTE];
+    if ((rc = mbedtls_ssl_get_session(&cli, guarda)) != 0)
+        falha("sessão do cliente", rc);
+    m->sessao = sizeof *guarda + (s_heap[CLIENTE] - antes);
+
+    mbedtls_ssl_free(&cli);
+    s_lado = SERVIDOR;
+    mbedtls_ssl_free(&srv);
+}
+
+// --- Relatório ---
+
+typedef struct {
+    double cli_us, srv_us;
+    medida_t ultima;
+    int retomados;
+} resumo_t;
+
+static void mede(cenario_t *s, int retomar, int repeticoes, resumo_t *r)
+{
+    mbedtls_ssl_session sessao;
+    medida_t m;
+    memset(r, 0, sizeof *r);
+    s_lado = CLIENTE;
+    mbedtls_ssl_session_init(&sessao);
+    if (retomar)
+        handshake(s, NULL, &sessao, &m);   // primeira conexão: a sessão a retomar
+    for (int i = 0; i < repeticoes; ++i)
+    {
+        handshake(s, retomar ? &sessao : NULL, &sessao, &m);
+        r->cli_us += m.cli_ns / 1e3 / repeticoes;
+        r->srv_us += m.srv_ns / 1e3 / repeticoes;
+        r->retomados += m.retomado;
+    }
+    r->ultima = m;
+    s_lado = CLIENTE;
+    mbedtls_ssl_session_free(&sessao);
+}
+
+static void imprime(const char *cert, const char *modo, const resumo_t *r, const resumo_t *completo)
+{
+    const medida_t *m = &r->ultima;
+    printf("| %s | %s | %s | %.0f | %.0f | %zu | %zu | %zu | %zu / %zu | %d | %d |\n", cert, modo,
+           m->suite, r->cli_us, r->srv_us, m->cli_pico, m->cli_aberta,
+           m->sessao, m->bytes_c2s, m->bytes_s2c, m->voos, m->voos / 2);
+    if (completo)
+        printf("|  | (retomado/completo) |  | %.1f%% | %.1f%% |  |  |  | %.0f%% do fio |  |  |\n",
+               100.0 * r->cli_us / completo->cli_us, 100.0 * r->srv_us / completo->srv_us,
+               100.0 * (m->bytes_c2s + m->bytes_s2c) / (completo->ultima.bytes_c2s + completo->ultima.bytes_s2c));
+}
+
+int main(int argc, char **argv)
+{
+    int repeticoes = argc > 1 ? atoi(argv[1]) : REPETICOES;
+    int rc, falhas = 0;
+    if (repeticoes < 1)
+        repeticoes = 1;
+
+    mbedtls_platform_set_calloc_free(conta_calloc, conta_free);
+    mbedtls_entropy_init(&s_entropia);
+    mbedtls_ctr_drbg_init(&s_drbg);
+    if ((rc = mbedtls_ctr_drbg_seed(&s_drbg, mbedtls_entropy_func, &s_entropia, (const unsigned char *)"tls_bench", 9)) != 0)
+        falha("ctr_drbg", rc);
+    mbedtls_x509_crt_init(&s_ca);
+    if ((rc = mbedtls_x509_crt_parse(&s_ca, (const unsigned char *)BENCH_TLS_CA_CRT, sizeof BENCH_TLS_CA_CRT)) != 0)
+        falha("CA", rc);
+
+    static certificado_t certs[2];
+    carrega_certificado(&certs[0], "ECDSA P-256", BENCH_TLS_EC_CRT, BENCH_TLS_EC_KEY);
+    carrega_certificado(&certs[1], "RSA-2048", BENCH_TLS_RSA_CRT, BENCH_TLS_RSA_KEY);
+
+    printf("mbedTLS %s, %d repetições por linha; tempos de CPU no host (média), heap e fio da última\n",
+           MBEDTLS_VERSION_STRING, repeticoes);
+    printf("| certificado | handshake | suíte | cliente (us) | servidor (us) | heap pico cliente (B) | "
+           "heap aberta (B) | sessão guardada (B) | bytes c→s / s→c | voos | RTT até o CONNECT |\n");
+    printf("|---|---|---|---|---|---|---|---|---|---|---|\n");
+
+    static const struct {
+        retomada_t modo;
+        const char *completo, *retomado;
+    } modos[] = {
+        {POR_ID, "completo (cache)", "retomado por ID"},
+        {POR_TICKET, "completo (ticket)", "retomado por ticket"},
+    };
+    for (size_t c = 0; c < 2; ++c)
+    {
+        for (size_t i = 0; i < sizeof modos / sizeof modos[0]; ++i)
+        {
+            static cenario_t s;
+            resumo_t completo, retomado;
+            monta_cenario(&s, &certs[c], modos[i].modo);
+            mede(&s, 0, repeticoes, &completo);
+            mede(&s, 1, repeticoes, &retomado);
+            imprime(certs[c].nome, modos[i].completo, &completo, NULL);
+            imprime(certs[c].nome, modos[i].retomado, &retomado, &completo);
+            if (retomado.retomados != repeticoes || completo.retomados != 0)
+            {
+                printf("  FALHOU: %s/%s retomou %d de %d\n", certs[c].nome, modos[i].retomado, retomado.retomados,
+                       repeticoes);
+                falhas++;
+            }
+            desmonta_cenario(&s);
+        }
+    }
+
+    if (falhas)
+    {
+        printf("FALHA: %d cenários\n", falhas);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,9 @@
+// Configuração do mbedTLS do tls_bench: a do firmware (cliente) mais o que só o
+// benchmark usa — o lado servidor do broker local, com cache de sessão e
+// tickets, e a troca do calloc/free para medir o heap.
+#include "mbedtls_config.h"
+
+#define MBEDTLS_SSL_SRV_C
+#define MBEDTLS_SSL_CACHE_C
+#define MBEDTLS_SSL_TICKET_C
+#define MBEDTLS_PLATFORM_MEMORY
@@ -0,0 +1,347 @@
+// Benchmark e conferência no host do despacho por árvore de tópicos
+// (inc/topic_trie.c) contra o laço de MQTT_MatchTopic do coreMQTT, um filtro
+// por vez. Para 10, 100 e 1000 filtros mede o tempo por tópico recebido até ter
+// a lista de todos os filtros que o casam.
+//
+// Os filtros imitam assinaturas de uma planta ("predio3/andar7/sala12/temp"),
+// com '+' em níveis sorteados, alguns terminados em '#' e alguns em "$SYS/...";
+// os tópicos vêm do mesmo vocabulário. Antes dos tempos, a lista da árvore é
+// conferida contra uma referência direta das regras do MQTT 3.1.1, nesses
+// conjuntos e num sorteio de níveis curtos ("a", "", "$s", '+', '#') que
+// exercita os casos de borda. A lista do laço é conferida contra a mesma
+// referência só para contar as divergências: depois de um '+', MQTT_MatchTopic
+// não casa '#' com o nível pai ("a/a" e "+/+/#") nem '+' com um nível vazio no
+// fim ("a/" e "+/+"). Os tópicos da planta não caem nesses casos.
+//
+// topic_trie_bench usa os vetores que crescem com realloc(),
+// topic_trie_bench_static o pool estático (TOPIC_TRIE_STATIC_POOL=1, com
+// capacidade para os 1000 filtros). Mesma fonte, mesma conferência.
+//   cmake --build build_sim --target topic_trie_bench topic_trie_bench_static
+//   ./build_sim/topic_trie_bench [iterações]
+// Os tempos são do host; a razão entre laço e árvore é o que vale para o RP2040.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "core_mqtt.h"
+#include "inc/topic_trie.h"
+
+#define FILTROS_MAX 1000
+#define TOPICOS 4096
+#define TOPICO_MAX 64
+#define ITERACOES_PADRAO 20000
+
+static const size_t s_filtros[] = {10, 100, 1000};
+static uint32_t s_iteracoes = ITERACOES_PADRAO;
+
+static topic_trie_t s_arvore;
+static char s_filtro[FILTROS_MAX][TOPICO_MAX];
+static uint16_t s_filtro_len[FILTROS_MAX];
+static size_t s_n_filtros;
+static char s_topico[TOPICOS][TOPICO_MAX];
+static uint16_t s_topico_len[TOPICOS];
+
+static uint32_t s_sorteio = 0x2545F491u;
+
+static uint32_t sorteia(uint32_t n)
+{
+    s_sorteio ^= s_sorteio << 13;
+    s_sorteio ^= s_sorteio >> 17;
+    s_sorteio ^= s_sorteio << 5;
+    return s_sorteio % n;
+}
+
+static uint64_t agora_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// --- Conjuntos de filtros e tópicos ---
+
+static const char *const s_grandezas[] = {"temp", "umid", "pres", "co2", "luz", "ruido", "porta", "energia"};
+
+// Nível k de um tópico da planta
+static int nivel_planta(char *dst, size_t cap, unsigned k)
+{
+    switch (k)
+    {
+    case 0:
+        return sorteia(64) == 0 ? snprintf(dst, cap, "$SYS") : snprintf(dst, cap, "predio%u", (unsigned)sorteia(4));
+    case 1:
+        return snprintf(dst, cap, "andar%u", (unsigned)sorteia(16));
+    case 2:
+        return snprintf(dst, cap, "sala%u", (unsigned)sorteia(64));
+    default:
+        return snprintf(dst, cap, "%s", s_grandezas[sorteia(8)]);
+    }
+}
+
+static uint16_t topico_planta(char *dst)
+{
+    int n = 0;
+    for (unsigned k = 0; k < 4; k++)
+    {
+        if (k)
+            dst[n++] = '/';
+        n += nivel_planta(&dst[n], TOPICO_MAX - (size_t)n, k);
+    }
+    return (uint16_t)n;
+}
+
+static uint16_t filtro_planta(char *dst)
+{
+    unsigned corte = sorteia(16) == 0 ? sorteia(4) : 4;   // níveis antes do '#'
+    int n = 0;
+    for (unsigned k = 0; k < corte; k++)
+    {
+        if (k)
+            dst[n++] = '/';
+        if (sorteia(8) == 0)
+            dst[n++] = '+';
+        else
+            n += nivel_planta(&dst[n], TOPICO_MAX - (size_t)n, k);
+    }
+    if (corte < 4)
+        n += snprintf(&dst[n], TOPICO_MAX - (size_t)n, corte ? "/#" : "#");
+    return (uint16_t)n;
+}
+
+// Níveis curtos: colisões de rótulo, nível vazio, '$' e curingas em toda posição
+static uint16_t sorteio_curto(char *dst, bool filtro)
+{
+    static const char *const niveis[] = {"a", "b", "", "$s", "+"};
+    unsigned n_niveis = 2 + sorteia(3);   // com um nível só, "" seria vazio
+    int n = 0;
+    for (unsigned k = 0; k < n_niveis; k++)
+    {
+        if (k)
+            dst[n++] = '/';
+        if (filtro && k == n_niveis - 1 && sorteia(4) == 0)
+        {
+            dst[n++] = '#';
+            break;
+        }
+        const char *s = niveis[sorteia(filtro ? 5 : 4)];
+        // '$' só faz sentido no primeiro nível do tópico
+        if (s[0] == '$' && k)
+            s = "c";
+        n += snprintf(&dst[n], TOPICO_MAX - (size_t)n, "%s", s);
+    }
+    return (uint16_t)n;
+}
+
+static void monta_arvore(size_t n_filtros, uint16_t (*gera)(char *, bool))
+{
+    topic_trie_free(&s_arvore);
+    s_n_filtros = n_filtros;
+    for (size_t i = 0; i < n_filtros; i++)
+    {
+        s_filtro_len[i] = gera(s_filtro[i], true);
+        if (!topic_trie_add(&s_arvore, s_filtro[i], s_filtro_len[i], (uint16_t)i))
+        {
+            printf("topic_trie_add(\"%.*s\") falhou com %u nós\n", s_filtro_len[i], s_filtro[i],
+                   (unsigned)topic_trie_nodes(&s_arvore));
+            exit(1);
+        }
+    }
+}
+
+static uint16_t gera_planta(char *dst, bool filtro)
+{
+    return filtro ? filtro_planta(dst) : topico_planta(dst);
+}
+
+// --- Os dois despachos ---
+
+static size_t por_laco(const char *topico, uint16_t len, uint16_t *ids, size_t max)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < s_n_filtros; i++)
+    {
+        bool casa = false;
+        if (MQTT_MatchTopic(topico, len, s_filtro[i], s_filtro_len[i], &casa) == MQTTSuccess && casa)
+        {
+            if (n < max)
+                ids[n] = (uint16_t)i;
+            n++;
+        }
+    }
+    return n;
+}
+
+// --- Referência ---
+
+// As regras do MQTT 3.1.1 nível a nível, sem otimização nenhuma
+static bool casa_referencia(const char *t, size_t t_len, const char *f, size_t f_len)
+{
+    if (t[0] == '$' && (f[0] == '+' || f[0] == '#'))
+        return false;
+    for (size_t i = 0, j = 0;;)
+    {
+        size_t f_fim = j;
+        while (f_fim < f_len && f[f_fim] != '/')
+            f_fim++;
+        if (f_fim - j == 1 && f[j] == '#')
+            return true;
+        if (i > t_len)
+            return false;   // o tópico acabou antes do filtro
+        size_t t_fim = i;
+        while (t_fim < t_len && t[t_fim] != '/')
+            t_fim++;
+        bool mais = f_fim - j == 1 && f[j] == '+';
+        if (!mais && (f_fim - j != t_fim - i || memcmp(&f[j], &t[i], t_fim - i) != 0))
+            return false;
+        if (f_fim == f_len)
+            return t_fim == t_len;
+        j = f_fim + 1;
+        i = t_fim == t_len ? t_len + 1 : t_fim + 1;
+    }
+}
+
+static size_t por_referencia(const char *topico, uint16_t len, uint16_t *ids, size_t max)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < s_n_filtros; i++)
+        if (casa_referencia(topico, len, s_filtro[i], s_filtro_len[i]))
+        {
+            if (n < max)
+                ids[n] = (uint16_t)i;
+            n++;
+        }
+    return n;
+}
+
+static int compara_id(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+static bool mesma_lista(uint16_t *a, size_t n_a, const uint16_t *b, size_t n_b)
+{
+    qsort(a, n_a, sizeof a[0], compara_id);
+    return n_a == n_b && memcmp(a, b, n_a * sizeof a[0]) == 0;
+}
+
+static uint32_t s_divergencias_laco;
+
+static bool confere_topico(const char *topico, uint16_t len)
+{
+    uint16_t esperado[FILTROS_MAX], obtido[FILTROS_MAX], laco[FILTROS_MAX];
+    size_t n_esperado = por_referencia(topico, len, esperado, FILTROS_MAX);
+    if (!mesma_lista(laco, por_laco(topico, len, laco, FILTROS_MAX), esperado, n_esperado))
+        s_divergencias_laco++;
+    size_t n_obtido = topic_trie_match(&s_arvore, topico, len, obtido, FILTROS_MAX);
+    if (mesma_lista(obtido, n_obtido, esperado, n_esperado))
+        return true;
+    printf("  divergência em \"%.*s\": referência %zu, árvore %zu filtros\n", len, topico, n_esperado, n_obtido);
+    for (size_t i = 0; i < n_esperado; i++)
+        printf("    referência: \"%.*s\"\n", s_filtro_len[esperado[i]], s_filtro[esperado[i]]);
+    for (size_t i = 0; i < n_obtido; i++)
+        printf("    árvore:     \"%.*s\"\n", s_filtro_len[obtido[i]], s_filtro[obtido[i]]);
+    return false;
+}
+
+static bool confere(void)
+{
+    uint32_t topicos = 0;
+    bool ok = true;
+    for (size_t f = 0; f < sizeof s_filtros / sizeof s_filtros[0] && ok; f++)
+    {
+        monta_arvore(s_filtros[f], gera_planta);
+        for (uint32_t i = 0; i < 20000 && ok; i++, topicos++)
+        {
+            char topico[TOPICO_MAX];
+            uint16_t len = topico_planta(topico);
+            ok = confere_topico(topico, len);
+        }
+    }
+    for (uint32_t r = 0; r < 500 && ok; r++)
+    {
+        monta_arvore(1 + sorteia(64), sorteio_curto);
+        for (uint32_t i = 0; i < 200 && ok; i++, topicos++)
+        {
+            char topico[TOPICO_MAX];
+            uint16_t len = sorteio_curto(topico, false);
+            ok = confere_topico(topico, len);
+        }
+    }
+
+    // Filtros inválidos são recusados sem mudar a árvore
+    static const char *const invalidos[] = {"a/b#", "a/#/b", "a+/b", "a/++", "#/a"};
+    topic_trie_free(&s_arvore);
+    topic_trie_add(&s_arvore, "a/b", 3, 0);
+    uint16_t nos = topic_trie_nodes(&s_arvore);
+    for (size_t i = 0; i < sizeof invalidos / sizeof invalidos[0]; i++)
+        if (topic_trie_add(&s_arvore, invalidos[i], strlen(invalidos[i]), 1) || topic_trie_nodes(&s_arvore) != nos)
+        {
+            printf("  filtro inválido \"%s\" aceito\n", invalidos[i]);
+            ok = false;
+        }
+
+    printf("Conferência contra a referência: %lu tópicos, %s\n", (unsigned long)topicos, ok ? "ok" : "FALHOU");
+    printf("Laço de MQTT_MatchTopic diverge da referência em %lu tópicos\n", (unsigned long)s_divergencias_laco);
+    return ok;
+}
+
+// --- Tempos ---
+
+static double mede(size_t (*despacho)(const char *, uint16_t, uint16_t *, size_t), uint64_t *casados)
+{
+    uint16_t ids[FILTROS_MAX];
+    uint64_t total = 0;
+    uint64_t t0 = agora_ns();
+    for (uint32_t i = 0; i < s_iteracoes; i++)
+    {
+        uint32_t k = i % TOPICOS;
+        total += despacho(s_topico[k], s_topico_len[k], ids, FILTROS_MAX);
+    }
+    double ns = (double)(agora_ns() - t0) / s_iteracoes;
+    *casados = total;
+    return ns;
+}
+
+static size_t por_arvore(const char *topico, uint16_t len, uint16_t *ids, size_t max)
+{
+    return topic_trie_match(&s_arvore, topico, len, ids, max);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        s_iteracoes = (uint32_t)strtoul(argv[1], NULL, 10);
+    if (s_iteracoes == 0)
+        s_iteracoes = ITERACOES_PADRAO;
+
+    printf("Despacho por árvore de tópicos: %s (TOPIC_TRIE_STATIC_POOL=%d), %zu B por nó\n",
+           TOPIC_TRIE_STATIC_POOL ? "pool estático" : "realloc", TOPIC_TRIE_STATIC_POOL, sizeof(topic_trie_node_t));
+    topic_trie_init(&s_arvore);
+    if (!confere())
+        return 1;
+
+    for (uint32_t i = 0; i < TOPICOS; i++)
+        s_topico_len[i] = topico_planta(s_topico[i]);
+
+    printf("\n%lu tópicos por rodada, ns por tópico até a lista dos filtros que casam\n",
+           (unsigned long)s_iteracoes);
+    printf("%8s %12s %12s %8s %10s %7s %9s\n", "filtros", "laço", "árvore", "ganho", "casam", "nós", "bytes");
+    for (size_t f = 0; f < sizeof s_filtros / sizeof s_filtros[0]; f++)
+    {
+        monta_arvore(s_filtros[f], gera_planta);
+        uint64_t casados_laco, casados_arvore;
+        double laco = mede(por_laco, &casados_laco);
+        double arvore = mede(por_arvore, &casados_arvore);
+        if (casados_laco != casados_arvore)
+        {
+            printf("laço casou %llu, árvore %llu\n", (unsigned long long)casados_laco,
+                   (unsigned long long)casados_arvore);
+            return 1;
+        }
+        printf("%8zu %12.1f %12.1f %7.1fx %10.2f %7u %9zu\n", s_filtros[f], laco, arvore, laco / arvore,
+               (double)casados_arvore / s_iteracoes, (unsigned)topic_trie_nodes(&s_arvore),
+               topic_trie_bytes(&s_arvore));
+    }
+    topic_trie_free(&s_arvore);
+    return 0;
+}
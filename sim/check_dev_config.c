@@ -0,0 +1,203 @@
+// Verificação no host da configuração em campo (inc/dev_config.c) sobre a
+// flash simulada (sim/sim_flash.c) e o backend real inc/flash_dev_pico.c:
+//   - comandos aceitos, rejeitados inteiros (chave, tipo, faixa, coerência) e a resposta;
+//   - configuração lida de volta depois de um reinício, com rotação entre os setores;
+//   - queda de energia no meio da gravação volta à configuração anterior.
+//   cmake --build build_sim --target dev_config_check && ./build_sim/dev_config_check
+// Sem o escalonador: a seção crítica do bloco vivo é substituída aqui.
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "dev_config.h"
+#include "hardware/flash.h"
+#include "sim_flash.h"
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+#define REGIAO_TAM DEV_CONFIG_FLASH_SIZE
+#define REGIAO_OFF (PICO_FLASH_SIZE_BYTES - REGIAO_TAM)
+
+static flash_dev_t s_dev;
+static int s_falhas;
+
+#define CONFERE(cond, ...)                    \
+    do {                                      \
+        if (!(cond)) {                        \
+            printf("  FALHOU: " __VA_ARGS__); \
+            printf("\n");                     \
+            s_falhas++;                       \
+        }                                     \
+    } while (0)
+
+static const dev_config_t s_padrao = {
+    .temp_threshold_c100 = 3000,
+    .dist_threshold_mm = 200,
+    .sensor_period_ms = 10000,
+    .sensor_period_fast_ms = 2000,
+    .display_period_ms = 10000,
+    .diag_interval_ms = 60000,
+    .report_by_exception = true,
+    .low_power = false,
+    .uplink_batch = 6,
+    .broker_port = 1883,
+    .broker_host = "test.mosquitto.org",
+};
+
+static char s_resp[DEV_CONFIG_RESP_MAX];
+
+static const char *comando(const char *json)
+{
+    size_t n = dev_config_command(json, strlen(json), s_resp, sizeof s_resp);
+    CONFERE(n > 0 && n == strlen(s_resp), "resposta de '%s' não coube", json);
+    return s_resp;
+}
+
+static bool contem(const char *s, const char *trecho)
+{
+    return strstr(s, trecho) != NULL;
+}
+
+static void reinicia(void)
+{
+    sim_flash_power_on();
+    CONFERE(flash_dev_pico(&s_dev, REGIAO_OFF, REGIAO_TAM), "flash_dev_pico");
+    dev_config_init(&s_padrao, &s_dev);
+}
+
+static void confere_comandos(void)
+{
+    printf("comandos\n");
+    dev_config_t c;
+    uint32_t v0 = dev_config_version();
+
+    const char *r = comando("{\"id\": 1, \"get\": true}");
+    CONFERE(contem(r, "\"id\": 1, \"ok\": true") && contem(r, "\"broker_host\": \"test.mosquitto.org\""), "get: %s", r);
+    CONFERE(dev_config_version() == v0, "get não muda a versão");
+
+    r = comando("{\"id\": 2, \"set\": {\"temp_threshold_c\": 28.456, \"sensor_period_ms\": 5000, "
+                "\"report_by_exception\": false, \"low_power\": true, \"uplink_batch\": 8, "
+                "\"broker_host\": \"broker.local\"}}");
+    dev_config_get(&c);
+    CONFERE(contem(r, "\"ok\": true") && contem(r, "\"saved\": true"), "set: %s", r);
+    CONFERE(c.temp_threshold_c100 == 2846 && c.sensor_period_ms == 5000 && !c.report_by_exception &&
+                c.low_power && c.uplink_batch == 8 && strcmp(c.broker_host, "broker.local") == 0 && c.dist_threshold_mm == 200,
+            "set aplicado: temp %ld, período %lu", (long)c.temp_threshold_c100, (unsigned long)c.sensor_period_ms);
+    CONFERE(dev_config_version() == v0 + 1, "set muda a versão uma vez");
+
+    r = comando("{\"set\": {\"temp_threshold_c\": -5}}");
+    dev_config_get(&c);
+    CONFERE(c.temp_threshold_c100 == -500 && !contem(r, "\"id\""), "negativo sem id: %s", r);
+
+    // Rejeitados inteiros: nada do comando é aplicado
+    static const struct {
+        const char *json, *esperado;
+    } ruins[] = {
+        {"{\"id\": 3, \"set\": {\"dist_threshold_mm\": 300, \"cor\": 1}}", "\"error\": \"unknown_key\", \"key\": \"cor\""},
+        {"{\"id\": 4, \"set\": {\"dist_threshold_mm\": 300, \"sensor_period_ms\": 10}}",
+         "\"error\": \"range\", \"key\": \"sensor_period_ms\""},
+        {"{\"id\": 5, \"set\": {\"dist_threshold_mm\": \"300\"}}", "\"error\": \"type\", \"key\": \"dist_threshold_mm\""},
+        {"{\"id\": 6, \"set\": {\"dist_threshold_mm\": 300, \"sensor_period_fast_ms\": 9000}}",
+         "\"error\": \"range\", \"key\": \"sensor_period_fast_ms\""},
+        {"{\"id\": 7, \"set\": {\"broker_host\": \"a b\"}}", "\"error\": \"range\", \"key\": \"broker_host\""},
+        {"{\"id\": 8, \"set\": {\"broker_port\": 70000}}", "\"error\": \"range\", \"key\": \"broker_port\""},
+        {"{\"id\": 8, \"set\": {\"uplink_batch\": 9}}", "\"error\": \"range\", \"key\": \"uplink_batch\""},
+        {"{\"id\": 8, \"set\": {\"low_power\": 1}}", "\"error\": \"type\", \"key\": \"low_power\""},
+        {"{\"id\": 9, \"set\": {\"dist_threshold_mm\": 1e2}}", "\"error\": \"type\""},
+        {"{\"id\": 10, \"set\": [1, 2]}", "\"error\": \"type\", \"key\": \"set\""},
+        {"{\"id\": 11, \"set\": {\"x\\\"y\": 1}}", "\"error\": \"unknown_key\"}"},
+        {"{\"id\": 12, \"set\": {", "\"error\": \"json\""},
+    };
+    uint32_t v = dev_config_version();
+    for (size_t i = 0; i < sizeof ruins / sizeof ruins[0]; ++i) {
+        r = comando(ruins[i].json);
+        CONFERE(contem(r, "\"ok\": false") && contem(r, ruins[i].esperado), "'%s': %s", ruins[i].json, r);
+    }
+    dev_config_get(&c);
+    CONFERE(dev_config_version() == v && c.dist_threshold_mm == 200, "rejeitados não aplicam nada");
+
+    // Host no tamanho máximo: a configuração completa ainda cabe na resposta
+    char json[128];
+    snprintf(json, sizeof json, "{\"set\": {\"broker_host\": \"%.*s\"}}", DEV_CONFIG_HOST_MAX,
+             "hhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhhh");
+    r = comando(json);
+    CONFERE(contem(r, "\"ok\": true") && contem(r, "\"uplink_batch\": 8"), "host máximo: %s", r);
+    comando("{\"set\": {\"broker_host\": \"broker.local\"}}");
+    v = dev_config_version();
+
+    // Mesmo valor: responde sem gravar de novo
+    dev_config_stats_t st0, st1;
+    dev_config_get_stats(&st0);
+    comando("{\"set\": {\"sensor_period_ms\": 5000}}");
+    dev_config_get_stats(&st1);
+    CONFERE(st1.saves == st0.saves && dev_config_version() == v, "set sem mudança não grava");
+}
+
+static void confere_persistencia(void)
+{
+    printf("persistência\n");
+    reinicia();
+    dev_config_t c;
+    dev_config_get(&c);
+    CONFERE(c.temp_threshold_c100 == -500 && c.sensor_period_ms == 5000 && strcmp(c.broker_host, "broker.local") == 0,
+            "configuração lida de volta");
+
+    // Muitas gravações: passa pelos dois setores várias vezes
+    char json[96];
+    for (uint32_t i = 0; i < 100; ++i) {
+        snprintf(json, sizeof json, "{\"set\": {\"dist_threshold_mm\": %lu}}", (unsigned long)(i + 1));
+        comando(json);
+    }
+    reinicia();
+    dev_config_get(&c);
+    CONFERE(c.dist_threshold_mm == 100 && c.temp_threshold_c100 == -500, "última de 100 gravações: %lu",
+            (unsigned long)c.dist_threshold_mm);
+
+    // Queda no meio da programação da página: volta à anterior
+    sim_flash_cut_after(1);
+    const char *r = comando("{\"set\": {\"dist_threshold_mm\": 999}}");
+    CONFERE(contem(r, "\"saved\": false") && !sim_flash_powered(), "gravação cortada: %s", r);
+    reinicia();
+    dev_config_get(&c);
+    CONFERE(c.dist_threshold_mm == 100, "queda na gravação: %lu", (unsigned long)c.dist_threshold_mm);
+    r = comando("{\"set\": {\"dist_threshold_mm\": 777}}");
+    reinicia();
+    dev_config_get(&c);
+    CONFERE(c.dist_threshold_mm == 777 && contem(r, "\"saved\": true"), "gravação depois da queda: %s", r);
+
+    // reset volta ao padrão de fábrica e também é persistido
+    comando("{\"reset\": true}");
+    reinicia();
+    dev_config_get(&c);
+    CONFERE(c.dist_threshold_mm == 200 && c.temp_threshold_c100 == 3000 && c.report_by_exception && !c.low_power &&
+                c.uplink_batch == 6,
+            "reset persistido");
+
+    // Região apagada: padrão de fábrica
+    sim_flash_reset();
+    reinicia();
+    dev_config_stats_t st;
+    dev_config_get_stats(&st);
+    dev_config_get(&c);
+    CONFERE(st.loaded_counter == 0 && strcmp(c.broker_host, "test.mosquitto.org") == 0, "flash vazia");
+}
+
+int main(void)
+{
+    sim_flash_reset();
+    reinicia();
+    confere_comandos();
+    confere_persistencia();
+    if (s_falhas) {
+        printf("FALHA: %d verificações\n", s_falhas);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,161 @@
+// Verificação no host do gerenciador de barramento (inc/i2c_bus.c), com o
+// escalonador do port POSIX e as tarefas donas de verdade:
+//   - transação postada antes de uma bloqueante no mesmo controlador sai na
+//     mesma rodada (maior rodada > 1) e depois da bloqueante;
+//   - postada sozinha espera no máximo I2C_BUS_POST_WAIT_MS;
+//   - postadas e bloqueante em conjuntos de pinos diferentes: uma troca de pinos por conjunto;
+//   - sem vaga em s_async, i2c_bus_post recusa e nada se perde.
+//   cmake --build build_sim --target i2c_bus_check && ./build_sim/i2c_bus_check
+// O periférico I2C é substituído aqui: as rotinas de teste só registram a ordem.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "inc/i2c_bus.h"
+#include "sim_pico.h"
+
+i2c_inst_t sim_i2c_inst[2] = {{0, 100000}, {1, 100000}};
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)i2c, (void)addr, (void)src, (void)nostop;
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    (void)i2c, (void)addr, (void)dst, (void)nostop;
+    return (int)len;
+}
+
+// Gancho do traceTASK_DELAY_UNTIL do kernel do host (sim/FreeRTOSConfig.h); o
+// sim_trace.c depende das tarefas de blink.c e fica fora deste binário
+void sim_trace_task_delay_until(unsigned long wake_tick)
+{
+    (void)wake_tick;
+}
+
+static int s_falhas;
+
+#define CONFERE(cond, ...)                    \
+    do {                                      \
+        if (!(cond)) {                        \
+            printf("  FALHOU: " __VA_ARGS__); \
+            printf("\n");                     \
+            s_falhas++;                       \
+        }                                     \
+    } while (0)
+
+// Ordem de execução das rotinas: cada uma grava o próprio rótulo
+static char s_ordem[16];
+static volatile size_t s_n;
+static volatile uint64_t s_executada_us;
+
+static bool job_marca(i2c_inst_t *i2c, void *ctx)
+{
+    (void)i2c;
+    if (s_n < sizeof s_ordem - 1) s_ordem[s_n++] = *(const char *)ctx;
+    s_ordem[s_n] = '\0';
+    s_executada_us = time_us_64();
+    return true;
+}
+
+static void limpa(void)
+{
+    s_n = 0;
+    s_ordem[0] = '\0';
+}
+
+// Espera as postadas terminarem (nada bloqueia o cliente nesse caso)
+static void espera_execucoes(size_t n)
+{
+    for (int i = 0; i < 200 && s_n < n; ++i)
+        vTaskDelay(1);
+}
+
+static void tarefaCheck(void *pvParameters)
+{
+    (void)pvParameters;
+    static const char A = 'a', B = 'b', C = 'c', D = 'd', E = 'e', P = 'p';
+    i2c_bus_id_t busA = i2c_bus_register(&(i2c_bus_pins_t){i2c1, 14, 15, 400 * 1000});
+    i2c_bus_id_t busB = i2c_bus_register(&(i2c_bus_pins_t){i2c1, 2, 3, 100 * 1000});
+    CONFERE(busA >= 0 && busB >= 0, "registro dos pinos");
+    i2c_bus_stats_t st0, st;
+
+    // Postada e bloqueante no mesmo conjunto: uma rodada, a bloqueante primeiro
+    i2c_bus_run(busA, job_marca, (void *)&A);
+    limpa();
+    i2c_bus_get_stats(1, &st0);
+    CONFERE(i2c_bus_post(busA, job_marca, (void *)&P), "post recusado");
+    CONFERE(i2c_bus_run(busA, job_marca, (void *)&A), "run falhou");
+    espera_execucoes(2);
+    i2c_bus_get_stats(1, &st);
+    CONFERE(strcmp(s_ordem, "ap") == 0, "ordem na rodada: '%s' (esperado 'ap')", s_ordem);
+    CONFERE(st.batches - st0.batches == 1, "%lu rodadas para postada + bloqueante",
+            (unsigned long)(st.batches - st0.batches));
+    CONFERE(st.max_batch > 1, "maior rodada %lu", (unsigned long)st.max_batch);
+
+    // Postada sozinha: sai depois do prazo de espera, sem ficar presa
+    limpa();
+    uint64_t t0 = time_us_64();
+    i2c_bus_post(busA, job_marca, (void *)&P);
+    espera_execucoes(1);
+    uint64_t atraso_us = s_executada_us - t0;
+    CONFERE(s_n == 1, "postada sozinha não executou");
+    CONFERE(atraso_us <= (I2C_BUS_POST_WAIT_MS + 10) * 1000u, "postada sozinha esperou %lu us",
+            (unsigned long)atraso_us);
+    printf("postada sozinha: executada após %lu us (prazo %u ms)\n", (unsigned long)atraso_us, I2C_BUS_POST_WAIT_MS);
+
+    // Conjuntos diferentes: começa pelo já selecionado (A), uma troca de pinos
+    limpa();
+    i2c_bus_get_stats(1, &st0);
+    i2c_bus_post(busB, job_marca, (void *)&C);
+    i2c_bus_post(busA, job_marca, (void *)&P);
+    i2c_bus_run(busB, job_marca, (void *)&B);
+    espera_execucoes(3);
+    i2c_bus_get_stats(1, &st);
+    CONFERE(strcmp(s_ordem, "pbc") == 0, "ordem entre conjuntos: '%s' (esperado 'pbc')", s_ordem);
+    CONFERE(st.remuxes - st0.remuxes == 1, "%lu trocas de pinos", (unsigned long)(st.remuxes - st0.remuxes));
+    CONFERE(st.batches - st0.batches == 1, "%lu rodadas entre conjuntos", (unsigned long)(st.batches - st0.batches));
+
+    // Vagas esgotadas: a postada a mais é recusada, as aceitas saem com a próxima bloqueante
+    limpa();
+    size_t aceitas = 0;
+    for (int i = 0; i < I2C_BUS_ASYNC_SLOTS + 1; ++i)
+        aceitas += i2c_bus_post(busB, job_marca, (void *)&D);
+    CONFERE(aceitas == I2C_BUS_ASYNC_SLOTS, "%zu postadas aceitas", aceitas);
+    i2c_bus_run(busB, job_marca, (void *)&E);
+    espera_execucoes(aceitas + 1);
+    CONFERE(s_n == aceitas + 1 && s_ordem[0] == 'e', "vagas esgotadas: '%s'", s_ordem);
+
+    i2c_bus_get_stats(1, &st);
+    printf("I2C1: %lu transações em %lu rodadas (máx %lu), %lu trocas de pinos\n", (unsigned long)st.transactions,
+           (unsigned long)st.batches, (unsigned long)st.max_batch, (unsigned long)st.remuxes);
+    if (s_falhas) {
+        printf("FALHA: %d verificações\n", s_falhas);
+        exit(1);
+    }
+    printf("OK\n");
+    exit(0);
+}
+
+int main(void)
+{
+    sim_pico_init();
+    xTaskCreate(tarefaCheck, "Check", 1024, NULL, 2, NULL);
+    vTaskStartScheduler();
+    return 1;
+}
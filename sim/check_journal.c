@@ -0,0 +1,209 @@
+// Verificação no host do diário de telemetria (inc/journal.c) sobre a flash
+// simulada (sim/sim_flash.c) e o backend real inc/flash_dev_pico.c: ordem e
+// conteúdo do reenvio, recuperação após reinício, anel cheio, distribuição de
+// apagamentos, queda de energia no meio de uma gravação e números de sequência
+// que nunca se repetem entre reinícios.
+//   cmake --build build_sim --target journal_check && ./build_sim/journal_check
+#include <stdio.h>
+#include <string.h>
+#include "journal.h"
+#include "hardware/flash.h"
+#include "sim_flash.h"
+
+#define SETORES 8
+#define REGIAO_OFF (PICO_FLASH_SIZE_BYTES - SETORES * FLASH_SECTOR_SIZE)
+#define REGIAO_TAM (SETORES * FLASH_SECTOR_SIZE)
+
+static flash_dev_t s_dev;
+static journal_t s_j;
+static int s_falhas;
+
+#define CONFERE(cond, ...)                  \
+    do {                                    \
+        if (!(cond)) {                      \
+            printf("  FALHOU: " __VA_ARGS__); \
+            printf("\n");                   \
+            s_falhas++;                     \
+        }                                   \
+    } while (0)
+
+static telemetry_sample_t amostra(uint32_t seq)
+{
+    telemetry_sample_t s = {
+        .seq = seq,
+        .t_ms = 1000u + seq * 10000u,
+        .temp_c100 = (int16_t)(2000 + seq % 700),
+        .pres_pa = 100000u + seq,
+        .dist_mm = (uint16_t)(seq % 1000),
+        .bpm_x10 = seq % 2 ? (uint16_t)(700 + seq % 50) : 0,
+        .spo2_x10 = seq % 2 ? 970 : 0,
+    };
+    return s;
+}
+
+static bool igual(const telemetry_sample_t *a, const telemetry_sample_t *b)
+{
+    return a->seq == b->seq && a->t_ms == b->t_ms && a->temp_c100 == b->temp_c100 && a->pres_pa == b->pres_pa &&
+           a->dist_mm == b->dist_mm && a->bpm_x10 == b->bpm_x10 && a->spo2_x10 == b->spo2_x10;
+}
+
+static void reinicia(void)
+{
+    sim_flash_power_on();
+    CONFERE(journal_open(&s_j, &s_dev), "journal_open após reinício");
+}
+
+// Anexa n amostras novas; devolve o seq da primeira
+static uint32_t anexa(uint32_t n)
+{
+    uint32_t primeiro = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        telemetry_sample_t s = amostra(journal_next_seq(&s_j));
+        if (i == 0) primeiro = s.seq;
+        journal_append(&s_j, &s);
+    }
+    return primeiro;
+}
+
+// Reenvia tudo em lotes; confere ordem, conteúdo e o primeiro seq esperado
+static uint32_t esvazia(uint32_t seq_esperado, bool confere_inicio)
+{
+    telemetry_sample_t lote[TELEMETRY_BATCH_MAX];
+    uint32_t total = 0;
+    size_t n;
+    bool primeiro = true;
+    while ((n = journal_peek(&s_j, lote, TELEMETRY_BATCH_MAX)) > 0) {
+        for (size_t i = 0; i < n; ++i) {
+            if (primeiro && !confere_inicio) seq_esperado = lote[i].seq;
+            primeiro = false;
+            telemetry_sample_t e = amostra(seq_esperado);
+            CONFERE(igual(&lote[i], &e), "amostra seq %lu (esperado %lu)", (unsigned long)lote[i].seq,
+                    (unsigned long)seq_esperado);
+            seq_esperado++;
+        }
+        journal_ack(&s_j);
+        total += (uint32_t)n;
+    }
+    CONFERE(journal_pending(&s_j) == 0, "pendentes após esvaziar: %lu", (unsigned long)journal_pending(&s_j));
+    return total;
+}
+
+static void teste_ordem_e_reinicio(void)
+{
+    printf("ordem, confirmação parcial e reinício\n");
+    uint32_t s0 = anexa(50);
+    telemetry_sample_t lote[TELEMETRY_BATCH_MAX];
+    for (int i = 0; i < 3; ++i) {
+        size_t n = journal_peek(&s_j, lote, TELEMETRY_BATCH_MAX);
+        CONFERE(n == TELEMETRY_BATCH_MAX && lote[0].seq == s0 + (uint32_t)i * TELEMETRY_BATCH_MAX, "lote %d", i);
+        journal_ack(&s_j);
+    }
+    // Lido mas não confirmado: volta depois do reinício
+    journal_peek(&s_j, lote, TELEMETRY_BATCH_MAX);
+    uint32_t pend = journal_pending(&s_j);
+    uint32_t proximo = s_j.next_seq;
+
+    reinicia();
+    CONFERE(journal_pending(&s_j) == pend, "pendentes %lu, esperado %lu", (unsigned long)journal_pending(&s_j),
+            (unsigned long)pend);
+    CONFERE(s_j.next_seq >= proximo, "seq recuou: %lu < %lu", (unsigned long)s_j.next_seq, (unsigned long)proximo);
+    esvazia(s0 + 3 * TELEMETRY_BATCH_MAX, true);
+}
+
+static void teste_seq_ao_vivo(void)
+{
+    printf("números de sequência sem gravação de amostras\n");
+    uint32_t ultimo = 0;
+    for (int i = 0; i < 3000; ++i)
+        ultimo = journal_next_seq(&s_j);
+    reinicia();
+    uint32_t novo = journal_next_seq(&s_j);
+    CONFERE(novo > ultimo, "seq %lu repetido após reinício (último %lu)", (unsigned long)novo, (unsigned long)ultimo);
+}
+
+static void teste_anel_cheio(void)
+{
+    printf("anel cheio (sobrescreve o setor mais antigo)\n");
+    journal_stats_t antes, depois;
+    journal_get_stats(&s_j, &antes);
+    uint32_t capacidade = SETORES * (FLASH_SECTOR_SIZE / JOURNAL_RECORD_SIZE - 1);
+    anexa(3 * capacidade);
+    journal_get_stats(&s_j, &depois);
+    uint32_t perdidas = depois.dropped - antes.dropped;
+    CONFERE(perdidas > 0, "nenhuma amostra descartada");
+    CONFERE(journal_pending(&s_j) <= capacidade && journal_pending(&s_j) > capacidade - 2 * capacidade / SETORES,
+            "pendentes %lu para capacidade %lu", (unsigned long)journal_pending(&s_j), (unsigned long)capacidade);
+    uint32_t pend = journal_pending(&s_j);
+    reinicia();
+    CONFERE(journal_pending(&s_j) == pend, "pendentes após reinício %lu, esperado %lu",
+            (unsigned long)journal_pending(&s_j), (unsigned long)pend);
+    // As que sobraram são as mais recentes, contíguas até a última
+    uint32_t n = esvazia(0, false);
+    CONFERE(n == pend, "reenviadas %lu de %lu", (unsigned long)n, (unsigned long)pend);
+}
+
+static void teste_queda_de_energia(void)
+{
+    printf("queda de energia durante gravação\n");
+    uint32_t s0 = anexa(20);
+    journal_stats_t antes;
+    journal_get_stats(&s_j, &antes);
+    telemetry_sample_t s = amostra(journal_next_seq(&s_j));
+    sim_flash_cut_after(1);
+    CONFERE(!journal_append(&s_j, &s) && !sim_flash_powered(), "gravação deveria ter sido cortada");
+    uint32_t cortado = s.seq;
+
+    reinicia();
+    journal_stats_t depois;
+    journal_get_stats(&s_j, &depois);
+    CONFERE(depois.corrupt >= 1, "registro cortado não detectado");
+    CONFERE(journal_next_seq(&s_j) > cortado, "seq do registro cortado reutilizado");
+    // As 20 gravadas antes continuam lá, na ordem
+    telemetry_sample_t lote[TELEMETRY_BATCH_MAX];
+    size_t n = journal_peek(&s_j, lote, 1);
+    CONFERE(n == 1 && lote[0].seq == s0, "primeira pendente após a queda");
+    uint32_t total = esvazia(s0, true);
+    CONFERE(total == 20, "reenviadas %lu de 20", (unsigned long)total);
+}
+
+static void teste_desgaste(void)
+{
+    printf("desgaste (ciclos de queda/reenvio)\n");
+    for (int ciclo = 0; ciclo < 200; ++ciclo) {
+        uint32_t s0 = anexa(37 + (uint32_t)(ciclo % 50));
+        esvazia(s0, true);
+    }
+    uint32_t min, max;
+    uint64_t total;
+    sim_flash_erase_range_stats(REGIAO_OFF, REGIAO_TAM, &min, &max, &total);
+    journal_stats_t st;
+    journal_get_stats(&s_j, &st);
+    printf("  apagamentos por setor: mín %lu, máx %lu (total %llu); %lu programações de página\n", (unsigned long)min,
+           (unsigned long)max, (unsigned long long)total, (unsigned long)sim_flash_programs());
+    CONFERE(max - min <= 1, "desgaste desigual: %lu..%lu", (unsigned long)min, (unsigned long)max);
+    CONFERE(st.max_erase_count == max, "contagem no cabeçalho %lu, flash %lu", (unsigned long)st.max_erase_count,
+            (unsigned long)max);
+}
+
+int main(void)
+{
+    sim_flash_reset();
+    if (!flash_dev_pico(&s_dev, REGIAO_OFF, REGIAO_TAM) || !journal_open(&s_j, &s_dev)) {
+        printf("região de flash inválida\n");
+        return 1;
+    }
+    printf("Diário: %u setores x %u registros\n", (unsigned)s_j.sectors, (unsigned)s_j.slots);
+    teste_ordem_e_reinicio();
+    teste_seq_ao_vivo();
+    teste_anel_cheio();
+    teste_queda_de_energia();
+    teste_desgaste();
+
+    journal_stats_t st;
+    journal_get_stats(&s_j, &st);
+    printf("Totais: %lu anexadas, %lu reenviadas, %lu descartadas, %lu corrompidas, %lu apagamentos\n",
+           (unsigned long)st.appended, (unsigned long)st.replayed, (unsigned long)st.dropped, (unsigned long)st.corrupt,
+           (unsigned long)st.erases);
+    printf("%s\n", s_falhas ? "FALHOU" : "OK");
+    return s_falhas ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+// Verificação no host do log diferido (inc/log_async.c):
+//   - log_async_format contra snprintf, em formatos e valores aleatórios
+//     (com os modificadores h/l, que o formatador ignora);
+//   - anel próprio e compartilhado: aceitos até encher, o resto descartado e contado.
+//   cmake --build build_sim --target log_async_check && ./build_sim/log_async_check
+// Sem o escalonador: as chamadas ao kernel usadas pelo módulo são substituídas aqui.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "log_async.h"
+
+static void *s_tls;
+static BaseType_t s_estado = taskSCHEDULER_RUNNING;
+
+BaseType_t xTaskGetSchedulerState(void)
+{
+    return s_estado;
+}
+
+void *pvTaskGetThreadLocalStoragePointer(TaskHandle_t t, BaseType_t idx)
+{
+    (void)t, (void)idx;
+    return s_tls;
+}
+
+void vTaskSetThreadLocalStoragePointer(TaskHandle_t t, BaseType_t idx, void *v)
+{
+    (void)t, (void)idx;
+    s_tls = v;
+}
+
+void vPortEnterCritical(void)
+{
+}
+
+void vPortExitCritical(void)
+{
+}
+
+// A tarefa de log não é criada neste teste
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *nome, configSTACK_DEPTH_TYPE pilha, void *arg, UBaseType_t prio,
+                       TaskHandle_t *out)
+{
+    (void)fn, (void)nome, (void)pilha, (void)arg, (void)prio, (void)out;
+    abort();
+}
+
+void vTaskDelay(TickType_t t)
+{
+    (void)t;
+    abort();
+}
+
+static uint32_t s_erros;
+
+static uint32_t aleatorio(void)
+{
+    static uint32_t x = 2463534242u;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    return x;
+}
+
+// Valores de teste: pequenos, limites de 8/16/32 bits e aleatórios
+static uint32_t valor(void)
+{
+    static const uint32_t limites[] = {0, 1, 9, 10, 99, 255, 256, 65535, 0x7FFFFFFFu, 0x80000000u, 0xFFFFFFFFu};
+    switch (aleatorio() % 3) {
+    case 0:
+        return limites[aleatorio() % (sizeof limites / sizeof limites[0])];
+    case 1:
+        return aleatorio() % 1000;
+    default:
+        return aleatorio();
+    }
+}
+
+static void confere_formato(void)
+{
+    static const char *const conversoes[] = {"d", "i", "u", "x", "X", "c", "ld", "lu", "lx", "hu", "02X", "5u", "-6d", "08lx", "3c", "%"};
+    unsigned casos = 0;
+    for (int k = 0; k < 200000; ++k) {
+        char fmt[96] = "";
+        uint32_t args[LOG_ARGS_MAX];
+        unsigned n = 0;
+        int partes = 1 + (int)(aleatorio() % LOG_ARGS_MAX);
+        for (int i = 0; i < partes; ++i) {
+            const char *c = conversoes[aleatorio() % (sizeof conversoes / sizeof conversoes[0])];
+            strcat(fmt, i ? " | " : "[T] ");
+            strcat(fmt, "%");
+            strcat(fmt, c);
+            if (strcmp(c, "%") != 0) {
+                uint32_t v = valor();
+                // %c com valores imprimíveis (o formatador grava o byte, snprintf pararia no zero)
+                if (c[strlen(c) - 1] == 'c') v = 'A' + v % 26;
+                args[n++] = v;
+            }
+        }
+        strcat(fmt, "\n");
+
+        // Referência: os mesmos formatos sem h/l, argumentos como int/unsigned de 32 bits
+        char ref_fmt[96];
+        size_t j = 0;
+        for (const char *p = fmt; *p; ++p)
+            if (*p != 'l' && *p != 'h') ref_fmt[j++] = *p;
+        ref_fmt[j] = '\0';
+        char ref[256], out[256];
+        snprintf(ref, sizeof ref, ref_fmt, args[0], args[1], args[2], args[3], args[4]);
+        log_async_format(out, sizeof out, fmt, args, n);
+        if (strcmp(ref, out) != 0 && s_erros++ < 5)
+            printf("formato '%s': esperado '%s', obtido '%s'\n", fmt, ref, out);
+        casos++;
+    }
+
+    // Corte no tamanho do buffer, sempre terminado em zero
+    char curto[8];
+    uint32_t a = 123456;
+    size_t len = log_async_format(curto, sizeof curto, "valor %u\n", &a, 1);
+    if (len != 7 || strcmp(curto, "valor 1") != 0) {
+        printf("corte: '%s' (%zu)\n", curto, len);
+        s_erros++;
+    }
+    printf("log_async_format: %u formatos conferidos com snprintf\n", casos);
+}
+
+static void confere_aneis(void)
+{
+    log_async_stats_t st;
+
+    // Antes do escalonador tudo vai para o anel compartilhado
+    s_estado = taskSCHEDULER_NOT_STARTED;
+    for (int i = 0; i < LOG_RING_SIZE + 3; ++i)
+        LOG_I("[T] compartilhado %d\n", i);
+    log_async_get_stats(&st);
+    if (st.written != LOG_RING_SIZE || st.dropped != 3) {
+        printf("anel compartilhado: %lu aceitos, %lu descartados\n", (unsigned long)st.written,
+               (unsigned long)st.dropped);
+        s_erros++;
+    }
+
+    // Anel próprio, sem trava
+    s_estado = taskSCHEDULER_RUNNING;
+    if (!log_async_register() || !s_tls) {
+        printf("log_async_register falhou\n");
+        s_erros++;
+    }
+    for (int i = 0; i < LOG_RING_SIZE + 7; ++i)
+        LOG_I("[T] proprio %d %u\n", i, (unsigned)(i * 3));
+    log_async_get_stats(&st);
+    if (st.written != 2 * LOG_RING_SIZE || st.dropped != 10) {
+        printf("anel próprio: %lu aceitos, %lu descartados\n", (unsigned long)st.written, (unsigned long)st.dropped);
+        s_erros++;
+    }
+
+    // O registro guardado (formato + argumentos crus) produz a linha da chamada original
+    const log_ring_t *r = s_tls;
+    const log_record_t *rec = &r->rec[5];
+    char linha[LOG_LINE_MAX];
+    log_async_format(linha, sizeof linha, rec->fmt, rec->args, rec->n);
+    if (strcmp(linha, "[T] proprio 5 15\n") != 0) {
+        printf("registro 5: '%s'\n", linha);
+        s_erros++;
+    }
+
+    // Níveis desligados na compilação não avaliam os argumentos
+    int avaliado = 0;
+    LOG_D("[T] depuração %d\n", ++avaliado);
+    if (LOG_LEVEL < LOG_LEVEL_DEBUG && avaliado) {
+        printf("LOG_D avaliou os argumentos\n");
+        s_erros++;
+    }
+    printf("anéis: %lu aceitos, %lu descartados\n", (unsigned long)st.written, (unsigned long)st.dropped);
+}
+
+int main(void)
+{
+    confere_formato();
+    confere_aneis();
+    if (s_erros) {
+        printf("FALHA: %lu erros\n", (unsigned long)s_erros);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
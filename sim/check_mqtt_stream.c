@@ -0,0 +1,356 @@
+// Verificação no host da entrega em fragmentos de PUBLISH maiores que o buffer
+// de rede do coreMQTT (MQTT_STREAM_LARGE_PUBLISH=1), com um transporte em
+// memória que entrega os bytes em pedaços sorteados:
+//   - PUBLISH de 0 B a 20 KB em QoS 0, 1 e 2, um atrás do outro: os fragmentos
+//     remontam o payload, o tópico vale em todos e o PUBACK/PUBREC sai uma vez;
+//   - pacotes pequenos depois dos grandes continuam inteiros no buffer;
+//   - QoS 2 repetido (DUP) é drenado sem chegar à aplicação;
+//   - tópico que não cabe no buffer: pacote descartado, o seguinte chega;
+//   - conexão caída no meio do payload: o registro QoS 2 sai, e a cópia
+//     reenviada pelo broker chega inteira;
+//   - erro de estado no início do PUBLISH: o resto é drenado e o pacote
+//     seguinte chega.
+//   cmake --build build_sim --target mqtt_stream_check && ./build_sim/mqtt_stream_check
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "core_mqtt.h"
+#include "core_mqtt_state.h"
+
+#define BUFFER 64             // cabeçalho, tópico e packet ID com folga
+#define PAYLOAD_MAX 20000
+#define ENTRADA_MAX (8 * (PAYLOAD_MAX + 64))
+#define REGISTROS 16          // os PUBLISH QoS 2 ficam à espera do PUBREL
+
+static const char s_topico_cfg[] = "pico_w/config/set";
+
+static uint32_t s_erros;
+
+static void confere(bool ok, const char *caso)
+{
+    if (!ok) {
+        printf("falhou: %s\n", caso);
+        s_erros++;
+    }
+}
+
+static uint32_t s_sorteio = 0x9E3779B9u;
+
+static uint32_t sorteia(uint32_t n)
+{
+    s_sorteio ^= s_sorteio << 13;
+    s_sorteio ^= s_sorteio >> 17;
+    s_sorteio ^= s_sorteio << 5;
+    return s_sorteio % n;
+}
+
+// --- Transporte em memória ---
+
+struct NetworkContext {
+    uint8_t rx[ENTRADA_MAX];
+    size_t ini, fim;
+    size_t cai_em;            // recv() falha quando ini chega aqui (0 = nunca)
+    uint8_t tx[256];
+    size_t enviados;
+};
+
+static NetworkContext_t s_rede;
+static MQTTContext_t s_mqtt;
+static uint8_t s_buffer[BUFFER];
+static MQTTPubAckInfo_t s_saida[REGISTROS], s_entrada[REGISTROS];
+
+static int32_t rede_recv(NetworkContext_t *ctx, void *buf, size_t len)
+{
+    if (ctx->cai_em && ctx->ini >= ctx->cai_em)
+        return -1;
+    size_t n = ctx->fim - ctx->ini;
+    size_t pedaco = 1 + sorteia(700);
+    if (n > pedaco)
+        n = pedaco;
+    if (n > len)
+        n = len;
+    if (ctx->cai_em && ctx->ini + n > ctx->cai_em)
+        n = ctx->cai_em - ctx->ini;
+    memcpy(buf, &ctx->rx[ctx->ini], n);
+    ctx->ini += n;
+    return (int32_t)n;
+}
+
+static int32_t rede_send(NetworkContext_t *ctx, const void *buf, size_t len)
+{
+    if (ctx->enviados + len <= sizeof ctx->tx)
+        memcpy(&ctx->tx[ctx->enviados], buf, len);
+    ctx->enviados += len;
+    return (int32_t)len;
+}
+
+static uint32_t tempo_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000u + ts.tv_nsec / 1000000u);
+}
+
+// PUBLISH serializado no fim da entrada
+static size_t entregar_publish(const char *topico, uint8_t qos, bool dup, uint16_t id, const uint8_t *payload,
+                               size_t len)
+{
+    size_t t = strlen(topico);
+    size_t resto = 2 + t + (qos ? 2 : 0) + len;
+    uint8_t *p = &s_rede.rx[s_rede.fim];
+    size_t n = 0;
+    p[n++] = (uint8_t)(0x30 | (dup ? 0x08 : 0) | (qos << 1));
+    do {
+        uint8_t b = resto & 0x7F;
+        resto >>= 7;
+        p[n++] = resto ? (uint8_t)(b | 0x80) : b;
+    } while (resto);
+    p[n++] = (uint8_t)(t >> 8);
+    p[n++] = (uint8_t)t;
+    memcpy(&p[n], topico, t);
+    n += t;
+    if (qos) {
+        p[n++] = (uint8_t)(id >> 8);
+        p[n++] = (uint8_t)id;
+    }
+    memcpy(&p[n], payload, len);
+    n += len;
+    s_rede.fim += n;
+    return n;
+}
+
+// --- Aplicação: remonta cada PUBLISH a partir dos fragmentos ---
+
+static uint8_t s_remontado[PAYLOAD_MAX];
+static size_t s_recebidos;        // bytes remontados do PUBLISH em curso
+static uint32_t s_fragmentos, s_completos, s_fora_de_ordem, s_topico_errado;
+static char s_topico[64];
+static uint16_t s_id;
+
+// PUBLISH completos na ordem de chegada: tamanho e FNV-1a do payload remontado
+typedef struct {
+    size_t len;
+    uint32_t soma;
+} completo_t;
+static completo_t s_log[16];
+
+static uint32_t soma(const uint8_t *p, size_t n)
+{
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i)
+        h = (h ^ p[i]) * 16777619u;
+    return h;
+}
+
+static void evento_cb(MQTTContext_t *ctx, MQTTPacketInfo_t *pacote, MQTTDeserializedInfo_t *info)
+{
+    (void)ctx;
+    if ((pacote->type & 0xF0U) != MQTT_PACKET_TYPE_PUBLISH)
+        return;
+    const MQTTPublishInfo_t *pub = info->pPublishInfo;
+    if (info->payloadOffset == 0) {
+        s_recebidos = 0;
+        snprintf(s_topico, sizeof s_topico, "%.*s", (int)pub->topicNameLength, pub->pTopicName);
+        s_id = info->packetIdentifier;
+    }
+    if (info->payloadOffset != s_recebidos || s_recebidos + pub->payloadLength > sizeof s_remontado ||
+        info->payloadTotalLength > sizeof s_remontado || info->packetIdentifier != s_id) {
+        s_fora_de_ordem++;
+        return;
+    }
+    if (pub->topicNameLength != strlen(s_topico) || memcmp(pub->pTopicName, s_topico, pub->topicNameLength) != 0)
+        s_topico_errado++;
+    memcpy(&s_remontado[s_recebidos], pub->pPayload, pub->payloadLength);
+    s_recebidos += pub->payloadLength;
+    s_fragmentos++;
+    if (s_recebidos == info->payloadTotalLength) {
+        if (s_completos < sizeof s_log / sizeof s_log[0])
+            s_log[s_completos] = (completo_t){s_recebidos, soma(s_remontado, s_recebidos)};
+        s_completos++;
+    }
+}
+
+// Contexto novo e entrada vazia
+static void iniciar(void)
+{
+    memset(s_saida, 0, sizeof s_saida);
+    memset(s_entrada, 0, sizeof s_entrada);
+    memset(&s_rede, 0, sizeof s_rede);
+    const TransportInterface_t transporte = {.recv = rede_recv, .send = rede_send, .pNetworkContext = &s_rede};
+    const MQTTFixedBuffer_t buffer = {.pBuffer = s_buffer, .size = sizeof s_buffer};
+    if (MQTT_Init(&s_mqtt, &transporte, tempo_ms, evento_cb, &buffer) != MQTTSuccess ||
+        MQTT_InitStatefulQoS(&s_mqtt, s_saida, REGISTROS, s_entrada, REGISTROS) != MQTTSuccess) {
+        printf("MQTT_Init/MQTT_InitStatefulQoS falhou\n");
+        exit(1);
+    }
+    s_mqtt.connectStatus = MQTTConnected;
+    s_completos = s_fragmentos = s_fora_de_ordem = s_topico_errado = 0;
+}
+
+// Roda o ProcessLoop() até consumir a entrada; devolve o primeiro erro
+static MQTTStatus_t processar(void)
+{
+    for (int voltas = 0; voltas < 100000; ++voltas) {
+        MQTTStatus_t st = MQTT_ProcessLoop(&s_mqtt);
+        if (st != MQTTSuccess && st != MQTTNeedMoreBytes)
+            return st;
+        if (s_rede.ini == s_rede.fim && s_mqtt.index == 0)
+            return MQTTSuccess;
+    }
+    return MQTTRecvFailed;
+}
+
+static void preencher(uint8_t *payload, size_t len, uint32_t semente)
+{
+    for (size_t i = 0; i < len; ++i)
+        payload[i] = (uint8_t)((i * 31u + semente) ^ (i >> 8));
+}
+
+// Um PUBLISH de cada tamanho e QoS, seguidos, com a remontagem conferida um a um
+static void tamanhos(void)
+{
+    static const size_t tam[] = {0, 1, 20, BUFFER - 25, BUFFER - 24, BUFFER, 1000, 4096, PAYLOAD_MAX};
+    static uint8_t payload[PAYLOAD_MAX];
+    uint32_t publicacoes = 0, acks_esperados = 0;
+    iniciar();
+    for (size_t i = 0; i < sizeof tam / sizeof tam[0]; ++i)
+        for (uint8_t qos = 0; qos <= 2; ++qos) {
+            uint16_t id = (uint16_t)(publicacoes + 1);
+            preencher(payload, tam[i], publicacoes);
+            s_rede.ini = s_rede.fim = 0;
+            entregar_publish(s_topico_cfg, qos, false, id, payload, tam[i]);
+            uint32_t completos = s_completos;
+            size_t enviados = s_rede.enviados;
+            confere(processar() == MQTTSuccess, "PUBLISH processado");
+            confere(s_completos == completos + 1, "um PUBLISH completo por pacote");
+            confere(s_recebidos == tam[i] && memcmp(s_remontado, payload, tam[i]) == 0, "payload remontado");
+            confere(strcmp(s_topico, s_topico_cfg) == 0, "tópico do PUBLISH");
+            if (qos) {
+                const uint8_t *ack = &s_rede.tx[enviados];
+                confere(s_rede.enviados == enviados + 4 && ack[0] == (qos == 1 ? 0x40 : 0x50) &&
+                            ack[2] == (uint8_t)(id >> 8) && ack[3] == (uint8_t)id,
+                        "PUBACK/PUBREC depois do último fragmento");
+                acks_esperados++;
+                if (s_rede.enviados > 128)
+                    s_rede.enviados = 0;
+            }
+            publicacoes++;
+        }
+    confere(s_fora_de_ordem == 0 && s_topico_errado == 0, "fragmentos em ordem e com o tópico");
+    printf("Tamanhos de 0 a %u B em QoS 0/1/2: %lu PUBLISH, %lu fragmentos, %lu acks\n", PAYLOAD_MAX,
+           (unsigned long)publicacoes, (unsigned long)s_fragmentos, (unsigned long)acks_esperados);
+}
+
+// Grandes e pequenos numa entrada só: o que sobra no buffer depois de um
+// PUBLISH pequeno e o que vem depois de um grande chegam inteiros
+static void em_sequencia(void)
+{
+    static uint8_t payloads[8][5000];
+    static const size_t tam[8] = {5000, 3, 2500, 10, 4999, 0, 1, 3000};
+    iniciar();
+    for (int i = 0; i < 8; ++i) {
+        preencher(payloads[i], tam[i], (uint32_t)i * 7u);
+        entregar_publish(i & 1 ? "a/b" : s_topico_cfg, (uint8_t)(i % 3), false, (uint16_t)(100 + i), payloads[i],
+                         tam[i]);
+    }
+    confere(processar() == MQTTSuccess, "sequência processada");
+    uint32_t ok = 0;
+    for (int i = 0; i < 8; ++i)
+        ok += s_log[i].len == tam[i] && s_log[i].soma == soma(payloads[i], tam[i]);
+    confere(s_completos == 8 && ok == 8 && s_fora_de_ordem == 0 && s_topico_errado == 0,
+            "grandes e pequenos em sequência");
+}
+
+// QoS 2 reenviado com DUP antes do PUBREL: drenado sem chegar à aplicação,
+// e o PUBREC sai de novo
+static void duplicado(void)
+{
+    static uint8_t payload[3000];
+    preencher(payload, sizeof payload, 3);
+    iniciar();
+    entregar_publish(s_topico_cfg, 2, false, 500, payload, sizeof payload);
+    entregar_publish(s_topico_cfg, 2, true, 500, payload, sizeof payload);
+    entregar_publish("a/b", 0, false, 0, payload, 10);
+    confere(processar() == MQTTSuccess, "duplicado processado");
+    confere(s_completos == 2 && s_log[0].len == sizeof payload && s_log[1].len == 10,
+            "duplicado não chega à aplicação");
+    confere(s_rede.enviados == 8 && s_rede.tx[0] == 0x50 && s_rede.tx[4] == 0x50, "PUBREC para os dois");
+}
+
+// Tópico maior que o buffer: não há onde guardá-lo, o pacote é descartado
+static void topico_longo(void)
+{
+    static uint8_t payload[500];
+    char topico[BUFFER + 10];
+    memset(topico, 't', sizeof topico - 1);
+    topico[sizeof topico - 1] = '\0';
+    iniciar();
+    entregar_publish(topico, 1, false, 7, payload, sizeof payload);
+    entregar_publish("a/b", 1, false, 8, payload, 20);
+    confere(processar() == MQTTSuccess, "tópico longo processado");
+    confere(s_completos == 1 && s_log[0].len == 20 && strcmp(s_topico, "a/b") == 0, "tópico longo descartado");
+    confere(s_rede.enviados == 4 && s_rede.tx[3] == 8, "PUBACK só do seguinte");
+}
+
+// Conexão cai no meio do payload: o registro sai, e a cópia que o broker
+// reenvia (sessão persistente) chega inteira em vez de ser tomada por duplicada
+static void queda(void)
+{
+    static uint8_t payload[5000];
+    preencher(payload, sizeof payload, 11);
+    iniciar();
+    size_t n = entregar_publish(s_topico_cfg, 2, false, 600, payload, sizeof payload);
+    s_rede.cai_em = n / 2;
+    MQTTStatus_t st = MQTTSuccess;
+    for (int voltas = 0; voltas < 1000 && st == MQTTSuccess; ++voltas)
+        st = MQTT_ProcessLoop(&s_mqtt);
+    confere(st == MQTTRecvFailed, "queda no meio do payload");
+    confere(s_completos == 0 && s_fragmentos > 0 && s_mqtt.index == 0, "payload incompleto não fecha");
+    confere(s_rede.enviados == 0, "sem PUBREC do incompleto");
+
+    s_rede.cai_em = 0;
+    s_rede.ini = s_rede.fim = 0;
+    entregar_publish(s_topico_cfg, 2, true, 600, payload, sizeof payload);
+    confere(processar() == MQTTSuccess, "cópia reenviada processada");
+    confere(s_completos == 1 && s_recebidos == sizeof payload && memcmp(s_remontado, payload, sizeof payload) == 0,
+            "cópia reenviada chega inteira");
+    confere(s_rede.enviados == 4 && s_rede.tx[0] == 0x50, "PUBREC da cópia");
+}
+
+// Erro de estado no PUBLISH grande (registros de entrada cheios): o erro sobe,
+// mas o resto do pacote sai do transporte e o seguinte é lido do cabeçalho
+static void erro_de_estado(void)
+{
+    static uint8_t payload[3000];
+    preencher(payload, sizeof payload, 5);
+    iniciar();
+    for (uint16_t id = 1; id <= REGISTROS; ++id)
+        entregar_publish("a/b", 2, false, id, payload, 4);
+    confere(processar() == MQTTSuccess && s_completos == REGISTROS, "registros QoS 2 ocupados");
+    entregar_publish(s_topico_cfg, 2, false, REGISTROS + 1, payload, sizeof payload);
+    entregar_publish("a/c", 0, false, 0, payload, 30);
+    uint32_t fragmentos = s_fragmentos;
+    confere(processar() == MQTTNoMemory, "erro de estado devolvido");
+    confere(s_fragmentos == fragmentos && s_mqtt.index == 0, "PUBLISH recusado não chega à aplicação");
+    confere(processar() == MQTTSuccess, "pacote seguinte processado");
+    confere(s_completos == REGISTROS + 1 && s_recebidos == 30 && strcmp(s_topico, "a/c") == 0,
+            "stream em sincronia depois do erro");
+}
+
+int main(void)
+{
+    tamanhos();
+    em_sequencia();
+    duplicado();
+    topico_longo();
+    queda();
+    erro_de_estado();
+
+    // Buffer de rede para receber o mesmo PUBLISH inteiro
+    size_t inteiro = 5 + 2 + strlen(s_topico_cfg) + 2 + PAYLOAD_MAX;
+    printf("Buffer de rede: %u B em fragmentos; %lu B para o PUBLISH de %u B inteiro\n", BUFFER,
+           (unsigned long)inteiro, PAYLOAD_MAX);
+    printf(s_erros ? "FALHOU (%lu)\n" : "OK\n", (unsigned long)s_erros);
+    return s_erros ? 1 : 0;
+}
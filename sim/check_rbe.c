@@ -0,0 +1,83 @@
+// Verificação no host do relato por exceção (inc/rbe.c):
+//   - zona morta absoluta e relativa, cruzamento de limiar e batimento;
+//   - período interno: cai pela metade com movimento, dobra com os valores parados.
+//   cmake --build build_sim --target rbe_check && ./build_sim/rbe_check
+#include <stdio.h>
+#include "rbe.h"
+
+static uint32_t s_erros;
+
+static void confere(bool ok, const char *caso)
+{
+    if (!ok) {
+        printf("falhou: %s\n", caso);
+        s_erros++;
+    }
+}
+
+static telemetry_sample_t amostra(uint32_t t_ms, int16_t temp_c100, uint16_t dist_mm)
+{
+    telemetry_sample_t s = {.t_ms = t_ms, .temp_c100 = temp_c100, .pres_pa = 101325, .dist_mm = dist_mm,
+                            .bpm_x10 = 720, .spo2_x10 = 970};
+    return s;
+}
+
+int main(void)
+{
+    rbe_config_t cfg;
+    rbe_t r;
+    rbe_default_config(&cfg, 3000, 200, 250, 2000);
+    rbe_init(&r, &cfg);
+
+    telemetry_sample_t s = amostra(0, 2500, 1000);
+    confere(rbe_update(&r, &s), "primeira amostra publicada");
+
+    // Dentro da zona morta: 0,2 °C e 5% de 1000 mm
+    s = amostra(250, 2520, 1050);
+    confere(!rbe_update(&r, &s), "dentro da zona morta suprimida");
+    s = amostra(500, 2521, 1000);
+    confere(rbe_update(&r, &s), "temperatura fora da zona morta publicada");
+    s = amostra(750, 2521, 1051);
+    confere(rbe_update(&r, &s), "distância fora da zona morta relativa publicada");
+
+    // Cruzamento do limiar com passo menor que a zona morta
+    rbe_stats_t st;
+    s = amostra(1000, 2990, 1051);
+    rbe_update(&r, &s);
+    s = amostra(1250, 3005, 1051);
+    confere(rbe_update(&r, &s), "cruzamento de limiar publicado");
+    rbe_get_stats(&r, &st);
+    confere(st.crossings == 1, "cruzamento contado");
+
+    // Valores parados: o período dobra a cada RBE_STABLE_CYCLES até o lento, com um batimento
+    uint32_t t = 1250, publicadas = st.reported;
+    for (int i = 0; i < 200; ++i) {
+        t += rbe_period_ms(&r);
+        s = amostra(t, 3005, 1051);
+        rbe_update(&r, &s);
+    }
+    rbe_get_stats(&r, &st);
+    confere(rbe_period_ms(&r) == 2000, "período lento com os valores parados");
+    confere(st.heartbeats == st.reported - publicadas && st.heartbeats >= t / RBE_MAX_SILENCE_MS - 1,
+            "só batimentos com os valores parados");
+
+    // Movimento rápido: volta ao período rápido
+    for (int i = 0; i < 4; ++i) {
+        t += rbe_period_ms(&r);
+        s = amostra(t, (int16_t)(3005 + 30 * (i + 1)), 1051);
+        confere(rbe_update(&r, &s), "movimento publicado");
+    }
+    confere(rbe_period_ms(&r) == 250, "período rápido com movimento");
+
+    rbe_get_stats(&r, &st);
+    confere(st.samples == st.reported + st.suppressed, "contadores somam");
+    printf("rbe: %lu amostras, %lu publicadas (%lu batimentos, %lu por limiar), %lu suprimidas\n",
+           (unsigned long)st.samples, (unsigned long)st.reported, (unsigned long)st.heartbeats,
+           (unsigned long)st.crossings, (unsigned long)st.suppressed);
+    if (s_erros) {
+        printf("FALHA: %lu erros\n", (unsigned long)s_erros);
+        return 1;
+    }
+    printf("OK\n");
+    return 0;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "pico.h"
+
+// Flash QSPI do host: memória em RAM com semântica de NOR (sim_flash.c).
+// O "XIP" é o próprio vetor, então leituras por ponteiro funcionam como no alvo.
+
+#define FLASH_PAGE_SIZE (1u << 8)
+#define FLASH_SECTOR_SIZE (1u << 12)
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2u * 1024 * 1024)
+#endif
+
+extern uint8_t sim_flash_mem[PICO_FLASH_SIZE_BYTES];
+#define XIP_BASE ((uintptr_t)sim_flash_mem)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void flash_range_erase(uint32_t flash_offs, size_t count);
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+// Instâncias I2C do host: o tráfego é roteado para o barramento virtual (sim_i2c.c)
+typedef struct i2c_inst {
+    uint index;
+    uint baudrate;
+} i2c_inst_t;
+
+extern i2c_inst_t sim_i2c_inst[2];
+#define i2c0 (&sim_i2c_inst[0])
+#define i2c1 (&sim_i2c_inst[1])
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint i2c_get_index(i2c_inst_t *i2c)
+{
+    return i2c->index;
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate);
+void i2c_deinit(i2c_inst_t *i2c);
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate);
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us);
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us);
+
+#ifdef __cplusplus
+}
+#endif
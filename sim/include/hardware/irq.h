@@ -0,0 +1,9 @@
+#pragma once
+
+#include "pico.h"
+#include "hardware/gpio.h"
+
+#define IO_IRQ_BANK0 13
+
+// No host as "interrupções" de GPIO são entregues por sim_gpio_drive(); a habilitação no NVIC é implícita
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num; (void)enabled; }
@@ -0,0 +1,23 @@
+#pragma once
+
+#include "pico.h"
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;
+    uint32_t top;
+} pwm_config;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint pwm_gpio_to_slice_num(uint gpio) { return (gpio >> 1u) & 7u; }
+static inline uint pwm_gpio_to_channel(uint gpio) { return gpio & 1u; }
+pwm_config pwm_get_default_config(void);
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+void pwm_set_gpio_level(uint gpio, uint16_t level);
+
+#ifdef __cplusplus
+}
+#endif
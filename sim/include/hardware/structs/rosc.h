@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico.h"
+
+typedef struct {
+    uint32_t randombit;
+} rosc_hw_t;
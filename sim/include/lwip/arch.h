@@ -0,0 +1,45 @@
+#pragma once
+
+// Tipos básicos do lwIP usados pelo firmware (simulação no host)
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef uint8_t u8_t;
+typedef int8_t s8_t;
+typedef uint16_t u16_t;
+typedef int16_t s16_t;
+typedef uint32_t u32_t;
+typedef int32_t s32_t;
+
+typedef s8_t err_t;
+#define ERR_OK 0
+#define ERR_MEM -1
+#define ERR_TIMEOUT -3
+#define ERR_INPROGRESS -5
+#define ERR_VAL -6
+#define ERR_ISCONN -10
+#define ERR_CONN -11
+#define ERR_ABRT -13
+#define ERR_ARG -16
+
+typedef struct ip4_addr {
+    u32_t addr;
+} ip4_addr_t;
+typedef ip4_addr_t ip_addr_t;
+
+#define IPADDR_TYPE_V4 0U
+#define IP_GET_TYPE(ipaddr) IPADDR_TYPE_V4
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+char *ip4addr_ntoa(const ip4_addr_t *addr);
+
+#ifdef __cplusplus
+}
+#endif
+
+// Nome da tarefa do núcleo do lwIP (lwip/opt.h); no host não há tcpip_thread
+#define TCPIP_THREAD_NAME "tcpip_thread"
@@ -0,0 +1,36 @@
+#pragma once
+
+// API de sockets do lwIP (lwip/sockets.h) com os tipos e constantes do host,
+// atendida pelo broker local da simulação (sim_socket.c): um socket TCP por vez
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+#define lwip_htons(x) htons(x)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int lwip_socket(int domain, int type, int protocol);
+int lwip_connect(int s, const struct sockaddr *name, socklen_t namelen);
+int lwip_close(int s);
+ssize_t lwip_recv(int s, void *mem, size_t len, int flags);
+ssize_t lwip_send(int s, const void *dataptr, size_t size, int flags);
+ssize_t lwip_writev(int s, const struct iovec *iov, int iovcnt);
+int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, struct timeval *timeout);
+int lwip_fcntl(int s, int cmd, int val);
+int lwip_getsockopt(int s, int level, int optname, void *optval, socklen_t *optlen);
+int lwip_setsockopt(int s, int level, int optname, const void *optval, socklen_t optlen);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,32 @@
+#pragma once
+
+// Contadores de memória do lwIP (lwip/stats.h) no host. Não há pilha TCP/IP
+// simulada: os valores ficam em zero, só o formato do diagnóstico é exercitado.
+
+#include "lwip/arch.h"
+
+#define LWIP_STATS 1
+
+typedef enum {
+    MEMP_PBUF_POOL,
+    MEMP_PBUF,
+    MEMP_TCP_PCB,
+    MEMP_TCP_SEG,
+    MEMP_SYS_TIMEOUT,
+    MEMP_MAX
+} memp_t;
+
+struct stats_mem {
+    u16_t err;
+    u16_t avail;
+    u16_t used;
+    u16_t max;
+    u16_t illegal;
+};
+
+struct stats_ {
+    struct stats_mem mem;
+    struct stats_mem *memp[MEMP_MAX];
+};
+
+extern struct stats_ lwip_stats;
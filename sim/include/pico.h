@@ -0,0 +1,34 @@
+#pragma once
+
+// Subconjunto do Pico SDK usado pelo firmware, reimplementado no host (sim_pico.c)
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+typedef uint64_t absolute_time_t;
+
+#define PICO_OK 0
+#define PICO_ERROR_GENERIC -1
+#define PICO_ERROR_TIMEOUT -2
+
+#define NUM_BANK0_GPIOS 30
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void sleep_ms(uint32_t ms);
+void sleep_us(uint64_t us);
+uint32_t time_us_32(void);
+uint64_t time_us_64(void);
+static inline absolute_time_t get_absolute_time(void) { return time_us_64(); }
+static inline uint32_t to_ms_since_boot(absolute_time_t t) { return (uint32_t)(t / 1000u); }
+
+bool stdio_init_all(void);
+void panic(const char *fmt, ...) __attribute__((noreturn));
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,7 @@
+#pragma once
+
+// Contexto assíncrono do SDK no host: só o tipo, o CYW43 simulado não usa tarefa própria
+
+typedef struct async_context {
+    int unused;
+} async_context_t;
@@ -0,0 +1,29 @@
+#pragma once
+
+// async_context_freertos no host: inicialização sem tarefa (o port POSIX não é SMP)
+
+#include <stdbool.h>
+#include "FreeRTOS.h"
+#include "pico/async_context.h"
+
+typedef struct async_context_freertos {
+    async_context_t core;
+} async_context_freertos_t;
+
+typedef struct async_context_freertos_config {
+    UBaseType_t task_priority;
+    configSTACK_DEPTH_TYPE task_stack_size;
+} async_context_freertos_config_t;
+
+static inline async_context_freertos_config_t async_context_freertos_default_config(void)
+{
+    async_context_freertos_config_t c = {tskIDLE_PRIORITY + 4, configMINIMAL_STACK_SIZE};
+    return c;
+}
+
+static inline bool async_context_freertos_init(async_context_freertos_t *self, async_context_freertos_config_t *config)
+{
+    (void)self;
+    (void)config;
+    return true;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// Rádio CYW43 no host: a "associação" é imediata (fora das quedas de
+// sim_wifi_set_up) e o lwIP é o broker local (sim_mqtt.c)
+
+#include "pico.h"
+#include "pico/async_context.h"
+
+#define CYW43_AUTH_OPEN 0
+#define CYW43_AUTH_WPA2_AES_PSK 0x00400004
+
+#define CYW43_ITF_STA 0
+#define CYW43_LINK_DOWN 0
+#define CYW43_LINK_UP 3
+#define CYW43_LINK_NONET (-2)
+
+// Economia de energia: mesma codificação do driver (cyw43.h)
+#define CYW43_NO_POWERSAVE_MODE 0
+#define CYW43_PM1_POWERSAVE_MODE 1
+#define CYW43_PM2_POWERSAVE_MODE 2
+#define cyw43_pm_value(pm_mode, pm2_sleep_ret_ms, li_beacon_period, li_dtim_period, li_assoc)              \
+    ((uint32_t)((li_assoc) << 20 | (li_dtim_period) << 16 | (li_beacon_period) << 12 |                     \
+                ((pm2_sleep_ret_ms) / 10) << 4 | (pm_mode)))
+#define CYW43_NONE_PM cyw43_pm_value(CYW43_NO_POWERSAVE_MODE, 10, 0, 0, 0)
+#define CYW43_AGGRESSIVE_PM cyw43_pm_value(CYW43_PM1_POWERSAVE_MODE, 10, 0, 0, 0)
+#define CYW43_PERFORMANCE_PM cyw43_pm_value(CYW43_PM2_POWERSAVE_MODE, 200, 1, 1, 10)
+#define CYW43_DEFAULT_PM CYW43_PERFORMANCE_PM
+
+typedef struct {
+    int itf_state;
+    uint32_t pm;            // último cyw43_wifi_pm(); a associação volta ao padrão
+} cyw43_t;
+
+extern cyw43_t cyw43_state;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void cyw43_arch_set_async_context(async_context_t *context);
+int cyw43_arch_init(void);
+void cyw43_arch_deinit(void);
+void cyw43_arch_enable_sta_mode(void);
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout);
+int cyw43_tcpip_link_status(cyw43_t *self, int itf);
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm);
+void cyw43_arch_lwip_begin(void);
+void cyw43_arch_lwip_end(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Sem segundo núcleo nem XIP no host: executa direto
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,15 @@
+#pragma once
+
+// Gerador do SDK no host: rand() da libc, sem semente de hardware
+
+#include "pico.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t get_rand_32(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,6 @@
+#pragma once
+
+#include "pico.h"
+
+// No host o "USB CDC" é o stdout do processo: sempre conectado
+static inline bool stdio_usb_connected(void) { return true; }
@@ -0,0 +1,5 @@
+#pragma once
+
+#include <stdio.h>
+#include "pico.h"
+#include "hardware/gpio.h"
@@ -0,0 +1,591 @@
+#include <math.h>
+#include <string.h>
+#include "pico.h"
+#include "sim_devices.h"
+#include "sim_pico.h"
+
+#define SIM_PI 3.14159265f
+
+// --- Ambiente ---
+
+static uint64_t s_hold_ini_us, s_hold_dur_us;
+
+void sim_env_hold(uint32_t ini_s, uint32_t dur_s)
+{
+    s_hold_ini_us = (uint64_t)ini_s * 1000000u;
+    s_hold_dur_us = (uint64_t)dur_s * 1000000u;
+}
+
+// Relógio do ambiente: parado durante a janela de sim_env_hold, contínuo depois dela
+static float env_time_s(void)
+{
+    uint64_t t = time_us_64();
+    if (s_hold_dur_us && t >= s_hold_ini_us)
+        t = t < s_hold_ini_us + s_hold_dur_us ? s_hold_ini_us : t - s_hold_dur_us;
+    return (float)t / 1e6f;
+}
+
+// Temperatura oscila 17,5..32,5 °C em 120 s (cruza TEMP_THRESHOLD_C padrão)
+float sim_env_temperature_c(void)
+{
+    float t = env_time_s();
+    return 25.0f + 7.5f * sinf(2.0f * SIM_PI * t / 120.0f);
+}
+
+// Distância 150..650 mm em 30 s (cruza DIST_THRESHOLD_MM padrão)
+uint16_t sim_env_distance_mm(void)
+{
+    float t = env_time_s();
+    return (uint16_t)(400.0f + 250.0f * sinf(2.0f * SIM_PI * t / 30.0f));
+}
+
+// Pulso 66..78 bpm em 60 s
+float sim_env_heart_bpm(void)
+{
+    float t = env_time_s();
+    return 72.0f + 6.0f * sinf(2.0f * SIM_PI * t / 60.0f);
+}
+
+// SpO2 fixo; o modelo do MAX30101 gera a razão R = (110 - SpO2) / 25 correspondente
+float sim_env_spo2(void)
+{
+    return 97.0f;
+}
+
+// --- BMP280: registradores 8 bits, ponteiro auto-incrementado ---
+
+typedef struct {
+    uint8_t regs[256];
+    uint8_t ptr;
+    bool converting;
+    uint64_t ready_us;
+} bmp280_model_t;
+
+static bmp280_model_t s_bmp;
+
+// Valores de calibração do exemplo do datasheet (seção 3.11.3)
+static const int32_t bmp_calib[12] = {27504, 26435, -1000, 36477, -10685, 3024, 2855, 140, -7, 15500, -14600, 6000};
+
+static void bmp280_reset_regs(void)
+{
+    memset(s_bmp.regs, 0, sizeof s_bmp.regs);
+    s_bmp.converting = false;
+    s_bmp.regs[0xD0] = 0x58;
+    for (int i = 0; i < 12; ++i) {
+        uint16_t v = (uint16_t)bmp_calib[i];
+        s_bmp.regs[0x88 + 2 * i] = (uint8_t)(v & 0xFF);
+        s_bmp.regs[0x89 + 2 * i] = (uint8_t)(v >> 8);
+    }
+}
+
+// Nova conversão: adc_T 519888 ~ 25,08 °C e ~3170 LSB/°C na vizinhança (datasheet)
+static void bmp280_convert(void)
+{
+    float dt = sim_env_temperature_c() - 25.08f;
+    uint32_t adc_t = (uint32_t)(519888.0f + dt * 3170.0f);
+    uint32_t adc_p = 415148u + (time_us_32() >> 10) % 64u;
+    s_bmp.regs[0xF7] = (uint8_t)(adc_p >> 12);
+    s_bmp.regs[0xF8] = (uint8_t)(adc_p >> 4);
+    s_bmp.regs[0xF9] = (uint8_t)((adc_p & 0x0F) << 4);
+    s_bmp.regs[0xFA] = (uint8_t)(adc_t >> 12);
+    s_bmp.regs[0xFB] = (uint8_t)(adc_t >> 4);
+    s_bmp.regs[0xFC] = (uint8_t)((adc_t & 0x0F) << 4);
+}
+
+// Tempo máximo de conversão do datasheet (3.8.1) para a sobreamostragem de ctrl_meas
+static uint32_t bmp280_conversion_us(uint8_t ctrl)
+{
+    uint8_t ost = (ctrl >> 5) & 7, osp = (ctrl >> 2) & 7;
+    uint32_t nt = ost ? 1u << ((ost > 5 ? 5 : ost) - 1) : 0;
+    uint32_t np = osp ? 1u << ((osp > 5 ? 5 : osp) - 1) : 0;
+    return 1250u + 2300u * nt + (np ? 2300u * np + 575u : 0u);
+}
+
+// Conclui a conversão forçada quando o tempo passou: status.measuring cai e o modo volta a sleep
+static void bmp280_advance(void)
+{
+    if (!s_bmp.converting || time_us_64() < s_bmp.ready_us) return;
+    s_bmp.converting = false;
+    bmp280_convert();
+    s_bmp.regs[0xF3] &= (uint8_t)~0x08;
+    s_bmp.regs[0xF4] &= (uint8_t)~0x03;
+}
+
+static bool bmp280_write(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)dev;
+    (void)nostop;
+    if (len == 0) return true;
+    s_bmp.ptr = src[0];
+    for (size_t i = 1; i < len; ++i) {
+        uint8_t reg = (uint8_t)(s_bmp.ptr + i - 1);
+        if (reg == 0xE0) {
+            if (src[i] == 0xB6) bmp280_reset_regs();
+            continue;
+        }
+        s_bmp.regs[reg] = src[i];
+        // Modo forçado: converte durante o tempo do datasheet e volta a dormir
+        if (reg == 0xF4 && (src[i] & 0x03) != 0) {
+            if ((src[i] & 0x03) == 0x03) {
+                bmp280_convert();
+            } else {
+                s_bmp.converting = true;
+                s_bmp.ready_us = time_us_64() + bmp280_conversion_us(src[i]);
+                s_bmp.regs[0xF3] |= 0x08;
+            }
+        }
+    }
+    return true;
+}
+
+static bool bmp280_read(sim_i2c_device_t *dev, uint8_t *dst, size_t len)
+{
+    (void)dev;
+    bmp280_advance();
+    // Modo normal: amostra nova a cada leitura de dados
+    if ((s_bmp.regs[0xF4] & 0x03) == 0x03 && s_bmp.ptr >= 0xF7)
+        bmp280_convert();
+    for (size_t i = 0; i < len; ++i)
+        dst[i] = s_bmp.regs[(uint8_t)(s_bmp.ptr + i)];
+    s_bmp.ptr = (uint8_t)(s_bmp.ptr + len);
+    return true;
+}
+
+static sim_i2c_device_t s_bmp_dev = {
+    .name = "BMP280", .bus = 0, .addr = 0x76, .sda = 0, .scl = 1,
+    .write = bmp280_write, .read = bmp280_read, .irq_pin = -1,
+};
+
+sim_i2c_device_t *sim_bmp280_device(void)
+{
+    memset(&s_bmp, 0, sizeof s_bmp);
+    bmp280_reset_regs();
+    bmp280_convert();
+    return &s_bmp_dev;
+}
+
+// --- VL53L0X: registradores 8 bits, medição única disparada por SYSRANGE_START ---
+
+typedef struct {
+    uint8_t regs[256];
+    uint8_t ptr;
+} vl53l0x_model_t;
+
+static vl53l0x_model_t s_l0x;
+
+static bool vl53l0x_write(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)dev;
+    (void)nostop;
+    if (len == 0) return true;
+    s_l0x.ptr = src[0];
+    for (size_t i = 1; i < len; ++i) {
+        uint8_t reg = (uint8_t)(s_l0x.ptr + i - 1);
+        s_l0x.regs[reg] = src[i];
+        if (reg == 0x00 && (src[i] & 0x01)) {
+            uint16_t mm = sim_env_distance_mm();
+            s_l0x.regs[0x14] |= 0x01;
+            s_l0x.regs[0x1E] = (uint8_t)(mm >> 8);
+            s_l0x.regs[0x1F] = (uint8_t)mm;
+        }
+    }
+    return true;
+}
+
+static bool vl53l0x_read(sim_i2c_device_t *dev, uint8_t *dst, size_t len)
+{
+    (void)dev;
+    for (size_t i = 0; i < len; ++i)
+        dst[i] = s_l0x.regs[(uint8_t)(s_l0x.ptr + i)];
+    s_l0x.ptr = (uint8_t)(s_l0x.ptr + len);
+    return true;
+}
+
+static sim_i2c_device_t s_l0x_dev = {
+    .name = "VL53L0X", .bus = 1, .addr = 0x29, .sda = 2, .scl = 3,
+    .write = vl53l0x_write, .read = vl53l0x_read, .irq_pin = -1,
+};
+
+sim_i2c_device_t *sim_vl53l0x_device(void)
+{
+    memset(&s_l0x, 0, sizeof s_l0x);
+    s_l0x.regs[0xC0] = 0xEE;
+    return &s_l0x_dev;
+}
+
+// --- VL53L1X: registradores de 16 bits; ranging temporizado pelo período intermedição ---
+
+#define L1X_OSC_CAL 0x01A0u
+
+typedef struct {
+    uint8_t regs[0x0111];   // até IDENTIFICATION__MODEL_ID (0x010F..0x0110)
+    uint16_t ptr;
+    bool ranging;
+    uint64_t last_us;
+    uint8_t stream;
+} vl53l1x_model_t;
+
+static vl53l1x_model_t s_l1x;
+
+static uint32_t vl53l1x_period_us(void)
+{
+    uint32_t raw = ((uint32_t)s_l1x.regs[0x6C] << 24) | ((uint32_t)s_l1x.regs[0x6D] << 16) |
+                   ((uint32_t)s_l1x.regs[0x6E] << 8) | s_l1x.regs[0x6F];
+    uint32_t ms = raw / L1X_OSC_CAL;
+    return (ms ? ms : 50u) * 1000u;
+}
+
+static sim_i2c_device_t s_l1x_dev;
+
+// GPIO1: GPIO_HV_MUX__CTRL bit 4 = 1 -> ativo em nível baixo
+static void vl53l1x_update_gpio1(void)
+{
+    if (s_l1x_dev.irq_pin < 0) return;
+    bool active = (s_l1x.regs[0x88] & 0x01) != 0;
+    bool active_low = (s_l1x.regs[0x30] & 0x10) != 0;
+    sim_gpio_drive((uint)s_l1x_dev.irq_pin, active_low ? !active : active);
+}
+
+// Conclui as medições que venceram desde a última consulta
+static void vl53l1x_advance(void)
+{
+    if (!s_l1x.ranging) return;
+    uint64_t now = time_us_64();
+    if (now - s_l1x.last_us < vl53l1x_period_us()) return;
+    s_l1x.last_us = now;
+    // O driver aplica o ganho 2011/2048 sobre o valor bruto
+    uint16_t raw = (uint16_t)(((uint32_t)sim_env_distance_mm() * 2048u + 1005u) / 2011u);
+    s_l1x.regs[0x89] = 0x09;               // RangeValid
+    s_l1x.regs[0x8B] = ++s_l1x.stream;
+    s_l1x.regs[0x96] = (uint8_t)(raw >> 8);
+    s_l1x.regs[0x97] = (uint8_t)raw;
+    s_l1x.regs[0x88] |= 0x01;              // nova medição
+    vl53l1x_update_gpio1();
+}
+
+static void vl53l1x_tick(sim_i2c_device_t *dev)
+{
+    (void)dev;
+    vl53l1x_advance();
+}
+
+static bool vl53l1x_write(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)dev;
+    (void)nostop;
+    if (len < 2) return true;
+    s_l1x.ptr = (uint16_t)((src[0] << 8) | src[1]);
+    for (size_t i = 2; i < len; ++i) {
+        uint16_t reg = (uint16_t)(s_l1x.ptr + i - 2);
+        if (reg >= sizeof s_l1x.regs) continue;
+        s_l1x.regs[reg] = src[i];
+        if (reg == 0x0086 && (src[i] & 0x01)) {
+            s_l1x.regs[0x88] &= (uint8_t)~0x01;
+            vl53l1x_update_gpio1();
+        }
+        if (reg == 0x0087) {
+            s_l1x.ranging = (src[i] & 0x40) != 0;
+            s_l1x.last_us = time_us_64();
+        }
+    }
+    return true;
+}
+
+static bool vl53l1x_read(sim_i2c_device_t *dev, uint8_t *dst, size_t len)
+{
+    (void)dev;
+    vl53l1x_advance();
+    for (size_t i = 0; i < len; ++i) {
+        uint16_t reg = (uint16_t)(s_l1x.ptr + i);
+        dst[i] = reg < sizeof s_l1x.regs ? s_l1x.regs[reg] : 0;
+    }
+    s_l1x.ptr = (uint16_t)(s_l1x.ptr + len);
+    return true;
+}
+
+static sim_i2c_device_t s_l1x_dev = {
+    .name = "VL53L1X", .bus = 1, .addr = 0x29, .sda = 2, .scl = 3,
+    .write = vl53l1x_write, .read = vl53l1x_read,
+    .tick = vl53l1x_tick, .irq_pin = 4,
+};
+
+sim_i2c_device_t *sim_vl53l1x_device(bool irq_line)
+{
+    s_l1x_dev.irq_pin = irq_line ? 4 : -1;
+    memset(&s_l1x, 0, sizeof s_l1x);
+    s_l1x.regs[0x06] = 0xB8;   // FAST_OSC_FREQUENCY
+    s_l1x.regs[0x07] = 0x9A;
+    s_l1x.regs[0xDE] = (uint8_t)(L1X_OSC_CAL >> 8);
+    s_l1x.regs[0xDF] = (uint8_t)L1X_OSC_CAL;
+    s_l1x.regs[0x30] = 0x01;   // GPIO_HV_MUX__CTRL: ativo em nível alto após o boot
+    s_l1x.regs[0x10F] = 0xEA;  // model ID
+    s_l1x.regs[0x110] = 0xCC;  // module type
+    return &s_l1x_dev;
+}
+
+// --- MAX30101: FIFO de 32 amostras (RED + IR, 3 bytes cada), INT dreno aberto ativo em nível baixo ---
+
+#define MAX_FIFO_DEPTH 32
+#define MAX_SAMPLE_US  40000   // 100 Hz com média de 4
+
+typedef struct {
+    uint8_t regs[256];
+    uint8_t ptr;
+    uint32_t fifo[MAX_FIFO_DEPTH][2];
+    uint8_t count;
+    uint8_t byte_idx;          // byte da amostra corrente numa leitura de FIFO_DATA
+    uint64_t last_us;
+    float phase;               // fase do batimento, 0..1
+    uint32_t rng;
+} max30101_model_t;
+
+static max30101_model_t s_max;
+static sim_i2c_device_t s_max_dev;
+
+static void max30101_reset_regs(void)
+{
+    memset(s_max.regs, 0, sizeof s_max.regs);
+    s_max.regs[0xFF] = 0x15;   // PART_ID
+    s_max.regs[0x00] = 0x01;   // PWR_RDY
+    s_max.count = 0;
+    s_max.byte_idx = 0;
+}
+
+static void max30101_update_int(void)
+{
+    if (s_max_dev.irq_pin < 0) return;
+    bool active = (s_max.regs[0x00] & s_max.regs[0x02] & 0xE0) != 0;
+    sim_gpio_drive((uint)s_max_dev.irq_pin, !active);
+}
+
+// Forma de onda de pulso (sístole + incisura dicrótica) com ruído pequeno
+static float max30101_pulse(void)
+{
+    float p = sinf(2.0f * SIM_PI * s_max.phase) + 0.3f * sinf(4.0f * SIM_PI * s_max.phase);
+    s_max.rng = s_max.rng * 1103515245u + 12345u;
+    return p + ((float)((s_max.rng >> 16) & 0xFF) - 127.5f) / 2550.0f;
+}
+
+static void max30101_push(void)
+{
+    s_max.phase += sim_env_heart_bpm() / 60.0f * (MAX_SAMPLE_US / 1e6f);
+    if (s_max.phase >= 1.0f) s_max.phase -= 1.0f;
+    float p = max30101_pulse();
+    float r = (110.0f - sim_env_spo2()) / 25.0f;
+
+    if (s_max.count == MAX_FIFO_DEPTH) {      // rollover desabilitado: amostra perdida
+        if ((s_max.regs[0x05] & 0x1F) < 0x1F) s_max.regs[0x05]++;
+        return;
+    }
+    uint8_t wr = s_max.regs[0x04] & 0x1F;
+    s_max.fifo[wr][0] = (uint32_t)(90000.0f * (1.0f - 0.02f * r * p)) & 0x3FFFF;   // RED
+    s_max.fifo[wr][1] = (uint32_t)(120000.0f * (1.0f - 0.02f * p)) & 0x3FFFF;      // IR
+    s_max.regs[0x04] = (wr + 1) & 0x1F;
+    s_max.count++;
+
+    uint8_t free_slots = s_max.regs[0x08] & 0x0F;
+    if (s_max.count == MAX_FIFO_DEPTH - free_slots) {
+        s_max.regs[0x00] |= 0x80;             // A_FULL
+        max30101_update_int();
+    }
+}
+
+static void max30101_advance(void)
+{
+    uint64_t now = time_us_64();
+    if ((s_max.regs[0x09] & 0x07) != 0x03) {  // fora do modo SpO2 não amostra
+        s_max.last_us = now;
+        return;
+    }
+    while (now - s_max.last_us >= MAX_SAMPLE_US) {
+        s_max.last_us += MAX_SAMPLE_US;
+        max30101_push();
+    }
+}
+
+static void max30101_tick(sim_i2c_device_t *dev)
+{
+    (void)dev;
+    max30101_advance();
+}
+
+static bool max30101_write(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)dev;
+    (void)nostop;
+    if (len == 0) return true;
+    s_max.ptr = src[0];
+    s_max.byte_idx = 0;
+    for (size_t i = 1; i < len; ++i) {
+        uint8_t reg = (uint8_t)(s_max.ptr + i - 1);
+        if (reg == 0x09 && (src[i] & 0x40)) {
+            max30101_reset_regs();
+            max30101_update_int();
+            continue;
+        }
+        s_max.regs[reg] = src[i];
+        if (reg >= 0x04 && reg <= 0x06)
+            s_max.count = (uint8_t)((s_max.regs[0x04] - s_max.regs[0x06]) & 0x1F);
+        if (reg == 0x09)
+            s_max.last_us = time_us_64();
+        if (reg == 0x02)
+            max30101_update_int();
+    }
+    return true;
+}
+
+static uint8_t max30101_fifo_byte(void)
+{
+    if (s_max.count == 0) return 0;
+    uint8_t rd = s_max.regs[0x06] & 0x1F;
+    uint32_t v = s_max.fifo[rd][s_max.byte_idx / 3];
+    uint8_t b = (uint8_t)(v >> (8 * (2 - s_max.byte_idx % 3)));
+    if (++s_max.byte_idx == 6) {
+        s_max.byte_idx = 0;
+        s_max.regs[0x06] = (rd + 1) & 0x1F;
+        s_max.count--;
+        s_max.regs[0x05] = 0;                 // OVF_COUNTER zera a cada amostra retirada
+    }
+    return b;
+}
+
+static bool max30101_read(sim_i2c_device_t *dev, uint8_t *dst, size_t len)
+{
+    (void)dev;
+    max30101_advance();
+    for (size_t i = 0; i < len; ++i) {
+        if (s_max.ptr == 0x07) {              // FIFO_DATA não auto-incrementa
+            dst[i] = max30101_fifo_byte();
+            continue;
+        }
+        dst[i] = s_max.regs[s_max.ptr];
+        if (s_max.ptr <= 0x01) {              // status limpa na leitura
+            s_max.regs[s_max.ptr] = 0;
+            max30101_update_int();
+        }
+        s_max.ptr++;
+    }
+    return true;
+}
+
+static sim_i2c_device_t s_max_dev = {
+    .name = "MAX30101", .bus = 1, .addr = 0x57, .sda = 2, .scl = 3,
+    .write = max30101_write, .read = max30101_read,
+    .tick = max30101_tick, .irq_pin = 8,
+};
+
+sim_i2c_device_t *sim_max30101_device(bool irq_line)
+{
+    s_max_dev.irq_pin = irq_line ? 8 : -1;
+    memset(&s_max, 0, sizeof s_max);
+    s_max.rng = 1;
+    max30101_reset_regs();
+    return &s_max_dev;
+}
+
+// --- SSD1306: bytes de controle Co/D-C (0x80/0x00 comandos, 0xC0/0x40 GDDRAM), endereçamento horizontal ---
+
+typedef struct {
+    uint8_t gddram[8][128];
+    uint8_t cmd[3];
+    uint8_t cmd_len;
+    uint8_t col_start, col_end, page_start, page_end;
+    uint8_t col, page;
+    uint32_t data_bytes;
+    uint32_t windows;    // janelas completadas (retorno ao início da área 0x21/0x22)
+} ssd1306_model_t;
+
+static ssd1306_model_t s_oled;
+
+static uint8_t ssd1306_cmd_args(uint8_t op)
+{
+    switch (op) {
+    case 0x21: case 0x22:
+        return 2;
+    case 0x20: case 0x81: case 0x8D: case 0xA8: case 0xD3: case 0xD5: case 0xD9: case 0xDA: case 0xDB:
+        return 1;
+    default:
+        return 0;
+    }
+}
+
+static void ssd1306_command(uint8_t b)
+{
+    s_oled.cmd[s_oled.cmd_len++] = b;
+    if (s_oled.cmd_len <= ssd1306_cmd_args(s_oled.cmd[0]))
+        return;
+    if (s_oled.cmd[0] == 0x21) {
+        s_oled.col_start = s_oled.col = s_oled.cmd[1] & 0x7F;
+        s_oled.col_end = s_oled.cmd[2] & 0x7F;
+    } else if (s_oled.cmd[0] == 0x22) {
+        s_oled.page_start = s_oled.page = s_oled.cmd[1] & 0x07;
+        s_oled.page_end = s_oled.cmd[2] & 0x07;
+    }
+    s_oled.cmd_len = 0;
+}
+
+static void ssd1306_data(uint8_t b)
+{
+    s_oled.gddram[s_oled.page][s_oled.col] = b;
+    s_oled.data_bytes++;
+    if (s_oled.col++ < s_oled.col_end) return;
+    s_oled.col = s_oled.col_start;
+    if (s_oled.page++ < s_oled.page_end) return;
+    s_oled.page = s_oled.page_start;
+    s_oled.windows++;
+}
+
+static bool ssd1306_write(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop)
+{
+    (void)dev;
+    (void)nostop;
+    size_t i = 0;
+    while (i < len) {
+        uint8_t ctrl = src[i++];
+        bool data = (ctrl & 0x40) != 0;
+        // Co=1: só o próximo byte usa este controle; depois vem outro byte de controle
+        size_t fim = (ctrl & 0x80) ? (i < len ? i + 1 : len) : len;
+        for (; i < fim; ++i) {
+            if (data)
+                ssd1306_data(src[i]);
+            else
+                ssd1306_command(src[i]);
+        }
+    }
+    return true;
+}
+
+static bool ssd1306_read(sim_i2c_device_t *dev, uint8_t *dst, size_t len)
+{
+    (void)dev;
+    memset(dst, 0, len);   // byte de status: display ligado, sem busy
+    return true;
+}
+
+static sim_i2c_device_t s_oled_dev = {
+    .name = "SSD1306", .bus = 1, .addr = 0x3C, .sda = 14, .scl = 15,
+    .write = ssd1306_write, .read = ssd1306_read, .irq_pin = -1,
+};
+
+sim_i2c_device_t *sim_ssd1306_device(void)
+{
+    memset(&s_oled, 0, sizeof s_oled);
+    s_oled.col_end = 127;
+    s_oled.page_end = 7;
+    return &s_oled_dev;
+}
+
+uint32_t sim_ssd1306_windows(void)
+{
+    return s_oled.windows;
+}
+
+uint32_t sim_ssd1306_data_bytes(void)
+{
+    return s_oled.data_bytes;
+}
+
+const uint8_t *sim_ssd1306_gddram(void)
+{
+    return &s_oled.gddram[0][0];
+}
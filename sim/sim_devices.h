@@ -0,0 +1,30 @@
+#pragma once
+
+#include "sim_i2c.h"
+
+// Modelos de registradores dos periféricos da placa, ligados nos mesmos pinos do hardware real:
+//   BMP280  -> i2c0 GP0/GP1 @0x76
+//   VL53L0X -> i2c1 GP2/GP3 @0x29 (ou VL53L1X no mesmo endereço)
+//   SSD1306 -> i2c1 GP14/GP15 @0x3C
+//   MAX30101 -> i2c1 GP2/GP3 @0x57, INT em GP8
+sim_i2c_device_t *sim_bmp280_device(void);
+sim_i2c_device_t *sim_vl53l0x_device(void);
+// irq_line=false deixa GPIO1 desconectado (o firmware cai para consulta periódica)
+sim_i2c_device_t *sim_vl53l1x_device(bool irq_line);
+sim_i2c_device_t *sim_ssd1306_device(void);
+// MAX30101 em i2c1 GP2/GP3 @0x57; irq_line=false deixa INT (GP8) desconectado
+sim_i2c_device_t *sim_max30101_device(bool irq_line);
+
+// Ambiente simulado (função do tempo desde o boot)
+float sim_env_temperature_c(void);
+uint16_t sim_env_distance_mm(void);
+float sim_env_heart_bpm(void);
+float sim_env_spo2(void);
+// Congela temperatura, distância e pulso de ini a ini+dur segundos (exercita o relato por exceção)
+void sim_env_hold(uint32_t ini_s, uint32_t dur_s);
+
+// Janelas de GDDRAM completadas e bytes de dados recebidos pelo display
+uint32_t sim_ssd1306_windows(void);
+uint32_t sim_ssd1306_data_bytes(void);
+// GDDRAM do modelo, 8 páginas x 128 colunas
+const uint8_t *sim_ssd1306_gddram(void);
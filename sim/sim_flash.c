@@ -0,0 +1,90 @@
+#include <string.h>
+#include "pico/flash.h"
+#include "hardware/flash.h"
+#include "sim_flash.h"
+
+uint8_t sim_flash_mem[PICO_FLASH_SIZE_BYTES];
+
+static bool s_off;
+static uint32_t s_cut;
+static uint32_t s_programs;
+static uint32_t s_erases[PICO_FLASH_SIZE_BYTES / FLASH_SECTOR_SIZE];
+
+void sim_flash_reset(void)
+{
+    memset(sim_flash_mem, 0xFF, sizeof sim_flash_mem);
+    memset(s_erases, 0, sizeof s_erases);
+    s_programs = 0;
+    sim_flash_power_on();
+}
+
+int flash_safe_execute(void (*func)(void *), void *param, uint32_t enter_exit_timeout_ms)
+{
+    (void)enter_exit_timeout_ms;
+    if (s_off) return PICO_ERROR_GENERIC;
+    func(param);
+    return s_off ? PICO_ERROR_GENERIC : PICO_OK;
+}
+
+void flash_range_erase(uint32_t flash_offs, size_t count)
+{
+    if (s_off || flash_offs % FLASH_SECTOR_SIZE || count % FLASH_SECTOR_SIZE ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        return;
+    memset(&sim_flash_mem[flash_offs], 0xFF, count);
+    for (uint32_t s = flash_offs / FLASH_SECTOR_SIZE; s < (flash_offs + count) / FLASH_SECTOR_SIZE; ++s)
+        s_erases[s]++;
+}
+
+void flash_range_program(uint32_t flash_offs, const uint8_t *data, size_t count)
+{
+    if (s_off || flash_offs % FLASH_PAGE_SIZE || count % FLASH_PAGE_SIZE ||
+        flash_offs + count > PICO_FLASH_SIZE_BYTES)
+        return;
+    s_programs++;
+    size_t n = count;
+    if (s_cut && --s_cut == 0) {
+        // Energia cai no meio dos bytes que estavam sendo alterados
+        size_t ini = 0, fim = count;
+        while (ini < count && data[ini] == 0xFF) ini++;
+        while (fim > ini && data[fim - 1] == 0xFF) fim--;
+        n = (ini + fim) / 2;
+        s_off = true;
+    }
+    // NOR: programar só zera bits
+    for (size_t i = 0; i < n; ++i)
+        sim_flash_mem[flash_offs + i] &= data[i];
+}
+
+void sim_flash_cut_after(uint32_t programs)
+{
+    s_cut = programs;
+}
+
+void sim_flash_power_on(void)
+{
+    s_off = false;
+    s_cut = 0;
+}
+
+bool sim_flash_powered(void)
+{
+    return !s_off;
+}
+
+void sim_flash_erase_range_stats(uint32_t offset, uint32_t size, uint32_t *min, uint32_t *max, uint64_t *total)
+{
+    *min = UINT32_MAX;
+    *max = 0;
+    *total = 0;
+    for (uint32_t s = offset / FLASH_SECTOR_SIZE; s < (offset + size) / FLASH_SECTOR_SIZE; ++s) {
+        if (s_erases[s] < *min) *min = s_erases[s];
+        if (s_erases[s] > *max) *max = s_erases[s];
+        *total += s_erases[s];
+    }
+}
+
+uint32_t sim_flash_programs(void)
+{
+    return s_programs;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Controle da flash simulada (sim_flash.c) pelos testes do host
+
+// Flash virgem (tudo em 0xFF) e contadores zerados; chamar antes do primeiro uso
+void sim_flash_reset(void);
+
+// Corta a energia durante a n-ésima programação a partir de agora (1 = a próxima):
+// só metade dos bytes alterados é gravada e toda operação seguinte falha até sim_flash_power_on()
+void sim_flash_cut_after(uint32_t programs);
+void sim_flash_power_on(void);
+bool sim_flash_powered(void);
+
+// Apagamentos por setor na faixa [offset, offset + size)
+void sim_flash_erase_range_stats(uint32_t offset, uint32_t size, uint32_t *min, uint32_t *max, uint64_t *total);
+uint32_t sim_flash_programs(void);
@@ -0,0 +1,141 @@
+#include <stdio.h>
+#include <string.h>
+#include "hardware/i2c.h"
+#include "sim_i2c.h"
+
+#define SIM_I2C_MAX_DEVICES 8
+
+i2c_inst_t sim_i2c_inst[2] = {{0, 100000}, {1, 100000}};
+
+static sim_i2c_device_t *s_devices[SIM_I2C_MAX_DEVICES];
+static size_t s_num_devices;
+static sim_i2c_bus_stats_t s_bus_stats[2];
+static bool s_realtime = true;
+
+void sim_i2c_attach(sim_i2c_device_t *dev)
+{
+    if (s_num_devices < SIM_I2C_MAX_DEVICES)
+        s_devices[s_num_devices++] = dev;
+}
+
+void sim_i2c_set_realtime(bool realtime)
+{
+    s_realtime = realtime;
+}
+
+const sim_i2c_bus_stats_t *sim_i2c_bus_stats(unsigned bus)
+{
+    return bus < 2 ? &s_bus_stats[bus] : NULL;
+}
+
+// No RP2040 o par (SDA, SCL) pertence ao controlador (gpio / 2) % 2
+static bool pin_routes_to(uint8_t pin, unsigned bus)
+{
+    return gpio_get_function(pin) == GPIO_FUNC_I2C && ((pin >> 1) & 1u) == bus;
+}
+
+static sim_i2c_device_t *find_device(i2c_inst_t *i2c, uint8_t addr)
+{
+    for (size_t i = 0; i < s_num_devices; ++i) {
+        sim_i2c_device_t *d = s_devices[i];
+        if (d->bus == i2c->index && d->addr == addr &&
+            pin_routes_to(d->sda, d->bus) && pin_routes_to(d->scl, d->bus))
+            return d;
+    }
+    return NULL;
+}
+
+// Start + endereço + len bytes, 9 clocks por byte (8 bits + ACK)
+static void account_bus_time(i2c_inst_t *i2c, sim_i2c_device_t *dev, size_t len)
+{
+    uint baud = i2c->baudrate ? i2c->baudrate : 100000;
+    uint64_t us = ((uint64_t)(len + 1) * 9u * 1000000u + baud - 1) / baud;
+    sim_i2c_bus_stats_t *st = &s_bus_stats[i2c->index];
+    st->transactions++;
+    st->bytes += (uint32_t)len;
+    st->bus_time_us += us;
+    if (dev) {
+        dev->bytes += (uint32_t)len;
+        dev->bus_time_us += us;
+    }
+    if (s_realtime)
+        sleep_us(us);
+}
+
+uint i2c_init(i2c_inst_t *i2c, uint baudrate)
+{
+    return i2c_set_baudrate(i2c, baudrate);
+}
+
+void i2c_deinit(i2c_inst_t *i2c)
+{
+    (void)i2c;
+}
+
+uint i2c_set_baudrate(i2c_inst_t *i2c, uint baudrate)
+{
+    if (i2c->baudrate != baudrate)
+        s_bus_stats[i2c->index].baud_changes++;
+    i2c->baudrate = baudrate;
+    return baudrate;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop)
+{
+    sim_i2c_device_t *dev = find_device(i2c, addr);
+    account_bus_time(i2c, dev, dev ? len : 0);
+    if (!dev || !dev->write || !dev->write(dev, src, len, nostop)) {
+        s_bus_stats[i2c->index].nacks++;
+        return PICO_ERROR_GENERIC;
+    }
+    dev->writes++;
+    return (int)len;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop)
+{
+    (void)nostop;
+    sim_i2c_device_t *dev = find_device(i2c, addr);
+    account_bus_time(i2c, dev, dev ? len : 0);
+    if (!dev || !dev->read || !dev->read(dev, dst, len)) {
+        s_bus_stats[i2c->index].nacks++;
+        return PICO_ERROR_GENERIC;
+    }
+    dev->reads++;
+    return (int)len;
+}
+
+int i2c_write_timeout_us(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop, uint timeout_us)
+{
+    (void)timeout_us;
+    return i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+int i2c_read_timeout_us(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop, uint timeout_us)
+{
+    (void)timeout_us;
+    return i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
+
+void sim_i2c_tick(void)
+{
+    for (size_t i = 0; i < s_num_devices; ++i)
+        if (s_devices[i]->tick)
+            s_devices[i]->tick(s_devices[i]);
+}
+
+void sim_i2c_report(void)
+{
+    for (unsigned b = 0; b < 2; ++b) {
+        const sim_i2c_bus_stats_t *st = &s_bus_stats[b];
+        printf("[SIM] i2c%u: %lu transações, %lu NACKs, %lu bytes, %llu us de barramento, %lu trocas de baud\n",
+               b, (unsigned long)st->transactions, (unsigned long)st->nacks, (unsigned long)st->bytes,
+               (unsigned long long)st->bus_time_us, (unsigned long)st->baud_changes);
+    }
+    for (size_t i = 0; i < s_num_devices; ++i) {
+        const sim_i2c_device_t *d = s_devices[i];
+        printf("[SIM]   %-8s i2c%u@0x%02X (GP%u/GP%u): %lu escritas, %lu leituras, %lu bytes, %llu us\n",
+               d->name, d->bus, d->addr, d->sda, d->scl, (unsigned long)d->writes, (unsigned long)d->reads,
+               (unsigned long)d->bytes, (unsigned long long)d->bus_time_us);
+    }
+}
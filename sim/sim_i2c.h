@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Barramento I2C virtual da simulação.
+// Cada dispositivo é um "backend" plugável com o mapa de registradores emulado;
+// ele só responde quando seus pinos SDA/SCL estão na função I2C (como no RP2040,
+// onde GP2/3 e GP14/15 disputam o mesmo controlador I2C1).
+
+typedef struct sim_i2c_device sim_i2c_device_t;
+
+struct sim_i2c_device {
+    const char *name;
+    uint8_t bus;   // 0 = i2c0, 1 = i2c1
+    uint8_t addr;  // endereço de 7 bits
+    uint8_t sda;
+    uint8_t scl;
+    // Escrita do mestre (ponteiro de registrador + dados). nostop = repeated start a seguir.
+    bool (*write)(sim_i2c_device_t *dev, const uint8_t *src, size_t len, bool nostop);
+    // Leitura do mestre a partir do ponteiro de registrador atual
+    bool (*read)(sim_i2c_device_t *dev, uint8_t *dst, size_t len);
+    // Avanço de tempo do modelo (conversões, linhas de interrupção); opcional
+    void (*tick)(sim_i2c_device_t *dev);
+    int8_t irq_pin;   // GPIO ligado à saída de interrupção do dispositivo (-1 = nenhum)
+    void *ctx;
+
+    // Estatísticas mantidas pelo barramento
+    uint32_t writes;
+    uint32_t reads;
+    uint32_t bytes;
+    uint64_t bus_time_us;
+};
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t nacks;
+    uint32_t bytes;
+    uint64_t bus_time_us;
+    uint32_t baud_changes;
+} sim_i2c_bus_stats_t;
+
+void sim_i2c_attach(sim_i2c_device_t *dev);
+// Tempo de barramento emulado em tempo real (sleep) ou apenas contabilizado
+void sim_i2c_set_realtime(bool realtime);
+const sim_i2c_bus_stats_t *sim_i2c_bus_stats(unsigned bus);
+void sim_i2c_report(void);
+// Chamado periodicamente pela tarefa SimHW da simulação
+void sim_i2c_tick(void);
@@ -0,0 +1,310 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "sim_pico.h"
+#include "sim_i2c.h"
+#include "sim_devices.h"
+#include "sim_mqtt.h"
+#include "sim_trace.h"
+#include "vl53l1x_ranging.h"
+#include "max30101_ppg.h"
+#include "i2c_bus.h"
+#include "ssd1306.h"
+#include "telemetry_decode.h"
+#include "journal.h"
+#include "rbe.h"
+#include "dev_config.h"
+#include "net_conn.h"
+#include "power_save.h"
+#include "sim_flash.h"
+#include "hardware/flash.h"
+
+// Simulação do firmware no host.
+//   ./blink_sim [segundos]         (padrão: 60)
+// Variáveis de ambiente:
+//   SIM_TOF=l0x|l1x|none           sensor ToF presente em GP2/GP3 (padrão: l1x)
+//   SIM_I2C_REALTIME=0             não dorme o tempo de barramento I2C, apenas contabiliza
+//   SIM_TOF_IRQ=0                  linha GPIO1 do VL53L1X desligada (exercita a consulta de fallback)
+//   SIM_PPG=0                      sem MAX30101 em GP2/GP3
+//   SIM_PPG_IRQ=0                  linha INT do MAX30101 desligada (FIFO lida por consulta)
+//   SIM_MQTT_OUTAGE=ini:dur        broker fora do ar de ini a ini+dur segundos (exercita o diário em flash)
+//   SIM_WIFI_OUTAGE=ini:dur        AP fora do ar de ini a ini+dur segundos (enlace e broker caem juntos)
+//   SIM_ENV_HOLD=ini:dur           ambiente parado de ini a ini+dur segundos (exercita o relato por exceção)
+//   SIM_CONFIG='t:{json}'          comando de configuração entregue em pico_w/config/set aos t segundos
+
+int blink_main(void);
+
+// Definidos em blink.c
+extern journal_t diario;
+extern rbe_t filtroRelato;
+
+static uint32_t s_duration_s = 60;
+
+// Lotes CBOR conferidos com o decodificador do backend
+static uint32_t s_cbor_lotes, s_cbor_amostras, s_cbor_erros;
+static uint64_t s_cbor_bytes;
+
+// Números de sequência recebidos pelo "backend": repetidos e faltantes
+#define SIM_SEQ_MAX (1u << 16)
+static uint8_t s_seq_visto[SIM_SEQ_MAX / 8];
+static uint32_t s_seq_unicos, s_seq_repetidos, s_seq_max;
+static uint32_t s_outage_ini, s_outage_dur;
+static uint32_t s_wifi_ini, s_wifi_dur;
+// Comando de SIM_CONFIG e respostas recebidas em DEV_CONFIG_TOPIC_RESP
+static uint32_t s_config_t;
+static const char *s_config_cmd;
+static uint32_t s_config_respostas;
+// Último registro de diagnóstico recebido (inc/diag.c)
+static diag_decoded_t s_diag;
+static uint32_t s_diag_registros, s_diag_erros, s_diag_bytes_max;
+
+static void sim_seq(uint32_t seq)
+{
+    if (seq >= SIM_SEQ_MAX) return;
+    if (s_seq_visto[seq / 8] & (1u << (seq % 8))) {
+        s_seq_repetidos++;
+        return;
+    }
+    s_seq_visto[seq / 8] |= (uint8_t)(1u << (seq % 8));
+    s_seq_unicos++;
+    sim_trace_sample_published(seq);
+    if (seq > s_seq_max) s_seq_max = seq;
+}
+
+static void sim_on_publish(const char *topic, const void *payload, size_t len)
+{
+    if (strcmp(topic, TELEMETRY_TOPIC_CBOR) == 0) {
+        telemetry_decoded_t d;
+        if (telemetry_decode_cbor(payload, len, &d) == len) {
+            s_cbor_lotes++;
+            s_cbor_amostras += (uint32_t)d.count;
+            s_cbor_bytes += len;
+            for (size_t i = 0; i < d.count; ++i)
+                sim_seq(d.samples[i].seq);
+        } else {
+            s_cbor_erros++;
+        }
+    } else if (strcmp(topic, DIAG_TOPIC) == 0) {
+        if (diag_decode_cbor(payload, len, &s_diag) == len) {
+            s_diag_registros++;
+            if (len > s_diag_bytes_max) s_diag_bytes_max = (uint32_t)len;
+        } else {
+            s_diag_erros++;
+        }
+    } else if (strcmp(topic, DEV_CONFIG_TOPIC_RESP) == 0) {
+        s_config_respostas++;
+        printf("[SIM] Resposta de configuração: %.*s\n", (int)len, (const char *)payload);
+    } else if (strcmp(topic, TELEMETRY_TOPIC_JSON) == 0) {
+        char buf[256];
+        unsigned long seq;
+        size_t n = len < sizeof buf - 1 ? len : sizeof buf - 1;
+        memcpy(buf, payload, n);
+        buf[n] = '\0';
+        if (sscanf(buf, "{\"seq\": %lu", &seq) == 1)
+            sim_seq((uint32_t)seq);
+    }
+}
+
+// Queda do broker programada por SIM_MQTT_OUTAGE
+static void tarefaSimRede(void *pvParameters)
+{
+    (void)pvParameters;
+    vTaskDelay(pdMS_TO_TICKS(s_outage_ini * 1000u));
+    printf("[SIM] Broker fora do ar por %lu s\n", (unsigned long)s_outage_dur);
+    sim_mqtt_set_online(0);
+    vTaskDelay(pdMS_TO_TICKS(s_outage_dur * 1000u));
+    printf("[SIM] Broker de volta\n");
+    sim_mqtt_set_online(1);
+    vTaskDelete(NULL);
+}
+
+// Queda do AP programada por SIM_WIFI_OUTAGE: sem enlace o broker também some
+static void tarefaSimWifi(void *pvParameters)
+{
+    (void)pvParameters;
+    vTaskDelay(pdMS_TO_TICKS(s_wifi_ini * 1000u));
+    printf("[SIM] AP fora do ar por %lu s\n", (unsigned long)s_wifi_dur);
+    sim_wifi_set_up(0);
+    sim_mqtt_set_online(0);
+    vTaskDelay(pdMS_TO_TICKS(s_wifi_dur * 1000u));
+    printf("[SIM] AP de volta\n");
+    sim_wifi_set_up(1);
+    sim_mqtt_set_online(1);
+    vTaskDelete(NULL);
+}
+
+// Comando de configuração programado por SIM_CONFIG, como se viesse do backend
+static void tarefaSimConfig(void *pvParameters)
+{
+    (void)pvParameters;
+    vTaskDelay(pdMS_TO_TICKS(s_config_t * 1000u));
+    printf("[SIM] Comando de configuração: %s\n", s_config_cmd);
+    if (!sim_mqtt_inject(DEV_CONFIG_TOPIC_SET, s_config_cmd, strlen(s_config_cmd)))
+        printf("[SIM] Comando não entregue (sem sessão ou sem assinatura)\n");
+    vTaskDelete(NULL);
+}
+
+// Faz o papel do tempo de hardware: avança os modelos e entrega as bordas de GPIO (IO_IRQ_BANK0)
+static void tarefaSimHW(void *pvParameters)
+{
+    (void)pvParameters;
+    while (1)
+    {
+        sim_i2c_tick();
+        vTaskDelay(1);
+    }
+}
+
+static void tarefaSimMonitor(void *pvParameters)
+{
+    (void)pvParameters;
+    vTaskDelay(pdMS_TO_TICKS(s_duration_s * 1000u));
+
+    vTaskSuspendAll();
+    printf("\n========== RELATÓRIO DA SIMULAÇÃO (%lu s) ==========\n", (unsigned long)s_duration_s);
+    sim_trace_report();
+    sim_mqtt_report();
+    sim_i2c_report();
+    if (s_cbor_lotes || s_cbor_erros)
+        printf("[SIM] Telemetria CBOR: %lu lotes, %lu amostras decodificadas (%.1f B/amostra), %lu inválidos\n",
+               (unsigned long)s_cbor_lotes, (unsigned long)s_cbor_amostras,
+               s_cbor_amostras ? (double)s_cbor_bytes / s_cbor_amostras : 0.0, (unsigned long)s_cbor_erros);
+    if (s_seq_unicos)
+        printf("[SIM] Sequência: %lu amostras únicas publicadas, %lu repetidas, %lu faltando até seq %lu\n",
+               (unsigned long)s_seq_unicos, (unsigned long)s_seq_repetidos,
+               (unsigned long)(s_seq_max + 1 - s_seq_unicos), (unsigned long)s_seq_max);
+    net_conn_stats_t net;
+    net_conn_get_stats(&net);
+    printf("[SIM] Conexão: %lu sessões (%lu reconexões), %lu quedas; falhas: %lu Wi-Fi, %lu DNS, %lu conexão, "
+           "%lu recusas, %lu assinatura; tempo até conectar: último %lu ms, máx %lu ms, médio %lu ms\n",
+           (unsigned long)net.sessions, (unsigned long)net.reconnects, (unsigned long)net.drops,
+           (unsigned long)net.wifi_failures, (unsigned long)net.dns_failures, (unsigned long)net.connect_failures,
+           (unsigned long)net.refused, (unsigned long)net.subscribe_failures, (unsigned long)net.last_connect_ms,
+           (unsigned long)net.max_connect_ms, (unsigned long)(net.sessions ? net.total_connect_ms / net.sessions : 0));
+    power_save_stats_t en;
+    power_save_get_stats(&en);
+    uint32_t en_ms = en.radio_awake_ms + en.radio_ps_ms;
+    printf("[SIM] Energia (baixo consumo %s): rádio acordado %lu ms, em economia %lu ms, %lu rajadas; "
+           "%lu mensagens, %lu B, %lu us no ar; núcleos %lu ms ocupados, %lu ms ociosos; "
+           "carga estimada %lu mA·s (%.1f mA médios)\n",
+           en.low_power ? "ligado" : "desligado", (unsigned long)en.radio_awake_ms, (unsigned long)en.radio_ps_ms,
+           (unsigned long)en.bursts, (unsigned long)en.tx_msgs, (unsigned long)en.tx_bytes,
+           (unsigned long)en.airtime_us, (unsigned long)en.core_busy_ms, (unsigned long)en.core_idle_ms,
+           (unsigned long)en.charge_mas, en_ms ? en.charge_mas * 1000.0 / en_ms : 0.0);
+    dev_config_stats_t cfg;
+    dev_config_get_stats(&cfg);
+    printf("[SIM] Configuração: versão %lu, %lu comandos, %lu aplicados, %lu rejeitados, %lu gravações "
+           "(%lu erros), %lu respostas\n",
+           (unsigned long)dev_config_version(), (unsigned long)cfg.commands, (unsigned long)cfg.applied,
+           (unsigned long)cfg.rejected, (unsigned long)cfg.saves, (unsigned long)cfg.save_errors,
+           (unsigned long)s_config_respostas);
+    rbe_stats_t rbe;
+    rbe_get_stats(&filtroRelato, &rbe);
+    printf("[SIM] Relato por exceção: %lu amostras, %lu publicadas (%lu por limiar, %lu batimentos), "
+           "%lu suprimidas; período atual %lu ms\n",
+           (unsigned long)rbe.samples, (unsigned long)rbe.reported, (unsigned long)rbe.crossings,
+           (unsigned long)rbe.heartbeats, (unsigned long)rbe.suppressed, (unsigned long)rbe.period_ms);
+    journal_stats_t jst;
+    journal_get_stats(&diario, &jst);
+    uint32_t er_min, er_max;
+    uint64_t er_total;
+    sim_flash_erase_range_stats(diario.dev ? PICO_FLASH_SIZE_BYTES - diario.dev->size : 0, diario.dev ? diario.dev->size : 0,
+                                &er_min, &er_max, &er_total);
+    printf("[SIM] Diário: %lu anexadas, %lu reenviadas, %lu pendentes, %lu descartadas, %lu corrompidas; "
+           "%lu apagamentos, %lu programações de página\n",
+           (unsigned long)jst.appended, (unsigned long)jst.replayed, (unsigned long)journal_pending(&diario),
+           (unsigned long)jst.dropped, (unsigned long)jst.corrupt, (unsigned long)er_total,
+           (unsigned long)sim_flash_programs());
+    ssd1306_stats_t oled;
+    ssd1306_get_stats(&oled);
+    printf("[SIM] SSD1306: %lu envios, %lu janelas (%lu completadas no display), %lu bytes de GDDRAM, %lu erros\n",
+           (unsigned long)oled.flushes, (unsigned long)oled.windows, (unsigned long)sim_ssd1306_windows(),
+           (unsigned long)sim_ssd1306_data_bytes(), (unsigned long)oled.errors);
+    for (unsigned c = 0; c < 2; ++c) {
+        i2c_bus_stats_t bus;
+        i2c_bus_get_stats(c, &bus);
+        printf("[SIM] Gerenciador I2C%u: %lu transações em %lu rodadas (máx %lu), %lu trocas de pinos\n", c,
+               (unsigned long)bus.transactions, (unsigned long)bus.batches, (unsigned long)bus.max_batch,
+               (unsigned long)bus.remuxes);
+    }
+    vl53l1x_ranging_stats_t tof;
+    vl53l1x_ranging_get_stats(&tof);
+    printf("[SIM] VL53L1X: %lu interrupções, %lu amostras, %lu sobrescritas, %lu consultas de fallback, %lu erros\n",
+           (unsigned long)tof.interrupts, (unsigned long)tof.samples, (unsigned long)tof.overruns,
+           (unsigned long)tof.fallback_polls, (unsigned long)tof.read_errors);
+    max30101_ppg_stats_t ppg;
+    ppg_result_t hr = {0};
+    max30101_ppg_get_stats(&ppg);
+    bool hr_ok = max30101_ppg_latest(&hr);
+    printf("[SIM] MAX30101: %lu interrupções, %lu lotes (máx %lu), %lu amostras, %lu perdidas, %lu consultas de fallback, %lu erros\n",
+           (unsigned long)ppg.interrupts, (unsigned long)ppg.batches, (unsigned long)ppg.max_batch,
+           (unsigned long)ppg.samples, (unsigned long)ppg.overflows, (unsigned long)ppg.fallback_polls,
+           (unsigned long)ppg.read_errors);
+    printf("[SIM]   derivado: %s %.1f bpm, SpO2 %.1f%% (ambiente %.1f bpm, %.1f%%)\n", hr_ok ? "válido" : "inválido",
+           hr.bpm_x10 / 10.0, hr.spo2_x10 / 10.0, sim_env_heart_bpm(), sim_env_spo2());
+    printf("[SIM] Heap livre mínimo: %lu B\n", (unsigned long)xPortGetMinimumEverFreeHeapSize());
+    if (s_diag_registros || s_diag_erros) {
+        printf("[SIM] Diagnóstico: %lu registros (máx %lu B), %lu inválidos; último:\n[SIM]   ",
+               (unsigned long)s_diag_registros, (unsigned long)s_diag_bytes_max, (unsigned long)s_diag_erros);
+        diag_print_json(&s_diag);
+    }
+    fflush(stdout);
+    exit(0);
+}
+
+int main(int argc, char **argv)
+{
+    if (argc > 1)
+        s_duration_s = (uint32_t)strtoul(argv[1], NULL, 10);
+
+    sim_pico_init();
+    sim_flash_reset();
+    sim_trace_init();
+
+    const char *rt = getenv("SIM_I2C_REALTIME");
+    sim_i2c_set_realtime(!(rt && strcmp(rt, "0") == 0));
+
+    sim_i2c_attach(sim_bmp280_device());
+    sim_i2c_attach(sim_ssd1306_device());
+    const char *tof = getenv("SIM_TOF");
+    if (!tof || strcmp(tof, "l1x") == 0) {
+        const char *irq = getenv("SIM_TOF_IRQ");
+        sim_i2c_attach(sim_vl53l1x_device(!(irq && strcmp(irq, "0") == 0)));
+    }
+    else if (strcmp(tof, "l0x") == 0)
+        sim_i2c_attach(sim_vl53l0x_device());
+
+    const char *ppg = getenv("SIM_PPG");
+    if (!(ppg && strcmp(ppg, "0") == 0)) {
+        const char *irq = getenv("SIM_PPG_IRQ");
+        sim_i2c_attach(sim_max30101_device(!(irq && strcmp(irq, "0") == 0)));
+    }
+
+    sim_mqtt_set_publish_hook(sim_on_publish);
+
+    const char *outage = getenv("SIM_MQTT_OUTAGE");
+    if (outage && sscanf(outage, "%u:%u", &s_outage_ini, &s_outage_dur) == 2)
+        xTaskCreate(tarefaSimRede, "SimRede", 512, NULL, configMAX_PRIORITIES - 2, NULL);
+    const char *wifi = getenv("SIM_WIFI_OUTAGE");
+    if (wifi && sscanf(wifi, "%u:%u", &s_wifi_ini, &s_wifi_dur) == 2)
+        xTaskCreate(tarefaSimWifi, "SimWifi", 512, NULL, configMAX_PRIORITIES - 2, NULL);
+
+    unsigned hold_ini, hold_dur;
+    const char *hold = getenv("SIM_ENV_HOLD");
+    if (hold && sscanf(hold, "%u:%u", &hold_ini, &hold_dur) == 2)
+        sim_env_hold(hold_ini, hold_dur);
+
+    const char *config = getenv("SIM_CONFIG");
+    const char *sep = config ? strchr(config, ':') : NULL;
+    if (sep) {
+        s_config_t = (uint32_t)strtoul(config, NULL, 10);
+        s_config_cmd = sep + 1;
+        xTaskCreate(tarefaSimConfig, "SimConfig", 512, NULL, configMAX_PRIORITIES - 2, NULL);
+    }
+
+    xTaskCreate(tarefaSimHW, "SimHW", 512, NULL, configMAX_PRIORITIES - 1, NULL);
+    xTaskCreate(tarefaSimMonitor, "SimMonitor", 1024, NULL, configMAX_PRIORITIES - 2, NULL);
+    return blink_main();
+}
@@ -0,0 +1,667 @@
+#include <stdio.h>
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico.h"
+#include "lwip/dns.h"
+#include "lwip/apps/mqtt.h"
+#include "lwip/stats.h"
+#include "lwipopts.h"   // MQTT_OUTPUT_RINGBUF_SIZE do firmware
+#include "sim_mqtt.h"
+
+#define SIM_MQTT_MAX_SUBS 8
+#define SIM_MQTT_TOPIC_LEN 64
+// Maior pacote do cliente que o broker monta
+#define SIM_MQTT_RX_MAX 8192
+
+// Padrões de lwip/apps/mqtt_opts.h
+#ifndef MQTT_OUTPUT_RINGBUF_SIZE
+#define MQTT_OUTPUT_RINGBUF_SIZE 256
+#endif
+#ifndef MQTT_VAR_HEADER_BUFFER_LEN
+#define MQTT_VAR_HEADER_BUFFER_LEN 128
+#endif
+#ifndef MQTT_REQ_MAX_IN_FLIGHT
+#define MQTT_REQ_MAX_IN_FLIGHT 4
+#endif
+
+// Tipos de pacote (nibble alto do primeiro byte)
+enum {
+    PKT_CONNECT = 1,
+    PKT_CONNACK = 2,
+    PKT_PUBLISH = 3,
+    PKT_PUBACK = 4,
+    PKT_SUBSCRIBE = 8,
+    PKT_SUBACK = 9,
+    PKT_UNSUBSCRIBE = 10,
+    PKT_UNSUBACK = 11,
+    PKT_PINGREQ = 12,
+    PKT_PINGRESP = 13,
+    PKT_DISCONNECT = 14,
+};
+
+static char s_subs[SIM_MQTT_MAX_SUBS][SIM_MQTT_TOPIC_LEN];
+static sim_mqtt_stats_t s_stats;
+static int s_online = 1;
+static void (*s_publish_hook)(const char *topic, const void *payload, size_t len);
+
+// Conexão aberta (um cliente por vez) e o pacote que está chegando dela
+static const sim_mqtt_link_t *s_link;
+static int s_sessao;
+static uint8_t s_rx[SIM_MQTT_RX_MAX];
+static size_t s_rx_len;
+static uint16_t s_pid;
+static int s_tratando;
+
+struct stats_ lwip_stats;
+
+// Faz o papel da trava do núcleo do lwIP (cyw43_arch_lwip_begin no host):
+// broker e clientes são chamados de várias tarefas
+static void travar(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        vTaskSuspendAll();
+}
+
+static void destravar(void)
+{
+    if (xTaskGetSchedulerState() != taskSCHEDULER_NOT_STARTED)
+        xTaskResumeAll();
+}
+
+char *ip4addr_ntoa(const ip4_addr_t *addr)
+{
+    static char buf[16];
+    uint32_t a = addr->addr;
+    snprintf(buf, sizeof buf, "%u.%u.%u.%u", (unsigned)(a & 0xFF), (unsigned)((a >> 8) & 0xFF),
+             (unsigned)((a >> 16) & 0xFF), (unsigned)(a >> 24));
+    return buf;
+}
+
+// Qualquer nome resolve para 127.0.0.1, já em cache (ERR_OK, sem callback)
+err_t dns_gethostbyname(const char *hostname, ip_addr_t *addr, dns_found_callback found, void *callback_arg)
+{
+    (void)hostname;
+    (void)found;
+    (void)callback_arg;
+    addr->addr = 0x0100007Fu;
+    return ERR_OK;
+}
+
+// --- Codificação comum ---
+
+static size_t put_remaining(uint8_t *p, uint32_t n)
+{
+    size_t i = 0;
+    do {
+        uint8_t b = n & 0x7F;
+        n >>= 7;
+        p[i++] = b | (n ? 0x80 : 0);
+    } while (n);
+    return i;
+}
+
+// Cabeçalho fixo completo em p[0..n): tamanho dele e o restante; 0 se faltam bytes
+static size_t get_header(const uint8_t *p, size_t n, uint32_t *remaining)
+{
+    uint32_t v = 0;
+    for (size_t i = 1; i < n && i <= 4; ++i) {
+        v |= (uint32_t)(p[i] & 0x7F) << (7 * (i - 1));
+        if (!(p[i] & 0x80)) {
+            *remaining = v;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+static uint16_t get16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] << 8 | p[1]);
+}
+
+// --- Broker ---
+
+static void responder(const uint8_t *p, size_t n)
+{
+    if (s_link)
+        s_link->deliver(p, n);
+}
+
+static void derrubar(void)
+{
+    const sim_mqtt_link_t *link = s_link;
+    s_link = NULL;
+    s_sessao = 0;
+    if (link)
+        link->closed();
+}
+
+static void registrar_publish(const uint8_t *topico, uint16_t tlen, const uint8_t *payload, size_t len)
+{
+    uint64_t now = time_us_64();
+    if (s_stats.publishes == 0) s_stats.first_us = now;
+    s_stats.last_us = now;
+    s_stats.publishes++;
+    s_stats.payload_bytes += len;
+    if (len > s_stats.max_payload) s_stats.max_payload = (uint32_t)len;
+    if (s_publish_hook) {
+        char t[SIM_MQTT_TOPIC_LEN];
+        size_t n = tlen < sizeof t - 1 ? tlen : sizeof t - 1;
+        memcpy(t, topico, n);
+        t[n] = '\0';
+        s_publish_hook(t, payload, len);
+    }
+}
+
+static void assinar(const uint8_t *p, uint32_t n)
+{
+    uint8_t resp[4 + SIM_MQTT_MAX_SUBS];
+    size_t k = 0;
+    for (uint32_t i = 2; i + 2 < n && k < SIM_MQTT_MAX_SUBS;) {
+        uint16_t len = get16(&p[i]);
+        const uint8_t *topico = &p[i + 2];
+        uint8_t qos = p[i + 2 + len];
+        i += 3u + len;
+        uint8_t codigo = 0x80;
+        for (int s = 0; s < SIM_MQTT_MAX_SUBS && len < SIM_MQTT_TOPIC_LEN; ++s) {
+            if (s_subs[s][0] != '\0') continue;
+            memcpy(s_subs[s], topico, len);
+            s_subs[s][len] = '\0';
+            s_stats.subscribes++;
+            codigo = qos > 1 ? 1 : qos;
+            break;
+        }
+        resp[4 + k++] = codigo;
+    }
+    resp[0] = PKT_SUBACK << 4;
+    resp[1] = (uint8_t)(2 + k);
+    resp[2] = p[0];
+    resp[3] = p[1];
+    responder(resp, 4 + k);
+}
+
+static void cancelar(const uint8_t *p, uint32_t n)
+{
+    for (uint32_t i = 2; i + 2 <= n;) {
+        uint16_t len = get16(&p[i]);
+        for (int s = 0; s < SIM_MQTT_MAX_SUBS; ++s)
+            if (strlen(s_subs[s]) == len && memcmp(s_subs[s], &p[i + 2], len) == 0)
+                s_subs[s][0] = '\0';
+        i += 2u + len;
+    }
+    const uint8_t resp[] = {PKT_UNSUBACK << 4, 2, p[0], p[1]};
+    responder(resp, sizeof resp);
+}
+
+static void tratar(uint8_t tipo, const uint8_t *p, uint32_t n)
+{
+    if (!s_sessao && tipo >> 4 != PKT_CONNECT) {
+        derrubar();
+        return;
+    }
+    switch (tipo >> 4) {
+    case PKT_CONNECT: {
+        // Sessão limpa: assinaturas da sessão anterior não valem mais
+        memset(s_subs, 0, sizeof s_subs);
+        s_sessao = 1;
+        s_stats.connects++;
+        const uint8_t connack[] = {PKT_CONNACK << 4, 2, 0, 0};
+        responder(connack, sizeof connack);
+        break;
+    }
+    case PKT_PUBLISH: {
+        uint8_t qos = (tipo >> 1) & 3;
+        uint16_t tlen = get16(p);
+        uint32_t off = 2u + tlen + (qos ? 2u : 0u);
+        if (off > n) {
+            derrubar();
+            return;
+        }
+        registrar_publish(&p[2], tlen, &p[off], n - off);
+        if (qos) {
+            const uint8_t puback[] = {PKT_PUBACK << 4, 2, p[2 + tlen], p[3 + tlen]};
+            responder(puback, sizeof puback);
+        }
+        break;
+    }
+    case PKT_SUBSCRIBE:
+        assinar(p, n);
+        break;
+    case PKT_UNSUBSCRIBE:
+        cancelar(p, n);
+        break;
+    case PKT_PINGREQ: {
+        const uint8_t pingresp[] = {PKT_PINGRESP << 4, 0};
+        responder(pingresp, sizeof pingresp);
+        break;
+    }
+    case PKT_DISCONNECT:
+        s_link = NULL;
+        s_sessao = 0;
+        break;
+    default:    // PUBACK das mensagens injetadas: nada a fazer
+        break;
+    }
+}
+
+bool sim_mqtt_open(const sim_mqtt_link_t *link)
+{
+    travar();
+    bool ok = s_online;
+    if (ok) {
+        s_link = link;
+        s_sessao = 0;
+        s_rx_len = 0;
+    }
+    destravar();
+    return ok;
+}
+
+void sim_mqtt_close(void)
+{
+    travar();
+    s_link = NULL;
+    s_sessao = 0;
+    destravar();
+}
+
+// Todos os pacotes completos que já chegaram. A resposta do cliente a um deles
+// (PUBACK) pode voltar para sim_mqtt_input() no meio: só é acrescentada aqui
+static void processar_rx(void)
+{
+    s_tratando = 1;
+    size_t ini = 0;
+    uint32_t resto;
+    size_t h;
+    while (s_link && (h = get_header(&s_rx[ini], s_rx_len - ini, &resto)) && s_rx_len - ini >= h + resto) {
+        tratar(s_rx[ini], &s_rx[ini + h], resto);
+        ini += h + resto;
+    }
+    memmove(s_rx, &s_rx[ini], s_rx_len - ini);
+    s_rx_len -= ini;
+    s_tratando = 0;
+}
+
+void sim_mqtt_input(const void *data, size_t len)
+{
+    travar();
+    const uint8_t *d = data;
+    while (len > 0 && s_link) {
+        size_t k = len < sizeof s_rx - s_rx_len ? len : sizeof s_rx - s_rx_len;
+        if (k == 0) {
+            printf("[SIM] Broker: pacote maior que %u bytes\n", (unsigned)sizeof s_rx);
+            derrubar();
+            break;
+        }
+        memcpy(&s_rx[s_rx_len], d, k);
+        s_rx_len += k;
+        d += k;
+        len -= k;
+        if (!s_tratando)
+            processar_rx();
+    }
+    destravar();
+}
+
+void sim_mqtt_set_online(int online)
+{
+    travar();
+    s_online = online;
+    if (!online)
+        derrubar();
+    destravar();
+}
+
+void sim_mqtt_set_publish_hook(void (*hook)(const char *topic, const void *payload, size_t len))
+{
+    s_publish_hook = hook;
+}
+
+int sim_mqtt_inject(const char *topic, const void *payload, size_t len)
+{
+    int entregue = 0;
+    travar();
+    for (int i = 0; i < SIM_MQTT_MAX_SUBS && s_sessao && !entregue; ++i) {
+        if (strcmp(s_subs[i], topic) != 0) continue;
+        static uint8_t pkt[SIM_MQTT_RX_MAX];
+        size_t tlen = strlen(topic);
+        size_t n = 1 + put_remaining(&pkt[1], (uint32_t)(2 + tlen + 2 + len));
+        if (n + 4 + tlen + len > sizeof pkt) break;
+        pkt[0] = PKT_PUBLISH << 4 | 1 << 1;
+        pkt[n++] = (uint8_t)(tlen >> 8);
+        pkt[n++] = (uint8_t)tlen;
+        memcpy(&pkt[n], topic, tlen);
+        n += tlen;
+        if (++s_pid == 0) s_pid = 1;
+        pkt[n++] = (uint8_t)(s_pid >> 8);
+        pkt[n++] = (uint8_t)s_pid;
+        memcpy(&pkt[n], payload, len);
+        responder(pkt, n + len);
+        entregue = 1;
+    }
+    destravar();
+    return entregue;
+}
+
+const sim_mqtt_stats_t *sim_mqtt_stats(void)
+{
+    return &s_stats;
+}
+
+void sim_mqtt_reset_stats(void)
+{
+    memset(&s_stats, 0, sizeof s_stats);
+}
+
+void sim_mqtt_report(void)
+{
+    double span_s = (double)(s_stats.last_us - s_stats.first_us) / 1e6;
+    printf("[SIM] MQTT: %lu conexões, %lu assinaturas, %lu publicações (%lu rejeitadas), %llu bytes de payload, máx %lu B\n",
+           (unsigned long)s_stats.connects, (unsigned long)s_stats.subscribes, (unsigned long)s_stats.publishes,
+           (unsigned long)s_stats.rejected, (unsigned long long)s_stats.payload_bytes, (unsigned long)s_stats.max_payload);
+    if (s_stats.publishes > 1 && span_s > 0)
+        printf("[SIM] MQTT: vazão %.2f publicações/s, %.1f B/s\n",
+               (s_stats.publishes - 1) / span_s, (double)s_stats.payload_bytes / span_s);
+}
+
+// --- Cliente lwIP (apps/mqtt.c) ---
+//
+// Mesmos campos e buffers do mqtt_client_s do lwIP 2.x: tudo o que sai passa
+// pelo anel output (cópia), e só então vai para o TCP (no host, direto para o
+// broker). A entrada chega em pacotes inteiros; o tópico vai para rx_buffer
+// terminado em NUL antes do pub_cb, como no lwIP.
+
+struct mqtt_request_t {
+    struct mqtt_request_t *next;
+    mqtt_request_cb_t cb;
+    void *arg;
+    u16_t pkt_id;
+    u16_t timeout_diff;
+};
+
+struct mqtt_ringbuf_t {
+    u16_t put;
+    u16_t get;
+    u8_t buf[MQTT_OUTPUT_RINGBUF_SIZE];
+};
+
+enum {
+    TCP_DISCONNECTED,
+    TCP_CONNECTING,
+    MQTT_CONNECTING,
+    MQTT_CONNECTED,
+};
+
+struct mqtt_client_s {
+    u16_t cyclic_tick;
+    u16_t keep_alive;
+    u16_t server_watchdog;
+    u16_t pkt_id_seq;
+    u16_t inpub_pkt_id;
+    u8_t conn_state;
+    void *conn;
+    void *connect_arg;
+    mqtt_connection_cb_t connect_cb;
+    struct mqtt_request_t *pend_req_queue;
+    struct mqtt_request_t req_list[MQTT_REQ_MAX_IN_FLIGHT];
+    void *inpub_arg;
+    mqtt_incoming_data_cb_t data_cb;
+    mqtt_incoming_publish_cb_t pub_cb;
+    u32_t msg_idx;
+    u8_t rx_buffer[MQTT_VAR_HEADER_BUFFER_LEN];
+    struct mqtt_ringbuf_t output;
+};
+
+static struct mqtt_client_s s_client;
+
+size_t sim_mqtt_lwip_client_size(void)
+{
+    return sizeof(struct mqtt_client_s);
+}
+
+static size_t anel_livre(const struct mqtt_ringbuf_t *r)
+{
+    return MQTT_OUTPUT_RINGBUF_SIZE - (u16_t)(r->put - r->get);
+}
+
+static void anel_escrever(struct mqtt_ringbuf_t *r, const void *data, size_t len)
+{
+    const u8_t *d = data;
+    for (size_t i = 0; i < len; ++i)
+        r->buf[(u16_t)(r->put + i) % MQTT_OUTPUT_RINGBUF_SIZE] = d[i];
+    r->put = (u16_t)(r->put + len);
+}
+
+// mqtt_output_send(): do anel para o TCP, em no máximo dois trechos contíguos
+static void anel_enviar(struct mqtt_ringbuf_t *r)
+{
+    while (r->put != r->get) {
+        size_t ini = r->get % MQTT_OUTPUT_RINGBUF_SIZE;
+        size_t n = (u16_t)(r->put - r->get);
+        if (ini + n > MQTT_OUTPUT_RINGBUF_SIZE)
+            n = MQTT_OUTPUT_RINGBUF_SIZE - ini;
+        r->get = (u16_t)(r->get + n);
+        sim_mqtt_input(&r->buf[ini], n);
+    }
+}
+
+static void anel_cabecalho(struct mqtt_ringbuf_t *r, u8_t tipo, u32_t restante)
+{
+    u8_t h[5];
+    h[0] = tipo;
+    anel_escrever(r, h, 1 + put_remaining(&h[1], restante));
+}
+
+static void anel_string(struct mqtt_ringbuf_t *r, const char *s, u16_t len)
+{
+    const u8_t l[2] = {(u8_t)(len >> 8), (u8_t)len};
+    anel_escrever(r, l, 2);
+    anel_escrever(r, s, len);
+}
+
+static u16_t novo_pkt_id(mqtt_client_t *client)
+{
+    if (++client->pkt_id_seq == 0)
+        client->pkt_id_seq = 1;
+    return client->pkt_id_seq;
+}
+
+static struct mqtt_request_t *pedido_novo(mqtt_client_t *client, u16_t pkt_id, mqtt_request_cb_t cb, void *arg)
+{
+    for (int i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; ++i) {
+        struct mqtt_request_t *r = &client->req_list[i];
+        if (r->pkt_id != 0) continue;
+        *r = (struct mqtt_request_t){.next = client->pend_req_queue, .cb = cb, .arg = arg, .pkt_id = pkt_id};
+        client->pend_req_queue = r;
+        return r;
+    }
+    return NULL;
+}
+
+static void pedido_concluir(mqtt_client_t *client, u16_t pkt_id, err_t err)
+{
+    for (struct mqtt_request_t **p = &client->pend_req_queue; *p; p = &(*p)->next) {
+        struct mqtt_request_t *r = *p;
+        if (r->pkt_id != pkt_id) continue;
+        *p = r->next;
+        r->pkt_id = 0;
+        if (r->cb) r->cb(r->arg, err);
+        return;
+    }
+}
+
+static void cliente_entrada(const uint8_t *p, size_t n)
+{
+    mqtt_client_t *c = &s_client;
+    uint32_t resto;
+    size_t h;
+    while (n > 0 && (h = get_header(p, n, &resto)) && n >= h + resto) {
+        const uint8_t *v = &p[h];
+        switch (p[0] >> 4) {
+        case PKT_CONNACK:
+            if (c->conn_state == MQTT_CONNECTING) {
+                c->conn_state = v[1] == 0 ? MQTT_CONNECTED : TCP_DISCONNECTED;
+                if (c->connect_cb)
+                    c->connect_cb(c, c->connect_arg, (mqtt_connection_status_t)v[1]);
+            }
+            break;
+        case PKT_SUBACK:
+            pedido_concluir(c, get16(v), v[2] == 0x80 ? ERR_ABRT : ERR_OK);
+            break;
+        case PKT_UNSUBACK:
+        case PKT_PUBACK:
+            pedido_concluir(c, get16(v), ERR_OK);
+            break;
+        case PKT_PUBLISH: {
+            u8_t qos = (p[0] >> 1) & 3;
+            u16_t tlen = get16(v);
+            u32_t off = 2u + tlen + (qos ? 2u : 0u);
+            if (tlen < sizeof c->rx_buffer) {
+                memcpy(c->rx_buffer, &v[2], tlen);
+                c->rx_buffer[tlen] = '\0';
+                if (c->pub_cb) c->pub_cb(c->inpub_arg, (const char *)c->rx_buffer, resto - off);
+                if (c->data_cb) c->data_cb(c->inpub_arg, &v[off], (u16_t)(resto - off), MQTT_DATA_FLAG_LAST);
+            }
+            if (qos == 1 && anel_livre(&c->output) >= 4) {
+                c->inpub_pkt_id = get16(&v[2 + tlen]);
+                anel_cabecalho(&c->output, PKT_PUBACK << 4, 2);
+                const u8_t pid[2] = {(u8_t)(c->inpub_pkt_id >> 8), (u8_t)c->inpub_pkt_id};
+                anel_escrever(&c->output, pid, 2);
+                anel_enviar(&c->output);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+        p += h + resto;
+        n -= h + resto;
+    }
+}
+
+static void cliente_fechado(void)
+{
+    mqtt_client_t *c = &s_client;
+    c->conn_state = TCP_DISCONNECTED;
+    for (int i = 0; i < MQTT_REQ_MAX_IN_FLIGHT; ++i)
+        c->req_list[i].pkt_id = 0;
+    c->pend_req_queue = NULL;
+    if (c->connect_cb) c->connect_cb(c, c->connect_arg, MQTT_CONNECT_DISCONNECTED);
+}
+
+static const sim_mqtt_link_t s_link_lwip = {cliente_entrada, cliente_fechado};
+
+mqtt_client_t *mqtt_client_new(void)
+{
+    memset(&s_client, 0, sizeof s_client);
+    return &s_client;
+}
+
+void mqtt_client_free(mqtt_client_t *client)
+{
+    (void)client;
+}
+
+err_t mqtt_client_connect(mqtt_client_t *client, const ip_addr_t *ipaddr, u16_t port, mqtt_connection_cb_t cb, void *arg,
+                          const struct mqtt_connect_client_info_t *client_info)
+{
+    (void)ipaddr;
+    (void)port;
+    if (client->conn_state != TCP_DISCONNECTED) return ERR_ISCONN;
+    // Como no lwIP: o cliente é zerado (inclusive os callbacks de entrada)
+    memset(client, 0, sizeof *client);
+    client->connect_cb = cb;
+    client->connect_arg = arg;
+    client->keep_alive = client_info->keep_alive;
+    if (!sim_mqtt_open(&s_link_lwip)) {
+        if (cb) cb(client, arg, MQTT_CONNECT_TIMEOUT);
+        return ERR_OK;
+    }
+    client->conn_state = MQTT_CONNECTING;
+    travar();
+    // CONNECT 3.1.1 com sessão limpa e só o client id
+    u16_t id_len = (u16_t)strlen(client_info->client_id);
+    static const u8_t var[] = {0, 4, 'M', 'Q', 'T', 'T', 4, 0x02};
+    anel_cabecalho(&client->output, PKT_CONNECT << 4, (u32_t)(sizeof var + 2 + 2 + id_len));
+    anel_escrever(&client->output, var, sizeof var);
+    const u8_t ka[2] = {(u8_t)(client->keep_alive >> 8), (u8_t)client->keep_alive};
+    anel_escrever(&client->output, ka, 2);
+    anel_string(&client->output, client_info->client_id, id_len);
+    anel_enviar(&client->output);
+    destravar();
+    return ERR_OK;
+}
+
+void mqtt_disconnect(mqtt_client_t *client)
+{
+    // mqtt_close(): fecha o TCP sem DISCONNECT nem callback
+    if (client->conn_state != TCP_DISCONNECTED)
+        sim_mqtt_close();
+    client->conn_state = TCP_DISCONNECTED;
+}
+
+u8_t mqtt_client_is_connected(mqtt_client_t *client)
+{
+    return client && client->conn_state == MQTT_CONNECTED;
+}
+
+void mqtt_set_inpub_callback(mqtt_client_t *client, mqtt_incoming_publish_cb_t pub_cb, mqtt_incoming_data_cb_t data_cb, void *arg)
+{
+    client->pub_cb = pub_cb;
+    client->data_cb = data_cb;
+    client->inpub_arg = arg;
+}
+
+err_t mqtt_sub_unsub(mqtt_client_t *client, const char *topic, u8_t qos, mqtt_request_cb_t cb, void *arg, u8_t sub)
+{
+    if (client->conn_state != MQTT_CONNECTED) return ERR_CONN;
+    u16_t tlen = (u16_t)strlen(topic);
+    u32_t restante = 2u + 2u + tlen + (sub ? 1u : 0u);
+    err_t err = ERR_MEM;
+    travar();
+    u16_t pkt_id = novo_pkt_id(client);
+    if (anel_livre(&client->output) >= restante + 5 && pedido_novo(client, pkt_id, cb, arg)) {
+        anel_cabecalho(&client->output, (sub ? PKT_SUBSCRIBE : PKT_UNSUBSCRIBE) << 4 | 0x02, restante);
+        const u8_t pid[2] = {(u8_t)(pkt_id >> 8), (u8_t)pkt_id};
+        anel_escrever(&client->output, pid, 2);
+        anel_string(&client->output, topic, tlen);
+        if (sub) anel_escrever(&client->output, &qos, 1);
+        anel_enviar(&client->output);
+        err = ERR_OK;
+    }
+    destravar();
+    return err;
+}
+
+err_t mqtt_publish(mqtt_client_t *client, const char *topic, const void *payload, u16_t payload_length, u8_t qos, u8_t retain,
+                   mqtt_request_cb_t cb, void *arg)
+{
+    if (client->conn_state != MQTT_CONNECTED) {
+        s_stats.rejected++;
+        return ERR_CONN;
+    }
+    u16_t tlen = (u16_t)strlen(topic);
+    u32_t restante = 2u + tlen + (qos ? 2u : 0u) + payload_length;
+    err_t err = ERR_MEM;
+    travar();
+    // Como no lwIP: a mensagem inteira (cabeçalho fixo, tópico, payload) cabe no buffer de saída
+    u16_t pkt_id = qos ? novo_pkt_id(client) : 0;
+    if (anel_livre(&client->output) >= restante + 5 && (qos == 0 || pedido_novo(client, pkt_id, cb, arg))) {
+        anel_cabecalho(&client->output, PKT_PUBLISH << 4 | (qos & 3) << 1 | (retain ? 1 : 0), restante);
+        anel_string(&client->output, topic, tlen);
+        if (qos) {
+            const u8_t pid[2] = {(u8_t)(pkt_id >> 8), (u8_t)pkt_id};
+            anel_escrever(&client->output, pid, 2);
+        }
+        anel_escrever(&client->output, payload, payload_length);
+        anel_enviar(&client->output);
+        err = ERR_OK;
+    }
+    else
+        s_stats.rejected++;
+    destravar();
+    // QoS 0 não tem pedido: o lwIP chama o callback logo depois de pôr no TCP
+    if (err == ERR_OK && qos == 0 && cb) cb(arg, ERR_OK);
+    return err;
+}
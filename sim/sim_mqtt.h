@@ -0,0 +1,48 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+// Broker MQTT local que substitui o test.mosquitto.org na simulação. Fala MQTT
+// 3.1.1 de verdade (CONNECT, SUBSCRIBE, PUBLISH QoS 0/1, PINGREQ, DISCONNECT)
+// com um cliente por vez, e mede o tráfego publicado. Dois clientes chegam a ele:
+//  - a API de lwip/apps/mqtt.h (sim_mqtt.c), um modelo do mqtt_client do lwIP:
+//    serializa no buffer de saída (MQTT_OUTPUT_RINGBUF_SIZE) e despeja no TCP;
+//  - a API de sockets de lwip/sockets.h (sim_socket.c), usada pelo coreMQTT.
+
+typedef struct {
+    uint32_t connects;
+    uint32_t subscribes;
+    uint32_t publishes;
+    uint32_t rejected;          // publicações recusadas pelo cliente lwIP (sem conexão ou sem buffer)
+    uint64_t payload_bytes;
+    uint64_t first_us, last_us;
+    uint32_t max_payload;
+} sim_mqtt_stats_t;
+
+// Um lado TCP do cliente: recebe os bytes do broker e o aviso de que ele fechou
+typedef struct {
+    void (*deliver)(const uint8_t *data, size_t len);
+    void (*closed)(void);
+} sim_mqtt_link_t;
+
+// Derruba/restaura a sessão (para exercitar os caminhos de reconexão)
+void sim_mqtt_set_online(int online);
+// Entrega uma mensagem QoS 1 no cliente como se viesse do broker (se houver assinatura)
+int sim_mqtt_inject(const char *topic, const void *payload, size_t len);
+// Chamado pelo broker a cada publicação aceita (NULL desliga)
+void sim_mqtt_set_publish_hook(void (*hook)(const char *topic, const void *payload, size_t len));
+
+const sim_mqtt_stats_t *sim_mqtt_stats(void);
+void sim_mqtt_reset_stats(void);
+void sim_mqtt_report(void);
+
+// Conexão TCP com o broker (false com o broker fora do ar), bytes do cliente em
+// qualquer fragmentação e fechamento pelo cliente (sem aviso em closed)
+bool sim_mqtt_open(const sim_mqtt_link_t *link);
+void sim_mqtt_input(const void *data, size_t len);
+void sim_mqtt_close(void);
+
+// Tamanho do mqtt_client_t do modelo (campos e buffers do lwIP, com os tamanhos do lwipopts.h)
+size_t sim_mqtt_lwip_client_size(void);
@@ -0,0 +1,278 @@
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico/stdlib.h"
+#include "pico/cyw43_arch.h"
+#include "pico/rand.h"
+#include "hardware/pwm.h"
+#include "sim_pico.h"
+
+// Estado de GPIO/PWM do host: só o necessário para o roteamento I2C,
+// os botões (pull-up = solto) e o registro dos níveis do LED RGB.
+static enum gpio_function s_func[NUM_BANK0_GPIOS];
+static bool s_pull_up[NUM_BANK0_GPIOS];
+static bool s_out[NUM_BANK0_GPIOS];
+static int s_in[NUM_BANK0_GPIOS];        // -1 = sem driver externo
+static uint16_t s_level[NUM_BANK0_GPIOS];
+static uint32_t s_irq_mask[NUM_BANK0_GPIOS];
+static uint32_t s_irq_pending[NUM_BANK0_GPIOS];
+static irq_handler_t s_raw_handler[NUM_BANK0_GPIOS];
+static gpio_irq_callback_t s_irq_cb;
+static uint64_t s_t0_ns;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+void sim_pico_init(void)
+{
+    for (int i = 0; i < NUM_BANK0_GPIOS; ++i) {
+        s_func[i] = GPIO_FUNC_NULL;
+        s_in[i] = -1;
+    }
+    s_t0_ns = now_ns();
+}
+
+void panic(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    fprintf(stderr, "*** PANIC ***\n");
+    vfprintf(stderr, fmt, ap);
+    fprintf(stderr, "\n");
+    va_end(ap);
+    abort();
+}
+
+uint64_t time_us_64(void)
+{
+    return (now_ns() - s_t0_ns) / 1000u;
+}
+
+uint32_t time_us_32(void)
+{
+    return (uint32_t)time_us_64();
+}
+
+// Espera real; o tick do port POSIX (SIGALRM) interrompe nanosleep, então retoma o restante
+void sleep_us(uint64_t us)
+{
+    struct timespec req = {(time_t)(us / 1000000u), (long)(us % 1000000u) * 1000L};
+    struct timespec rem;
+    while (nanosleep(&req, &rem) == -1 && errno == EINTR)
+        req = rem;
+}
+
+// Com configSUPPORT_PICO_TIME_INTEROP o sleep_ms do alvo bloqueia a tarefa em vez de girar
+void sleep_ms(uint32_t ms)
+{
+    if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING)
+        vTaskDelay(pdMS_TO_TICKS(ms) ? pdMS_TO_TICKS(ms) : 1);
+    else
+        sleep_us((uint64_t)ms * 1000u);
+}
+
+bool stdio_init_all(void)
+{
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
+
+void gpio_init(uint gpio)
+{
+    s_func[gpio] = GPIO_FUNC_SIO;
+    s_out[gpio] = false;
+}
+
+void gpio_set_dir(uint gpio, bool out)
+{
+    s_out[gpio] = out;
+}
+
+void gpio_set_function(uint gpio, enum gpio_function fn)
+{
+    s_func[gpio] = fn;
+}
+
+enum gpio_function gpio_get_function(uint gpio)
+{
+    return s_func[gpio];
+}
+
+void gpio_pull_up(uint gpio)
+{
+    s_pull_up[gpio] = true;
+}
+
+void gpio_pull_down(uint gpio)
+{
+    s_pull_up[gpio] = false;
+}
+
+void gpio_disable_pulls(uint gpio)
+{
+    s_pull_up[gpio] = false;
+}
+
+bool gpio_get(uint gpio)
+{
+    if (s_in[gpio] >= 0)
+        return s_in[gpio] != 0;
+    return s_pull_up[gpio];
+}
+
+void gpio_put(uint gpio, bool value)
+{
+    s_level[gpio] = value;
+}
+
+void gpio_set_irq_enabled(uint gpio, uint32_t event_mask, bool enabled)
+{
+    if (enabled)
+        s_irq_mask[gpio] |= event_mask;
+    else
+        s_irq_mask[gpio] &= ~event_mask;
+}
+
+void gpio_set_irq_enabled_with_callback(uint gpio, uint32_t event_mask, bool enabled, gpio_irq_callback_t callback)
+{
+    gpio_set_irq_enabled(gpio, event_mask, enabled);
+    if (callback)
+        s_irq_cb = callback;
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler)
+{
+    s_raw_handler[gpio] = handler;
+}
+
+uint32_t gpio_get_irq_event_mask(uint gpio)
+{
+    return s_irq_pending[gpio];
+}
+
+void gpio_acknowledge_irq(uint gpio, uint32_t event_mask)
+{
+    s_irq_pending[gpio] &= ~event_mask;
+}
+
+// Executa no contexto da tarefa SimHW, que faz o papel do IO_IRQ_BANK0
+void sim_gpio_drive(uint gpio, bool level)
+{
+    bool old = gpio_get(gpio);
+    s_in[gpio] = level;
+    uint32_t ev = 0;
+    if (old && !level) ev = GPIO_IRQ_EDGE_FALL;
+    if (!old && level) ev = GPIO_IRQ_EDGE_RISE;
+    ev &= s_irq_mask[gpio];
+    if (!ev) return;
+    s_irq_pending[gpio] |= ev;
+    if (s_raw_handler[gpio])
+        s_raw_handler[gpio]();
+    else if (s_irq_cb)
+        s_irq_cb(gpio, ev);
+    s_irq_pending[gpio] &= ~ev;
+}
+
+uint16_t sim_pwm_level(uint gpio)
+{
+    return s_level[gpio];
+}
+
+pwm_config pwm_get_default_config(void)
+{
+    pwm_config c = {0, 1u << 4, 0xffff};
+    return c;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start)
+{
+    (void)slice_num;
+    (void)c;
+    (void)start;
+}
+
+void pwm_set_gpio_level(uint gpio, uint16_t level)
+{
+    s_level[gpio] = level;
+}
+
+uint32_t get_rand_32(void)
+{
+    return ((uint32_t)rand() << 16) ^ (uint32_t)rand();
+}
+
+// --- CYW43: associação instantânea, exceto com o AP fora do ar ---
+
+cyw43_t cyw43_state;
+static volatile int s_wifi_ap = 1;
+
+void sim_wifi_set_up(int up)
+{
+    s_wifi_ap = up;
+    if (!up)
+        cyw43_state.itf_state = 0;
+}
+
+void cyw43_arch_set_async_context(async_context_t *context)
+{
+    (void)context;
+}
+
+int cyw43_arch_init(void)
+{
+    return 0;
+}
+
+void cyw43_arch_deinit(void)
+{
+}
+
+void cyw43_arch_enable_sta_mode(void)
+{
+}
+
+int cyw43_arch_wifi_connect_timeout_ms(const char *ssid, const char *pw, uint32_t auth, uint32_t timeout)
+{
+    (void)ssid;
+    (void)pw;
+    (void)auth;
+    // Sem o AP a varredura termina sem rede em alguns segundos, antes do prazo
+    if (!s_wifi_ap) {
+        vTaskDelay(pdMS_TO_TICKS(timeout < 3000 ? timeout : 3000));
+        return PICO_ERROR_GENERIC;
+    }
+    cyw43_state.itf_state = 1;
+    cyw43_state.pm = CYW43_DEFAULT_PM;
+    return 0;
+}
+
+int cyw43_tcpip_link_status(cyw43_t *self, int itf)
+{
+    (void)itf;
+    return self->itf_state ? CYW43_LINK_UP : CYW43_LINK_DOWN;
+}
+
+int cyw43_wifi_pm(cyw43_t *self, uint32_t pm)
+{
+    self->pm = pm;
+    return 0;
+}
+
+// O lock do lwIP vira seção crítica: o broker local é chamado no contexto de quem publica
+void cyw43_arch_lwip_begin(void)
+{
+    vTaskSuspendAll();
+}
+
+void cyw43_arch_lwip_end(void)
+{
+    xTaskResumeAll();
+}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "pico.h"
+
+// Controle do "hardware" do host pelos modelos e pelo harness da simulação
+void sim_pico_init(void);
+// Dirige um pino de entrada (botão, linha de interrupção de sensor) e dispara o callback de IRQ
+void sim_gpio_drive(uint gpio, bool level);
+uint16_t sim_pwm_level(uint gpio);
+// AP fora do ar (0): a associação falha e o enlace cai
+void sim_wifi_set_up(int up);
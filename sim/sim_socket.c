@@ -0,0 +1,224 @@
+#include <string.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "semphr.h"
+#include "lwip/sockets.h"
+#include "sim_mqtt.h"
+
+// Socket TCP único ligado ao broker local (sim_mqtt.c). O broker responde na
+// hora, dentro do send(): as respostas ficam num anel até o recv(), e o
+// select() espera por elas num semáforo (as mensagens injetadas e a queda
+// chegam de outras tarefas).
+
+#define SIM_SOCKET_FD 3
+#define SIM_SOCKET_RX_MAX 16384
+
+static struct {
+    int aberto;
+    int conectado;
+    int fechado_par;        // o broker fechou: recv() devolve 0
+    int flags;              // F_SETFL
+    uint8_t rx[SIM_SOCKET_RX_MAX];
+    size_t ini, n;
+} s_sock;
+
+static SemaphoreHandle_t s_dados;
+
+static void travar(void)
+{
+    vTaskSuspendAll();
+}
+
+static void destravar(void)
+{
+    xTaskResumeAll();
+}
+
+static void entregar(const uint8_t *data, size_t len)
+{
+    if (len > SIM_SOCKET_RX_MAX - s_sock.n) {
+        // Janela de recepção cheia: o broker de verdade esperaria; aqui é erro de uso
+        s_sock.fechado_par = 1;
+    } else {
+        for (size_t i = 0; i < len; ++i)
+            s_sock.rx[(s_sock.ini + s_sock.n + i) % SIM_SOCKET_RX_MAX] = data[i];
+        s_sock.n += len;
+    }
+    xSemaphoreGive(s_dados);
+}
+
+static void fechado(void)
+{
+    s_sock.fechado_par = 1;
+    xSemaphoreGive(s_dados);
+}
+
+static const sim_mqtt_link_t s_link = {entregar, fechado};
+
+static int invalido(int s)
+{
+    if (s == SIM_SOCKET_FD && s_sock.aberto)
+        return 0;
+    errno = EBADF;
+    return 1;
+}
+
+int lwip_socket(int domain, int type, int protocol)
+{
+    (void)protocol;
+    if (domain != AF_INET || type != SOCK_STREAM || s_sock.aberto) {
+        errno = s_sock.aberto ? EMFILE : EINVAL;
+        return -1;
+    }
+    if (!s_dados)
+        s_dados = xSemaphoreCreateBinary();
+    memset(&s_sock, 0, sizeof s_sock);
+    s_sock.aberto = 1;
+    return SIM_SOCKET_FD;
+}
+
+// Completa na hora (também sem bloqueio); broker fora do ar = conexão recusada
+int lwip_connect(int s, const struct sockaddr *name, socklen_t namelen)
+{
+    (void)name;
+    (void)namelen;
+    if (invalido(s))
+        return -1;
+    xSemaphoreTake(s_dados, 0);
+    if (!sim_mqtt_open(&s_link)) {
+        errno = ECONNREFUSED;
+        return -1;
+    }
+    s_sock.conectado = 1;
+    return 0;
+}
+
+int lwip_close(int s)
+{
+    if (invalido(s))
+        return -1;
+    if (s_sock.conectado && !s_sock.fechado_par)
+        sim_mqtt_close();
+    s_sock.aberto = 0;
+    s_sock.conectado = 0;
+    return 0;
+}
+
+static size_t ler(void *mem, size_t len)
+{
+    travar();
+    size_t k = len < s_sock.n ? len : s_sock.n;
+    for (size_t i = 0; i < k; ++i)
+        ((uint8_t *)mem)[i] = s_sock.rx[(s_sock.ini + i) % SIM_SOCKET_RX_MAX];
+    s_sock.ini = (s_sock.ini + k) % SIM_SOCKET_RX_MAX;
+    s_sock.n -= k;
+    destravar();
+    return k;
+}
+
+ssize_t lwip_recv(int s, void *mem, size_t len, int flags)
+{
+    if (invalido(s))
+        return -1;
+    while (1) {
+        size_t k = ler(mem, len);
+        if (k > 0)
+            return (ssize_t)k;
+        if (s_sock.fechado_par || !s_sock.conectado)
+            return 0;
+        if ((flags & MSG_DONTWAIT) || (s_sock.flags & O_NONBLOCK)) {
+            errno = EWOULDBLOCK;
+            return -1;
+        }
+        xSemaphoreTake(s_dados, portMAX_DELAY);
+    }
+}
+
+ssize_t lwip_send(int s, const void *dataptr, size_t size, int flags)
+{
+    (void)flags;
+    if (invalido(s))
+        return -1;
+    if (!s_sock.conectado || s_sock.fechado_par) {
+        errno = s_sock.fechado_par ? ECONNRESET : ENOTCONN;
+        return -1;
+    }
+    sim_mqtt_input(dataptr, size);
+    return (ssize_t)size;
+}
+
+// Um tcp_write() por vetor sob uma trava só, como o netconn_write_vectors() do lwIP
+ssize_t lwip_writev(int s, const struct iovec *iov, int iovcnt)
+{
+    ssize_t total = 0;
+    travar();
+    for (int i = 0; i < iovcnt; ++i) {
+        ssize_t r = lwip_send(s, iov[i].iov_base, iov[i].iov_len, 0);
+        if (r < 0) {
+            total = total > 0 ? total : -1;
+            break;
+        }
+        total += r;
+    }
+    destravar();
+    return total;
+}
+
+int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset, struct timeval *timeout)
+{
+    (void)exceptset;
+    int s = SIM_SOCKET_FD;
+    if (maxfdp1 <= s || invalido(s))
+        return -1;
+    int ler_pedido = readset && FD_ISSET(s, readset);
+    int escrever_pedido = writeset && FD_ISSET(s, writeset);
+    TickType_t fim = timeout ? xTaskGetTickCount() + pdMS_TO_TICKS(timeout->tv_sec * 1000 + timeout->tv_usec / 1000)
+                             : portMAX_DELAY;
+    while (1) {
+        int pronto_ler = ler_pedido && (s_sock.n > 0 || s_sock.fechado_par);
+        int pronto_escrever = escrever_pedido && s_sock.conectado;
+        TickType_t agora = xTaskGetTickCount();
+        if (pronto_ler || pronto_escrever || (timeout && (int32_t)(fim - agora) <= 0)) {
+            if (readset && !pronto_ler) FD_CLR(s, readset);
+            if (writeset && !pronto_escrever) FD_CLR(s, writeset);
+            return pronto_ler + pronto_escrever;
+        }
+        xSemaphoreTake(s_dados, timeout ? fim - agora : portMAX_DELAY);
+    }
+}
+
+int lwip_fcntl(int s, int cmd, int val)
+{
+    if (invalido(s))
+        return -1;
+    if (cmd == F_GETFL)
+        return s_sock.flags;
+    if (cmd == F_SETFL) {
+        s_sock.flags = val;
+        return 0;
+    }
+    errno = EINVAL;
+    return -1;
+}
+
+int lwip_getsockopt(int s, int level, int optname, void *optval, socklen_t *optlen)
+{
+    if (invalido(s))
+        return -1;
+    if (level == SOL_SOCKET && optname == SO_ERROR && *optlen >= sizeof(int)) {
+        *(int *)optval = 0;
+        return 0;
+    }
+    errno = ENOPROTOOPT;
+    return -1;
+}
+
+// SO_SNDTIMEO, TCP_NODELAY: sem efeito, o broker nunca deixa o envio esperando
+int lwip_setsockopt(int s, int level, int optname, const void *optval, socklen_t optlen)
+{
+    (void)level;
+    (void)optname;
+    (void)optval;
+    (void)optlen;
+    return invalido(s) ? -1 : 0;
+}
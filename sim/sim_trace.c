@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include "FreeRTOS.h"
+#include "task.h"
+#include "pico.h"
+#include "sample_ring.h"
+#include "core_load.h"
+#include "sensor_timing.h"
+#include "log_async.h"
+#include "sim_trace.h"
+
+// Definidos em blink.c
+extern sample_ring_t anelAmostras;
+extern TaskHandle_t hTarefaSensor;
+
+// Instante de cada commit no anel, pela ordem; cobre quedas do broker de alguns minutos
+#define SIM_TRACE_FIFO 1024
+
+static uint64_t s_send_us[SIM_TRACE_FIFO];
+static uint32_t s_head;
+
+static uint64_t s_last_delay_us;
+static TickType_t s_last_wake_tick;
+
+static sim_acc_t s_loop_period;
+static sim_acc_t s_loop_active;
+static sim_acc_t s_latency;
+
+void sim_acc_add(sim_acc_t *acc, uint64_t v)
+{
+    if (acc->n == 0 || v < acc->min) acc->min = v;
+    if (v > acc->max) acc->max = v;
+    acc->sum += v;
+    acc->n++;
+}
+
+void sim_acc_print(const char *label, const sim_acc_t *acc, const char *unit)
+{
+    if (acc->n == 0) {
+        printf("[SIM] %s: sem amostras\n", label);
+        return;
+    }
+    printf("[SIM] %s: n=%lu min=%llu méd=%llu máx=%llu %s\n", label, (unsigned long)acc->n,
+           (unsigned long long)acc->min, (unsigned long long)(acc->sum / acc->n), (unsigned long long)acc->max, unit);
+}
+
+void sim_trace_init(void)
+{
+    s_head = 0;
+}
+
+void sim_trace_ring_commit(void *ring)
+{
+    if (ring != (void *)&anelAmostras) return;
+    s_send_us[s_head++ % SIM_TRACE_FIFO] = time_us_64();
+}
+
+
+// Chamado só quando o laço vai de fato dormir (prazo ainda não passou)
+void sim_trace_task_delay_until(unsigned long wake_tick)
+{
+    if (hTarefaSensor == NULL || xTaskGetCurrentTaskHandle() != hTarefaSensor) return;
+    uint64_t now = time_us_64();
+    if (s_last_delay_us) {
+        // Tempo ativo: do prazo anterior (instante em que acordou) até aqui, em ticks
+        TickType_t active = xTaskGetTickCount() - s_last_wake_tick;
+        sim_acc_add(&s_loop_period, now - s_last_delay_us);
+        sim_acc_add(&s_loop_active, (uint64_t)active * portTICK_PERIOD_MS * 1000u);
+    }
+    s_last_delay_us = now;
+    s_last_wake_tick = (TickType_t)wake_tick;
+}
+
+void sim_trace_sample_published(uint32_t seq)
+{
+    if (seq >= s_head || s_head - seq > SIM_TRACE_FIFO) return;
+    sim_acc_add(&s_latency, time_us_64() - s_send_us[seq % SIM_TRACE_FIFO]);
+}
+
+void sim_trace_report(void)
+{
+    sim_acc_print("Laço do sensor (período)", &s_loop_period, "us");
+    sim_acc_print("Laço do sensor (tempo ativo)", &s_loop_active, "us");
+    sim_acc_print("Latência amostra->publicação", &s_latency, "us");
+    // Mesmas grandezas medidas pelo próprio firmware (inc/sensor_timing.c, vão no diagnóstico)
+    sensor_timing_t prazos;
+    sensor_timing_get(&prazos);
+    printf("[SIM] Prazos do laço (firmware): %lu ciclos de %lu ms, %lu prazos perdidos, erro de período máx %lu us, "
+           "tempo ativo máx %lu us, latência máx %lu us (%lu amostras ao vivo)\n",
+           (unsigned long)prazos.cycles, (unsigned long)prazos.period_ms, (unsigned long)prazos.overruns,
+           (unsigned long)prazos.period_err.max_us, (unsigned long)prazos.active_max_us,
+           (unsigned long)prazos.latency.max_us, (unsigned long)prazos.latency.count);
+    sample_ring_stats_t anel;
+    sample_ring_get_stats(&anelAmostras, &anel);
+    printf("[SIM] Anel de amostras: %lu publicadas, ocupação máx %lu de %lu, descartes %lu\n",
+           (unsigned long)anel.commits, (unsigned long)anel.high_water, (unsigned long)anel.capacity,
+           (unsigned long)anel.drops);
+    log_async_stats_t log;
+    log_async_get_stats(&log);
+    printf("[SIM] Log diferido: %lu registros, %lu escritos, %lu descartados, ocupação máx %lu de %d\n",
+           (unsigned long)log.written, (unsigned long)log.printed, (unsigned long)log.dropped,
+           (unsigned long)log.high_water, LOG_RING_SIZE);
+#if CORE_LOAD_PROFILE
+    core_load_stats_t carga;
+    core_load_get_stats(&carga);
+    printf("[SIM] Carga do núcleo (port POSIX, 1 núcleo): %lu intervalos, média %u.%u%%, pior %u.%u%%\n",
+           (unsigned long)carga.intervals, carga.avg_permille[0] / 10, carga.avg_permille[0] % 10,
+           carga.max_permille[0] / 10, carga.max_permille[0] % 10);
+#endif
+}
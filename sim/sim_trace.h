@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdint.h>
+
+// Métricas da simulação alimentadas pelos ganchos de trace do FreeRTOS (FreeRTOSConfig.h do sim):
+//   - período e tempo ativo do laço de tarefaSensorBMP280 (entre chamadas a xTaskDelayUntil)
+//   - ocupação máxima e descartes do anel de amostras (inc/sample_ring.c)
+//   - latência amostra -> publicação (commit no anel até mqtt_publish no broker local)
+
+typedef struct {
+    uint32_t n;
+    uint64_t sum;
+    uint64_t min;
+    uint64_t max;
+} sim_acc_t;
+
+void sim_acc_add(sim_acc_t *acc, uint64_t v);
+void sim_acc_print(const char *label, const sim_acc_t *acc, const char *unit);
+
+void sim_trace_init(void);
+// Primeira publicação da amostra seq. A flash simulada começa vazia, então seq é
+// a ordem de commit no anel (ao vivo ou reenviada do diário).
+void sim_trace_sample_published(uint32_t seq);
+void sim_trace_report(void);
@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <string.h>
+#include "telemetry_decode.h"
+
+typedef struct {
+    const uint8_t *p;
+    const uint8_t *end;
+    bool erro;
+} leitor_t;
+
+static bool head(leitor_t *r, uint8_t *major, uint32_t *v)
+{
+    if (r->erro || r->p >= r->end) goto falha;
+    uint8_t ib = *r->p++;
+    *major = ib >> 5;
+    uint8_t ai = ib & 0x1F;
+    if (ai < 24) {
+        *v = ai;
+        return true;
+    }
+    size_t n = ai == 24 ? 1 : ai == 25 ? 2 : ai == 26 ? 4 : 0;
+    if (n == 0 || r->end - r->p < (ptrdiff_t)n) goto falha;   // 64 bits/indefinido fora do formato v1
+    *v = 0;
+    while (n--) *v = (*v << 8) | *r->p++;
+    return true;
+falha:
+    r->erro = true;
+    return false;
+}
+
+static uint32_t ler_uint(leitor_t *r)
+{
+    uint8_t major;
+    uint32_t v;
+    if (!head(r, &major, &v) || major != 0) {
+        r->erro = true;
+        return 0;
+    }
+    return v;
+}
+
+static int32_t ler_int(leitor_t *r)
+{
+    uint8_t major;
+    uint32_t v;
+    if (!head(r, &major, &v) || major > 1) {
+        r->erro = true;
+        return 0;
+    }
+    return major ? -1 - (int32_t)v : (int32_t)v;
+}
+
+static uint32_t ler_array(leitor_t *r)
+{
+    uint8_t major;
+    uint32_t v;
+    if (!head(r, &major, &v) || major != 4) {
+        r->erro = true;
+        return 0;
+    }
+    return v;
+}
+
+// Texto de até cap-1 bytes, terminado em '\0'
+static void ler_texto(leitor_t *r, char *out, size_t cap)
+{
+    uint8_t major;
+    uint32_t n;
+    if (!head(r, &major, &n) || major != 3 || n >= cap || r->end - r->p < (ptrdiff_t)n) {
+        r->erro = true;
+        out[0] = '\0';
+        return;
+    }
+    memcpy(out, r->p, n);
+    out[n] = '\0';
+    r->p += n;
+}
+
+size_t telemetry_decode_cbor(const uint8_t *buf, size_t len, telemetry_decoded_t *out)
+{
+    leitor_t r = {buf, buf + len, false};
+    uint32_t itens = ler_array(&r);
+    out->version = ler_uint(&r);
+    // v1: sem seq0 (amostras saem com seq 0)
+    if (!((out->version == 1 && itens == 5) || (out->version == TELEMETRY_CBOR_VERSION && itens == 6))) return 0;
+    uint32_t seq = out->version == 1 ? 0 : ler_uint(&r);
+    uint32_t t = ler_uint(&r);
+    out->meta.dist_threshold_mm = (uint16_t)ler_uint(&r);
+    out->meta.temp_threshold_c100 = (int16_t)ler_int(&r);
+    out->count = ler_array(&r);
+    if (r.erro || out->count > sizeof out->samples / sizeof out->samples[0]) return 0;
+
+    for (size_t i = 0; i < out->count; ++i) {
+        telemetry_sample_t *s = &out->samples[i];
+        uint32_t campos = ler_array(&r);
+        if (campos != 4 && campos != 6) return 0;
+        t += ler_uint(&r);
+        s->seq = out->version == 1 ? 0 : seq + (uint32_t)i;
+        s->t_ms = t;
+        s->temp_c100 = (int16_t)ler_int(&r);
+        s->pres_pa = ler_uint(&r);
+        s->dist_mm = (uint16_t)ler_uint(&r);
+        s->bpm_x10 = campos == 6 ? (uint16_t)ler_uint(&r) : 0;
+        s->spo2_x10 = campos == 6 ? (uint16_t)ler_uint(&r) : 0;
+    }
+    return r.erro ? 0 : (size_t)(r.p - buf);
+}
+
+void telemetry_print_json(const telemetry_decoded_t *d)
+{
+    for (size_t i = 0; i < d->count; ++i) {
+        const telemetry_sample_t *s = &d->samples[i];
+        printf("{\"seq\": %lu, \"t_ms\": %lu, \"temp\": %.2f, \"pres\": %lu, \"dist\": %u", (unsigned long)s->seq,
+               (unsigned long)s->t_ms,
+               s->temp_c100 / 100.0, (unsigned long)s->pres_pa, (unsigned)s->dist_mm);
+        if (s->bpm_x10)
+            printf(", \"bpm\": %.1f, \"spo2\": %.1f", s->bpm_x10 / 10.0, s->spo2_x10 / 10.0);
+        printf(", \"threshold_mm\": %u, \"temp_threshold_c\": %.2f}\n", (unsigned)d->meta.dist_threshold_mm,
+               d->meta.temp_threshold_c100 / 100.0);
+    }
+}
+
+static bool ler_hist(leitor_t *r, timing_hist_t *h)
+{
+    memset(h, 0, sizeof *h);
+    if (ler_array(r) != 4) return false;
+    h->base_us = ler_uint(r);
+    h->count = ler_uint(r);
+    h->max_us = ler_uint(r);
+    uint32_t n = ler_array(r);
+    if (n > SENSOR_TIMING_BINS) return false;
+    for (uint32_t i = 0; i < n; ++i)
+        h->bins[i] = ler_uint(r);
+    return !r->erro;
+}
+
+size_t diag_decode_cbor(const uint8_t *buf, size_t len, diag_decoded_t *out)
+{
+    leitor_t r = {buf, buf + len, false};
+    uint32_t itens = ler_array(&r);
+    out->version = ler_uint(&r);
+    if (out->version < 1 || out->version > DIAG_CBOR_VERSION || itens != 7 + out->version) return 0;
+    out->uptime_s = ler_uint(&r);
+    out->interval_ms = ler_uint(&r);
+    out->heap_free = ler_uint(&r);
+    out->heap_min = ler_uint(&r);
+    out->task_count = ler_array(&r);
+    if (r.erro || out->task_count > DIAG_MAX_TASKS) return 0;
+    for (size_t i = 0; i < out->task_count; ++i) {
+        diag_task_t *t = &out->tasks[i];
+        if (ler_array(&r) != 5) return 0;
+        ler_texto(&r, t->name, sizeof t->name);
+        t->prio = ler_uint(&r);
+        t->core = ler_int(&r);
+        t->stack_free_words = ler_uint(&r);
+        t->cpu_permille = ler_uint(&r);
+    }
+    if (ler_array(&r) != 3) return 0;
+    for (int i = 0; i < 3; ++i)
+        out->mem[i] = ler_uint(&r);
+    if (ler_array(&r) != DIAG_POOLS) return 0;
+    for (int i = 0; i < DIAG_POOLS; ++i) {
+        if (ler_array(&r) != 3) return 0;
+        for (int k = 0; k < 3; ++k)
+            out->pools[i][k] = ler_uint(&r);
+    }
+    memset(&out->timing, 0, sizeof out->timing);
+    if (out->version >= 2) {
+        sensor_timing_t *t = &out->timing;
+        if (ler_array(&r) != 6) return 0;
+        t->period_ms = ler_uint(&r);
+        t->cycles = ler_uint(&r);
+        t->overruns = ler_uint(&r);
+        t->active_max_us = ler_uint(&r);
+        if (!ler_hist(&r, &t->period_err) || !ler_hist(&r, &t->latency)) return 0;
+    }
+    memset(&out->net, 0, sizeof out->net);
+    if (out->version >= 3) {
+        net_conn_stats_t *n = &out->net;
+        if (ler_array(&r) != NET_CONN_CBOR_ITEMS) return 0;
+        uint32_t *campos[NET_CONN_CBOR_ITEMS] = {
+            &n->state,         &n->sessions,           &n->reconnects,       &n->drops,
+            &n->wifi_failures, &n->dns_failures,       &n->connect_failures, &n->refused,
+            &n->subscribe_failures, &n->last_connect_ms, &n->max_connect_ms, &n->total_connect_ms,
+        };
+        for (int i = 0; i < NET_CONN_CBOR_ITEMS; ++i)
+            *campos[i] = ler_uint(&r);
+    }
+    memset(&out->power, 0, sizeof out->power);
+    if (out->version >= 4) {
+        power_save_stats_t *e = &out->power;
+        if (ler_array(&r) != POWER_SAVE_CBOR_ITEMS) return 0;
+        uint32_t *campos[POWER_SAVE_CBOR_ITEMS] = {
+            &e->low_power, &e->radio_awake_ms, &e->radio_ps_ms,  &e->bursts,       &e->tx_msgs,
+            &e->tx_bytes,  &e->airtime_us,     &e->core_busy_ms, &e->core_idle_ms, &e->charge_mas,
+        };
+        for (int i = 0; i < POWER_SAVE_CBOR_ITEMS; ++i)
+            *campos[i] = ler_uint(&r);
+    }
+    return r.erro ? 0 : (size_t)(r.p - buf);
+}
+
+// Faixas como {"<limite_us>": contagem}; a última, aberta, como ">=limite"
+static void imprime_hist(const timing_hist_t *h)
+{
+    printf("{\"count\": %lu, \"max_us\": %lu, \"bins\": {", (unsigned long)h->count, (unsigned long)h->max_us);
+    bool primeiro = true;
+    for (unsigned i = 0; i < SENSOR_TIMING_BINS; ++i) {
+        if (!h->bins[i]) continue;
+        if (i < SENSOR_TIMING_BINS - 1)
+            printf("%s\"<%lu\": %lu", primeiro ? "" : ", ", (unsigned long)h->base_us << i, (unsigned long)h->bins[i]);
+        else
+            printf("%s\">=%lu\": %lu", primeiro ? "" : ", ", (unsigned long)h->base_us << (i - 1),
+                   (unsigned long)h->bins[i]);
+        primeiro = false;
+    }
+    printf("}}");
+}
+
+void diag_print_json(const diag_decoded_t *d)
+{
+    static const char *const pools[DIAG_POOLS] = {"pbuf_pool", "pbuf", "tcp_pcb", "tcp_seg", "sys_timeout"};
+    printf("{\"uptime_s\": %lu, \"interval_ms\": %lu, \"heap_free\": %lu, \"heap_min\": %lu, \"tasks\": [",
+           (unsigned long)d->uptime_s, (unsigned long)d->interval_ms, (unsigned long)d->heap_free,
+           (unsigned long)d->heap_min);
+    for (size_t i = 0; i < d->task_count; ++i) {
+        const diag_task_t *t = &d->tasks[i];
+        printf("%s{\"name\": \"%s\", \"prio\": %lu, \"core\": %ld, \"stack_free\": %lu, \"cpu\": %.1f}",
+               i ? ", " : "", t->name, (unsigned long)t->prio, (long)t->core, (unsigned long)t->stack_free_words,
+               t->cpu_permille / 10.0);
+    }
+    printf("], \"mem\": {\"used\": %lu, \"max\": %lu, \"err\": %lu}", (unsigned long)d->mem[0],
+           (unsigned long)d->mem[1], (unsigned long)d->mem[2]);
+    for (int i = 0; i < DIAG_POOLS; ++i)
+        printf(", \"%s\": {\"used\": %lu, \"max\": %lu, \"err\": %lu}", pools[i], (unsigned long)d->pools[i][0],
+               (unsigned long)d->pools[i][1], (unsigned long)d->pools[i][2]);
+    if (d->version >= 2) {
+        const sensor_timing_t *t = &d->timing;
+        printf(", \"sensor\": {\"period_ms\": %lu, \"cycles\": %lu, \"overruns\": %lu, \"active_max_us\": %lu, "
+               "\"period_err\": ",
+               (unsigned long)t->period_ms, (unsigned long)t->cycles, (unsigned long)t->overruns,
+               (unsigned long)t->active_max_us);
+        imprime_hist(&t->period_err);
+        printf(", \"latency\": ");
+        imprime_hist(&t->latency);
+        printf("}");
+    }
+    if (d->version >= 3) {
+        static const char *const estados[] = {"wifi", "dns", "connect", "subscribe", "online", "backoff"};
+        const net_conn_stats_t *n = &d->net;
+        printf(", \"net\": {\"state\": \"%s\", \"sessions\": %lu, \"reconnects\": %lu, \"drops\": %lu, "
+               "\"failures\": {\"wifi\": %lu, \"dns\": %lu, \"connect\": %lu, \"refused\": %lu, \"subscribe\": %lu}, "
+               "\"connect_ms\": {\"last\": %lu, \"max\": %lu, \"mean\": %lu}}",
+               n->state < sizeof estados / sizeof estados[0] ? estados[n->state] : "?", (unsigned long)n->sessions,
+               (unsigned long)n->reconnects, (unsigned long)n->drops, (unsigned long)n->wifi_failures,
+               (unsigned long)n->dns_failures, (unsigned long)n->connect_failures, (unsigned long)n->refused,
+               (unsigned long)n->subscribe_failures, (unsigned long)n->last_connect_ms,
+               (unsigned long)n->max_connect_ms,
+               (unsigned long)(n->sessions ? n->total_connect_ms / n->sessions : 0));
+    }
+    if (d->version >= 4) {
+        // Corrente média desde o boot: mA·s / s = mA
+        const power_save_stats_t *e = &d->power;
+        uint32_t total_ms = e->radio_awake_ms + e->radio_ps_ms;
+        printf(", \"power\": {\"low_power\": %s, \"radio_ms\": {\"awake\": %lu, \"ps\": %lu}, \"bursts\": %lu, "
+               "\"tx\": {\"msgs\": %lu, \"bytes\": %lu, \"airtime_us\": %lu}, "
+               "\"core_ms\": {\"busy\": %lu, \"idle\": %lu}, \"charge_mas\": %lu, \"avg_ma\": %.2f}",
+               e->low_power ? "true" : "false", (unsigned long)e->radio_awake_ms, (unsigned long)e->radio_ps_ms,
+               (unsigned long)e->bursts, (unsigned long)e->tx_msgs, (unsigned long)e->tx_bytes,
+               (unsigned long)e->airtime_us, (unsigned long)e->core_busy_ms, (unsigned long)e->core_idle_ms,
+               (unsigned long)e->charge_mas, total_ms ? e->charge_mas * 1000.0 / total_ms : 0.0);
+    }
+    printf("}\n");
+}
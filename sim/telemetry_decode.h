@@ -0,0 +1,51 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "telemetry.h"
+#include "diag.h"
+
+// Decodificador no host dos lotes CBOR de inc/telemetry.c e dos registros de
+// diagnóstico de inc/diag.c (lado do backend).
+
+typedef struct {
+    uint32_t version;            // 1 ou 2 (v1 sem número de sequência)
+    telemetry_meta_t meta;
+    size_t count;
+    telemetry_sample_t samples[23];   // timestamps já absolutos
+} telemetry_decoded_t;
+
+// Decodifica um lote no início de buf. Retorna os bytes consumidos (vários
+// lotes podem vir concatenados, ex. mosquitto_sub -N) ou 0 se inválido/incompleto.
+size_t telemetry_decode_cbor(const uint8_t *buf, size_t len, telemetry_decoded_t *out);
+// Uma linha JSON por amostra decodificada
+void telemetry_print_json(const telemetry_decoded_t *d);
+
+typedef struct {
+    char name[DIAG_NAME_LEN + 1];
+    uint32_t prio;
+    int32_t core;                // -1 = sem afinidade
+    uint32_t stack_free_words;
+    uint32_t cpu_permille;
+} diag_task_t;
+
+typedef struct {
+    uint32_t version;            // 1 a 4 (v1 sem os prazos do laço de aquisição, v2 sem a conexão, v3 sem a energia)
+    uint32_t uptime_s;
+    uint32_t interval_ms;
+    uint32_t heap_free;
+    uint32_t heap_min;
+    size_t task_count;
+    diag_task_t tasks[DIAG_MAX_TASKS];
+    uint32_t mem[3];             // used, max, err
+    uint32_t pools[DIAG_POOLS][3];
+    sensor_timing_t timing;
+    net_conn_stats_t net;
+    power_save_stats_t power;
+} diag_decoded_t;
+
+// Registro de diagnóstico no início de buf; bytes consumidos ou 0 se inválido
+size_t diag_decode_cbor(const uint8_t *buf, size_t len, diag_decoded_t *out);
+// Um objeto JSON por registro
+void diag_print_json(const diag_decoded_t *d);
@@ -0,0 +1,54 @@
+// Decodifica lotes CBOR da telemetria lidos da entrada padrão e imprime uma linha JSON por amostra.
+//   mosquitto_sub -h test.mosquitto.org -t pico_w/sensor/cbor -N | ./build_sim/telemetry_decode
+// Com -d, registros de diagnóstico (inc/diag.c), um objeto JSON por registro:
+//   mosquitto_sub -h test.mosquitto.org -t pico_w/diag -N | ./build_sim/telemetry_decode -d
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "telemetry_decode.h"
+
+int main(int argc, char **argv)
+{
+    bool diag = argc > 1 && strcmp(argv[1], "-d") == 0;
+    static uint8_t buf[4096];
+    size_t len = 0;
+    ssize_t n;
+    int erro = 0;
+
+    // read() devolve o que já chegou: lotes saem assim que o mosquitto_sub os entrega
+    while ((n = read(STDIN_FILENO, buf + len, sizeof buf - len)) > 0 || len > 0) {
+        if (n < 0) return 1;
+        len += (size_t)n;
+        size_t pos = 0;
+        static telemetry_decoded_t d;
+        static diag_decoded_t dd;
+        size_t usado;
+        while (pos < len && (usado = diag ? diag_decode_cbor(buf + pos, len - pos, &dd)
+                                          : telemetry_decode_cbor(buf + pos, len - pos, &d)) > 0) {
+            if (diag)
+                diag_print_json(&dd);
+            else
+                telemetry_print_json(&d);
+            fflush(stdout);
+            pos += usado;
+        }
+        memmove(buf, buf + pos, len - pos);
+        len -= pos;
+        if (n == 0) {
+            // Fim da entrada com bytes que não formam um lote
+            if (len) {
+                fprintf(stderr, "telemetry_decode: %zu bytes finais inválidos\n", len);
+                erro = 1;
+            }
+            break;
+        }
+        if (len == sizeof buf) {
+            if (diag)
+                fprintf(stderr, "telemetry_decode: entrada não é um registro de diagnóstico v%d\n", DIAG_CBOR_VERSION);
+            else
+                fprintf(stderr, "telemetry_decode: entrada não é um lote CBOR v1/v%d\n", TELEMETRY_CBOR_VERSION);
+            return 1;
+        }
+    }
+    return erro;
+}